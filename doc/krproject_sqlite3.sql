@@ -183,11 +183,18 @@ REC_ID               INTEGER                        not null,
 DATASRC_ID           INTEGER                        not null,
 PROC_TIME            TIMESTAMP                      not null,
 TRANS_TIME           TIMESTAMP                      not null,
+KEY_VALUE            VARCHAR(64)                    not null,
 RECORD_LENGTH        INTEGER,
 RECORD_BUFFER        VARCHAR(4096),
 primary key (REC_ID)
 );
 
+create index IDX_RECORD_KEY on KR_TBL_RECORD (
+DATASRC_ID ASC,
+KEY_VALUE ASC,
+TRANS_TIME ASC
+);
+
 create table KR_TBL_RULE (
 RULE_ID              INTEGER                        not null,
 RULE_NAME            VARCHAR(30)                    not null,
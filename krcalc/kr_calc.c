@@ -2,6 +2,7 @@
 #include "kr_calc_tree.h"
 #include "kr_calc_parser.h"
 #include "kr_calc_dumper.h"
+#include "kr_calc_profile.h"
 
 
 T_KRCalc *kr_calc_construct(E_KRCalcFormat format, char *calcstr, 
@@ -21,6 +22,14 @@ T_KRCalc *kr_calc_construct(E_KRCalcFormat format, char *calcstr,
         kr_free(krcalc);
         return NULL;
     }
+
+    /*attach shared profile if profiling enabled*/
+    if (kr_calc_profile_rate() > 0) {
+        if (kr_calc_profile_attach(krcalc) != 0) {
+            KR_LOG(KR_LOGERROR, "kr_calc_profile_attach [%s] failed!", 
+                    krcalc->calc_string);
+        }
+    }
     
     return krcalc;
 }
@@ -47,9 +56,32 @@ int kr_calc_check(T_KRCalc *krcalc)
 /* evaluate the calc with current record as parameter */
 int kr_calc_eval(T_KRCalc *krcalc, void *param)
 {
+    int ret = 0;
     krcalc->calc_param = param;
 
-    if (kr_calc_tree_eval(krcalc->calc_tree, krcalc) != 0) {
+    /*rebind if param's slots rebuilt since last bind*/
+    if (krcalc->calc_bound != 0 && krcalc->bind_stamp_cb != NULL &&
+            krcalc->bind_stamp_cb(param) != krcalc->calc_bind_stamp) {
+        kr_calc_unbind(krcalc);
+    }
+
+    /*specialize on first evaluation, types resolved with param*/
+    if (krcalc->calc_bound == 0) {
+        kr_calc_bind(krcalc, param);
+    }
+
+    /*only 1 in calc_sample_rate evaluations get profiled*/
+    if (krcalc->calc_profile != NULL && 
+            ++krcalc->calc_sample_cnt >= krcalc->calc_sample_rate) {
+        krcalc->calc_sample_cnt = 0;
+        ret = kr_calc_tree_eval_profile(krcalc->calc_tree, krcalc);
+    } else if (krcalc->calc_bound == 1) {
+        ret = kr_calc_tree_eval_bound(krcalc->calc_tree, krcalc);
+    } else {
+        ret = kr_calc_tree_eval(krcalc->calc_tree, krcalc);
+    }
+
+    if (ret != 0) {
         KR_LOG(KR_LOGERROR, "kr_calc_tree_eval %s failed", 
                 krcalc->calc_string);
         return -1;
@@ -59,6 +91,48 @@ int kr_calc_eval(T_KRCalc *krcalc, void *param)
 }
 
 
+/* set slot binding functions, slots belong to param,
+ * calc rebinds when param's bind stamp changes
+ */
+void kr_calc_set_bind_func(T_KRCalc *krcalc, 
+        KRBindFunc bind_func, KRGetSlotFunc get_slot_func, 
+        KRBindStampFunc bind_stamp_func)
+{
+    krcalc->bind_cb = bind_func;
+    krcalc->get_slot_cb = get_slot_func;
+    krcalc->bind_stamp_cb = bind_stamp_func;
+    kr_calc_unbind(krcalc);
+}
+
+/* resolve extern types and slots, check and specialize the tree */
+int kr_calc_bind(T_KRCalc *krcalc, void *param)
+{
+    krcalc->calc_param = param;
+    if (krcalc->bind_stamp_cb != NULL) {
+        krcalc->calc_bind_stamp = krcalc->bind_stamp_cb(param);
+    }
+
+    if (kr_calc_tree_bind(krcalc->calc_tree, krcalc) != 0) {
+        KR_LOG(KR_LOGDEBUG, "kr_calc_tree_bind %s failed [%s]", 
+                krcalc->calc_string, krcalc->calc_errmsg);
+        kr_calc_tree_unbind(krcalc->calc_tree);
+        krcalc->calc_bound = -1;
+        return -1;
+    }
+    
+    krcalc->calc_bound = 1;
+    return 0;
+}
+
+void kr_calc_unbind(T_KRCalc *krcalc)
+{
+    if (krcalc != NULL) {
+        kr_calc_tree_unbind(krcalc->calc_tree);
+        krcalc->calc_bound = 0;
+    }
+}
+
+
 int kr_calc_status(T_KRCalc *krcalc)
 {
     return krcalc->calc_status;
@@ -84,3 +158,13 @@ U_KRValue *kr_calc_value(T_KRCalc *krcalc)
     return &krcalc->calc_tree->value;
 }
 
+int kr_calc_has_kind(T_KRCalc *krcalc, E_KRCalcKind kind)
+{
+    return kr_calc_tree_has_kind(krcalc->calc_tree, kind);
+}
+
+void kr_calc_foreach_id(T_KRCalc *krcalc, KRCalcIdFunc func, void *data)
+{
+    kr_calc_tree_foreach_id(krcalc->calc_tree, func, data);
+}
+
@@ -6,10 +6,19 @@
 /* callback function definition*/
 typedef E_KRType (*KRGetTypeFunc)(char kind, int id, void *param);
 typedef void *(*KRGetValueFunc)(char kind, int id, void *param);
+/* optional, resolve id to a slot once, then get value by slot */
+typedef void *(*KRBindFunc)(char kind, int id, void *param);
+typedef void *(*KRGetSlotFunc)(char kind, void *slot, void *param);
+typedef long (*KRBindStampFunc)(void *param);
+/* called with each identifier referenced by a calculator */
+typedef void (*KRCalcIdFunc)(int kind, int id, void *data);
 
 /*T_KRCalcTree forward declaration*/
 typedef struct _kr_calc_tree_t T_KRCalcTree;
 
+/*T_KRCalcProfile forward declaration*/
+typedef struct _kr_calc_profile_t T_KRCalcProfile;
+
 /* operation code */
 typedef enum {
     /* arithmetic operation code */
@@ -54,7 +63,8 @@ typedef enum {
     KR_CALCKIND_FID     = 12,  /*field identifier*/
     KR_CALCKIND_SID     = 13,  /*static identifier*/
     KR_CALCKIND_DID     = 14,  /*dynamic identifier*/
-    KR_CALCKIND_HID     = 15   /*history identifier*/
+    KR_CALCKIND_HID     = 15,  /*history identifier*/
+    KR_CALCKIND_GID     = 16   /*global frequency identifier*/
 }E_KRCalcKind;
 
 /* Format of this calculator */
@@ -72,15 +82,25 @@ typedef struct _kr_calc_t
     char             *calc_string;
     KRGetTypeFunc     get_type_cb;
     KRGetValueFunc    get_value_cb;
+    KRBindFunc        bind_cb;
+    KRGetSlotFunc     get_slot_cb;
+    KRBindStampFunc   bind_stamp_cb;
     
     /* inner fields */
     T_KRCalcTree     *calc_tree;
     void             *calc_state;        /*state of the lexer*/
+    int               calc_bound;        /*0:not yet,1:specialized,-1:failed*/
+    long              calc_bind_stamp;   /*param's stamp when bound*/
 
     /* parameter for evaluate */
     void             *calc_param;
     int               calc_status;       /*0:success,-1:failure*/
     char              calc_errmsg[1024];
+
+    /* profiling, attached only while profiling enabled */
+    T_KRCalcProfile  *calc_profile;
+    unsigned int      calc_sample_rate;  /*profile 1 in N evaluations*/
+    unsigned int      calc_sample_cnt;
 }T_KRCalc;
 
 /* function declarations */
@@ -92,6 +112,11 @@ extern T_KRCalc *kr_calc_construct(E_KRCalcFormat format, char *calcstr,
 extern void kr_calc_destruct(T_KRCalc *krcalc);
 extern int kr_calc_check(T_KRCalc *krcalc);
 extern int kr_calc_eval(T_KRCalc *krcalc, void *param);
+extern void kr_calc_set_bind_func(T_KRCalc *krcalc, 
+        KRBindFunc bind_func, KRGetSlotFunc get_slot_func, 
+        KRBindStampFunc bind_stamp_func);
+extern int kr_calc_bind(T_KRCalc *krcalc, void *param);
+extern void kr_calc_unbind(T_KRCalc *krcalc);
 
 /*calculator result functions*/
 extern int kr_calc_status(T_KRCalc *krcalc);
@@ -99,5 +124,8 @@ extern char *kr_calc_errmsg(T_KRCalc *krcalc);
 extern E_KRType kr_calc_type(T_KRCalc *krcalc);
 extern U_KRValue *kr_calc_value(T_KRCalc *krcalc);
 extern E_KRValueInd kr_calc_ind(T_KRCalc *krcalc);
+extern int kr_calc_has_kind(T_KRCalc *krcalc, E_KRCalcKind kind);
+extern void kr_calc_foreach_id(T_KRCalc *krcalc, 
+        KRCalcIdFunc func, void *data);
 
 #endif    /* __KR_CALC_H__ */
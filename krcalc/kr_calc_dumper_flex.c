@@ -99,6 +99,9 @@ static char *_kr_calc_dump_flex(T_KRCalcTree *t, char *str)
         case KR_CALCKIND_HID:
             str += sprintf(str, "H_%d", t->id);
             break;    
+        case KR_CALCKIND_GID:
+            str += sprintf(str, "G_%d", t->id);
+            break;    
         default:
             return NULL;
     }
@@ -63,6 +63,7 @@ static cJSON *_kr_calc_dump_json(T_KRCalcTree *t)
         case KR_CALCKIND_SID:
         case KR_CALCKIND_DID:
         case KR_CALCKIND_HID:
+        case KR_CALCKIND_GID:
         {
             cJSON_AddNumberToObject(krjson, "kind", t->kind);
             cJSON_AddNumberToObject(krjson, "value", t->id);
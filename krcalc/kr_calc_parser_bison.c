@@ -119,35 +119,36 @@ extern int yydebug;
     SID = 268,
     DID = 269,
     HID = 270,
-    SET = 271,
-    MULTI = 272,
-    REGEX = 273,
-    COMMA = 274,
-    ASSIGN = 275,
-    OR = 276,
-    AND = 277,
-    EQ = 278,
-    NEQ = 279,
-    LT = 280,
-    LE = 281,
-    GT = 282,
-    GE = 283,
-    BL = 284,
-    NBL = 285,
-    MATCH = 286,
-    PLUS = 287,
-    SUB = 288,
-    MUT = 289,
-    DIV = 290,
-    MOD = 291,
-    LP = 292,
-    RP = 293,
-    LSP = 294,
-    RSP = 295,
-    LFP = 296,
-    RFP = 297,
-    NOT = 298,
-    UMINUS = 299
+    GID = 271,
+    SET = 272,
+    MULTI = 273,
+    REGEX = 274,
+    COMMA = 275,
+    ASSIGN = 276,
+    OR = 277,
+    AND = 278,
+    EQ = 279,
+    NEQ = 280,
+    LT = 281,
+    LE = 282,
+    GT = 283,
+    GE = 284,
+    BL = 285,
+    NBL = 286,
+    MATCH = 287,
+    PLUS = 288,
+    SUB = 289,
+    MUT = 290,
+    DIV = 291,
+    MOD = 292,
+    LP = 293,
+    RP = 294,
+    LSP = 295,
+    RSP = 296,
+    LFP = 297,
+    RFP = 298,
+    NOT = 299,
+    UMINUS = 300
   };
 #endif
 /* Tokens.  */
@@ -164,35 +165,36 @@ extern int yydebug;
 #define SID 268
 #define DID 269
 #define HID 270
-#define SET 271
-#define MULTI 272
-#define REGEX 273
-#define COMMA 274
-#define ASSIGN 275
-#define OR 276
-#define AND 277
-#define EQ 278
-#define NEQ 279
-#define LT 280
-#define LE 281
-#define GT 282
-#define GE 283
-#define BL 284
-#define NBL 285
-#define MATCH 286
-#define PLUS 287
-#define SUB 288
-#define MUT 289
-#define DIV 290
-#define MOD 291
-#define LP 292
-#define RP 293
-#define LSP 294
-#define RSP 295
-#define LFP 296
-#define RFP 297
-#define NOT 298
-#define UMINUS 299
+#define GID 271
+#define SET 272
+#define MULTI 273
+#define REGEX 274
+#define COMMA 275
+#define ASSIGN 276
+#define OR 277
+#define AND 278
+#define EQ 279
+#define NEQ 280
+#define LT 281
+#define LE 282
+#define GT 283
+#define GE 284
+#define BL 285
+#define NBL 286
+#define MATCH 287
+#define PLUS 288
+#define SUB 289
+#define MUT 290
+#define DIV 291
+#define MOD 292
+#define LP 293
+#define RP 294
+#define LSP 295
+#define RSP 296
+#define LFP 297
+#define RFP 298
+#define NOT 299
+#define UMINUS 300
 
 /* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
@@ -449,23 +451,23 @@ union yyalloc
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  21
+#define YYFINAL  22
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   70
+#define YYLAST   69
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  45
+#define YYNTOKENS  46
 /* YYNNTS -- Number of nonterminals.  */
 #define YYNNTS  8
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  36
+#define YYNRULES  37
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  59
+#define YYNSTATES  60
 
 /* YYTRANSLATE[YYX] -- Symbol number corresponding to YYX as returned
    by yylex, with out-of-bounds checking.  */
 #define YYUNDEFTOK  2
-#define YYMAXUTOK   299
+#define YYMAXUTOK   300
 
 #define YYTRANSLATE(YYX)                                                \
   ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
@@ -503,7 +505,8 @@ static const yytype_uint8 yytranslate[] =
        5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
       15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
       25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
-      35,    36,    37,    38,    39,    40,    41,    42,    43,    44
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
+      45
 };
 
 #if YYDEBUG
@@ -513,7 +516,7 @@ static const yytype_uint8 yyrline[] =
        0,    47,    47,    51,    59,    67,    74,    78,    86,    94,
      102,   110,   118,   126,   134,   142,   150,   154,   162,   170,
      178,   186,   194,   199,   201,   205,   209,   210,   214,   215,
-     219,   220,   221,   222,   223,   224,   225
+     219,   220,   221,   222,   223,   224,   225,   226
 };
 #endif
 
@@ -523,7 +526,7 @@ static const yytype_uint8 yyrline[] =
 static const char *const yytname[] =
 {
   "$end", "error", "$undefined", "SEMI", "ENDFILE", "ERROR", "ID", "NUM",
-  "FNUM", "STR", "SCHAR", "CID", "FID", "SID", "DID", "HID", "SET",
+  "FNUM", "STR", "SCHAR", "CID", "FID", "SID", "DID", "HID", "GID", "SET",
   "MULTI", "REGEX", "COMMA", "ASSIGN", "OR", "AND", "EQ", "NEQ", "LT",
   "LE", "GT", "GE", "BL", "NBL", "MATCH", "PLUS", "SUB", "MUT", "DIV",
   "MOD", "LP", "RP", "LSP", "RSP", "LFP", "RFP", "NOT", "UMINUS",
@@ -540,14 +543,14 @@ static const yytype_uint16 yytoknum[] =
      265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
      275,   276,   277,   278,   279,   280,   281,   282,   283,   284,
      285,   286,   287,   288,   289,   290,   291,   292,   293,   294,
-     295,   296,   297,   298,   299
+     295,   296,   297,   298,   299,   300
 };
 # endif
 
-#define YYPACT_NINF -17
+#define YYPACT_NINF -13
 
 #define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-17)))
+  (!!((Yystate) == (-13)))
 
 #define YYTABLE_NINF -1
 
@@ -558,12 +561,12 @@ static const yytype_uint16 yytoknum[] =
      STATE-NUM.  */
 static const yytype_int8 yypact[] =
 {
-      -7,   -17,   -17,   -17,   -17,   -17,   -17,   -17,   -17,    20,
-      -7,    -7,    12,     0,    33,    34,   -17,   -17,   -17,     3,
-     -17,   -17,   -17,     2,     2,     2,     2,     2,     2,     2,
-       2,    15,    15,     5,     2,     2,     2,     2,     2,   -17,
-      33,    33,    34,    34,    34,    34,    34,    34,   -17,   -17,
-     -17,   -17,   -17,   -17,   -16,   -16,   -17,   -17,   -17
+      -7,   -13,   -13,   -13,   -13,   -13,   -13,   -13,   -13,   -13,
+      21,    -7,    -7,    10,     0,    33,    -1,   -13,   -13,   -13,
+       2,   -13,   -13,   -13,     4,     4,     4,     4,     4,     4,
+       4,     4,    22,    22,    -5,     4,     4,     4,     4,     4,
+     -13,    33,    33,    -1,    -1,    -1,    -1,    -1,    -1,   -13,
+     -13,   -13,   -13,   -13,   -13,    14,    14,   -13,   -13,   -13
 };
 
   /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -571,24 +574,24 @@ static const yytype_int8 yypact[] =
      means the default is an error.  */
 static const yytype_uint8 yydefact[] =
 {
-       0,    26,    28,    30,    31,    32,    33,    34,    35,     0,
-       0,     0,     0,     0,     6,    16,    22,    27,    29,     0,
-       5,     1,     2,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,    36,
-       3,     4,    11,    12,     7,     8,     9,    10,    23,    24,
-      13,    14,    25,    15,    17,    18,    19,    20,    21
+       0,    26,    28,    30,    31,    32,    33,    34,    35,    36,
+       0,     0,     0,     0,     0,     6,    16,    22,    27,    29,
+       0,     5,     1,     2,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+      37,     3,     4,    11,    12,     7,     8,     9,    10,    23,
+      24,    13,    14,    25,    15,    17,    18,    19,    20,    21
 };
 
   /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int8 yypgoto[] =
 {
-     -17,   -17,    23,    14,    17,    -3,   -17,   -17
+     -13,   -13,    55,    44,    17,   -12,   -13,   -13
 };
 
   /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-      -1,    12,    13,    14,    15,    50,    53,    16
+      -1,    13,    14,    15,    16,    51,    54,    17
 };
 
   /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -596,47 +599,45 @@ static const yytype_int8 yydefgoto[] =
      number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
-       1,     2,     3,    22,     4,     5,     6,     7,     8,     1,
-       2,     3,    21,     4,     5,     6,     7,     8,    36,    37,
-      38,    23,    24,    52,    23,    24,     9,    17,    18,    51,
-      10,    48,    49,    19,    20,     9,    11,    40,    41,    10,
-       0,    39,    42,    43,    44,    45,    46,    47,     0,     0,
-       0,    54,    55,    56,    57,    58,    25,    26,    27,    28,
-      29,    30,    31,    32,    33,     0,    34,    35,    36,    37,
-      38
+       1,     2,     3,    23,     4,     5,     6,     7,     8,     9,
+      22,     1,     2,     3,    53,     4,     5,     6,     7,     8,
+       9,    52,    24,    25,    24,    25,     0,    10,    18,    19,
+       0,    11,    35,    36,    37,    38,    39,    12,    10,    49,
+      50,    40,    11,    43,    44,    45,    46,    47,    48,    37,
+      38,    39,    55,    56,    57,    58,    59,    26,    27,    28,
+      29,    30,    31,    32,    33,    34,    20,    21,    41,    42
 };
 
 static const yytype_int8 yycheck[] =
 {
-       7,     8,     9,     3,    11,    12,    13,    14,    15,     7,
-       8,     9,     0,    11,    12,    13,    14,    15,    34,    35,
-      36,    21,    22,    18,    21,    22,    33,     7,     8,    32,
-      37,    16,    17,    10,    11,    33,    43,    23,    24,    37,
-      -1,    38,    25,    26,    27,    28,    29,    30,    -1,    -1,
-      -1,    34,    35,    36,    37,    38,    23,    24,    25,    26,
-      27,    28,    29,    30,    31,    -1,    32,    33,    34,    35,
-      36
+       7,     8,     9,     3,    11,    12,    13,    14,    15,    16,
+       0,     7,     8,     9,    19,    11,    12,    13,    14,    15,
+      16,    33,    22,    23,    22,    23,    -1,    34,     7,     8,
+      -1,    38,    33,    34,    35,    36,    37,    44,    34,    17,
+      18,    39,    38,    26,    27,    28,    29,    30,    31,    35,
+      36,    37,    35,    36,    37,    38,    39,    24,    25,    26,
+      27,    28,    29,    30,    31,    32,    11,    12,    24,    25
 };
 
   /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
      symbol of state STATE-NUM.  */
 static const yytype_uint8 yystos[] =
 {
-       0,     7,     8,     9,    11,    12,    13,    14,    15,    33,
-      37,    43,    46,    47,    48,    49,    52,     7,     8,    47,
-      47,     0,     3,    21,    22,    23,    24,    25,    26,    27,
-      28,    29,    30,    31,    32,    33,    34,    35,    36,    38,
-      48,    48,    49,    49,    49,    49,    49,    49,    16,    17,
-      50,    50,    18,    51,    49,    49,    49,    49,    49
+       0,     7,     8,     9,    11,    12,    13,    14,    15,    16,
+      34,    38,    44,    47,    48,    49,    50,    53,     7,     8,
+      48,    48,     0,     3,    22,    23,    24,    25,    26,    27,
+      28,    29,    30,    31,    32,    33,    34,    35,    36,    37,
+      39,    49,    49,    50,    50,    50,    50,    50,    50,    17,
+      18,    51,    51,    19,    52,    50,    50,    50,    50,    50
 };
 
   /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
 static const yytype_uint8 yyr1[] =
 {
-       0,    45,    46,    47,    47,    47,    47,    48,    48,    48,
-      48,    48,    48,    48,    48,    48,    48,    49,    49,    49,
-      49,    49,    49,    50,    50,    51,    52,    52,    52,    52,
-      52,    52,    52,    52,    52,    52,    52
+       0,    46,    47,    48,    48,    48,    48,    49,    49,    49,
+      49,    49,    49,    49,    49,    49,    49,    50,    50,    50,
+      50,    50,    50,    51,    51,    52,    53,    53,    53,    53,
+      53,    53,    53,    53,    53,    53,    53,    53
 };
 
   /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
@@ -645,7 +646,7 @@ static const yytype_uint8 yyr2[] =
        0,     2,     2,     3,     3,     2,     1,     3,     3,     3,
        3,     3,     3,     3,     3,     3,     1,     3,     3,     3,
        3,     3,     1,     1,     1,     1,     1,     2,     1,     2,
-       1,     1,     1,     1,     1,     1,     3
+       1,     1,     1,     1,     1,     1,     1,     3
 };
 
 
@@ -1640,6 +1641,12 @@ yyreduce:
 
   case 36:
 
+    { (yyval) = yylval;}
+
+    break;
+
+  case 37:
+
     { (yyval) = (yyvsp[-1]); }
 
     break;
@@ -25,7 +25,7 @@ void yyerror(T_KRCalc *krcalc, void *lexer_state, const char *errmsg);
 */
 
 %token SEMI ENDFILE ERROR 
-%token ID NUM FNUM STR SCHAR CID FID SID DID HID SET MULTI REGEX
+%token ID NUM FNUM STR SCHAR CID FID SID DID HID GID SET MULTI REGEX
 %left COMMA
 %right ASSIGN
 %left OR
@@ -222,6 +222,7 @@ primary     : NUM  { $$ = yylval;}
             | SID  { $$ = yylval;}
             | DID  { $$ = yylval;}
             | HID  { $$ = yylval;}
+            | GID  { $$ = yylval;}
 			| LP rule RP
                 { $$ = $2; }
 			;
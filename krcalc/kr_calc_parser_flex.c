@@ -357,8 +357,8 @@ static void yy_fatal_error (yyconst char msg[] ,yyscan_t yyscanner );
 	*yy_cp = '\0'; \
 	yyg->yy_c_buf_p = yy_cp;
 
-#define YY_NUM_RULES 44
-#define YY_END_OF_BUFFER 45
+#define YY_NUM_RULES 45
+#define YY_END_OF_BUFFER 46
 /* This struct is not used in this scanner,
    but its presence is necessary. */
 struct yy_trans_info
@@ -366,17 +366,17 @@ struct yy_trans_info
 	flex_int32_t yy_verify;
 	flex_int32_t yy_nxt;
 	};
-static yyconst flex_int16_t yy_accept[84] =
+static yyconst flex_int16_t yy_accept[87] =
     {   0,
-        0,    0,   45,   43,   42,   41,   15,   43,    5,   43,
-       43,   18,   19,    3,    1,   17,    2,    4,   27,   16,
-        6,   14,    8,   43,   43,   43,   43,   43,   43,   43,
-       20,   21,   22,   43,   23,   42,   11,   25,   26,   12,
-        0,    0,   29,    0,   27,    7,   10,    9,   24,    0,
-        0,    0,    0,    0,    0,    0,   40,    0,    0,   13,
-       29,   29,   30,   28,   36,   31,   34,   32,   35,   33,
-        0,    0,    0,    0,    0,    0,   37,    0,   39,    0,
-        0,   38,    0
+        0,    0,   46,   44,   43,   42,   15,   44,    5,   44,
+       44,   18,   19,    3,    1,   17,    2,    4,   27,   16,
+        6,   14,    8,   44,   44,   44,   44,   44,   44,   44,
+       44,   20,   21,   22,   44,   23,   43,   11,   25,   26,
+       12,    0,    0,   29,    0,   27,    7,   10,    9,   24,
+        0,    0,    0,    0,    0,    0,    0,    0,   41,    0,
+        0,   13,   29,   29,   30,   28,   37,   31,   34,   32,
+       36,   35,   33,    0,    0,    0,    0,    0,    0,   38,
+        0,   40,    0,    0,   39,    0
     } ;
 
 static yyconst flex_int32_t yy_ec[256] =
@@ -388,13 +388,13 @@ static yyconst flex_int32_t yy_ec[256] =
        11,   12,   13,   14,   15,   16,   17,   18,   18,   18,
        18,   18,   18,   18,   18,   18,   18,    1,   19,   20,
        21,   22,    1,   23,   24,    1,   25,   26,    1,   27,
-        1,   28,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,   29,    1,    1,    1,    1,    1,    1,    1,
-       30,    1,   31,    1,   32,    1,    1,    1,    1,    1,
+       28,   29,    1,    1,    1,    1,    1,    1,    1,    1,
+        1,    1,   30,    1,    1,    1,    1,    1,    1,    1,
+       31,    1,   32,    1,   33,    1,    1,    1,    1,    1,
 
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,   33,   34,   35,    1,    1,    1,    1,    1,
+        1,    1,   34,   35,   36,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
@@ -411,78 +411,78 @@ static yyconst flex_int32_t yy_ec[256] =
         1,    1,    1,    1,    1
     } ;
 
-static yyconst flex_int32_t yy_meta[36] =
+static yyconst flex_int32_t yy_meta[37] =
     {   0,
         1,    1,    1,    1,    2,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1
+        1,    1,    1,    1,    1,    1
     } ;
 
-static yyconst flex_int16_t yy_base[88] =
+static yyconst flex_int16_t yy_base[91] =
     {   0,
-        0,    0,  107,  108,  104,  108,   15,   99,  108,   96,
-       34,  108,  108,  108,  108,  108,  108,  108,   23,  108,
-       82,   81,   80,   77,   67,   66,   65,   64,   63,   62,
-       62,  108,   31,   58,  108,   89,  108,  108,  108,  108,
-       81,   80,   79,   69,   26,  108,  108,  108,  108,   68,
-       67,   66,   65,   64,   63,   49,   41,   62,   32,  108,
-      108,  108,  108,   51,   50,   49,   48,   47,   46,   45,
-       52,   46,   27,   40,   38,   37,  108,   38,  108,   35,
-       41,  108,  108,   73,   53,   75,   77
+        8,    0,   66,  113,   66,  113,   25,   63,  113,   62,
+       47,  113,  113,  113,  113,  113,  113,  113,   35,  113,
+       50,   52,   53,   52,   43,   44,   45,   46,   48,   49,
+       50,   52,  113,   43,   51,  113,   85,  113,  113,  113,
+      113,   79,   80,   81,   73,   39,  113,  113,  113,  113,
+       74,   75,   76,   77,   78,   79,   80,   67,   68,   92,
+       31,  113,  113,  113,  113,   84,   85,   86,   87,   88,
+       89,   90,   91,  101,   97,   36,   94,   49,   45,  113,
+       46,  113,   44,   49,  113,  113,    0,    2,    4,    6
     } ;
 
-static yyconst flex_int16_t yy_def[88] =
+static yyconst flex_int16_t yy_def[91] =
     {   0,
-       83,    1,   83,   83,   83,   83,   83,   83,   83,   83,
-       84,   83,   83,   83,   83,   83,   83,   83,   83,   83,
-       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
-       85,   83,   83,   83,   83,   83,   83,   83,   83,   83,
-       86,   86,   83,   83,   83,   83,   83,   83,   83,   83,
-       83,   83,   83,   83,   83,   85,   85,   87,   83,   83,
-       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
-       87,   83,   83,   83,   83,   83,   83,   83,   83,   83,
-       83,   83,    0,   83,   83,   83,   83
+       86,    1,   86,   86,   86,   86,   86,   86,   86,   86,
+       87,   86,   86,   86,   86,   86,   86,   86,   86,   86,
+       86,   86,   86,   86,   86,   86,   86,   86,   86,   86,
+       86,   88,   86,   86,   86,   86,   86,   86,   86,   86,
+       86,   89,   89,   86,   86,   86,   86,   86,   86,   86,
+       86,   86,   86,   86,   86,   86,   86,   88,   88,   90,
+       86,   86,   86,   86,   86,   86,   86,   86,   86,   86,
+       86,   86,   86,   90,   86,   86,   86,   86,   86,   86,
+       86,   86,   86,   86,   86,    0,   86,   86,   86,   86
     } ;
 
-static yyconst flex_int16_t yy_nxt[144] =
+static yyconst flex_int16_t yy_nxt[150] =
     {   0,
-        4,    5,    6,    7,    4,    8,    9,   10,   11,   12,
-       13,   14,   15,   16,   17,    4,   18,   19,   20,   21,
-       22,   23,   24,   25,   26,   27,   28,   29,   30,   31,
-       32,    4,   33,   34,   35,   37,   42,   38,   44,   58,
-       45,   44,   43,   45,   76,   73,   58,   74,   59,   59,
-       73,   80,   81,   56,   76,   78,   74,   78,   81,   75,
-       72,   77,   70,   69,   68,   67,   66,   65,   64,   82,
-       72,   57,   79,   41,   41,   42,   42,   71,   71,   57,
-       70,   69,   68,   67,   66,   65,   64,   63,   62,   61,
-       36,   60,   57,   55,   54,   53,   52,   51,   50,   49,
-
-       48,   47,   46,   40,   39,   36,   83,    3,   83,   83,
-       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
-       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
-       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
-       83,   83,   83
+       42,   42,   58,   86,   43,   43,   74,   74,    4,    5,
+        6,    7,    4,    8,    9,   10,   11,   12,   13,   14,
+       15,   16,   17,    4,   18,   19,   20,   21,   22,   23,
+       24,   25,   26,   27,   28,   29,   30,   31,   32,   33,
+        4,   34,   35,   36,   76,   38,   77,   39,   61,   43,
+       45,   60,   46,   79,   45,   44,   46,   60,   76,   83,
+       61,   84,   79,   81,   77,   86,   84,   37,   40,   41,
+       47,   80,   48,   49,   50,   51,   52,   53,   54,   85,
+       55,   56,   57,   59,   82,   62,   37,   63,   64,   65,
+       66,   67,   68,   69,   70,   71,   72,   73,   59,   59,
+
+       75,   66,   67,   68,   69,   70,   71,   72,   73,   75,
+       78,   81,    3,   86,   86,   86,   86,   86,   86,   86,
+       86,   86,   86,   86,   86,   86,   86,   86,   86,   86,
+       86,   86,   86,   86,   86,   86,   86,   86,   86,   86,
+       86,   86,   86,   86,   86,   86,   86,   86,   86
     } ;
 
-static yyconst flex_int16_t yy_chk[144] =
+static yyconst flex_int16_t yy_chk[150] =
     {   0,
+       87,   87,   88,   88,   89,   89,   90,   90,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
-        1,    1,    1,    1,    1,    7,   11,    7,   19,   33,
-       19,   45,   11,   45,   73,   59,   75,   59,   33,   59,
-       76,   78,   80,   85,   76,   78,   81,   74,   81,   72,
-       71,   73,   70,   69,   68,   67,   66,   65,   64,   80,
-       58,   57,   75,   84,   84,   86,   86,   87,   87,   56,
-       55,   54,   53,   52,   51,   50,   44,   43,   42,   41,
-       36,   34,   31,   30,   29,   28,   27,   26,   25,   24,
-
-       23,   22,   21,   10,    8,    5,    3,   83,   83,   83,
-       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
-       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
-       83,   83,   83,   83,   83,   83,   83,   83,   83,   83,
-       83,   83,   83
+        1,    1,    1,    1,   61,    7,   61,    7,   61,   11,
+       19,   34,   19,   76,   46,   11,   46,   78,   79,   81,
+       34,   83,   79,   81,   84,    3,   84,    5,    8,   10,
+       21,   76,   22,   23,   24,   25,   26,   27,   28,   83,
+       29,   30,   31,   32,   78,   35,   37,   42,   43,   44,
+       45,   51,   52,   53,   54,   55,   56,   57,   58,   59,
+
+       60,   66,   67,   68,   69,   70,   71,   72,   73,   74,
+       75,   77,   86,   86,   86,   86,   86,   86,   86,   86,
+       86,   86,   86,   86,   86,   86,   86,   86,   86,   86,
+       86,   86,   86,   86,   86,   86,   86,   86,   86,   86,
+       86,   86,   86,   86,   86,   86,   86,   86,   86
     } ;
 
 /* The intent behind this definition is that it'll catch
@@ -795,13 +795,13 @@ yy_match:
 			while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 				{
 				yy_current_state = (int) yy_def[yy_current_state];
-				if ( yy_current_state >= 84 )
+				if ( yy_current_state >= 87 )
 					yy_c = yy_meta[(unsigned int) yy_c];
 				}
 			yy_current_state = yy_nxt[yy_base[yy_current_state] + (unsigned int) yy_c];
 			++yy_cp;
 			}
-		while ( yy_base[yy_current_state] != 108 );
+		while ( yy_base[yy_current_state] != 113 );
 
 yy_find_action:
 		yy_act = yy_accept[yy_current_state];
@@ -1005,12 +1005,19 @@ YY_RULE_SETUP
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
+{ (*yylval) = kr_calc_tree_new(KR_CALCKIND_GID);
+			      (*yylval)->id = atoi(yytext+2);
+			      return GID;
+			    }
+	YY_BREAK
+case 37:
+YY_RULE_SETUP
 { (*yylval) = kr_calc_tree_new(KR_CALCKIND_SET);
 			      (*yylval)->id = atoi(yytext+2);
 			      return SET;
 			    }
 	YY_BREAK
-case 37:
+case 38:
 YY_RULE_SETUP
 { (*yylval) = kr_calc_tree_new(KR_CALCKIND_MINT);
                   char caTemp[1024]={0};
@@ -1021,7 +1028,7 @@ YY_RULE_SETUP
 			      return MULTI;
                 }
 	YY_BREAK
-case 38:
+case 39:
 YY_RULE_SETUP
 { (*yylval) = kr_calc_tree_new(KR_CALCKIND_MFLOAT);
                   char caTemp[1024]={0};
@@ -1032,8 +1039,8 @@ YY_RULE_SETUP
 			      return MULTI;
                 }
 	YY_BREAK
-case 39:
-/* rule 39 can match eol */
+case 40:
+/* rule 40 can match eol */
 YY_RULE_SETUP
 { (*yylval) = kr_calc_tree_new(KR_CALCKIND_MSTRING);
                   char caTemp[1024]={0};
@@ -1044,8 +1051,8 @@ YY_RULE_SETUP
 			      return MULTI;
                 }
 	YY_BREAK
-case 40:
-/* rule 40 can match eol */
+case 41:
+/* rule 41 can match eol */
 YY_RULE_SETUP
 { (*yylval) = kr_calc_tree_new(KR_CALCKIND_REGEX);
                   char caTemp[1024]={0};
@@ -1056,20 +1063,20 @@ YY_RULE_SETUP
 			      return REGEX;
 			    }
 	YY_BREAK
-case 41:
-/* rule 41 can match eol */
+case 42:
+/* rule 42 can match eol */
 YY_RULE_SETUP
 {}
 	YY_BREAK
-case 42:
+case 43:
 YY_RULE_SETUP
 {}
 	YY_BREAK
-case 43:
+case 44:
 YY_RULE_SETUP
 { ECHO; printf("error!~\n"); return ERROR;}
 	YY_BREAK
-case 44:
+case 45:
 YY_RULE_SETUP
 ECHO;
 	YY_BREAK
@@ -1366,7 +1373,7 @@ static int yy_get_next_buffer (yyscan_t yyscanner)
 		while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 			{
 			yy_current_state = (int) yy_def[yy_current_state];
-			if ( yy_current_state >= 84 )
+			if ( yy_current_state >= 87 )
 				yy_c = yy_meta[(unsigned int) yy_c];
 			}
 		yy_current_state = yy_nxt[yy_base[yy_current_state] + (unsigned int) yy_c];
@@ -1395,11 +1402,11 @@ static int yy_get_next_buffer (yyscan_t yyscanner)
 	while ( yy_chk[yy_base[yy_current_state] + yy_c] != yy_current_state )
 		{
 		yy_current_state = (int) yy_def[yy_current_state];
-		if ( yy_current_state >= 84 )
+		if ( yy_current_state >= 87 )
 			yy_c = yy_meta[(unsigned int) yy_c];
 		}
 	yy_current_state = yy_nxt[yy_base[yy_current_state] + (unsigned int) yy_c];
-	yy_is_jam = (yy_current_state == 83);
+	yy_is_jam = (yy_current_state == 86);
 
 	return yy_is_jam ? 0 : yy_current_state;
 }
@@ -58,35 +58,36 @@ extern int yydebug;
     SID = 268,
     DID = 269,
     HID = 270,
-    SET = 271,
-    MULTI = 272,
-    REGEX = 273,
-    COMMA = 274,
-    ASSIGN = 275,
-    OR = 276,
-    AND = 277,
-    EQ = 278,
-    NEQ = 279,
-    LT = 280,
-    LE = 281,
-    GT = 282,
-    GE = 283,
-    BL = 284,
-    NBL = 285,
-    MATCH = 286,
-    PLUS = 287,
-    SUB = 288,
-    MUT = 289,
-    DIV = 290,
-    MOD = 291,
-    LP = 292,
-    RP = 293,
-    LSP = 294,
-    RSP = 295,
-    LFP = 296,
-    RFP = 297,
-    NOT = 298,
-    UMINUS = 299
+    GID = 271,
+    SET = 272,
+    MULTI = 273,
+    REGEX = 274,
+    COMMA = 275,
+    ASSIGN = 276,
+    OR = 277,
+    AND = 278,
+    EQ = 279,
+    NEQ = 280,
+    LT = 281,
+    LE = 282,
+    GT = 283,
+    GE = 284,
+    BL = 285,
+    NBL = 286,
+    MATCH = 287,
+    PLUS = 288,
+    SUB = 289,
+    MUT = 290,
+    DIV = 291,
+    MOD = 292,
+    LP = 293,
+    RP = 294,
+    LSP = 295,
+    RSP = 296,
+    LFP = 297,
+    RFP = 298,
+    NOT = 299,
+    UMINUS = 300
   };
 #endif
 /* Tokens.  */
@@ -103,35 +104,36 @@ extern int yydebug;
 #define SID 268
 #define DID 269
 #define HID 270
-#define SET 271
-#define MULTI 272
-#define REGEX 273
-#define COMMA 274
-#define ASSIGN 275
-#define OR 276
-#define AND 277
-#define EQ 278
-#define NEQ 279
-#define LT 280
-#define LE 281
-#define GT 282
-#define GE 283
-#define BL 284
-#define NBL 285
-#define MATCH 286
-#define PLUS 287
-#define SUB 288
-#define MUT 289
-#define DIV 290
-#define MOD 291
-#define LP 292
-#define RP 293
-#define LSP 294
-#define RSP 295
-#define LFP 296
-#define RFP 297
-#define NOT 298
-#define UMINUS 299
+#define GID 271
+#define SET 272
+#define MULTI 273
+#define REGEX 274
+#define COMMA 275
+#define ASSIGN 276
+#define OR 277
+#define AND 278
+#define EQ 279
+#define NEQ 280
+#define LT 281
+#define LE 282
+#define GT 283
+#define GE 284
+#define BL 285
+#define NBL 286
+#define MATCH 287
+#define PLUS 288
+#define SUB 289
+#define MUT 290
+#define DIV 291
+#define MOD 292
+#define LP 293
+#define RP 294
+#define LSP 295
+#define RSP 296
+#define LFP 297
+#define RFP 298
+#define NOT 299
+#define UMINUS 300
 
 /* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
@@ -67,6 +67,7 @@ T_KRCalcTree *kr_calc_parse_ele(T_KRCalc *krcalc, int kind, cJSON *json)
             tree->ind = KR_VALUE_UNSET;
             break;
         case KR_CALCKIND_HID:
+        case KR_CALCKIND_GID:
             tree = kr_calc_tree_new(kind);
             tree->id = kr_calcjson_getint(json);
             tree->ind = KR_VALUE_UNSET;
@@ -0,0 +1,220 @@
+#include "kr_calc_profile.h"
+#include "kr_calc_tree.h"
+
+/* profiles are keyed by calc string, every worker thread parses
+ * the same string into the same tree, so node N of one calc tree
+ * always matches node N of the others, and they can share counters.
+ * the registry lock is only taken while attaching, evaluations
+ * update counters with atomic builtins.
+ */
+static pthread_mutex_t gtProfileLock = PTHREAD_MUTEX_INITIALIZER;
+static T_KRHashTable  *gptProfileTable = NULL;
+static unsigned int    guiSampleRate = 0;
+
+
+static void kr_calc_profile_free(T_KRCalcProfile *profile)
+{
+    if (profile != NULL) {
+        kr_free(profile->calc_string);
+        kr_free(profile->nodes);
+        kr_free(profile);
+    }
+}
+
+void kr_calc_profile_enable(unsigned int sample_rate)
+{
+    pthread_mutex_lock(&gtProfileLock);
+    if (gptProfileTable == NULL) {
+        gptProfileTable = kr_hashtable_new_full(
+                (KRHashFunc )kr_string_hash, (KREqualFunc )kr_string_equal,
+                NULL, (KRDestroyNotify )kr_calc_profile_free);
+    }
+    guiSampleRate = sample_rate;
+    pthread_mutex_unlock(&gtProfileLock);
+}
+
+void kr_calc_profile_disable(void)
+{
+    pthread_mutex_lock(&gtProfileLock);
+    guiSampleRate = 0;
+    pthread_mutex_unlock(&gtProfileLock);
+}
+
+unsigned int kr_calc_profile_rate(void)
+{
+    return guiSampleRate;
+}
+
+/* must be called after all calcs destructed */
+void kr_calc_profile_destroy(void)
+{
+    pthread_mutex_lock(&gtProfileLock);
+    if (gptProfileTable != NULL) {
+        kr_hashtable_destroy(gptProfileTable);
+        gptProfileTable = NULL;
+    }
+    guiSampleRate = 0;
+    pthread_mutex_unlock(&gtProfileLock);
+}
+
+
+static int _kr_calc_profile_count(T_KRCalcTree *t)
+{
+    int cnt = 1;
+    for (int i=0; i < t->childnum; i++) {
+        cnt += _kr_calc_profile_count(t->children[i]);
+    }
+    return cnt;
+}
+
+static void _kr_calc_profile_number(T_KRCalcTree *t, int *seq, int depth,
+        T_KRCalcProfileNode *nodes)
+{
+    t->seq = (*seq)++;
+    if (nodes != NULL) {
+        nodes[t->seq].kind = t->kind;
+        nodes[t->seq].op = t->op;
+        nodes[t->seq].id = t->id;
+        nodes[t->seq].depth = depth;
+    }
+    for (int i=0; i < t->childnum; i++) {
+        _kr_calc_profile_number(t->children[i], seq, depth+1, nodes);
+    }
+}
+
+int kr_calc_profile_attach(T_KRCalc *krcalc)
+{
+    int seq = 0;
+    T_KRCalcProfile *profile = NULL;
+
+    if (krcalc->calc_tree == NULL || krcalc->calc_string == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&gtProfileLock);
+    if (gptProfileTable == NULL || guiSampleRate == 0) {
+        pthread_mutex_unlock(&gtProfileLock);
+        return 0;
+    }
+
+    profile = kr_hashtable_lookup(gptProfileTable, krcalc->calc_string);
+    if (profile == NULL) {
+        profile = kr_calloc(sizeof(*profile));
+        profile->calc_string = kr_strdup(krcalc->calc_string);
+        profile->node_num = _kr_calc_profile_count(krcalc->calc_tree);
+        profile->nodes = kr_calloc(sizeof(T_KRCalcProfileNode) * \
+                profile->node_num);
+        _kr_calc_profile_number(krcalc->calc_tree, &seq, 0, profile->nodes);
+        kr_hashtable_insert(gptProfileTable, profile->calc_string, profile);
+    } else {
+        _kr_calc_profile_number(krcalc->calc_tree, &seq, 0, NULL);
+        if (seq != profile->node_num) {
+            KR_LOG(KR_LOGERROR, "calc [%s] node number mismatch [%d]:[%d]!",
+                    krcalc->calc_string, seq, profile->node_num);
+            pthread_mutex_unlock(&gtProfileLock);
+            return -1;
+        }
+    }
+    krcalc->calc_profile = profile;
+    krcalc->calc_sample_rate = guiSampleRate;
+    krcalc->calc_sample_cnt = 0;
+    pthread_mutex_unlock(&gtProfileLock);
+
+    return 0;
+}
+
+void kr_calc_profile_record(T_KRCalcProfile *profile,
+        T_KRCalcTree *t, long nanosecs)
+{
+    T_KRCalcProfileNode *node = &profile->nodes[t->seq];
+
+    __sync_fetch_and_add(&node->eval_cnt, 1);
+    __sync_fetch_and_add(&node->nanosecs, nanosecs);
+    if (t->ind == KR_VALUE_SETED && t->type == KR_TYPE_BOOL) {
+        if (t->value.b) {
+            __sync_fetch_and_add(&node->true_cnt, 1);
+        } else {
+            __sync_fetch_and_add(&node->false_cnt, 1);
+        }
+    }
+}
+
+static void _kr_calc_profile_reset(void *key, T_KRCalcProfile *profile,
+        void *data)
+{
+    for (int i=0; i<profile->node_num; i++) {
+        T_KRCalcProfileNode *node = &profile->nodes[i];
+        __sync_lock_test_and_set(&node->eval_cnt, 0);
+        __sync_lock_test_and_set(&node->true_cnt, 0);
+        __sync_lock_test_and_set(&node->false_cnt, 0);
+        __sync_lock_test_and_set(&node->nanosecs, 0);
+    }
+}
+
+void kr_calc_profile_reset(void)
+{
+    pthread_mutex_lock(&gtProfileLock);
+    if (gptProfileTable != NULL) {
+        kr_hashtable_foreach(gptProfileTable,
+                (KRHFunc )_kr_calc_profile_reset, NULL);
+    }
+    pthread_mutex_unlock(&gtProfileLock);
+}
+
+
+static cJSON *_kr_calc_profile_info(T_KRCalcProfile *profile)
+{
+    cJSON *calc = cJSON_CreateObject();
+    cJSON_AddStringToObject(calc, "calc_string", profile->calc_string);
+    cJSON_AddNumberToObject(calc, "sample_rate", guiSampleRate);
+
+    cJSON *nodes = cJSON_CreateArray();
+    for (int i=0; i<profile->node_num; i++) {
+        T_KRCalcProfileNode *node = &profile->nodes[i];
+        cJSON *json = cJSON_CreateObject();
+        cJSON_AddNumberToObject(json, "seq", i);
+        cJSON_AddNumberToObject(json, "depth", node->depth);
+        cJSON_AddNumberToObject(json, "kind", node->kind);
+        cJSON_AddNumberToObject(json, "op", node->op);
+        cJSON_AddNumberToObject(json, "id", node->id);
+        cJSON_AddNumberToObject(json, "eval_cnt", node->eval_cnt);
+        cJSON_AddNumberToObject(json, "true_cnt", node->true_cnt);
+        cJSON_AddNumberToObject(json, "false_cnt", node->false_cnt);
+        cJSON_AddNumberToObject(json, "nanosecs", node->nanosecs);
+        cJSON_AddItemToArray(nodes, json);
+    }
+    cJSON_AddItemToObject(calc, "nodes", nodes);
+
+    return calc;
+}
+
+cJSON *kr_calc_profile_info(T_KRCalc *krcalc)
+{
+    if (krcalc == NULL || krcalc->calc_profile == NULL) {
+        return NULL;
+    }
+    return _kr_calc_profile_info(krcalc->calc_profile);
+}
+
+static void _kr_calc_profile_info_add(void *key, T_KRCalcProfile *profile,
+        cJSON *calcs)
+{
+    cJSON_AddItemToArray(calcs, _kr_calc_profile_info(profile));
+}
+
+cJSON *kr_calc_profile_info_all(void)
+{
+    cJSON *profile = cJSON_CreateObject();
+    cJSON_AddNumberToObject(profile, "sample_rate", guiSampleRate);
+
+    cJSON *calcs = cJSON_CreateArray();
+    pthread_mutex_lock(&gtProfileLock);
+    if (gptProfileTable != NULL) {
+        kr_hashtable_foreach(gptProfileTable,
+                (KRHFunc )_kr_calc_profile_info_add, calcs);
+    }
+    pthread_mutex_unlock(&gtProfileLock);
+    cJSON_AddItemToObject(profile, "calcs", calcs);
+
+    return profile;
+}
@@ -0,0 +1,43 @@
+#ifndef __KR_CALC_PROFILE_H__
+#define __KR_CALC_PROFILE_H__
+
+#include "kr_calc.h"
+
+/* per-node counters, shared by all calcs with the same calc string,
+ * updated with atomic builtins so worker threads never take a lock
+ */
+typedef struct _kr_calc_profile_node_t
+{
+    E_KRCalcKind     kind;
+    E_KRCalcOp       op;
+    int              id;
+    int              depth;
+
+    volatile long    eval_cnt;      /* sampled evaluations */
+    volatile long    true_cnt;      /* evaluated to TRUE */
+    volatile long    false_cnt;     /* evaluated to FALSE */
+    volatile long    nanosecs;      /* cumulative time, children included */
+}T_KRCalcProfileNode;
+
+struct _kr_calc_profile_t
+{
+    char                 *calc_string;
+    int                   node_num;
+    T_KRCalcProfileNode  *nodes;     /* preorder of the calc tree */
+};
+
+/* function declarations */
+extern void kr_calc_profile_enable(unsigned int sample_rate);
+extern void kr_calc_profile_disable(void);
+extern unsigned int kr_calc_profile_rate(void);
+extern void kr_calc_profile_destroy(void);
+
+extern int kr_calc_profile_attach(T_KRCalc *krcalc);
+extern void kr_calc_profile_record(T_KRCalcProfile *profile,
+        T_KRCalcTree *t, long nanosecs);
+extern void kr_calc_profile_reset(void);
+
+extern cJSON *kr_calc_profile_info(T_KRCalc *krcalc);
+extern cJSON *kr_calc_profile_info_all(void);
+
+#endif    /* __KR_CALC_PROFILE_H__ */
@@ -1,4 +1,5 @@
 #include "kr_calc_tree.h"
+#include "kr_calc_profile.h"
 #include "krutils/kr_utils.h"
 
 /* calctree traversal function definition */
@@ -131,11 +132,19 @@ static int _kr_calc_tree_check(T_KRCalcTree *t, T_KRCalc *krcalc)
                     }
                     break;
                 case KR_CALCOP_BL: case KR_CALCOP_NBL:
+                {
+                    /*constant multiple value holds its element type in set*/
+                    E_KRType set_type = right->type;
+                    if (right->kind == KR_CALCKIND_MINT || 
+                        right->kind == KR_CALCKIND_MFLOAT || 
+                        right->kind == KR_CALCKIND_MSTRING) {
+                        set_type = ((T_KRHashSet *)right->value.p)->type;
+                    }
                     if ((right->kind != KR_CALCKIND_MINT && 
                          right->kind != KR_CALCKIND_MFLOAT && 
                          right->kind != KR_CALCKIND_MSTRING && 
                          right->kind != KR_CALCKIND_SET) ||
-                         left->type != right->type) 
+                         left->type != set_type) 
                     {
                         krcalc->calc_status = -1;
                         snprintf(krcalc->calc_errmsg, sizeof(krcalc->calc_errmsg),
@@ -145,6 +154,7 @@ static int _kr_calc_tree_check(T_KRCalcTree *t, T_KRCalc *krcalc)
                         return -1;        
                     }
                     break;
+                }
                 case KR_CALCOP_MATCH:
                     if (left->type != KR_TYPE_STRING ||
                         right->kind != KR_CALCKIND_REGEX) 
@@ -600,7 +610,7 @@ static int _kr_calc_tree_eval_logic(T_KRCalcTree *t, T_KRCalc *krcalc)
                 if (left->type == KR_TYPE_STRING &&
                         set->type == KR_TYPE_STRING) {
                     b = !kr_hashset_search(set, left->value.s);
-                } else if(left->type == right->type) {
+                } else if(left->type == set->type) {
                     b = !kr_hashset_search(set, &left->value);
                 } else {
                     krcalc->calc_status = -1;
@@ -732,18 +742,50 @@ static int _kr_calc_tree_eval(T_KRCalcTree *t, T_KRCalc *krcalc)
         case KR_CALCKIND_SID:
         case KR_CALCKIND_DID:
         case KR_CALCKIND_HID:
+        case KR_CALCKIND_GID:
             return _kr_calc_tree_eval_extern(t, krcalc);
     }
 
     return 0;
 }
 
+int kr_calc_tree_eval_node(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    return _kr_calc_tree_eval(t, krcalc);
+}
+
 int kr_calc_tree_eval(T_KRCalcTree *root, T_KRCalc *krcalc)
 {
     return kr_calc_tree_traverse(root, krcalc, 
             NULL, (traverse_func )_kr_calc_tree_eval);
 }
 
+/* same postorder as kr_calc_tree_eval,
+ * but time each node and feed the calc's profile
+ */
+int kr_calc_tree_eval_profile(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    struct timespec ts1, ts2;
+
+    if (t == NULL) return 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts1);
+    for (int i=0; i < t->childnum; i++) {
+        if (kr_calc_tree_eval_profile(t->children[i], krcalc) != 0) {
+            return -1;
+        }
+    }
+    int ret = (t->eval_func != NULL) ? \
+        t->eval_func(t, krcalc) : _kr_calc_tree_eval(t, krcalc);
+    clock_gettime(CLOCK_MONOTONIC, &ts2);
+
+    long nanosecs = (ts2.tv_sec - ts1.tv_sec) * 1000000000L +
+        (ts2.tv_nsec - ts1.tv_nsec);
+    kr_calc_profile_record(krcalc->calc_profile, t, nanosecs);
+
+    return ret;
+}
+
 
 /* free this calctree node and free his allocated subvalue */
 static int _kr_calc_tree_free(T_KRCalcTree *t, void *data)
@@ -777,3 +819,40 @@ void kr_calc_tree_free(T_KRCalcTree *root)
 }
 
 
+/* stop traversal at the first node of this kind */
+static int _kr_calc_tree_match_kind(T_KRCalcTree *t, E_KRCalcKind *kind)
+{
+    return (t->kind == *kind) ? -1 : 0;
+}
+
+/* whether calctree has any node of this kind */
+int kr_calc_tree_has_kind(T_KRCalcTree *root, E_KRCalcKind kind)
+{
+    return kr_calc_tree_traverse(root, &kind, 
+            (traverse_func )_kr_calc_tree_match_kind, NULL) != 0;
+}
+
+
+typedef struct _kr_calc_tree_visit_t
+{
+    KRCalcIdFunc  func;
+    void         *data;
+}T_KRCalcTreeVisit;
+
+static int _kr_calc_tree_visit_id(T_KRCalcTree *t, T_KRCalcTreeVisit *visit)
+{
+    if (t->kind >= KR_CALCKIND_SET) {
+        visit->func(t->kind, t->id, visit->data);
+    }
+    return 0;
+}
+
+/* call func with every identifier in calctree, in preorder */
+void kr_calc_tree_foreach_id(T_KRCalcTree *root, KRCalcIdFunc func, void *data)
+{
+    T_KRCalcTreeVisit visit = {func, data};
+    kr_calc_tree_traverse(root, &visit, 
+            (traverse_func )_kr_calc_tree_visit_id, NULL);
+}
+
+
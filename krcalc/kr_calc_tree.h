@@ -7,6 +7,9 @@
 #define YYSTYPE         T_KRCalcTree*
 #define YY_EXTRA_TYPE   T_KRCalc*
 
+/* specialized evaluation of a single node, resolved by kr_calc_bind */
+typedef int (*KRCalcEvalFunc)(T_KRCalcTree *t, T_KRCalc *krcalc);
+
 /* calculator tree definition */
 struct _kr_calc_tree_t
 {
@@ -16,18 +19,31 @@ struct _kr_calc_tree_t
     E_KRCalcKind             kind;
     E_KRCalcOp               op;
     int                      id;
+    int                      seq;     /*preorder sequence, for profiling*/
 
     E_KRType                 type;
     E_KRValueInd             ind;
     U_KRValue                value;
+
+    KRCalcEvalFunc           eval_func;  /*NULL until specialized*/
+    void                    *slot;       /*bound slot of extern identifier*/
 };
 
 /* function declarations */
 extern T_KRCalcTree *kr_calc_tree_new(E_KRCalcKind kind);
 extern void kr_calc_tree_append(T_KRCalcTree *t, T_KRCalcTree *child);
 extern void kr_calc_tree_free(T_KRCalcTree *root);
+extern int kr_calc_tree_has_kind(T_KRCalcTree *root, E_KRCalcKind kind);
+extern void kr_calc_tree_foreach_id(T_KRCalcTree *root, 
+        KRCalcIdFunc func, void *data);
 
 extern int kr_calc_tree_check(T_KRCalcTree *root, T_KRCalc *krcalc);
 extern int kr_calc_tree_eval(T_KRCalcTree *root, T_KRCalc *krcalc);
+extern int kr_calc_tree_eval_profile(T_KRCalcTree *root, T_KRCalc *krcalc);
+extern int kr_calc_tree_eval_node(T_KRCalcTree *t, T_KRCalc *krcalc);
+
+extern int kr_calc_tree_bind(T_KRCalcTree *root, T_KRCalc *krcalc);
+extern void kr_calc_tree_unbind(T_KRCalcTree *root);
+extern int kr_calc_tree_eval_bound(T_KRCalcTree *root, T_KRCalc *krcalc);
 
 #endif  /* __KR_CALC_TREE_H__ */
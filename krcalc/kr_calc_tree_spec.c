@@ -0,0 +1,584 @@
+#include "kr_calc_tree.h"
+#include "krutils/kr_utils.h"
+
+/* Node specialization:
+ * once every extern identifier's type is resolved and the tree passes
+ * type checking, each node gets an evaluation function for its exact
+ * operand types (e.g. LT_LONG_LONG, EQ_STR_CONST), and extern identifiers
+ * get bound to slots by the calc's bind_cb, so evaluating a bound tree
+ * does no type switching and no id lookup.
+ * nodes without a specialized function fall back to kr_calc_tree_eval_node.
+ */
+
+#define KR_CALC_CHILDREN_UNSET(t) \
+    ((t)->children[0]->ind != KR_VALUE_SETED || \
+     (t)->children[1]->ind != KR_VALUE_SETED)
+
+
+/* constant node, value set while parsing */
+static int _kr_calc_eval_const(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    return 0;
+}
+
+
+/* extern identifiers, got by id or by bound slot */
+#define KR_CALC_DEF_EXTERN(tname, field, expr) \
+static int _kr_calc_eval_extern_##tname(T_KRCalcTree *t, T_KRCalc *krcalc) \
+{ \
+    void *val = krcalc->get_value_cb(t->kind, t->id, krcalc->calc_param); \
+    if (val == NULL) { \
+        t->ind = KR_VALUE_UNSET; \
+        return 0; \
+    } \
+    t->value.field = expr; \
+    t->ind = KR_VALUE_SETED; \
+    return 0; \
+} \
+static int _kr_calc_eval_slot_##tname(T_KRCalcTree *t, T_KRCalc *krcalc) \
+{ \
+    void *val = krcalc->get_slot_cb(t->kind, t->slot, krcalc->calc_param); \
+    if (val == NULL) { \
+        t->ind = KR_VALUE_UNSET; \
+        return 0; \
+    } \
+    t->value.field = expr; \
+    t->ind = KR_VALUE_SETED; \
+    return 0; \
+}
+
+KR_CALC_DEF_EXTERN(BOOL,    b, *(kr_bool *)val)
+KR_CALC_DEF_EXTERN(INT,     i, *(kr_int *)val)
+KR_CALC_DEF_EXTERN(LONG,    l, *(kr_long *)val)
+KR_CALC_DEF_EXTERN(DOUBLE,  d, *(kr_double *)val)
+KR_CALC_DEF_EXTERN(STRING,  s, (kr_string )val)
+KR_CALC_DEF_EXTERN(POINTER, p, (kr_pointer )val)
+/* set identifier keeps its element type, value is the hashset */
+KR_CALC_DEF_EXTERN(SET,     p, (kr_pointer )val)
+
+
+/* relation operations, all children are bool */
+static int _kr_calc_eval_AND_BOOL(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    kr_bool b = TRUE;
+    for (int i=0; i < t->childnum; i++) {
+        T_KRCalcTree *child = t->children[i];
+        if (child->ind != KR_VALUE_SETED) {
+            t->ind = KR_VALUE_UNSET;
+            return -1;
+        }
+        if (!child->value.b) {
+            b = FALSE;
+            break;
+        }
+    }
+    t->value.b = b;
+    t->ind = KR_VALUE_SETED;
+    return 0;
+}
+
+static int _kr_calc_eval_OR_BOOL(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    kr_bool b = FALSE;
+    for (int i=0; i < t->childnum; i++) {
+        T_KRCalcTree *child = t->children[i];
+        if (child->ind != KR_VALUE_SETED) {
+            t->ind = KR_VALUE_UNSET;
+            return -1;
+        }
+        if (child->value.b) {
+            b = TRUE;
+            break;
+        }
+    }
+    t->value.b = b;
+    t->ind = KR_VALUE_SETED;
+    return 0;
+}
+
+static int _kr_calc_eval_NOT_BOOL(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    kr_bool b = TRUE;
+    for (int i=0; i < t->childnum; i++) {
+        T_KRCalcTree *child = t->children[i];
+        if (child->ind != KR_VALUE_SETED) {
+            t->ind = KR_VALUE_UNSET;
+            return -1;
+        }
+        if (child->value.b) {
+            b = FALSE;
+            break;
+        }
+    }
+    t->value.b = b;
+    t->ind = KR_VALUE_SETED;
+    return 0;
+}
+
+
+/* numeric comparison, integers compared as long, others as double */
+#define KR_CALC_DEF_CMP(name, OP, lfld, rfld, ctype) \
+static int _kr_calc_eval_##name(T_KRCalcTree *t, T_KRCalc *krcalc) \
+{ \
+    if (KR_CALC_CHILDREN_UNSET(t)) { \
+        t->ind = KR_VALUE_UNSET; \
+        return -1; \
+    } \
+    t->value.b = ((ctype )t->children[0]->value.lfld OP \
+                  (ctype )t->children[1]->value.rfld); \
+    t->ind = KR_VALUE_SETED; \
+    return 0; \
+}
+
+/* string comparison */
+#define KR_CALC_DEF_STRCMP(name, OP) \
+static int _kr_calc_eval_##name(T_KRCalcTree *t, T_KRCalc *krcalc) \
+{ \
+    if (KR_CALC_CHILDREN_UNSET(t)) { \
+        t->ind = KR_VALUE_UNSET; \
+        return -1; \
+    } \
+    t->value.b = (strcmp(t->children[0]->value.s, \
+                         t->children[1]->value.s) OP 0); \
+    t->ind = KR_VALUE_SETED; \
+    return 0; \
+}
+
+#define KR_CALC_DEF_CMP_OP(op, OP) \
+    KR_CALC_DEF_CMP(op##_INT_INT,       OP, i, i, long) \
+    KR_CALC_DEF_CMP(op##_INT_LONG,      OP, i, l, long) \
+    KR_CALC_DEF_CMP(op##_INT_DOUBLE,    OP, i, d, double) \
+    KR_CALC_DEF_CMP(op##_LONG_INT,      OP, l, i, long) \
+    KR_CALC_DEF_CMP(op##_LONG_LONG,     OP, l, l, long) \
+    KR_CALC_DEF_CMP(op##_LONG_DOUBLE,   OP, l, d, double) \
+    KR_CALC_DEF_CMP(op##_DOUBLE_INT,    OP, d, i, double) \
+    KR_CALC_DEF_CMP(op##_DOUBLE_LONG,   OP, d, l, double) \
+    KR_CALC_DEF_CMP(op##_DOUBLE_DOUBLE, OP, d, d, double) \
+    KR_CALC_DEF_STRCMP(op##_STR_STR,    OP)
+
+KR_CALC_DEF_CMP_OP(LT,  <)
+KR_CALC_DEF_CMP_OP(LE,  <=)
+KR_CALC_DEF_CMP_OP(GT,  >)
+KR_CALC_DEF_CMP_OP(GE,  >=)
+KR_CALC_DEF_CMP_OP(EQ,  ==)
+KR_CALC_DEF_CMP_OP(NEQ, !=)
+
+/* string equality against a string constant,
+ * first character rejects most of the mismatches
+ */
+static int _kr_calc_eval_EQ_STR_CONST(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    if (KR_CALC_CHILDREN_UNSET(t)) {
+        t->ind = KR_VALUE_UNSET;
+        return -1;
+    }
+    char *s0 = t->children[0]->value.s;
+    char *s1 = t->children[1]->value.s;
+    t->value.b = (s0[0] == s1[0] && strcmp(s0, s1) == 0);
+    t->ind = KR_VALUE_SETED;
+    return 0;
+}
+
+static int _kr_calc_eval_NEQ_STR_CONST(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    if (KR_CALC_CHILDREN_UNSET(t)) {
+        t->ind = KR_VALUE_UNSET;
+        return -1;
+    }
+    char *s0 = t->children[0]->value.s;
+    char *s1 = t->children[1]->value.s;
+    t->value.b = (s0[0] != s1[0] || strcmp(s0, s1) != 0);
+    t->ind = KR_VALUE_SETED;
+    return 0;
+}
+
+#define KR_CALC_SPEC_ROW(op) \
+    {{_kr_calc_eval_##op##_INT_INT, \
+      _kr_calc_eval_##op##_INT_LONG, \
+      _kr_calc_eval_##op##_INT_DOUBLE}, \
+     {_kr_calc_eval_##op##_LONG_INT, \
+      _kr_calc_eval_##op##_LONG_LONG, \
+      _kr_calc_eval_##op##_LONG_DOUBLE}, \
+     {_kr_calc_eval_##op##_DOUBLE_INT, \
+      _kr_calc_eval_##op##_DOUBLE_LONG, \
+      _kr_calc_eval_##op##_DOUBLE_DOUBLE}}
+
+/* indexed by op-KR_CALCOP_LT, left type, right type */
+static KRCalcEvalFunc _kr_calc_cmp_funcs[6][3][3] = {
+    KR_CALC_SPEC_ROW(LT), KR_CALC_SPEC_ROW(LE),
+    KR_CALC_SPEC_ROW(GT), KR_CALC_SPEC_ROW(GE),
+    KR_CALC_SPEC_ROW(EQ), KR_CALC_SPEC_ROW(NEQ)
+};
+
+static KRCalcEvalFunc _kr_calc_strcmp_funcs[6] = {
+    _kr_calc_eval_LT_STR_STR, _kr_calc_eval_LE_STR_STR,
+    _kr_calc_eval_GT_STR_STR, _kr_calc_eval_GE_STR_STR,
+    _kr_calc_eval_EQ_STR_STR, _kr_calc_eval_NEQ_STR_STR
+};
+
+
+/* set and regex operations */
+static int _kr_calc_eval_BL_STR(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    if (KR_CALC_CHILDREN_UNSET(t)) {
+        t->ind = KR_VALUE_UNSET;
+        return -1;
+    }
+    T_KRHashSet *set = (T_KRHashSet *)t->children[1]->value.p;
+    t->value.b = kr_hashset_search(set, t->children[0]->value.s);
+    t->ind = KR_VALUE_SETED;
+    return 0;
+}
+
+static int _kr_calc_eval_BL_VAL(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    if (KR_CALC_CHILDREN_UNSET(t)) {
+        t->ind = KR_VALUE_UNSET;
+        return -1;
+    }
+    T_KRHashSet *set = (T_KRHashSet *)t->children[1]->value.p;
+    t->value.b = kr_hashset_search(set, &t->children[0]->value);
+    t->ind = KR_VALUE_SETED;
+    return 0;
+}
+
+static int _kr_calc_eval_NBL_STR(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    if (KR_CALC_CHILDREN_UNSET(t)) {
+        t->ind = KR_VALUE_UNSET;
+        return -1;
+    }
+    T_KRHashSet *set = (T_KRHashSet *)t->children[1]->value.p;
+    t->value.b = !kr_hashset_search(set, t->children[0]->value.s);
+    t->ind = KR_VALUE_SETED;
+    return 0;
+}
+
+static int _kr_calc_eval_NBL_VAL(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    if (KR_CALC_CHILDREN_UNSET(t)) {
+        t->ind = KR_VALUE_UNSET;
+        return -1;
+    }
+    T_KRHashSet *set = (T_KRHashSet *)t->children[1]->value.p;
+    t->value.b = !kr_hashset_search(set, &t->children[0]->value);
+    t->ind = KR_VALUE_SETED;
+    return 0;
+}
+
+static int _kr_calc_eval_MATCH(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    if (KR_CALC_CHILDREN_UNSET(t)) {
+        t->ind = KR_VALUE_UNSET;
+        return -1;
+    }
+    T_KRRegex *regex = (T_KRRegex *)t->children[1]->value.p;
+    t->value.b = kr_regex_execute(regex, t->children[0]->value.s);
+    t->ind = KR_VALUE_SETED;
+    return 0;
+}
+
+
+/* arithmetic operations, result type is double except mod */
+#define KR_CALC_DEF_ARITH(name, OP, lfld, rfld) \
+static int _kr_calc_eval_##name(T_KRCalcTree *t, T_KRCalc *krcalc) \
+{ \
+    if (KR_CALC_CHILDREN_UNSET(t)) { \
+        t->ind = KR_VALUE_UNSET; \
+        return -1; \
+    } \
+    t->value.d = (double )t->children[0]->value.lfld OP \
+                 (double )t->children[1]->value.rfld; \
+    t->ind = KR_VALUE_SETED; \
+    return 0; \
+}
+
+#define KR_CALC_DEF_MOD(name, lfld, rfld) \
+static int _kr_calc_eval_##name(T_KRCalcTree *t, T_KRCalc *krcalc) \
+{ \
+    if (KR_CALC_CHILDREN_UNSET(t)) { \
+        t->ind = KR_VALUE_UNSET; \
+        return -1; \
+    } \
+    int i1 = (int )t->children[1]->value.rfld; \
+    if (i1 == 0) { \
+        krcalc->calc_status = -1; \
+        snprintf(krcalc->calc_errmsg, sizeof(krcalc->calc_errmsg), \
+                "op[%d] modulo by zero!", t->op); \
+        t->ind = KR_VALUE_UNSET; \
+        return -1; \
+    } \
+    t->value.i = (int )t->children[0]->value.lfld % i1; \
+    t->ind = KR_VALUE_SETED; \
+    return 0; \
+}
+
+#define KR_CALC_DEF_ARITH_OP(op, OP) \
+    KR_CALC_DEF_ARITH(op##_INT_INT,       OP, i, i) \
+    KR_CALC_DEF_ARITH(op##_INT_LONG,      OP, i, l) \
+    KR_CALC_DEF_ARITH(op##_INT_DOUBLE,    OP, i, d) \
+    KR_CALC_DEF_ARITH(op##_LONG_INT,      OP, l, i) \
+    KR_CALC_DEF_ARITH(op##_LONG_LONG,     OP, l, l) \
+    KR_CALC_DEF_ARITH(op##_LONG_DOUBLE,   OP, l, d) \
+    KR_CALC_DEF_ARITH(op##_DOUBLE_INT,    OP, d, i) \
+    KR_CALC_DEF_ARITH(op##_DOUBLE_LONG,   OP, d, l) \
+    KR_CALC_DEF_ARITH(op##_DOUBLE_DOUBLE, OP, d, d)
+
+KR_CALC_DEF_ARITH_OP(PLUS, +)
+KR_CALC_DEF_ARITH_OP(SUB,  -)
+KR_CALC_DEF_ARITH_OP(MUT,  *)
+KR_CALC_DEF_ARITH_OP(DIV,  /)
+
+KR_CALC_DEF_MOD(MOD_INT_INT,       i, i)
+KR_CALC_DEF_MOD(MOD_INT_LONG,      i, l)
+KR_CALC_DEF_MOD(MOD_INT_DOUBLE,    i, d)
+KR_CALC_DEF_MOD(MOD_LONG_INT,      l, i)
+KR_CALC_DEF_MOD(MOD_LONG_LONG,     l, l)
+KR_CALC_DEF_MOD(MOD_LONG_DOUBLE,   l, d)
+KR_CALC_DEF_MOD(MOD_DOUBLE_INT,    d, i)
+KR_CALC_DEF_MOD(MOD_DOUBLE_LONG,   d, l)
+KR_CALC_DEF_MOD(MOD_DOUBLE_DOUBLE, d, d)
+
+/* indexed by op-KR_CALCOP_PLUS, left type, right type */
+static KRCalcEvalFunc _kr_calc_arith_funcs[5][3][3] = {
+    KR_CALC_SPEC_ROW(PLUS), KR_CALC_SPEC_ROW(SUB),
+    KR_CALC_SPEC_ROW(MUT), KR_CALC_SPEC_ROW(DIV),
+    KR_CALC_SPEC_ROW(MOD)
+};
+
+
+/* numeric type index of the specialization tables */
+static inline int _kr_calc_type_index(E_KRType type)
+{
+    switch(type) {
+        case KR_TYPE_INT: return 0;
+        case KR_TYPE_LONG: return 1;
+        case KR_TYPE_DOUBLE: return 2;
+        default: return -1;
+    }
+}
+
+static KRCalcEvalFunc _kr_calc_spec_rel(T_KRCalcTree *t)
+{
+    for (int i=0; i < t->childnum; i++) {
+        if (t->children[i]->type != KR_TYPE_BOOL) {
+            return kr_calc_tree_eval_node;
+        }
+    }
+    switch(t->op) {
+        case KR_CALCOP_AND: return _kr_calc_eval_AND_BOOL;
+        case KR_CALCOP_OR:  return _kr_calc_eval_OR_BOOL;
+        case KR_CALCOP_NOT: return _kr_calc_eval_NOT_BOOL;
+        default: return kr_calc_tree_eval_node;
+    }
+}
+
+static KRCalcEvalFunc _kr_calc_spec_arith(T_KRCalcTree *t)
+{
+    T_KRCalcTree *left = t->children[0];
+    T_KRCalcTree *right = t->children[1];
+    int li = _kr_calc_type_index(left->type);
+    int ri = _kr_calc_type_index(right->type);
+    if (li < 0 || ri < 0) {
+        return kr_calc_tree_eval_node;
+    }
+
+    if (t->op == KR_CALCOP_MOD) {
+        if (t->type != KR_TYPE_INT) return kr_calc_tree_eval_node;
+    } else if (t->op >= KR_CALCOP_PLUS && t->op <= KR_CALCOP_DIV) {
+        if (t->type != KR_TYPE_DOUBLE) return kr_calc_tree_eval_node;
+    } else {
+        return kr_calc_tree_eval_node;
+    }
+
+    return _kr_calc_arith_funcs[t->op-KR_CALCOP_PLUS][li][ri];
+}
+
+static KRCalcEvalFunc _kr_calc_spec_logic(T_KRCalcTree *t)
+{
+    T_KRCalcTree *left = t->children[0];
+    T_KRCalcTree *right = t->children[1];
+
+    switch(t->op) {
+        case KR_CALCOP_LT: case KR_CALCOP_LE:
+        case KR_CALCOP_GT: case KR_CALCOP_GE:
+        case KR_CALCOP_EQ: case KR_CALCOP_NEQ:
+        {
+            if (left->type == KR_TYPE_STRING &&
+                    right->type == KR_TYPE_STRING) {
+                if (right->kind == KR_CALCKIND_STRING) {
+                    if (t->op == KR_CALCOP_EQ)
+                        return _kr_calc_eval_EQ_STR_CONST;
+                    if (t->op == KR_CALCOP_NEQ)
+                        return _kr_calc_eval_NEQ_STR_CONST;
+                }
+                return _kr_calc_strcmp_funcs[t->op-KR_CALCOP_LT];
+            }
+            int li = _kr_calc_type_index(left->type);
+            int ri = _kr_calc_type_index(right->type);
+            if (li < 0 || ri < 0) {
+                return kr_calc_tree_eval_node;
+            }
+            return _kr_calc_cmp_funcs[t->op-KR_CALCOP_LT][li][ri];
+        }
+        case KR_CALCOP_BL:
+            return (left->type == KR_TYPE_STRING) ? \
+                _kr_calc_eval_BL_STR : _kr_calc_eval_BL_VAL;
+        case KR_CALCOP_NBL:
+            return (left->type == KR_TYPE_STRING) ? \
+                _kr_calc_eval_NBL_STR : _kr_calc_eval_NBL_VAL;
+        case KR_CALCOP_MATCH:
+            return _kr_calc_eval_MATCH;
+        default:
+            return kr_calc_tree_eval_node;
+    }
+}
+
+static KRCalcEvalFunc _kr_calc_spec_extern(T_KRCalcTree *t)
+{
+    int bound = (t->slot != NULL);
+
+    if (t->kind == KR_CALCKIND_SET) {
+        return bound ? _kr_calc_eval_slot_SET : _kr_calc_eval_extern_SET;
+    }
+
+    switch(t->type) {
+        case KR_TYPE_BOOL:
+            return bound ? _kr_calc_eval_slot_BOOL : _kr_calc_eval_extern_BOOL;
+        case KR_TYPE_INT:
+            return bound ? _kr_calc_eval_slot_INT : _kr_calc_eval_extern_INT;
+        case KR_TYPE_LONG:
+            return bound ? _kr_calc_eval_slot_LONG : _kr_calc_eval_extern_LONG;
+        case KR_TYPE_DOUBLE:
+            return bound ? _kr_calc_eval_slot_DOUBLE : _kr_calc_eval_extern_DOUBLE;
+        case KR_TYPE_STRING:
+            return bound ? _kr_calc_eval_slot_STRING : _kr_calc_eval_extern_STRING;
+        case KR_TYPE_POINTER:
+            return bound ? _kr_calc_eval_slot_POINTER : _kr_calc_eval_extern_POINTER;
+        default:
+            return kr_calc_tree_eval_node;
+    }
+}
+
+
+/* resolve type and slot of extern identifiers */
+static int _kr_calc_tree_resolve(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    for (int i=0; i < t->childnum; i++) {
+        if (_kr_calc_tree_resolve(t->children[i], krcalc) != 0) {
+            return -1;
+        }
+    }
+
+    switch(t->kind) {
+        case KR_CALCKIND_SET:
+        case KR_CALCKIND_CID:
+        case KR_CALCKIND_FID:
+        case KR_CALCKIND_SID:
+        case KR_CALCKIND_DID:
+        case KR_CALCKIND_HID:
+        case KR_CALCKIND_GID:
+            if (t->type == KR_TYPE_UNKNOWN) {
+                t->type = krcalc->get_type_cb(t->kind, t->id, krcalc->calc_param);
+                if (t->type == KR_TYPE_UNKNOWN) {
+                    krcalc->calc_status = -1;
+                    snprintf(krcalc->calc_errmsg, sizeof(krcalc->calc_errmsg),
+                            "kind[%d],id[%d] type unknown", t->kind, t->id);
+                    return -1;
+                }
+            }
+            t->slot = NULL;
+            if (krcalc->bind_cb != NULL && krcalc->get_slot_cb != NULL) {
+                t->slot = krcalc->bind_cb(t->kind, t->id, krcalc->calc_param);
+            }
+            break;
+        default:
+            break;
+    }
+    return 0;
+}
+
+/* choose evaluation function in postorder */
+static void _kr_calc_tree_specialize(T_KRCalcTree *t)
+{
+    for (int i=0; i < t->childnum; i++) {
+        _kr_calc_tree_specialize(t->children[i]);
+    }
+
+    switch(t->kind) {
+        case KR_CALCKIND_REL:
+            t->eval_func = _kr_calc_spec_rel(t);
+            break;
+        case KR_CALCKIND_ARITH:
+            t->eval_func = _kr_calc_spec_arith(t);
+            break;
+        case KR_CALCKIND_LOGIC:
+            t->eval_func = _kr_calc_spec_logic(t);
+            break;
+        case KR_CALCKIND_SET:
+        case KR_CALCKIND_CID:
+        case KR_CALCKIND_FID:
+        case KR_CALCKIND_SID:
+        case KR_CALCKIND_DID:
+        case KR_CALCKIND_HID:
+        case KR_CALCKIND_GID:
+            t->eval_func = _kr_calc_spec_extern(t);
+            break;
+        default:
+            t->eval_func = _kr_calc_eval_const;
+            break;
+    }
+}
+
+int kr_calc_tree_bind(T_KRCalcTree *root, T_KRCalc *krcalc)
+{
+    if (root == NULL) return -1;
+
+    if (_kr_calc_tree_resolve(root, krcalc) != 0) {
+        return -1;
+    }
+
+    if (kr_calc_tree_check(root, krcalc) != 0) {
+        return -1;
+    }
+
+    _kr_calc_tree_specialize(root);
+    return 0;
+}
+
+void kr_calc_tree_unbind(T_KRCalcTree *t)
+{
+    if (t == NULL) return;
+
+    for (int i=0; i < t->childnum; i++) {
+        kr_calc_tree_unbind(t->children[i]);
+    }
+
+    t->eval_func = NULL;
+    t->slot = NULL;
+    switch(t->kind) {
+        case KR_CALCKIND_SET:
+        case KR_CALCKIND_CID:
+        case KR_CALCKIND_FID:
+        case KR_CALCKIND_SID:
+        case KR_CALCKIND_DID:
+        case KR_CALCKIND_HID:
+        case KR_CALCKIND_GID:
+            t->type = KR_TYPE_UNKNOWN;
+            t->ind = KR_VALUE_UNSET;
+            break;
+        default:
+            break;
+    }
+}
+
+/* postorder evaluation of a bound tree */
+int kr_calc_tree_eval_bound(T_KRCalcTree *t, T_KRCalc *krcalc)
+{
+    for (int i=0; i < t->childnum; i++) {
+        if (kr_calc_tree_eval_bound(t->children[i], krcalc) != 0) {
+            return -1;
+        }
+    }
+    return t->eval_func(t, krcalc);
+}
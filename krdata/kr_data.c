@@ -1,14 +1,17 @@
 #include "kr_data.h"
 
+extern void kr_sdi_table_filter(T_KRSDITable *ptSdiTable, T_KRData *ptData);
+extern void kr_ddi_table_filter(T_KRDDITable *ptDdiTable, T_KRData *ptData);
+
 T_KRData* kr_data_construct(T_KRParam *ptParam, 
         T_KRModule *ptModule, T_DbsEnv *ptDbsEnv, T_KRCache *ptHDICache,
         KRGetTypeFunc pfGetType, KRGetValueFunc pfGetValue)
 {
     short nSecId = ptParam->nSecId;
     
-    T_KRData *ptData = kr_malloc(sizeof(T_KRData));
+    T_KRData *ptData = kr_calloc(sizeof(T_KRData));
     if (ptData == NULL) {
-        KR_LOG(KR_LOGERROR, "kr_malloc ptData Failed!");
+        KR_LOG(KR_LOGERROR, "kr_calloc ptData Failed!");
         return NULL;
     }
     ptData->ptParam = ptParam;
@@ -22,6 +25,7 @@ T_KRData* kr_data_construct(T_KRParam *ptParam,
             ptDbsEnv);
     if (ptData->ptSetTable == NULL) {
         KR_LOG(KR_LOGERROR, "kr_set_table_construct Failed!");
+        kr_data_destruct(ptData);
         return NULL;
     }
     
@@ -29,6 +33,7 @@ T_KRData* kr_data_construct(T_KRParam *ptParam,
             ptModule, pfGetType, pfGetValue);
     if (ptData->ptSdiTable == NULL) {
         KR_LOG(KR_LOGERROR, "kr_sdi_table_construct Failed!");
+        kr_data_destruct(ptData);
         return NULL;
     }
     
@@ -36,6 +41,7 @@ T_KRData* kr_data_construct(T_KRParam *ptParam,
             ptModule, pfGetType, pfGetValue);
     if (ptData->ptDdiTable == NULL) {
         KR_LOG(KR_LOGERROR, "kr_ddi_table_construct Failed!");
+        kr_data_destruct(ptData);
         return NULL;
     }
 
@@ -43,32 +49,70 @@ T_KRData* kr_data_construct(T_KRParam *ptParam,
             ptModule);
     if (ptData->ptHdiTable == NULL) {
         KR_LOG(KR_LOGERROR, "kr_hdi_table_construct Failed!");
+        kr_data_destruct(ptData);
         return NULL;
     }
 
     ptData->ptCurrRec = NULL;
     ptData->ptRecord = NULL;
+    ptData->lBindStamp = 0;
+    ptData->ptDeps = NULL;
+    kr_data_set_related_mode(ptData, KR_RELATED_ALWAYS);
+    ptData->ptArena = kr_arena_new(KR_DATA_ARENA_CHUNK);
+    if (ptData->ptArena == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_arena_new Failed!");
+        kr_data_destruct(ptData);
+        return NULL;
+    }
     
     return ptData;
 }
 
+static void _kr_data_init_sdi(void *value, void *data)
+{
+    kr_sdi_init((T_KRSDI *)value);
+}
+
+static void _kr_data_init_ddi(void *value, void *data)
+{
+    kr_ddi_init((T_KRDDI *)value);
+}
+
+static void _kr_data_init_hdi(void *value, void *data)
+{
+    kr_hdi_init((T_KRHDI *)value);
+}
+
+/* only items of ptDeps could be computed by this event if set,
+ * the whole tables are initialized otherwise
+ */
 void kr_data_init(T_KRData *ptData)
 {
     if (ptData) {
-        kr_set_table_init(ptData->ptSetTable);
-        kr_sdi_table_init(ptData->ptSdiTable);
-        kr_ddi_table_init(ptData->ptDdiTable);
-        kr_hdi_table_init(ptData->ptHdiTable);
+        T_KRDataDeps *ptDeps = ptData->ptDeps;
+        if (ptDeps != NULL && ptDeps->lBindStamp == ptData->lBindStamp) {
+            kr_list_foreach(ptDeps->ptSDIList, _kr_data_init_sdi, NULL);
+            kr_list_foreach(ptDeps->ptDDIList, _kr_data_init_ddi, NULL);
+            kr_list_foreach(ptDeps->ptHDIList, _kr_data_init_hdi, NULL);
+        } else {
+            kr_set_table_init(ptData->ptSetTable);
+            kr_sdi_table_init(ptData->ptSdiTable);
+            kr_ddi_table_init(ptData->ptDdiTable);
+            kr_hdi_table_init(ptData->ptHdiTable);
+        }
+        ptData->ptDeps = NULL;
     }
 }
 
 void kr_data_destruct(T_KRData *ptData)
 {
     if (ptData) {
-        kr_set_table_destruct(ptData->ptSetTable);
-        kr_sdi_table_destruct(ptData->ptSdiTable);
-        kr_ddi_table_destruct(ptData->ptDdiTable);
-        kr_hdi_table_destruct(ptData->ptHdiTable);
+        /*tables may be missing if construct failed*/
+        if (ptData->ptSetTable) kr_set_table_destruct(ptData->ptSetTable);
+        if (ptData->ptSdiTable) kr_sdi_table_destruct(ptData->ptSdiTable);
+        if (ptData->ptDdiTable) kr_ddi_table_destruct(ptData->ptDdiTable);
+        if (ptData->ptHdiTable) kr_hdi_table_destruct(ptData->ptHdiTable);
+        kr_arena_free(ptData->ptArena);
         kr_free(ptData);
     }
 }
@@ -92,6 +136,7 @@ int kr_data_check(T_KRData *ptData)
         if (ptSetTable != NULL) {
             kr_set_table_destruct(ptData->ptSetTable);
             ptData->ptSetTable = ptSetTable;
+            ptData->lBindStamp++;
         } else {
             KR_LOG(KR_LOGERROR, "reload set table error!");
             return -1;
@@ -106,6 +151,7 @@ int kr_data_check(T_KRData *ptData)
         if (ptSDITable != NULL) {
             kr_sdi_table_destruct(ptData->ptSdiTable);
             ptData->ptSdiTable = ptSDITable;
+            ptData->lBindStamp++;
         } else {
             KR_LOG(KR_LOGERROR, "reload sdi table error!");
             return -1;
@@ -120,6 +166,7 @@ int kr_data_check(T_KRData *ptData)
         if (ptDDITable != NULL) {
             kr_ddi_table_destruct(ptData->ptDdiTable);
             ptData->ptDdiTable = ptDDITable;
+            ptData->lBindStamp++;
         } else {
             KR_LOG(KR_LOGERROR, "reload ddi table error!");
             return -1;
@@ -134,6 +181,7 @@ int kr_data_check(T_KRData *ptData)
         if (ptHDITable != NULL) {
             kr_hdi_table_destruct(ptData->ptHdiTable);
             ptData->ptHdiTable = ptHDITable;
+            ptData->lBindStamp++;
         } else {
             KR_LOG(KR_LOGERROR, "reload hdi table error!");
             return -1;
@@ -144,3 +192,52 @@ int kr_data_check(T_KRData *ptData)
 }
 
 
+
+/* register key statistics the loaded section reads from ptDB,
+ * before it inserts or restores records, see kr_ddi_table_register
+ */
+int kr_data_register(T_KRParam *ptParam, T_KRDB *ptDB)
+{
+    short nSecId = ptParam->nSecId;
+    return kr_ddi_table_register(&ptParam->stParamDDI[nSecId], ptDB);
+}
+
+
+/* per-event copy of an item's string value, 
+ * valid until the arena is reset after the event
+ */
+char *kr_data_strndup(T_KRData *ptData, const char *s, size_t len)
+{
+    if (ptData->ptArena == NULL) {
+        ptData->ptArena = kr_arena_new(KR_DATA_ARENA_CHUNK);
+        if (ptData->ptArena == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_arena_new Failed!");
+            return NULL;
+        }
+    }
+    return kr_arena_strndup(ptData->ptArena, s, len);
+}
+
+
+/* records kept while computing only if always wanted, 
+ * on fire ones are computed again when asked for
+ */
+void kr_data_set_related_mode(T_KRData *ptData, E_KRRelatedMode eMode)
+{
+    ptData->eRelatedMode = eMode;
+    ptData->bRelatedCapture = (eMode == KR_RELATED_ALWAYS);
+}
+
+
+/* evaluate record-invariant filters of statistics items once, 
+ * while ptRecord inserted into krdb, aggregations test the bits later
+ */
+void kr_data_filter_record(T_KRData *ptData, T_KRRecord *ptRecord)
+{
+    T_KRRecord *ptSavedRec = ptData->ptRecord;
+
+    ptData->ptRecord = ptRecord;
+    kr_sdi_table_filter(ptData->ptSdiTable, ptData);
+    kr_ddi_table_filter(ptData->ptDdiTable, ptData);
+    ptData->ptRecord = ptSavedRec;
+}
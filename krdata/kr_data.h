@@ -6,6 +6,11 @@
 #include "kr_data_ddi.h"
 #include "kr_data_hdi.h"
 #include "kr_data_hdi_cache.h"
+#include "kr_data_deps.h"
+#include "krutils/kr_arena.h"
+
+/*first chunk of the per-event arena*/
+#define KR_DATA_ARENA_CHUNK  (64*1024)
 
 
 typedef struct _kr_data_t
@@ -24,6 +29,13 @@ typedef struct _kr_data_t
 
     T_KRRecord       *ptCurrRec;
     T_KRRecord       *ptRecord;
+    long              lBindStamp;    /*bumped on reload, calcs rebind*/
+    long              lFreqValue;    /*last global frequency read*/
+    T_KRDataDeps     *ptDeps;        /*items this event may compute,
+                                       NULL if unknown*/
+    T_KRArena        *ptArena;       /*per-event scratch, reset by owner*/
+    E_KRRelatedMode   eRelatedMode;
+    kr_bool           bRelatedCapture; /*items keep records aggregated*/
 }T_KRData;
 
 
@@ -33,9 +45,20 @@ T_KRData *kr_data_construct(T_KRParam *ptParam,
 void kr_data_destruct(T_KRData *ptData);
 void kr_data_init(T_KRData *ptData);
 int kr_data_check(T_KRData *ptData);
+int kr_data_register(T_KRParam *ptParam, T_KRDB *ptDB);
+void kr_data_filter_record(T_KRData *ptData, T_KRRecord *ptRecord);
+char *kr_data_strndup(T_KRData *ptData, const char *s, size_t len);
+void kr_data_set_related_mode(T_KRData *ptData, E_KRRelatedMode eMode);
+T_KRRelated *kr_sdi_related(T_KRSDI *ptSDI, T_KRData *ptData);
+T_KRRelated *kr_ddi_related(T_KRDDI *ptDDI, T_KRData *ptData);
 
 E_KRType kr_data_get_type(char kind, int id, void *param);
 void *kr_data_get_value(char kind, int id, void *param);
+void *kr_data_bind(char kind, int id, void *param);
+void *kr_data_get_slot(char kind, void *slot, void *param);
+long kr_data_bind_stamp(void *param);
+void kr_data_bind_calc(T_KRCalc *krcalc);
+int kr_data_record_invariant(T_KRCalc *krcalc);
 
 #endif /* __KR_DATA_H__ */
 
@@ -10,6 +10,27 @@ extern E_KRType kr_ddi_get_type(int did, T_KRData *ptData);
 extern void *kr_ddi_get_value(int did, T_KRData *ptData);
 extern E_KRType kr_hdi_get_type(int hid, T_KRData *ptData);
 extern void *kr_hdi_get_value(int hid, T_KRData *ptData);
+extern void *kr_sdi_get_item_value(T_KRSDI *ptSDI, T_KRData *ptData);
+extern void *kr_ddi_get_item_value(T_KRDDI *ptDDI, T_KRData *ptData);
+extern void *kr_hdi_get_item_value(T_KRHDI *ptHDI, T_KRData *ptData);
+
+/* global frequency of the current record's field value,
+ * only counted for records of the frequency's table
+ */
+static void *kr_freq_get_value(int gid, T_KRData *ptData)
+{
+    T_KRRecord *ptCurrRec = ptData->ptCurrRec;
+    if (ptCurrRec == NULL) return NULL;
+
+    T_KRTable *ptTable = ptCurrRec->ptTable;
+    T_KRFreq *ptFreq = kr_freq_get(ptTable->ptDB, gid);
+    if (ptFreq == NULL || ptFreq->ptTable != ptTable) {
+        return NULL;
+    }
+    ptData->lFreqValue = (long )kr_freq_estimate(ptFreq, ptCurrRec);
+    return &ptData->lFreqValue;
+}
+
 
 E_KRType kr_data_get_type(char kind, int id, void *param)
 {
@@ -34,6 +55,9 @@ E_KRType kr_data_get_type(char kind, int id, void *param)
         case KR_CALCKIND_HID: 
             return kr_hdi_get_type(id, ptData);
             break;
+        case KR_CALCKIND_GID: 
+            return KR_TYPE_LONG;
+            break;
         default:
             return KR_TYPE_UNKNOWN;
     }
@@ -63,8 +87,86 @@ void *kr_data_get_value(char kind, int id, void *param)
         case KR_CALCKIND_HID: 
             return kr_hdi_get_value(id, ptData);
             break;
+        case KR_CALCKIND_GID: 
+            return kr_freq_get_value(id, ptData);
+            break;
+        default:
+            return NULL;
+    }
+}
+
+
+
+/* calc slot binding, slot is the item itself,
+ * fields still go through kr_data_get_value with the current record
+ */
+void *kr_data_bind(char kind, int id, void *param)
+{
+    T_KRData *ptData = (T_KRData *)param;
+    switch(kind) 
+    {
+        case KR_CALCKIND_SET:
+            return kr_set_lookup(ptData->ptSetTable, id);
+        case KR_CALCKIND_SID:
+            return kr_sdi_lookup(ptData->ptSdiTable, id);
+        case KR_CALCKIND_DID: 
+            return kr_ddi_lookup(ptData->ptDdiTable, id);
+        case KR_CALCKIND_HID: 
+            return kr_hdi_lookup(ptData->ptHdiTable, id);
+        default:
+            return NULL;
+    }
+}
+
+
+void *kr_data_get_slot(char kind, void *slot, void *param)
+{
+    T_KRData *ptData = (T_KRData *)param;
+    switch(kind) 
+    {
+        case KR_CALCKIND_SET:
+            return ((T_KRSet *)slot)->ptHashSet;
+        case KR_CALCKIND_SID:
+            return kr_sdi_get_item_value((T_KRSDI *)slot, ptData);
+        case KR_CALCKIND_DID: 
+            return kr_ddi_get_item_value((T_KRDDI *)slot, ptData);
+        case KR_CALCKIND_HID: 
+            return kr_hdi_get_item_value((T_KRHDI *)slot, ptData);
         default:
             return NULL;
     }
 }
 
+
+long kr_data_bind_stamp(void *param)
+{
+    return ((T_KRData *)param)->lBindStamp;
+}
+
+
+/* let calcs evaluated against T_KRData bind their items */
+void kr_data_bind_calc(T_KRCalc *krcalc)
+{
+    if (krcalc != NULL && krcalc->get_value_cb == kr_data_get_value &&
+            krcalc->bind_cb != kr_data_bind) {
+        kr_calc_set_bind_func(krcalc, 
+                kr_data_bind, kr_data_get_slot, kr_data_bind_stamp);
+    }
+}
+
+
+/* whether calc only depends on fields of ptRecord, 
+ * its result for a stored record never changes then
+ */
+int kr_data_record_invariant(T_KRCalc *krcalc)
+{
+    if (krcalc == NULL || krcalc->get_value_cb != kr_data_get_value) {
+        return 0;
+    }
+    return !kr_calc_has_kind(krcalc, KR_CALCKIND_CID) &&
+           !kr_calc_has_kind(krcalc, KR_CALCKIND_SET) &&
+           !kr_calc_has_kind(krcalc, KR_CALCKIND_SID) &&
+           !kr_calc_has_kind(krcalc, KR_CALCKIND_DID) &&
+           !kr_calc_has_kind(krcalc, KR_CALCKIND_HID) &&
+           !kr_calc_has_kind(krcalc, KR_CALCKIND_GID);
+}
@@ -1,4 +1,80 @@
 #include "kr_data.h"
+#include <ctype.h>
+
+/* split a SEQUENCE's filter string into step predicates, steps end
+ * with ';' like a single filter, "@<seconds>" before a step bounds
+ * the time since its previous step, e.g.
+ * "F_3 == 'reset'; @600 F_3 == 'newdev'; F_4 > 10000;"
+ */
+static int kr_ddi_sequence_construct(T_KRDDI *ptDDI, 
+        KRGetTypeFunc pfGetType, KRGetValueFunc pfGetValue)
+{
+    T_KRParamDDIDef *ptParamDDIDef = ptDDI->ptParamDDIDef;
+    char caStep[sizeof(ptParamDDIDef->caDdiFilterString)+1];
+    char *p = ptParamDDIDef->caDdiFilterString;
+    int iQuoted = 0, iBracket = 0;
+
+    if (ptParamDDIDef->caDdiFilterFormat[0] != KR_CALCFORMAT_FLEX) {
+        KR_LOG(KR_LOGERROR, "SEQUENCE DDI[%ld] needs flex format!", \
+               ptDDI->lDDIId);
+        return -1;
+    }
+    ptDDI->pptStepCalc = kr_calloc(sizeof(T_KRCalc *)*KR_SEQUENCE_STEPS_MAX);
+    if (ptDDI->pptStepCalc == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc pptStepCalc failed!");
+        return -1;
+    }
+
+    while (*p != '\0') {
+        /*cut one step, ';' in strings and regexes doesn't end it*/
+        char *q = p;
+        for (; *q != '\0'; q++) {
+            if (*q == '\'') iQuoted = !iQuoted;
+            else if (!iQuoted && *q == '[') iBracket++;
+            else if (!iQuoted && *q == ']') iBracket--;
+            else if (!iQuoted && iBracket <= 0 && *q == ';') break;
+        }
+        while (isspace((unsigned char )*p)) p++;
+        if (p == q) {
+            p = (*q == ';') ? q+1 : q;
+            continue;
+        }
+        if (ptDDI->iStepCnt == KR_SEQUENCE_STEPS_MAX) {
+            KR_LOG(KR_LOGERROR, "SEQUENCE DDI[%ld] over [%d] steps!", \
+                   ptDDI->lDDIId, KR_SEQUENCE_STEPS_MAX);
+            return -1;
+        }
+
+        long lGap = 0;
+        if (*p == '@') {
+            lGap = strtol(p+1, &p, 10);
+            while (isspace((unsigned char )*p)) p++;
+        }
+        snprintf(caStep, sizeof(caStep), "%.*s;", (int )(q-p), p);
+        T_KRCalc *ptStepCalc = kr_calc_construct(KR_CALCFORMAT_FLEX, \
+                caStep, pfGetType, pfGetValue);
+        if (ptStepCalc == NULL) {
+            KR_LOG(KR_LOGERROR, "SEQUENCE DDI[%ld] step [%s] error!", \
+                   ptDDI->lDDIId, caStep);
+            return -1;
+        }
+        kr_data_bind_calc(ptStepCalc);
+        ptDDI->stPattern.gap[ptDDI->iStepCnt] = ptDDI->iStepCnt ? lGap : 0;
+        ptDDI->pptStepCalc[ptDDI->iStepCnt++] = ptStepCalc;
+        
+        p = (*q == ';') ? q+1 : q;
+    }
+
+    if (ptDDI->iStepCnt == 0) {
+        KR_LOG(KR_LOGERROR, "SEQUENCE DDI[%ld] without steps!", ptDDI->lDDIId);
+        return -1;
+    }
+    ptDDI->stPattern.steps = ptDDI->iStepCnt;
+    ptDDI->stPattern.window = ptParamDDIDef->lStatisticsValue;
+    
+    return 0;
+}
+
 
 /*static dataitem*/
 T_KRDDI *kr_ddi_construct(T_KRParamDDIDef *ptParamDDIDef, T_KRModule *ptModule,
@@ -11,8 +87,26 @@ T_KRDDI *kr_ddi_construct(T_KRParamDDIDef *ptParamDDIDef, T_KRModule *ptModule,
     }
     ptDDI->ptParamDDIDef = ptParamDDIDef;
     ptDDI->lDDIId = ptParamDDIDef->lDdiId;
-    ptDDI->ptDDICalc = kr_calc_construct(ptParamDDIDef->caDdiFilterFormat[0], \
-            ptParamDDIDef->caDdiFilterString, pfGetType, pfGetValue);
+    ptDDI->iSequenceId = -1;
+    if (ptParamDDIDef->caStatisticsMethod[0] == KR_DDI_METHOD_SEQUENCE) {
+        /*steps are filtered one by one, there's no whole filter*/
+        if (kr_ddi_sequence_construct(ptDDI, pfGetType, pfGetValue) != 0) {
+            KR_LOG(KR_LOGERROR, "kr_ddi_sequence_construct [%ld] error!", \
+                    ptDDI->lDDIId);
+            kr_ddi_destruct(ptDDI);
+            return NULL;
+        }
+    } else {
+        const char *psRefused = kr_ddi_refused(ptParamDDIDef);
+        if (psRefused != NULL) {
+            KR_LOG(KR_LOGERROR, "DDI[%ld] %s!", ptDDI->lDDIId, psRefused);
+            kr_free(ptDDI);
+            return NULL;
+        }
+        ptDDI->ptDDICalc = kr_calc_construct(ptParamDDIDef->caDdiFilterFormat[0], \
+                ptParamDDIDef->caDdiFilterString, pfGetType, pfGetValue);
+        kr_data_bind_calc(ptDDI->ptDDICalc);
+    }
     ptDDI->eValueType = ptParamDDIDef->caDdiValueType[0];
     /*get the retrieve data function from module*/
     if (ptParamDDIDef->caDdiAggrFunc[0] != '\0') {
@@ -21,11 +115,17 @@ T_KRDDI *kr_ddi_construct(T_KRParamDDIDef *ptParamDDIDef, T_KRModule *ptModule,
         if (ptDDI->pfDDIAggr == NULL) {
             KR_LOG(KR_LOGERROR, "kr_module_symbol [%s] error!", \
                     ptParamDDIDef->caDdiAggrFunc);
+            kr_ddi_destruct(ptDDI);
             return NULL;
         }
     }
     ptDDI->eValueInd = KR_VALUE_UNSET;
-    ptDDI->ptRelated = kr_hashtable_new(kr_pointer_hash, kr_pointer_equal);
+    ptDDI->ptRelated = kr_related_new();
+    ptDDI->iDecayId = -1;
+    ptDDI->iTopKId = -1;
+    ptDDI->iQuantileId = -1;
+    ptDDI->iColumnId = -1;
+    ptDDI->iRunId = -1;
     
     return ptDDI;
 }
@@ -34,22 +134,95 @@ void kr_ddi_init(T_KRDDI *ptDDI)
 {
     /*initialize first*/
     ptDDI->eValueInd = KR_VALUE_UNSET;
-    kr_hashtable_remove_all(ptDDI->ptRelated);
+    kr_related_reset(ptDDI->ptRelated);
 
-    /*string comes from kr_strdup, need kr_free*/
-    if (ptDDI->eValueType == KR_TYPE_STRING)
-        kr_free(ptDDI->uValue.s);
+    /*string comes from the event arena, released with it*/
     memset(&ptDDI->uValue, 0x00, sizeof(ptDDI->uValue));
+
+    ptDDI->lAggrCnt = 0;
+    memset(&ptDDI->uAggrLast, 0x00, sizeof(ptDDI->uAggrLast));
+    if (ptDDI->ptDistinct != NULL)
+        kr_distinct_reset(ptDDI->ptDistinct);
+    if (ptDDI->ptTDigest != NULL)
+        kr_tdigest_reset(ptDDI->ptTDigest);
 }
 
 void kr_ddi_destruct(T_KRDDI *ptDDI)
 {
-    kr_hashtable_destroy(ptDDI->ptRelated);
+    kr_related_free(ptDDI->ptRelated);
     kr_calc_destruct(ptDDI->ptDDICalc);
+    for (int i=0; i<ptDDI->iStepCnt; i++) {
+        kr_calc_destruct(ptDDI->pptStepCalc[i]);
+    }
+    kr_free(ptDDI->pptStepCalc);
+    kr_distinct_free(ptDDI->ptDistinct);
+    kr_tdigest_free(ptDDI->ptTDigest);
     kr_free(ptDDI);
 }
 
 
+static void kr_ddi_fused_free(T_KRDDIFused *ptFused)
+{
+    kr_list_destroy(ptFused->ptDDIList);
+    kr_free(ptFused);
+}
+
+/* group DDIs with the same index and datasrc, 
+ * DDIs with module aggregate functions are always scanned alone,
+ * decayed, heavy hitters, sequence and columnar ones never scan rows
+ */
+static void kr_ddi_table_plan(T_KRDDITable *ptDdiTable)
+{
+    T_KRParamDDI *ptParamDDI = ptDdiTable->ptParamDDI;
+    T_KRListNode *node = NULL;
+    T_KRDDIFused *ptFused = NULL;
+    
+    ptDdiTable->ptFusedList = kr_list_new();
+    kr_list_set_free(ptDdiTable->ptFusedList, 
+            (KRListFreeFunc )kr_ddi_fused_free);
+
+    for (int i=0; i<ptParamDDI->lDDIDefCnt; ++i) {
+        T_KRDDI *ptDDI = kr_ddi_lookup(ptDdiTable, 
+                (int )ptParamDDI->stParamDDIDef[i].lDdiId);
+        if (ptDDI == NULL || ptDDI->pfDDIAggr != NULL) continue;
+        
+        T_KRParamDDIDef *ptParamDDIDef = ptDDI->ptParamDDIDef;
+        if (ptParamDDIDef->caStatisticsType[0] == KR_DDI_STATISTICS_DECAY ||
+            ptParamDDIDef->caStatisticsMethod[0] == KR_DDI_METHOD_SEQUENCE ||
+            kr_ddi_is_topk(ptParamDDIDef) || kr_ddi_is_quantile(ptParamDDIDef) ||
+            kr_ddi_is_run(ptParamDDIDef) || kr_ddi_is_columnar(ptDDI))
+            continue;
+        for (node=ptDdiTable->ptFusedList->head; node; node=node->next) {
+            ptFused = (T_KRDDIFused *)kr_list_value(node);
+            if (ptFused->lStatisticsIndex == \
+                    ptParamDDIDef->lStatisticsIndex &&
+                ptFused->lStatisticsDatasrc == \
+                    ptParamDDIDef->lStatisticsDatasrc) {
+                break;
+            }
+        }
+        if (node == NULL) {
+            ptFused = kr_calloc(sizeof(T_KRDDIFused));
+            ptFused->lStatisticsIndex = ptParamDDIDef->lStatisticsIndex;
+            ptFused->lStatisticsDatasrc = ptParamDDIDef->lStatisticsDatasrc;
+            ptFused->ptDDIList = kr_list_new();
+            kr_list_add_tail(ptDdiTable->ptFusedList, ptFused);
+        }
+        kr_list_add_tail(ptFused->ptDDIList, ptDDI);
+    }
+
+    /*a DDI alone gains nothing from fusing*/
+    for (node=ptDdiTable->ptFusedList->head; node; node=node->next) {
+        ptFused = (T_KRDDIFused *)kr_list_value(node);
+        if (kr_list_length(ptFused->ptDDIList) < 2) continue;
+        T_KRListNode *member = ptFused->ptDDIList->head;
+        for (; member; member=member->next) {
+            ((T_KRDDI *)kr_list_value(member))->ptFused = ptFused;
+        }
+    }
+}
+
+
 T_KRDDITable *kr_ddi_table_construct(T_KRParamDDI *ptParamDDI, T_KRModule *ptModule, KRGetTypeFunc pfGetType, KRGetValueFunc pfGetValue)
 {
     T_KRDDITable *ptDdiTable = kr_calloc(sizeof(T_KRDDITable));
@@ -74,8 +247,15 @@ T_KRDDITable *kr_ddi_table_construct(T_KRParamDDI *ptParamDDI, T_KRModule *ptMod
             kr_free(ptDdiTable);
             return NULL;
         }
+        /*record-invariant filters get a bit in each record's header*/
+        ptDDI->iFilterBit = -1;
+        if (i < KR_FILTER_BITS_MAX && 
+                kr_data_record_invariant(ptDDI->ptDDICalc)) {
+            ptDDI->iFilterBit = i;
+        }
         kr_hashtable_insert(ptDdiTable->ptDDITable, &ptDDI->lDDIId, ptDDI);
     }
+    kr_ddi_table_plan(ptDdiTable);
     ptDdiTable->tConstructTime = ptParamDDI->tLastLoadTime;
     
     return ptDdiTable;    
@@ -93,6 +273,7 @@ void kr_ddi_table_init(T_KRDDITable *ptDdiTable)
 
 void kr_ddi_table_destruct(T_KRDDITable *ptDdiTable)
 {
+    kr_list_destroy(ptDdiTable->ptFusedList);
     kr_hashtable_destroy(ptDdiTable->ptDDITable);
     kr_free(ptDdiTable);
 }
@@ -2,35 +2,146 @@
 #define __KR_DDI_H__
 
 #include "krutils/kr_utils.h"
+#include "krutils/kr_distinct.h"
+#include "krutils/kr_tdigest.h"
+#include "krutils/kr_simd.h"
 #include "krparam/kr_param.h"
 #include "krcalc/kr_calc.h"
 #include "krdb/kr_db.h"
+#include "kr_data_related.h"
 
 typedef int  (*KRDDIAggrFunc)(void *p1, void *p2);
 
+typedef enum {
+    KR_DDI_STATISTICS_INCLUDE     = 'I',  /*include current record*/
+    KR_DDI_STATISTICS_EXCLUDE     = 'E',  /*exclude current record*/
+    KR_DDI_STATISTICS_DECAY       = 'D'   /*decayed counter, value is half-life*/
+}E_KRDDIStatisticsType;
+
+typedef enum {
+    KR_DDI_METHOD_SUM        = '0',  /*sum*/
+    KR_DDI_METHOD_MIN        = '1',  /*min*/
+    KR_DDI_METHOD_MAX        = '2',  /*max*/
+    KR_DDI_METHOD_COUNT      = '3',  /*count*/
+    KR_DDI_METHOD_CON_INC    = '4',  /*continuous increase*/
+    KR_DDI_METHOD_CON_DEC    = '5',  /*continuous decrease*/
+    KR_DDI_METHOD_CNT_DIS    = '6',  /*count distinct*/
+    KR_DDI_METHOD_QUANTILE   = '7',  /*quantile, per mille in statistics_count,
+                                       kept per key while inserting*/
+    KR_DDI_METHOD_TOP_VALUE  = '8',  /*most frequent value of key*/
+    KR_DDI_METHOD_TOP_FREQ   = '9',  /*frequency of the most frequent value*/
+    KR_DDI_METHOD_CUR_FREQ   = 'A',  /*frequency of current record's value*/
+    KR_DDI_METHOD_SEQUENCE   = 'B'   /*steps matched of a pattern*/
+}E_KRDDIMethod;
+
+/*DDIs sharing one statistics index and datasrc, scanned in one pass*/
+typedef struct _kr_ddi_fused_t
+{
+    long                  lStatisticsIndex;
+    long                  lStatisticsDatasrc;
+    T_KRList              *ptDDIList;
+}T_KRDDIFused;
+
 typedef struct _kr_ddi_t
 {
     T_KRParamDDIDef       *ptParamDDIDef;
     long                  lDDIId;
     T_KRCalc              *ptDDICalc;
+    int                   iFilterBit;   /*record filter bit, -1 if none*/
     E_KRType              eValueType;
     KRDDIAggrFunc         pfDDIAggr;
+    T_KRDDIFused          *ptFused;     /*NULL if scanned alone*/
+    kr_bool               bScanStopped; /*passed window in fused scan*/
     
     T_KRRecord            *ptCurrRec;
     E_KRType              eKeyType;
     void                  *pKeyValue;
-    T_KRList              *ptRecList;
+    T_KRDBCursor          stCursor;     /*key's records, latest first*/
+    
+    /*scan state of methods depending on the records aggregated before*/
+    long                  lAggrCnt;     /*records aggregated in this scan*/
+    U_KRValue             uAggrLast;    /*value of the last one aggregated*/
+    T_KRDistinct          *ptDistinct;  /*values seen by CNT_DIS*/
+    T_KRTDigest           *ptTDigest;   /*QUANTILE's panes merged*/
+    int                   iDecayId;     /*decayed counter in index slots*/
+    int                   iTopKId;      /*heavy hitters in index slots*/
+    int                   iQuantileId;  /*value digests in index slots*/
+    int                   iColumnId;    /*field mirrored in index slots*/
+    int                   iRunId;       /*latest run in index slots*/
+    
+    /*SEQUENCE's steps, one predicate each, matched while inserting*/
+    int                   iStepCnt;
+    T_KRCalc              **pptStepCalc;
+    T_KRSeqPattern        stPattern;
+    int                   iSequenceId;  /*pattern NFA in index slots*/
     
     E_KRValueInd          eValueInd;
     U_KRValue             uValue;
-    T_KRHashTable         *ptRelated;
+    T_KRRelated           *ptRelated;
 }T_KRDDI;
 
+/*heavy hitters are kept per key while inserting, never scanned*/
+static inline int kr_ddi_is_topk(T_KRParamDDIDef *ptParamDDIDef)
+{
+    char cMethod = ptParamDDIDef->caStatisticsMethod[0];
+    return (cMethod == KR_DDI_METHOD_TOP_VALUE || 
+            cMethod == KR_DDI_METHOD_TOP_FREQ ||
+            cMethod == KR_DDI_METHOD_CUR_FREQ);
+}
+
+/*value digests are kept per key while inserting, never scanned*/
+static inline int kr_ddi_is_quantile(T_KRParamDDIDef *ptParamDDIDef)
+{
+    return ptParamDDIDef->caStatisticsMethod[0] == KR_DDI_METHOD_QUANTILE;
+}
+
+/*decayed counters, heavy hitters and value digests are kept by
+ *every insert, records are neither filtered nor left out*/
+static inline int kr_ddi_takes_all(T_KRParamDDIDef *ptParamDDIDef)
+{
+    return ptParamDDIDef->caStatisticsType[0] == KR_DDI_STATISTICS_DECAY ||
+        kr_ddi_is_topk(ptParamDDIDef) || kr_ddi_is_quantile(ptParamDDIDef);
+}
+
+static inline int kr_ddi_has_filter(T_KRParamDDIDef *ptParamDDIDef)
+{
+    return ptParamDDIDef->caDdiFilterString[0] != '\0' ||
+        ptParamDDIDef->caStatisticsType[0] == KR_DDI_STATISTICS_EXCLUDE;
+}
+
+/*runs of every record are kept per key while inserting, 
+ *filtered ones and those of a module's function are scanned*/
+static inline int kr_ddi_is_run(T_KRParamDDIDef *ptParamDDIDef)
+{
+    char cMethod = ptParamDDIDef->caStatisticsMethod[0];
+    return (cMethod == KR_DDI_METHOD_CON_INC || 
+            cMethod == KR_DDI_METHOD_CON_DEC) &&
+        ptParamDDIDef->caStatisticsType[0] == KR_DDI_STATISTICS_INCLUDE &&
+        !kr_ddi_has_filter(ptParamDDIDef) &&
+        ptParamDDIDef->caDdiAggrFunc[0] == '\0';
+}
+
+/*why a DDI kept by every insert can't be defined so, NULL if it can*/
+static inline const char *kr_ddi_refused(T_KRParamDDIDef *ptParamDDIDef)
+{
+    if (!kr_ddi_takes_all(ptParamDDIDef)) {
+        return NULL;
+    } else if (kr_ddi_has_filter(ptParamDDIDef)) {
+        return "takes every record, no filter or exclude";
+    } else if (kr_ddi_is_topk(ptParamDDIDef) &&
+            ptParamDDIDef->lStatisticsValue != 0) {
+        /*the sketch counts every record since registered*/
+        return "counts every record, no window";
+    }
+    return NULL;
+}
+
 typedef struct _kr_ddi_table_t
 {
     T_KRParamDDI          *ptParamDDI;
     long                  lDDICnt;
     T_KRHashTable         *ptDDITable;
+    T_KRList              *ptFusedList;
     time_t                tConstructTime;
 }T_KRDDITable;
 
@@ -46,6 +157,11 @@ T_KRDDITable *kr_ddi_table_construct(T_KRParamDDI *ptParamDDI, T_KRModule *ptMod
 void kr_ddi_table_destruct(T_KRDDITable *ptDdiTable);
 void kr_ddi_table_init(T_KRDDITable *ptDdiTable);
 T_KRDDI *kr_ddi_lookup(T_KRDDITable *ptDdiTable, int id);
+int kr_ddi_table_register(T_KRParamDDI *ptParamDDI, T_KRDB *ptDB);
+
+void kr_ddi_set_quantile_compression(double dCompression);
+void kr_ddi_set_columnar(kr_bool bColumnar);
+int kr_ddi_is_columnar(T_KRDDI *ptDDI);
 
 
 #endif /* __KR_DDI_H__ */
@@ -1,55 +1,322 @@
 #include "kr_data.h"
 
-typedef enum {
-    KR_DDI_STATISTICS_INCLUDE     = 'I',  /*include current record*/
-    KR_DDI_STATISTICS_EXCLUDE     = 'E'   /*exclude current record*/
-}E_KRDDIStatisticsType;
-
-typedef enum {
-    KR_DDI_METHOD_SUM        = '0',  /*sum*/
-    KR_DDI_METHOD_MIN        = '1',  /*min*/
-    KR_DDI_METHOD_MAX        = '2',  /*max*/
-    KR_DDI_METHOD_COUNT      = '3',  /*count*/
-    KR_DDI_METHOD_CON_INC    = '4',  /*continuous increase*/
-    KR_DDI_METHOD_CON_DEC    = '5',  /*continuous decrease*/
-    KR_DDI_METHOD_CNT_DIS    = '6'   /*count distinct*/
-}E_KRDDIMethod;
+/*CNT_DIS keeps exact values up to this, estimates above*/
+#define KR_DDI_DISTINCT_EXACT_MAX  128
 
+/*keys counted by TOP_* methods if statistics_count not set*/
+#define KR_DDI_TOPK_CAPACITY  16
 
-int kr_ddi_aggr_func(T_KRDDI *ptDDI, T_KRData *ptData)
+/*QUANTILE's t-digest compression, bigger is more accurate and slower,
+ *and takes more memory per key's pane*/
+#define KR_DDI_QUANTILE_COMPRESSION  100
+static double gdQuantileCompression = KR_DDI_QUANTILE_COMPRESSION;
+
+/*whether SUM, MIN, MAX and COUNT read fields mirrored in index slots*/
+static kr_bool gbColumnar = FALSE;
+
+void kr_ddi_set_quantile_compression(double dCompression)
 {
-    int iResult = -1;
-    int iAbsLoc = -1;
-    int iRelLoc = -1;
-    
-    T_KRListNode *node = ptDDI->ptRecList->tail;
-    while(node)
+    if (dCompression > 0) {
+        gdQuantileCompression = dCompression;
+    }
+}
+
+void kr_ddi_set_columnar(kr_bool bColumnar)
+{
+    gbColumnar = bColumnar;
+}
+
+/* a filter kept in record headers lets the columns be 
+ * aggregated without evaluating it on rows
+ */
+int kr_ddi_is_columnar(T_KRDDI *ptDDI)
+{
+    T_KRParamDDIDef *ptParamDDIDef = ptDDI->ptParamDDIDef;
+    if (!gbColumnar || ptDDI->iFilterBit < 0 || 
+        ptParamDDIDef->caDdiAggrFunc[0] != '\0' ||
+        ptParamDDIDef->caStatisticsType[0] == KR_DDI_STATISTICS_DECAY) {
+        return FALSE;
+    }
+    switch(ptParamDDIDef->caStatisticsMethod[0])
     {
-        ptData->ptRecord = (T_KRRecord *)kr_list_value(node);
-        
-        iAbsLoc++; 
-        
-        if ((ptDDI->ptParamDDIDef->caStatisticsType[0] == \
-                               KR_DDI_STATISTICS_EXCLUDE) && 
-            (ptData->ptRecord == ptData->ptCurrRec)) {
-            node = node->prev;
-            continue;
+        case KR_DDI_METHOD_SUM:
+        case KR_DDI_METHOD_MIN:
+        case KR_DDI_METHOD_MAX:
+        case KR_DDI_METHOD_COUNT:
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+
+/* steps of a SEQUENCE matched by ptData->ptRecord */
+static unsigned int kr_ddi_sequence_mask(T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    unsigned int uiMask = 0;
+
+    for (int i=0; i<ptDDI->iStepCnt; i++) {
+        T_KRCalc *ptStepCalc = ptDDI->pptStepCalc[i];
+        if (kr_calc_eval(ptStepCalc, ptData) != 0) {
+            KR_LOG(KR_LOGERROR, "kr_calc_eval [%ld] step [%d] failed!", \
+                   ptDDI->lDDIId, i);
+        } else if (kr_calc_type(ptStepCalc) != KR_TYPE_BOOL) {
+            KR_LOG(KR_LOGERROR, "result_type of step calc must be boolean!");
+        } else if (kr_calc_ind(ptStepCalc) == KR_VALUE_SETED &&
+                   kr_calc_value(ptStepCalc)->b) {
+            uiMask |= (1U << i);
         }
-        
-        if (((T_KRTable *)ptData->ptRecord->ptTable)->iTableId != \
-            ptDDI->ptParamDDIDef->lStatisticsDatasrc) {
-            node = node->prev;
-            continue;
+    }
+    return uiMask;
+}
+
+
+/* retract the key's partial matches, and feed its records kept
+ * within window of the latest again, in event time order
+ */
+static void kr_ddi_sequence_replay(T_KRDDI *ptDDI, T_KRData *ptData, 
+        T_KRIndexTable *ptIndexTable, void *key)
+{
+    T_KRRecord *ptSavedRec = ptData->ptRecord;
+    /*records referred to while the writer waits, 
+     *the NFA is changed under the slot held again*/
+    T_KRIndexSolt *ptIndexSlot = kr_index_slot_hold(ptIndexTable->ptIndex, key);
+    if (ptIndexSlot == NULL) return;
+
+    int iRecCnt = 0;
+    time_t tLatest = 0;
+    /*scratch of this event, gone when the arena is reset after it*/
+    T_KRRecordRef *ptRef = kr_arena_alloc(ptData->ptArena, \
+            sizeof(T_KRRecordRef)*kr_list_length(ptIndexSlot->pRecList));
+    if (ptRef == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_arena_alloc ptRef failed!");
+        kr_index_slot_release(ptIndexSlot);
+        return;
+    }
+    T_KRListNode *node = ptIndexSlot->pRecList->head;
+    for (; node; node=node->next) {
+        T_KRRecord *ptRecord = (T_KRRecord *)kr_list_value(node);
+        if (ptRecord->ptTable != ptIndexTable->ptTable) continue;
+        T_KRRecordRef stRef;
+        if (kr_record_ref_set(&stRef, ptRecord) != 0) continue;
+        time_t tTransTime = kr_get_transtime(ptRecord);
+        if (tTransTime > tLatest) tLatest = tTransTime;
+        /*insertion sort keeps records of the same time in arrival order,
+         *lists are mostly sorted already*/
+        int j = iRecCnt++;
+        for (; j > 0 && kr_get_transtime(ptRef[j-1].ptRecord) > tTransTime; j--) {
+            ptRef[j] = ptRef[j-1];
         }
-        
-        time_t tCurrTransTime = kr_get_transtime(ptData->ptCurrRec);
-        time_t tRecTransTime = kr_get_transtime(ptData->ptRecord);
+        ptRef[j] = stRef;
+    }
+    kr_index_slot_release(ptIndexSlot);
+
+    /*each read again now, the ring may have rewritten it*/
+    char *pCopy = NULL;
+    size_t ulCopySize = 0;
+    kr_index_sequence_reset(ptIndexTable, ptDDI->iSequenceId, key);
+    for (int i=0; i<iRecCnt; i++) {
+        T_KRRecord *ptRecord = kr_record_ref_read(&ptRef[i], \
+                ptIndexTable->ptIndex, key, &pCopy, &ulCopySize);
+        if (ptRecord == NULL) continue;
+        time_t tTransTime = kr_get_transtime(ptRecord);
+        if (tLatest - tTransTime > ptDDI->stPattern.window) continue;
+        ptData->ptRecord = ptRecord;
+        unsigned int uiMask = kr_ddi_sequence_mask(ptDDI, ptData);
+        if (uiMask == 0) continue;
+        kr_index_sequence_advance(ptIndexTable, ptDDI->iSequenceId, \
+                key, uiMask, tTransTime);
+    }
+    kr_free(pCopy);
+    ptData->ptRecord = ptSavedRec;
+}
+
+
+/* match ptData->ptRecord against every step of a SEQUENCE, 
+ * and advance its key's partial matches kept in the index slot,
+ * each record is inserted by one context, so it's fed once,
+ * a late one of a retracting table replays the key's records
+ */
+static void kr_ddi_sequence_filter(T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    T_KRParamDDIDef *ptParamDDIDef = ptDDI->ptParamDDIDef;
+    T_KRRecord *ptRecord = ptData->ptRecord;
+    T_KRTable *ptTable = (T_KRTable *)ptRecord->ptTable;
+
+    if (ptTable->iTableId != ptParamDDIDef->lStatisticsDatasrc) return;
+
+    int iRetract = (ptTable->eLatePolicy == KR_LATEPOLICY_RETRACT &&
+                    kr_record_is_late(ptRecord));
+    unsigned int uiMask = kr_ddi_sequence_mask(ptDDI, ptData);
+    if (uiMask == 0 && !iRetract) return;
+
+    T_KRIndexTable *ptIndexTable = kr_index_table_get(ptTable->ptDB, \
+            ptParamDDIDef->lStatisticsIndex, ptTable->iTableId);
+    if (ptIndexTable == NULL) {
+        KR_LOG(KR_LOGERROR, "index[%ld] table[%d] not found!", \
+               ptParamDDIDef->lStatisticsIndex, ptTable->iTableId);
+        return;
+    }
+    if (ptDDI->iSequenceId < 0) {
+        ptDDI->iSequenceId = kr_index_sequence_register(ptIndexTable, \
+                ptDDI->lDDIId, &ptDDI->stPattern);
+        if (ptDDI->iSequenceId < 0) {
+            KR_LOG(KR_LOGERROR, "DDI[%ld] register sequence failed!", \
+                   ptDDI->lDDIId);
+            return;
+        }
+    }
+    void *key = kr_field_get_value(ptRecord, ptIndexTable->iIndexFieldId);
+    if (iRetract) {
+        kr_ddi_sequence_replay(ptDDI, ptData, ptIndexTable, key);
+        return;
+    }
+    kr_index_sequence_advance(ptIndexTable, ptDDI->iSequenceId, \
+            key, uiMask, kr_get_transtime(ptRecord));
+}
+
+
+static void _kr_ddi_filter_record(void *key, T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    T_KRRecord *ptRecord = ptData->ptRecord;
+    int iPassed = 0;
+
+    if (ptDDI->iStepCnt > 0) {
+        kr_ddi_sequence_filter(ptDDI, ptData);
+        return;
+    }
+    if (ptDDI->iFilterBit < 0) return;
+    if (((T_KRTable *)ptRecord->ptTable)->iTableId != \
+        ptDDI->ptParamDDIDef->lStatisticsDatasrc) {
+        return;
+    }
+
+    if (kr_calc_eval(ptDDI->ptDDICalc, ptData) != 0) {
+        KR_LOG(KR_LOGERROR, "kr_calc_eval [%ld] failed!", ptDDI->lDDIId);
+    } else if (kr_calc_type(ptDDI->ptDDICalc) != KR_TYPE_BOOL) {
+        KR_LOG(KR_LOGERROR, "result_type of ddi_calc must be boolean!");
+    } else if (kr_calc_ind(ptDDI->ptDDICalc) == KR_VALUE_SETED) {
+        iPassed = kr_calc_value(ptDDI->ptDDICalc)->b;
+    }
+    kr_record_filter_set(ptRecord, KR_FILTERSET_DDI, ptDDI->iFilterBit, iPassed);
+}
+
+/* set filter bits of ptData->ptRecord, stamped with construct time */
+void kr_ddi_table_filter(T_KRDDITable *ptDdiTable, T_KRData *ptData)
+{
+    if (ptDdiTable->tConstructTime == 0) return;
+
+    kr_hashtable_foreach(ptDdiTable->ptDDITable, 
+            (KRHFunc )_kr_ddi_filter_record, ptData);
+    kr_record_filter_stamp(ptData->ptRecord, KR_FILTERSET_DDI, 
+            (long )ptDdiTable->tConstructTime);
+}
+
+
+static int kr_ddi_value_compare(E_KRType type, U_KRValue *v1, U_KRValue *v2)
+{
+    switch(type)
+    {
+        case KR_TYPE_INT:
+            return (v1->i > v2->i) - (v1->i < v2->i);
+        case KR_TYPE_LONG:
+            return (v1->l > v2->l) - (v1->l < v2->l);
+        case KR_TYPE_DOUBLE:
+            return (v1->d > v2->d) - (v1->d < v2->d);
+        case KR_TYPE_STRING:
+            return strcmp(v1->s, v2->s);
+        default:
+            return 0;
+    }
+}
+
+static int kr_ddi_set_count(T_KRDDI *ptDDI, long lCount)
+{
+    switch(ptDDI->eValueType)
+    {
+        case KR_TYPE_INT:
+            ptDDI->uValue.i = (int )lCount;
+            break;
+        case KR_TYPE_LONG:
+            ptDDI->uValue.l = lCount;
+            break;
+        case KR_TYPE_DOUBLE:
+            ptDDI->uValue.d = (double )lCount;
+            break;
+        default:
+            KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", ptDDI->eValueType);
+            return -1;
+    }
+    return 0;
+}
+
+
+static int kr_ddi_set_double(T_KRDDI *ptDDI, double dValue)
+{
+    switch(ptDDI->eValueType)
+    {
+        case KR_TYPE_INT:
+            ptDDI->uValue.i = (int )dValue;
+            break;
+        case KR_TYPE_LONG:
+            ptDDI->uValue.l = (long )dValue;
+            break;
+        case KR_TYPE_DOUBLE:
+            ptDDI->uValue.d = dValue;
+            break;
+        default:
+            KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", ptDDI->eValueType);
+            return -1;
+    }
+    return 0;
+}
+
+
+/* aggregate ptData->ptRecord into ptDDI, skip it if out of window or filtered,
+ * return 1 once the record is older than the window plus the table's slack,
+ * no record inserted before it can fall into the window then
+ */
+static int kr_ddi_aggr_record(T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    int iResult = -1;
+    int iPassed = 0;
+    
+    if ((ptDDI->ptParamDDIDef->caStatisticsType[0] == \
+                           KR_DDI_STATISTICS_EXCLUDE) && 
+        kr_record_is(ptData->ptRecord, ptData->ptCurrRec)) {
+        return 0;
+    }
+    
+    if (((T_KRTable *)ptData->ptRecord->ptTable)->iTableId != \
+        ptDDI->ptParamDDIDef->lStatisticsDatasrc) {
+        return 0;
+    }
+    
+    time_t tCurrTransTime = kr_get_transtime(ptData->ptCurrRec);
+    time_t tRecTransTime = kr_get_transtime(ptData->ptRecord);
+    /*the window ends at the current record's event time, records 
+     *inserted before a late current record may be after it*/
+    if (tRecTransTime > tCurrTransTime) {
+        return 0;
+    }
+    if ((tCurrTransTime - tRecTransTime) > 
+            ptDDI->ptParamDDIDef->lStatisticsValue ) {
+        T_KRTable *ptTable = (T_KRTable *)ptData->ptRecord->ptTable;
         if ((tCurrTransTime - tRecTransTime) > 
-                ptDDI->ptParamDDIDef->lStatisticsValue ) {
-            node = node->prev;
-            continue;
+                ptDDI->ptParamDDIDef->lStatisticsValue + \
+                ptTable->lTransTimeSlack) {
+            return 1;
         }
-        
+        return 0;
+    }
+    
+    /*test the bit set while inserting, evaluate if not there*/
+    iPassed = kr_record_filter_test(ptData->ptRecord, KR_FILTERSET_DDI, 
+            (long )ptData->ptDdiTable->tConstructTime, ptDDI->iFilterBit);
+    if (iPassed < 0 && ptDDI->ptDDICalc == NULL) {
+        /*run DDIs scanned have no filter*/
+        iPassed = 1;
+    } else if (iPassed < 0) {
         iResult = kr_calc_eval(ptDDI->ptDDICalc, ptData);
         if (iResult != 0) {
             KR_LOG(KR_LOGERROR, "kr_calc_eval[%ld] failed!", ptDDI->lDDIId);
@@ -57,145 +324,220 @@ int kr_ddi_aggr_func(T_KRDDI *ptDDI, T_KRData *ptData)
         } else if (kr_calc_type(ptDDI->ptDDICalc) != KR_TYPE_BOOL) {
             KR_LOG(KR_LOGERROR, "result_type of ddi_calc must be boolean!");
             return -1;
-        } else if (kr_calc_ind(ptDDI->ptDDICalc) != KR_VALUE_SETED ||
-                   !kr_calc_value(ptDDI->ptDDICalc)->b) {
-            node = node->prev;
-            continue;
         }
+        iPassed = (kr_calc_ind(ptDDI->ptDDICalc) == KR_VALUE_SETED &&
+                   kr_calc_value(ptDDI->ptDDICalc)->b);
+    }
+    if (!iPassed) {
+        return 0;
+    }
+
+    E_KRType type = kr_field_get_type(ptData->ptRecord, ptDDI->ptParamDDIDef->lStatisticsField);
+    void *val = kr_field_get_value(ptData->ptRecord, ptDDI->ptParamDDIDef->lStatisticsField);
+    U_KRValue stValue = {0};
+    switch(type)
+    {
+        case KR_TYPE_INT:
+            stValue.i = *(int *)val;
+            break;
+        case KR_TYPE_LONG:
+            stValue.l = *(long *)val;
+            break;
+        case KR_TYPE_DOUBLE:
+            stValue.d = *(double *)val;
+            break;
+        case KR_TYPE_STRING:
+            stValue.s = (char *)val;
+            break;
+        default:
+            KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", type);
+            return -1;
+    }
     
-        iRelLoc++; 
-                        
-        E_KRType type = kr_field_get_type(ptData->ptRecord, ptDDI->ptParamDDIDef->lStatisticsField);
-        void *val = kr_field_get_value(ptData->ptRecord, ptDDI->ptParamDDIDef->lStatisticsField);
-        U_KRValue stValue = {0};
-        switch(type)
-        {
-            case KR_TYPE_INT:
-                stValue.i = *(int *)val;
-                break;
-            case KR_TYPE_LONG:
-                stValue.l = *(long *)val;
-                break;
-            case KR_TYPE_DOUBLE:
-                stValue.d = *(double *)val;
-                break;
-            case KR_TYPE_STRING:
-                stValue.s = (char *)val;
-                break;
-            default:
-                KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", type);
-                return -1;
-        }
-        
-        switch(ptDDI->ptParamDDIDef->caStatisticsMethod[0])
-        {
-            case KR_DDI_METHOD_SUM:
-                switch(ptDDI->eValueType)
-                {
-                    case KR_TYPE_INT:
-                        ptDDI->uValue.i = ptDDI->uValue.i + stValue.i;
-                        break;
-                    case KR_TYPE_LONG:
-                        ptDDI->uValue.l = ptDDI->uValue.l + stValue.l;
-                        break;
-                    case KR_TYPE_DOUBLE:
-                        ptDDI->uValue.d = ptDDI->uValue.d + stValue.d;
-                        break;
-                    default:
-                        KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", 
-                                ptDDI->eValueType);
-                        return -1;
-                }
-                break;
-            case KR_DDI_METHOD_MIN:
-                switch(ptDDI->eValueType)
-                {
-                    case KR_TYPE_INT:
-                        ptDDI->uValue.i = MIN(ptDDI->uValue.i, stValue.i);
-                        break;
-                    case KR_TYPE_LONG:
-                        ptDDI->uValue.l = MIN(ptDDI->uValue.l, stValue.l);
-                        break;
-                    case KR_TYPE_DOUBLE:
-                        ptDDI->uValue.d = MIN(ptDDI->uValue.d, stValue.d);
-                        break;
-                    default:
-                        KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", 
-                                ptDDI->eValueType);
-                        return -1;
-                }
-                break;
-            case KR_DDI_METHOD_MAX:
-                switch(ptDDI->eValueType)
-                {
-                    case KR_TYPE_INT:
-                        ptDDI->uValue.i = MAX(ptDDI->uValue.i, stValue.i);
-                        break;
-                    case KR_TYPE_LONG:
-                        ptDDI->uValue.l = MAX(ptDDI->uValue.l, stValue.l);
-                        break;
-                    case KR_TYPE_DOUBLE:
-                        ptDDI->uValue.d = MAX(ptDDI->uValue.d, stValue.d);
-                        break;
-                    default:
-                        KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", 
-                                ptDDI->eValueType);
-                        return -1;
+    char cMethod = ptDDI->ptParamDDIDef->caStatisticsMethod[0];
+    switch(cMethod)
+    {
+        case KR_DDI_METHOD_SUM:
+            switch(ptDDI->eValueType)
+            {
+                case KR_TYPE_INT:
+                    ptDDI->uValue.i = ptDDI->uValue.i + stValue.i;
+                    break;
+                case KR_TYPE_LONG:
+                    ptDDI->uValue.l = ptDDI->uValue.l + stValue.l;
+                    break;
+                case KR_TYPE_DOUBLE:
+                    ptDDI->uValue.d = ptDDI->uValue.d + stValue.d;
+                    break;
+                default:
+                    KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", 
+                            ptDDI->eValueType);
+                    return -1;
+            }
+            break;
+        case KR_DDI_METHOD_MIN:
+            switch(ptDDI->eValueType)
+            {
+                case KR_TYPE_INT:
+                    ptDDI->uValue.i = MIN(ptDDI->uValue.i, stValue.i);
+                    break;
+                case KR_TYPE_LONG:
+                    ptDDI->uValue.l = MIN(ptDDI->uValue.l, stValue.l);
+                    break;
+                case KR_TYPE_DOUBLE:
+                    ptDDI->uValue.d = MIN(ptDDI->uValue.d, stValue.d);
+                    break;
+                default:
+                    KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", 
+                            ptDDI->eValueType);
+                    return -1;
+            }
+            break;
+        case KR_DDI_METHOD_MAX:
+            switch(ptDDI->eValueType)
+            {
+                case KR_TYPE_INT:
+                    ptDDI->uValue.i = MAX(ptDDI->uValue.i, stValue.i);
+                    break;
+                case KR_TYPE_LONG:
+                    ptDDI->uValue.l = MAX(ptDDI->uValue.l, stValue.l);
+                    break;
+                case KR_TYPE_DOUBLE:
+                    ptDDI->uValue.d = MAX(ptDDI->uValue.d, stValue.d);
+                    break;
+                default:
+                    KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", 
+                            ptDDI->eValueType);
+                    return -1;
+            }
+            break;
+        case KR_DDI_METHOD_COUNT:
+            switch(ptDDI->eValueType)
+            {
+                case KR_TYPE_INT:
+                    ptDDI->uValue.i = ptDDI->uValue.i + 1;
+                    break;
+                case KR_TYPE_LONG:
+                    ptDDI->uValue.l = ptDDI->uValue.l + 1;
+                    break;
+                case KR_TYPE_DOUBLE:
+                    ptDDI->uValue.d = ptDDI->uValue.d + 1;
+                    break;
+                default:
+                    KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", 
+                            ptDDI->eValueType);
+                    return -1;
+            }
+            break;
+        case KR_DDI_METHOD_CON_INC:
+        case KR_DDI_METHOD_CON_DEC:
+            /*scanning backward from the latest, the run ends at the first 
+             *record breaking the trend, so the scan stops there*/
+            if (ptDDI->lAggrCnt > 0) {
+                int iCmp = kr_ddi_value_compare(type, &stValue, 
+                        &ptDDI->uAggrLast);
+                if ((cMethod == KR_DDI_METHOD_CON_INC && iCmp >= 0) ||
+                    (cMethod == KR_DDI_METHOD_CON_DEC && iCmp <= 0)) {
+                    return 1;
                 }
-                break;
-            case KR_DDI_METHOD_COUNT:
-                switch(ptDDI->eValueType)
-                {
-                    case KR_TYPE_INT:
-                        ptDDI->uValue.i = ptDDI->uValue.i + 1;
-                        break;
-                    case KR_TYPE_LONG:
-                        ptDDI->uValue.l = ptDDI->uValue.l + 1;
-                        break;
-                    case KR_TYPE_DOUBLE:
-                        ptDDI->uValue.d = ptDDI->uValue.d + 1;
-                        break;
-                    default:
-                        KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", 
-                                ptDDI->eValueType);
-                        return -1;
+            }
+            ptDDI->uAggrLast = stValue;
+            if (kr_ddi_set_count(ptDDI, ptDDI->lAggrCnt + 1) != 0) {
+                return -1;
+            }
+            break;
+        case KR_DDI_METHOD_CNT_DIS:
+            /*exact while small, estimated by kr_ddi_aggr_finish*/
+            if (ptDDI->ptDistinct == NULL) {
+                ptDDI->ptDistinct = kr_distinct_new(KR_DDI_DISTINCT_EXACT_MAX);
+                if (ptDDI->ptDistinct == NULL) {
+                    KR_LOG(KR_LOGERROR, "kr_distinct_new failed!");
+                    return -1;
                 }
-                break;
-            case KR_DDI_METHOD_CON_INC:
-                //TODO
-                break;
-            case KR_DDI_METHOD_CON_DEC:
-                //TODO
-                break;
-            case KR_DDI_METHOD_CNT_DIS:
-                //TODO
-                break;
-            default:
-                KR_LOG(KR_LOGERROR, "Bad Method [%c]!", \
-                       ptDDI->ptParamDDIDef->caStatisticsMethod[0]);
-                return -1;    
+            }
+            int iRet;
+            switch(type)
+            {
+                case KR_TYPE_INT:
+                    iRet = kr_distinct_add(ptDDI->ptDistinct, &stValue.i, sizeof(int));
+                    break;
+                case KR_TYPE_LONG:
+                    iRet = kr_distinct_add(ptDDI->ptDistinct, &stValue.l, sizeof(long));
+                    break;
+                case KR_TYPE_DOUBLE:
+                    iRet = kr_distinct_add(ptDDI->ptDistinct, &stValue.d, sizeof(double));
+                    break;
+                default:
+                    iRet = kr_distinct_add(ptDDI->ptDistinct, stValue.s, strlen(stValue.s));
+                    break;
+            }
+            if (iRet != 0) {
+                KR_LOG(KR_LOGERROR, "kr_distinct_add upgrade failed!");
+                return -1;
+            }
+            break;
+        default:
+            KR_LOG(KR_LOGERROR, "Bad Method [%c]!", \
+                   ptDDI->ptParamDDIDef->caStatisticsMethod[0]);
+            return -1;    
+    }
+    
+    /*add this record to related*/
+    if (ptDDI->ptRelated->bCaptured) {
+        kr_related_add(ptDDI->ptRelated, ptData->ptRecord);
+    }
+    ptDDI->lAggrCnt++;
+
+    return 0;
+}
+
+
+/* set values computed from the whole scan */
+static int kr_ddi_aggr_finish(T_KRDDI *ptDDI)
+{
+    char cMethod = ptDDI->ptParamDDIDef->caStatisticsMethod[0];
+    if (cMethod == KR_DDI_METHOD_CNT_DIS) {
+        long lCount = 0;
+        if (ptDDI->ptDistinct != NULL) {
+            lCount = (long )kr_distinct_count(ptDDI->ptDistinct);
+        }
+        if (kr_ddi_set_count(ptDDI, lCount) != 0) {
+            return -1;
+        }
+    }
+    
+    ptDDI->eValueInd = KR_VALUE_SETED;
+    return 0;
+}
+
+
+int kr_ddi_aggr_func(T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    int iResult = -1;
+    
+    while((ptData->ptRecord = kr_db_cursor_next(&ptDDI->stCursor)) != NULL)
+    {
+        iResult = kr_ddi_aggr_record(ptDDI, ptData);
+        if (iResult < 0) {
+            return -1;
+        } else if (iResult > 0) {
+            break;
         }
-        
-        /*add this record to related*/
-        kr_hashtable_insert(ptDDI->ptRelated, \
-                ptData->ptRecord, ptData->ptRecord);
-        
-        node = node->prev;
     }
 
     /* This is what the difference between DDI and DDI:
      * DDI only set once, while DDI still need to traversal all the list
      */
-    ptDDI->eValueInd = KR_VALUE_SETED;
-
-    return 0;
+    return kr_ddi_aggr_finish(ptDDI);
 }
 
 
-int kr_ddi_compute(T_KRDDI *ptDDI, T_KRData *ptData)
+/* initialize ptDDI and its cursor over the current key's records */
+static int kr_ddi_prepare(T_KRDDI *ptDDI, T_KRData *ptData)
 {
     /*initialize first*/
     kr_ddi_init(ptDDI);
+    ptDDI->ptRelated->bCaptured = ptData->bRelatedCapture;
     
     int iIndexId = ptDDI->ptParamDDIDef->lStatisticsIndex;
     
@@ -214,15 +556,670 @@ int kr_ddi_compute(T_KRDDI *ptDDI, T_KRData *ptData)
         kr_field_get_type(ptCurrRec, ptIndexTable->iIndexFieldId);
     ptDDI->pKeyValue = \
         kr_field_get_value(ptCurrRec, ptIndexTable->iIndexFieldId);
-    //FIXME:
-    /*
-    ptDDI->ptRecList = \
-        kr_db_select(ptDB, iIndexId, ptData->pKeyValue);
-        */
+    kr_db_cursor_init(&ptDDI->stCursor, ptIndexTable->ptIndex, 
+            ptDDI->pKeyValue, KR_CURSOR_REVERSE);
+
+    return 0;
+}
+
+
+/* walk the key's records once, aggregating every DDI of ptFused,
+ * the others' values stay cached until the current record changes
+ */
+static int kr_ddi_fused_compute(T_KRDDIFused *ptFused, T_KRData *ptData)
+{
+    T_KRListNode *member = NULL;
+    T_KRDDI *ptDDI = NULL;
+    T_KRDBCursor *ptCursor = NULL;
+    int iResult = -1;
+    int iScanning = 0;
+    
+    for (member=ptFused->ptDDIList->head; member; member=member->next) {
+        ptDDI = (T_KRDDI *)kr_list_value(member);
+        if (kr_ddi_prepare(ptDDI, ptData) != 0) {
+            return -1;
+        }
+        ptDDI->bScanStopped = FALSE;
+        ptCursor = &ptDDI->stCursor;
+        iScanning++;
+    }
+
+    /*stop walking once every DDI passed its window*/
+    while(iScanning > 0 && 
+            (ptData->ptRecord = kr_db_cursor_next(ptCursor)) != NULL)
+    {
+        for (member=ptFused->ptDDIList->head; member; member=member->next) {
+            ptDDI = (T_KRDDI *)kr_list_value(member);
+            if (ptDDI->bScanStopped) continue;
+            iResult = kr_ddi_aggr_record(ptDDI, ptData);
+            if (iResult < 0) {
+                KR_LOG(KR_LOGERROR, "Fused DDI[%ld] aggregate failed!", 
+                        ptDDI->lDDIId);
+                kr_db_cursor_close(ptCursor);
+                return -1;
+            } else if (iResult > 0) {
+                ptDDI->bScanStopped = TRUE;
+                iScanning--;
+            }
+        }
+    }
+    kr_db_cursor_close(ptCursor);
+    
+    for (member=ptFused->ptDDIList->head; member; member=member->next) {
+        ptDDI = (T_KRDDI *)kr_list_value(member);
+        if (kr_ddi_aggr_finish(ptDDI) != 0) {
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+
+/* locate the current key in its index, and the index table of 
+ * datasrc where the key statistics of ptDDI are registered
+ */
+static T_KRIndexTable *kr_ddi_locate_key(T_KRDDI *ptDDI, T_KRData *ptData,
+        T_KRIndexTable **pptStatIndexTable)
+{
+    T_KRParamDDIDef *ptParamDDIDef = ptDDI->ptParamDDIDef;
+    int iIndexId = ptParamDDIDef->lStatisticsIndex;
+    
+    T_KRRecord *ptCurrRec = ptData->ptCurrRec;
+    T_KRTable *ptTable = ptCurrRec->ptTable;
+    T_KRDB *ptDB = ptTable->ptDB;
+    T_KRIndexTable *ptIndexTable = \
+        kr_index_table_get(ptDB, iIndexId, ptTable->iTableId);
+    if (ptIndexTable == NULL) {
+        KR_LOG(KR_LOGERROR, "index[%d] table[%d] not found!", \
+               iIndexId, ptTable->iTableId);
+        return NULL;
+    }
+    *pptStatIndexTable = kr_index_table_get(ptDB, \
+            iIndexId, ptParamDDIDef->lStatisticsDatasrc);
+    if (*pptStatIndexTable == NULL) {
+        KR_LOG(KR_LOGERROR, "index[%d] table[%ld] not found!", \
+               iIndexId, ptParamDDIDef->lStatisticsDatasrc);
+        return NULL;
+    }
+    
+    ptDDI->ptCurrRec = ptCurrRec;
+    ptDDI->eKeyType  = \
+        kr_field_get_type(ptCurrRec, ptIndexTable->iIndexFieldId);
+    ptDDI->pKeyValue = \
+        kr_field_get_value(ptCurrRec, ptIndexTable->iIndexFieldId);
+    
+    return ptIndexTable;
+}
+
+
+/* register the decayed counter, heavy hitters sketch, value digest
+ * or run a DDI reads in index slots of its datasrc, 
+ * registered again shares it,
+ * return its location in slots, -1 if failed
+ */
+static int kr_ddi_key_register(T_KRParamDDIDef *ptParamDDIDef, 
+        T_KRIndexTable *ptStatIndexTable)
+{
+    if (kr_ddi_is_run(ptParamDDIDef)) {
+        return kr_index_run_register(ptStatIndexTable, \
+                ptParamDDIDef->lStatisticsField, \
+                ptParamDDIDef->caStatisticsMethod[0] == KR_DDI_METHOD_CON_DEC);
+    }
+    if (kr_ddi_is_quantile(ptParamDDIDef)) {
+        return kr_index_quantile_register(ptStatIndexTable, \
+                ptParamDDIDef->lStatisticsField, \
+                ptParamDDIDef->lStatisticsValue, gdQuantileCompression);
+    }
+    if (ptParamDDIDef->caStatisticsType[0] != KR_DDI_STATISTICS_DECAY) {
+        unsigned int uiCapacity = KR_DDI_TOPK_CAPACITY;
+        if (ptParamDDIDef->lStatisticsCount > 0) {
+            uiCapacity = (unsigned int )ptParamDDIDef->lStatisticsCount;
+        }
+        return kr_index_topk_register(ptStatIndexTable, \
+                ptParamDDIDef->lStatisticsField, uiCapacity);
+    }
+
+    int iFieldId = -1;
+    switch(ptParamDDIDef->caStatisticsMethod[0])
+    {
+        case KR_DDI_METHOD_SUM:
+            iFieldId = ptParamDDIDef->lStatisticsField;
+            break;
+        case KR_DDI_METHOD_COUNT:
+            iFieldId = -1;
+            break;
+        default:
+            KR_LOG(KR_LOGERROR, "Bad Method [%c] for decayed DDI!", \
+                   ptParamDDIDef->caStatisticsMethod[0]);
+            return -1;
+    }
+    return kr_index_decay_register(ptStatIndexTable, \
+            iFieldId, ptParamDDIDef->lStatisticsValue);
+}
+
+
+/* register key statistics of decayed, heavy hitters, QUANTILE and
+ * run DDIs before ptDB inserts or restores records, so they count 
+ * every record of their datasrc, those not registered here are on 
+ * first compute
+ */
+int kr_ddi_table_register(T_KRParamDDI *ptParamDDI, T_KRDB *ptDB)
+{
+    for (int i=0; i<ptParamDDI->lDDIDefCnt; ++i) {
+        T_KRParamDDIDef *ptParamDDIDef = &ptParamDDI->stParamDDIDef[i];
+        if (!kr_ddi_takes_all(ptParamDDIDef) && 
+            !kr_ddi_is_run(ptParamDDIDef)) {
+            continue;
+        }
+        const char *psRefused = kr_ddi_refused(ptParamDDIDef);
+        if (psRefused != NULL) {
+            KR_LOG(KR_LOGERROR, "DDI[%ld] %s!", \
+                   ptParamDDIDef->lDdiId, psRefused);
+            return -1;
+        }
+        T_KRIndexTable *ptStatIndexTable = kr_index_table_get(ptDB, \
+                ptParamDDIDef->lStatisticsIndex, \
+                ptParamDDIDef->lStatisticsDatasrc);
+        if (ptStatIndexTable == NULL) {
+            KR_LOG(KR_LOGERROR, "index[%ld] table[%ld] not found!", \
+                   ptParamDDIDef->lStatisticsIndex, \
+                   ptParamDDIDef->lStatisticsDatasrc);
+            return -1;
+        }
+        if (kr_ddi_key_register(ptParamDDIDef, ptStatIndexTable) < 0) {
+            KR_LOG(KR_LOGERROR, "DDI[%ld] register key statistics failed!", \
+                   ptParamDDIDef->lDdiId);
+            return -1;
+        }
+    }
+    
+    return 0;
+}
+
+
+/* read the key's decayed counter kept in its index slot, O(1),
+ * the counter sees every record of the datasrc inserted since
+ * registered, by kr_ddi_table_register or else on first compute
+ */
+static int kr_ddi_decay_compute(T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    T_KRParamDDIDef *ptParamDDIDef = ptDDI->ptParamDDIDef;
+    T_KRIndexTable *ptStatIndexTable = NULL;
+    
+    kr_ddi_init(ptDDI);
+    
+    T_KRIndexTable *ptIndexTable = \
+        kr_ddi_locate_key(ptDDI, ptData, &ptStatIndexTable);
+    if (ptIndexTable == NULL) {
+        return -1;
+    }
+    
+    if (ptDDI->iDecayId < 0) {
+        ptDDI->iDecayId = kr_ddi_key_register(ptParamDDIDef, ptStatIndexTable);
+        if (ptDDI->iDecayId < 0) {
+            KR_LOG(KR_LOGERROR, "DDI[%ld] register decay failed!", \
+                   ptDDI->lDDIId);
+            return -1;
+        }
+    }
+    
+    double dValue = kr_index_decay_value(ptIndexTable->ptIndex, \
+            ptDDI->iDecayId, ptParamDDIDef->lStatisticsValue, \
+            ptDDI->pKeyValue, kr_get_transtime(ptData->ptCurrRec));
+    if (kr_ddi_set_double(ptDDI, dValue) != 0) {
+        return -1;
+    }
+    
+    ptDDI->eValueInd = KR_VALUE_SETED;
+    return 0;
+}
+
+
+static int kr_ddi_set_key(T_KRDDI *ptDDI, T_KRTopKItem *ptItem, 
+        T_KRData *ptData)
+{
+    switch(ptDDI->eValueType)
+    {
+        case KR_TYPE_INT:
+            if (ptItem->len != sizeof(int)) break;
+            memcpy(&ptDDI->uValue.i, ptItem->key, sizeof(int));
+            return 0;
+        case KR_TYPE_LONG:
+            if (ptItem->len != sizeof(long)) break;
+            memcpy(&ptDDI->uValue.l, ptItem->key, sizeof(long));
+            return 0;
+        case KR_TYPE_DOUBLE:
+            if (ptItem->len != sizeof(double)) break;
+            memcpy(&ptDDI->uValue.d, ptItem->key, sizeof(double));
+            return 0;
+        case KR_TYPE_STRING:
+            ptDDI->uValue.s = kr_data_strndup(ptData, ptItem->key, ptItem->len);
+            return 0;
+        default:
+            break;
+    }
+    KR_LOG(KR_LOGERROR, "Bad FieldType [%c] for key length [%zu]!", \
+           ptDDI->eValueType, ptItem->len);
+    return -1;
+}
+
+
+/* read the key's heavy hitters sketch kept in its index slot,
+ * registered like decayed counters,
+ * counts cover every record of the datasrc since then
+ */
+static int kr_ddi_topk_compute(T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    T_KRParamDDIDef *ptParamDDIDef = ptDDI->ptParamDDIDef;
+    T_KRIndexTable *ptStatIndexTable = NULL;
+    
+    kr_ddi_init(ptDDI);
+    
+    T_KRIndexTable *ptIndexTable = \
+        kr_ddi_locate_key(ptDDI, ptData, &ptStatIndexTable);
+    if (ptIndexTable == NULL) {
+        return -1;
+    }
+    
+    if (ptDDI->iTopKId < 0) {
+        ptDDI->iTopKId = kr_ddi_key_register(ptParamDDIDef, ptStatIndexTable);
+        if (ptDDI->iTopKId < 0) {
+            KR_LOG(KR_LOGERROR, "DDI[%ld] register topk failed!", \
+                   ptDDI->lDDIId);
+            return -1;
+        }
+    }
+    
+    /*the writer waits while the sketch is read*/
+    T_KRIndexSolt *ptIndexSlot = NULL;
+    T_KRTopK *ptTopK = kr_index_topk_hold(ptIndexTable->ptIndex, \
+            ptDDI->iTopKId, ptDDI->pKeyValue, &ptIndexSlot);
+    T_KRTopKItem *ptTop = ptTopK ? kr_topk_top(ptTopK) : NULL;
+    T_KRRecord *ptCurrRec = ptData->ptCurrRec;
+    long lCount = 0;
+    int iResult = -1;
+    
+    switch(ptParamDDIDef->caStatisticsMethod[0])
+    {
+        case KR_DDI_METHOD_TOP_VALUE:
+            /*no value counted, leave it unset*/
+            if (ptTop == NULL) {
+                iResult = 0;
+                goto RELEASE;
+            }
+            if (kr_ddi_set_key(ptDDI, ptTop, ptData) != 0) {
+                goto RELEASE;
+            }
+            break;
+        case KR_DDI_METHOD_TOP_FREQ:
+            if (ptTop != NULL) lCount = (long )ptTop->count;
+            if (kr_ddi_set_count(ptDDI, lCount) != 0) {
+                goto RELEASE;
+            }
+            break;
+        case KR_DDI_METHOD_CUR_FREQ:
+            /*current value only exists in records of datasrc*/
+            if (((T_KRTable *)ptCurrRec->ptTable)->iTableId != \
+                ptParamDDIDef->lStatisticsDatasrc) {
+                iResult = 0;
+                goto RELEASE;
+            }
+            if (ptTopK != NULL) {
+                int iFieldId = ptParamDDIDef->lStatisticsField;
+                lCount = (long )kr_topk_count(ptTopK, 
+                        kr_field_get_value(ptCurrRec, iFieldId), 
+                        kr_field_get_size(ptCurrRec, iFieldId));
+            }
+            if (kr_ddi_set_count(ptDDI, lCount) != 0) {
+                goto RELEASE;
+            }
+            break;
+        default:
+            KR_LOG(KR_LOGERROR, "Bad Method [%c] for topk DDI!", \
+                   ptParamDDIDef->caStatisticsMethod[0]);
+            goto RELEASE;
+    }
+    
+    ptDDI->eValueInd = KR_VALUE_SETED;
+    iResult = 0;
+
+RELEASE:
+    if (ptIndexSlot != NULL) kr_index_slot_release(ptIndexSlot);
+    return iResult;
+}
+
+
+/* merge the key's value digests of the panes in the window, 
+ * O(panes * compression), whatever records the key has
+ */
+static int kr_ddi_quantile_compute(T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    T_KRParamDDIDef *ptParamDDIDef = ptDDI->ptParamDDIDef;
+    T_KRIndexTable *ptStatIndexTable = NULL;
+    
+    kr_ddi_init(ptDDI);
+    
+    T_KRIndexTable *ptIndexTable = \
+        kr_ddi_locate_key(ptDDI, ptData, &ptStatIndexTable);
+    if (ptIndexTable == NULL) {
+        return -1;
+    }
+    
+    if (ptDDI->iQuantileId < 0) {
+        ptDDI->iQuantileId = kr_ddi_key_register(ptParamDDIDef, ptStatIndexTable);
+        if (ptDDI->iQuantileId < 0) {
+            KR_LOG(KR_LOGERROR, "DDI[%ld] register quantile failed!", \
+                   ptDDI->lDDIId);
+            return -1;
+        }
+    }
+    if (ptDDI->ptTDigest == NULL) {
+        ptDDI->ptTDigest = kr_tdigest_new(gdQuantileCompression);
+        if (ptDDI->ptTDigest == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_tdigest_new failed!");
+            return -1;
+        }
+    }
+    
+    kr_index_quantile_merge(ptIndexTable->ptIndex, ptDDI->iQuantileId, \
+            ptParamDDIDef->lStatisticsValue, ptDDI->pKeyValue, \
+            kr_get_transtime(ptData->ptCurrRec), ptDDI->ptTDigest);
+    /*no value added in the window, leave it unset*/
+    if (kr_tdigest_total(ptDDI->ptTDigest) == 0) {
+        return 0;
+    }
+    double dQuantile = kr_tdigest_quantile(ptDDI->ptTDigest, 
+            ptParamDDIDef->lStatisticsCount / 1000.0);
+    if (kr_ddi_set_double(ptDDI, dQuantile) != 0) {
+        return -1;
+    }
+    
+    ptDDI->eValueInd = KR_VALUE_SETED;
+    return 0;
+}
+
+
+/* read the key's pattern NFA kept in its index slot, 
+ * O(steps), partial matches were advanced while inserting
+ */
+static int kr_ddi_sequence_compute(T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    T_KRIndexTable *ptStatIndexTable = NULL;
+    
+    kr_ddi_init(ptDDI);
+    
+    T_KRIndexTable *ptIndexTable = \
+        kr_ddi_locate_key(ptDDI, ptData, &ptStatIndexTable);
+    if (ptIndexTable == NULL) {
+        return -1;
+    }
+    
+    if (ptDDI->iSequenceId < 0) {
+        ptDDI->iSequenceId = kr_index_sequence_register(ptStatIndexTable, \
+                ptDDI->lDDIId, &ptDDI->stPattern);
+        if (ptDDI->iSequenceId < 0) {
+            KR_LOG(KR_LOGERROR, "DDI[%ld] register sequence failed!", \
+                   ptDDI->lDDIId);
+            return -1;
+        }
+    }
+    
+    int iProgress = kr_index_sequence_progress(ptStatIndexTable, \
+            ptDDI->iSequenceId, ptDDI->pKeyValue, \
+            kr_get_transtime(ptData->ptCurrRec));
+    if (kr_ddi_set_count(ptDDI, (long )iProgress) != 0) {
+        return -1;
+    }
+    
+    ptDDI->eValueInd = KR_VALUE_SETED;
+    return 0;
+}
+
+
+/*records aggregated by a kernel call, their filter bits on the stack*/
+#define KR_DDI_COLUMN_CHUNK  1024
+
+/* aggregate the key's field mirrored in its index slot, latest chunk
+ * first, rows are only reached for their filter bits and related records,
+ * the kernels fold the chunk's values in the window with the bits on,
+ * return 1 if not mirrored yet or a filter bit is missing, the rows
+ * are scanned then
+ */
+static int kr_ddi_column_compute(T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    T_KRParamDDIDef *ptParamDDIDef = ptDDI->ptParamDDIDef;
+    T_KRIndexTable *ptStatIndexTable = NULL;
+    char cMethod = ptParamDDIDef->caStatisticsMethod[0];
+    
+    kr_ddi_init(ptDDI);
+    
+    if (kr_ddi_locate_key(ptDDI, ptData, &ptStatIndexTable) == NULL) {
+        return -1;
+    }
+    
+    /*COUNT reads no field, transtime stands in for it*/
+    T_KRTable *ptTable = ptStatIndexTable->ptTable;
+    int iFieldId = (int )ptParamDDIDef->lStatisticsField;
+    if (cMethod == KR_DDI_METHOD_COUNT) iFieldId = KR_FIELDID_TRANSTIME;
+    if (iFieldId < 0 || iFieldId >= ptTable->iFieldCnt) {
+        return 1;
+    }
+    E_KRType eType = ptTable->ptFieldDef[iFieldId].type;
+    if (eType != KR_TYPE_INT && eType != KR_TYPE_LONG && 
+        eType != KR_TYPE_DOUBLE) {
+        return 1;
+    }
+    if (ptDDI->iColumnId < 0) {
+        ptDDI->iColumnId = kr_index_column_register(ptStatIndexTable, iFieldId);
+        if (ptDDI->iColumnId < 0) {
+            return 1;
+        }
+    }
+    
+    T_KRIndexSolt *ptIndexSlot = NULL;
+    T_KRColumns *ptColumns = kr_index_columns_hold(ptStatIndexTable, \
+            ptDDI->pKeyValue, &ptIndexSlot);
+    if (ptColumns == NULL || ptDDI->iColumnId >= ptColumns->iFieldCnt) {
+        /*mirrored from the key's next insert on*/
+        if (ptIndexSlot != NULL) kr_index_slot_release(ptIndexSlot);
+        return 1;
+    }
+    
+    time_t tCurrTransTime = kr_get_transtime(ptData->ptCurrRec);
+    long lWindow = ptParamDDIDef->lStatisticsValue;
+    long lStamp = (long )ptData->ptDdiTable->tConstructTime;
+    int iExclude = (ptParamDDIDef->caStatisticsType[0] == \
+            KR_DDI_STATISTICS_EXCLUDE);
+    T_KRRecord **pptRecord = kr_columns_record(ptColumns);
+    time_t *ptTransTime = kr_columns_transtime(ptColumns);
+    long *plValue = kr_columns_long(ptColumns, ptDDI->iColumnId);
+    double *pdValue = kr_columns_double(ptColumns, ptDDI->iColumnId);
+    time_t tBeginTime = tCurrTransTime - lWindow;
+    
+    /*none before the first past the window by more than the slack*/
+    long lLow = (long )ptColumns->uiCnt;
+    while (lLow > 0 && 
+           ptTransTime[lLow-1] >= tBeginTime - ptTable->lTransTimeSlack) {
+        lLow--;
+    }
+    
+    /*from zero as the row scan does*/
+    long lValue = 0;
+    double dValue = 0;
+    long lCount = 0;
+    int iResult = 0;
+    uint64_t uiMask[KR_DDI_COLUMN_CHUNK/64];
+    T_KRSimdSel stSel = {NULL, tBeginTime, tCurrTransTime, uiMask};
+    
+    for (long lEnd=(long )ptColumns->uiCnt; lEnd>lLow; ) {
+        long lBegin = MAX(lLow, lEnd - KR_DDI_COLUMN_CHUNK);
+        
+        /*filter bits of the rows in the window only*/
+        memset(uiMask, 0x00, sizeof(uiMask));
+        for (long i=lEnd-1; i>=lBegin; i--) {
+            if (ptTransTime[i] < tBeginTime || 
+                ptTransTime[i] > tCurrTransTime) continue;
+            if (iExclude && pptRecord[i] == ptData->ptCurrRec) continue;
+            
+            int iPassed = kr_record_filter_test(pptRecord[i], KR_FILTERSET_DDI, 
+                    lStamp, ptDDI->iFilterBit);
+            if (iPassed < 0) {
+                /*inserted before the filters loaded*/
+                iResult = 1;
+                break;
+            } else if (!iPassed) {
+                continue;
+            }
+            uiMask[(i-lBegin)>>6] |= (uint64_t )1 << ((i-lBegin)&63);
+            if (ptDDI->ptRelated->bCaptured) {
+                kr_related_add(ptDDI->ptRelated, pptRecord[i]);
+            }
+        }
+        if (iResult != 0) break;
+        
+        size_t n = (size_t )(lEnd - lBegin);
+        stSel.ptTime = ptTransTime + lBegin;
+        switch(cMethod)
+        {
+            case KR_DDI_METHOD_SUM:
+                if (eType == KR_TYPE_DOUBLE) 
+                    lCount += kr_simd_sum_double(pdValue+lBegin, n, &stSel, &dValue);
+                else 
+                    lCount += kr_simd_sum_long(plValue+lBegin, n, &stSel, &lValue);
+                break;
+            case KR_DDI_METHOD_MIN:
+                if (eType == KR_TYPE_DOUBLE) 
+                    lCount += kr_simd_min_double(pdValue+lBegin, n, &stSel, &dValue);
+                else 
+                    lCount += kr_simd_min_long(plValue+lBegin, n, &stSel, &lValue);
+                break;
+            case KR_DDI_METHOD_MAX:
+                if (eType == KR_TYPE_DOUBLE) 
+                    lCount += kr_simd_max_double(pdValue+lBegin, n, &stSel, &dValue);
+                else 
+                    lCount += kr_simd_max_long(plValue+lBegin, n, &stSel, &lValue);
+                break;
+            default:
+                lCount += kr_simd_count(n, &stSel);
+                break;
+        }
+        lEnd = lBegin;
+    }
+    kr_index_slot_release(ptIndexSlot);
+    
+    if (iResult != 0) {
+        kr_ddi_init(ptDDI);
+        return 1;
+    }
+    ptDDI->lAggrCnt = lCount;
+    if (cMethod == KR_DDI_METHOD_COUNT) {
+        iResult = kr_ddi_set_count(ptDDI, lCount);
+    } else if (eType == KR_TYPE_DOUBLE) {
+        iResult = kr_ddi_set_double(ptDDI, dValue);
+    } else {
+        iResult = kr_ddi_set_count(ptDDI, lValue);
+    }
+    if (iResult != 0) {
+        return -1;
+    }
+    
+    ptDDI->eValueInd = KR_VALUE_SETED;
+    return 0;
+}
+
+
+/* read the key's latest run kept in its index slot, O(1),
+ * the run ends at the latest record, so it is what a scan counts
+ * if it and the record it started after are in the current window,
+ * return 1 if not, or if some of its records may not be kept, 
+ * the rows are scanned then, as they are capturing related
+ */
+static int kr_ddi_run_compute(T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    T_KRParamDDIDef *ptParamDDIDef = ptDDI->ptParamDDIDef;
+    T_KRIndexTable *ptStatIndexTable = NULL;
+    
+    if (ptData->bRelatedCapture) {
+        return 1;
+    }
+    
+    kr_ddi_init(ptDDI);
+    
+    T_KRIndexTable *ptIndexTable = \
+        kr_ddi_locate_key(ptDDI, ptData, &ptStatIndexTable);
+    if (ptIndexTable == NULL) {
+        return -1;
+    }
+    
+    /*a field not numeric has no run kept*/
+    if (ptDDI->iRunId < 0) {
+        ptDDI->iRunId = kr_ddi_key_register(ptParamDDIDef, ptStatIndexTable);
+        if (ptDDI->iRunId < 0) {
+            return 1;
+        }
+    }
+    
+    T_KRRun stRun;
+    kr_index_run_value(ptIndexTable->ptIndex, ptDDI->iRunId, 
+            ptDDI->pKeyValue, &stRun);
+    time_t tEnd = kr_get_transtime(ptData->ptCurrRec);
+    time_t tBegin = tEnd - ptParamDDIDef->lStatisticsValue;
+    if (stRun.lLength == 0 || stRun.bPartial ||
+        stRun.tMinTransTime < tBegin || stRun.tMaxTransTime > tEnd) {
+        return 1;
+    }
+    if (stRun.tBefore != 0 && 
+        (stRun.tBefore < tBegin || stRun.tBefore > tEnd)) {
+        return 1;
+    }
+    
+    if (kr_ddi_set_count(ptDDI, stRun.lLength) != 0) {
+        return -1;
+    }
+    
+    ptDDI->eValueInd = KR_VALUE_SETED;
+    return 0;
+}
+
+
+int kr_ddi_compute(T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    if (ptDDI->ptParamDDIDef->caStatisticsType[0] == KR_DDI_STATISTICS_DECAY) {
+        return kr_ddi_decay_compute(ptDDI, ptData);
+    }
+    if (kr_ddi_is_topk(ptDDI->ptParamDDIDef)) {
+        return kr_ddi_topk_compute(ptDDI, ptData);
+    }
+    if (kr_ddi_is_quantile(ptDDI->ptParamDDIDef)) {
+        return kr_ddi_quantile_compute(ptDDI, ptData);
+    }
+    if (ptDDI->iStepCnt > 0) {
+        return kr_ddi_sequence_compute(ptDDI, ptData);
+    }
+    if (kr_ddi_is_run(ptDDI->ptParamDDIDef)) {
+        int iResult = kr_ddi_run_compute(ptDDI, ptData);
+        if (iResult <= 0) return iResult;
+    }
+    if (kr_ddi_is_columnar(ptDDI)) {
+        int iResult = kr_ddi_column_compute(ptDDI, ptData);
+        if (iResult <= 0) return iResult;
+    }
+
+    /*DDIs on the same index and datasrc share one scan*/
+    if (ptDDI->ptFused != NULL) {
+        return kr_ddi_fused_compute(ptDDI->ptFused, ptData);
+    }
+
+    if (kr_ddi_prepare(ptDDI, ptData) != 0) {
+        return -1;
+    }
 
     if (ptDDI->pfDDIAggr == NULL) 
         ptDDI->pfDDIAggr = (KRDDIAggrFunc )kr_ddi_aggr_func;
-    if (ptDDI->pfDDIAggr(ptDDI, ptData) != 0) {
+    int iResult = ptDDI->pfDDIAggr(ptDDI, ptData);
+    kr_db_cursor_close(&ptDDI->stCursor);
+    if (iResult != 0) {
         KR_LOG(KR_LOGERROR, "Run DDI[%ld] AggrFunc failed!", ptDDI->lDDIId);
         return -1;
     }
@@ -243,24 +1240,18 @@ E_KRType kr_ddi_get_type(int did, T_KRData *ptData)
     return ptDDI->eValueType;
 }
 
-void *kr_ddi_get_value(int did, T_KRData *ptData)
+/* value of a bound ddi, computed once per current record */
+void *kr_ddi_get_item_value(T_KRDDI *ptDDI, T_KRData *ptData)
 {
-    if (ptData == NULL) return NULL;
-        
-    long lDID = (long )did;
-    T_KRDDITable *ptDdiTable = ptData->ptDdiTable;
-    T_KRDDI *ptDDI = kr_hashtable_lookup(ptDdiTable->ptDDITable, &lDID);
-    if (ptDDI == NULL) return NULL;
-    
     if (ptDDI->ptCurrRec != ptData->ptCurrRec) {
         kr_ddi_compute(ptDDI, ptData);
         if (ptDDI->eValueInd != KR_VALUE_SETED) {
-            KR_LOG(KR_LOGDEBUG, "kr_ddi_compute [%d] unset!", did);
+            KR_LOG(KR_LOGDEBUG, "kr_ddi_compute [%ld] unset!", ptDDI->lDDIId);
             return NULL;
         }
         ptDDI->ptCurrRec = ptData->ptCurrRec;
     } else {
-        KR_LOG(KR_LOGDEBUG, "Get DDI [%d] value record cached!", did);
+        KR_LOG(KR_LOGDEBUG, "Get DDI [%ld] value record cached!", ptDDI->lDDIId);
     }
     
     if (ptDDI->eValueInd == KR_VALUE_SETED) {
@@ -268,3 +1259,48 @@ void *kr_ddi_get_value(int did, T_KRData *ptData)
     }
     return NULL;
 }
+
+
+void *kr_ddi_get_value(int did, T_KRData *ptData)
+{
+    if (ptData == NULL) return NULL;
+        
+    long lDID = (long )did;
+    T_KRDDITable *ptDdiTable = ptData->ptDdiTable;
+    T_KRDDI *ptDDI = kr_hashtable_lookup(ptDdiTable->ptDDITable, &lDID);
+    if (ptDDI == NULL) return NULL;
+
+    return kr_ddi_get_item_value(ptDDI, ptData);
+}
+
+
+/* records aggregated into ptDDI's current value, 
+ * computed again capturing them if they were not kept,
+ * values read from index slots have none
+ */
+T_KRRelated *kr_ddi_related(T_KRDDI *ptDDI, T_KRData *ptData)
+{
+    if (ptData->eRelatedMode == KR_RELATED_OFF || 
+        ptDDI->eValueInd != KR_VALUE_SETED) {
+        return NULL;
+    }
+
+    if (!ptDDI->ptRelated->bCaptured &&
+        ptDDI->ptParamDDIDef->caStatisticsType[0] != KR_DDI_STATISTICS_DECAY &&
+        !kr_ddi_is_topk(ptDDI->ptParamDDIDef) && 
+        !kr_ddi_is_quantile(ptDDI->ptParamDDIDef) && ptDDI->iStepCnt == 0) {
+        T_KRRecord *ptSavedRec = ptData->ptRecord;
+        kr_bool bSavedCapture = ptData->bRelatedCapture;
+        ptData->bRelatedCapture = TRUE;
+        int iResult = kr_ddi_compute(ptDDI, ptData);
+        ptData->bRelatedCapture = bSavedCapture;
+        ptData->ptRecord = ptSavedRec;
+        if (iResult != 0) {
+            KR_LOG(KR_LOGERROR, "DDI[%ld] capture related failed!", 
+                    ptDDI->lDDIId);
+            return NULL;
+        }
+    }
+    
+    return ptDDI->ptRelated;
+}
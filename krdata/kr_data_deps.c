@@ -0,0 +1,182 @@
+#include "kr_data.h"
+
+typedef struct _kr_data_deps_walk_t
+{
+    T_KRDataDeps          *ptDeps;
+    T_KRData              *ptData;
+    T_KRHashTable         *ptSeen;
+}T_KRDataDepsWalk;
+
+static void kr_data_deps_walk(T_KRCalc *krcalc, T_KRDataDepsWalk *ptWalk);
+
+
+T_KRDataDeps *kr_data_deps_new(void)
+{
+    T_KRDataDeps *ptDeps = kr_calloc(sizeof(T_KRDataDeps));
+    if (ptDeps == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptDeps failed!");
+        return NULL;
+    }
+    ptDeps->ptCalcList = kr_list_new();
+    ptDeps->lBindStamp = -1;
+
+    return ptDeps;
+}
+
+
+static void kr_data_deps_clear(T_KRDataDeps *ptDeps)
+{
+    if (ptDeps->ptSDIList) kr_list_destroy(ptDeps->ptSDIList);
+    if (ptDeps->ptDDIList) kr_list_destroy(ptDeps->ptDDIList);
+    if (ptDeps->ptHDIList) kr_list_destroy(ptDeps->ptHDIList);
+    ptDeps->ptSDIList = NULL;
+    ptDeps->ptDDIList = NULL;
+    ptDeps->ptHDIList = NULL;
+    ptDeps->lBindStamp = -1;
+}
+
+
+void kr_data_deps_free(T_KRDataDeps *ptDeps)
+{
+    if (ptDeps) {
+        kr_data_deps_clear(ptDeps);
+        kr_list_destroy(ptDeps->ptCalcList);
+        kr_free(ptDeps);
+    }
+}
+
+
+void kr_data_deps_add_calc(T_KRDataDeps *ptDeps, T_KRCalc *krcalc)
+{
+    if (krcalc != NULL) {
+        kr_list_add_tail(ptDeps->ptCalcList, krcalc);
+        ptDeps->lBindStamp = -1;
+    }
+}
+
+
+/* whether item was reached already, marks it if not */
+static int kr_data_deps_seen(T_KRDataDepsWalk *ptWalk, void *item)
+{
+    if (kr_hashtable_lookup(ptWalk->ptSeen, item) != NULL) {
+        return 1;
+    }
+    kr_hashtable_insert(ptWalk->ptSeen, item, item);
+    return 0;
+}
+
+
+/* a DDI drags in its filters, and its fused siblings computed
+ * along with it in one scan
+ */
+static void kr_data_deps_add_ddi(T_KRDDI *ptDDI, T_KRDataDepsWalk *ptWalk)
+{
+    if (kr_data_deps_seen(ptWalk, ptDDI)) return;
+
+    kr_list_add_tail(ptWalk->ptDeps->ptDDIList, ptDDI);
+    kr_data_deps_walk(ptDDI->ptDDICalc, ptWalk);
+    for (int i=0; i<ptDDI->iStepCnt; i++) {
+        kr_data_deps_walk(ptDDI->pptStepCalc[i], ptWalk);
+    }
+    if (ptDDI->ptFused != NULL) {
+        T_KRListNode *node = ptDDI->ptFused->ptDDIList->head;
+        while (node) {
+            kr_data_deps_add_ddi(kr_list_value(node), ptWalk);
+            node = node->next;
+        }
+    }
+}
+
+
+static void _kr_data_deps_visit(int kind, int id, T_KRDataDepsWalk *ptWalk)
+{
+    T_KRData *ptData = ptWalk->ptData;
+
+    switch(kind)
+    {
+        case KR_CALCKIND_SID:
+        {
+            T_KRSDI *ptSDI = kr_sdi_lookup(ptData->ptSdiTable, id);
+            if (ptSDI == NULL || kr_data_deps_seen(ptWalk, ptSDI)) return;
+            kr_list_add_tail(ptWalk->ptDeps->ptSDIList, ptSDI);
+            kr_data_deps_walk(ptSDI->ptSDICalc, ptWalk);
+            break;
+        }
+        case KR_CALCKIND_DID:
+        {
+            T_KRDDI *ptDDI = kr_ddi_lookup(ptData->ptDdiTable, id);
+            if (ptDDI == NULL) return;
+            kr_data_deps_add_ddi(ptDDI, ptWalk);
+            break;
+        }
+        case KR_CALCKIND_HID:
+        {
+            T_KRHDI *ptHDI = kr_hdi_lookup(ptData->ptHdiTable, id);
+            if (ptHDI == NULL || kr_data_deps_seen(ptWalk, ptHDI)) return;
+            kr_list_add_tail(ptWalk->ptDeps->ptHDIList, ptHDI);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+
+static void kr_data_deps_walk(T_KRCalc *krcalc, T_KRDataDepsWalk *ptWalk)
+{
+    if (krcalc != NULL) {
+        kr_calc_foreach_id(krcalc,
+                (KRCalcIdFunc )_kr_data_deps_visit, ptWalk);
+    }
+}
+
+
+/* SEQUENCE steps are evaluated while inserting, before any group */
+static void _kr_data_deps_walk_steps(void *key, void *value, void *data)
+{
+    T_KRDDI *ptDDI = (T_KRDDI *)value;
+    for (int i=0; i<ptDDI->iStepCnt; i++) {
+        kr_data_deps_walk(ptDDI->pptStepCalc[i], (T_KRDataDepsWalk *)data);
+    }
+}
+
+
+/* collect the items reachable from the root calcs,
+ * again only after the data tables reloaded
+ */
+int kr_data_deps_resolve(T_KRDataDeps *ptDeps, T_KRData *ptData)
+{
+    if (ptDeps->lBindStamp == ptData->lBindStamp) {
+        return 0;
+    }
+
+    kr_data_deps_clear(ptDeps);
+    ptDeps->ptSDIList = kr_list_new();
+    ptDeps->ptDDIList = kr_list_new();
+    ptDeps->ptHDIList = kr_list_new();
+
+    T_KRDataDepsWalk stWalk = {ptDeps, ptData, NULL};
+    stWalk.ptSeen = kr_hashtable_new(kr_pointer_hash, kr_pointer_equal);
+    if (stWalk.ptSeen == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_hashtable_new ptSeen failed!");
+        kr_data_deps_clear(ptDeps);
+        return -1;
+    }
+
+    T_KRListNode *node = ptDeps->ptCalcList->head;
+    while (node) {
+        kr_data_deps_walk(kr_list_value(node), &stWalk);
+        node = node->next;
+    }
+    kr_hashtable_foreach(ptData->ptDdiTable->ptDDITable,
+            _kr_data_deps_walk_steps, &stWalk);
+    kr_hashtable_destroy(stWalk.ptSeen);
+
+    KR_LOG(KR_LOGDEBUG, "deps resolved sdi[%u] ddi[%u] hdi[%u]",
+            kr_list_length(ptDeps->ptSDIList),
+            kr_list_length(ptDeps->ptDDIList),
+            kr_list_length(ptDeps->ptHDIList));
+    ptDeps->lBindStamp = ptData->lBindStamp;
+
+    return 0;
+}
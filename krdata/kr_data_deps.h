@@ -0,0 +1,28 @@
+#ifndef __KR_DATA_DEPS_H__
+#define __KR_DATA_DEPS_H__
+
+#include "krutils/kr_utils.h"
+#include "krcalc/kr_calc.h"
+
+struct _kr_data_t;
+
+/* data items some calcs may compute, directly or through the filters
+ * of items they reference, resolved against one T_KRData
+ */
+typedef struct _kr_data_deps_t
+{
+    T_KRList              *ptCalcList;  /*root calcs, not owned*/
+    long                  lBindStamp;   /*data's stamp when resolved*/
+
+    T_KRList              *ptSDIList;
+    T_KRList              *ptDDIList;
+    T_KRList              *ptHDIList;
+}T_KRDataDeps;
+
+
+T_KRDataDeps *kr_data_deps_new(void);
+void kr_data_deps_free(T_KRDataDeps *ptDeps);
+void kr_data_deps_add_calc(T_KRDataDeps *ptDeps, T_KRCalc *krcalc);
+int kr_data_deps_resolve(T_KRDataDeps *ptDeps, struct _kr_data_t *ptData);
+
+#endif /* __KR_DATA_DEPS_H__ */
@@ -31,9 +31,7 @@ void kr_hdi_init(T_KRHDI *ptHDI)
     /*initialize first*/
     ptHDI->eValueInd = KR_VALUE_UNSET;
 
-    /*string comes from kr_strdup, need kr_free*/
-    if (ptHDI->eValueType == KR_TYPE_STRING)
-        kr_free(ptHDI->uValue.s);
+    /*string comes from the event arena, released with it*/
     memset(&ptHDI->uValue, 0x00, sizeof(ptHDI->uValue));
 }
 
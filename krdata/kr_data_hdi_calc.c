@@ -250,7 +250,9 @@ int kr_hdi_aggr_flag(T_KRHDI *ptHDI, T_KRData *ptData, char *object)
             ptHDI->uValue.d = atof(stHdiFlagSel.caOutDataFlag);
             break;
         case KR_TYPE_STRING:
-            ptHDI->uValue.s = kr_strdup(stHdiFlagSel.caOutDataFlag);
+            ptHDI->uValue.s = kr_data_strndup(ptData, 
+                    stHdiFlagSel.caOutDataFlag, 
+                    strlen(stHdiFlagSel.caOutDataFlag));
             break;
         default:
             KR_LOG(KR_LOGERROR, "unsupported ValueType [%s],[%c]!",\
@@ -328,7 +330,8 @@ static void kr_hdi_get_value_from_cache(T_KRHDI *ptHDI, T_KRData *ptData)
             case KR_TYPE_DOUBLE:
                 ptHDI->uValue.d = cache_value->uValue.d; break;
             case KR_TYPE_STRING:
-                ptHDI->uValue.s = kr_strdup(cache_value->uValue.s);
+                ptHDI->uValue.s = kr_data_strndup(ptData, 
+                        cache_value->uValue.s, strlen(cache_value->uValue.s));
                 break;
         }
         ptHDI->eValueInd = KR_VALUE_SETED;
@@ -360,26 +363,20 @@ static void kr_hdi_get_value_from_cache(T_KRHDI *ptHDI, T_KRData *ptData)
 }
 
 
-void *kr_hdi_get_value(int hid, T_KRData *ptData)
+/* value of a bound hdi, computed once per current record */
+void *kr_hdi_get_item_value(T_KRHDI *ptHDI, T_KRData *ptData)
 {
-    if (ptData == NULL) return NULL;
-    
-    long lHID = (long )hid;
-    T_KRHDITable *ptHdiTable = ptData->ptHdiTable;
-    T_KRHDI *ptHDI = kr_hashtable_lookup(ptHdiTable->ptHDITable, &lHID);
-    if (ptHDI == NULL) return NULL;
-    
     if (ptHDI->ptCurrRec != ptData->ptCurrRec) {
         /*get the value from cache*/
         if (ptData->ptHDICache != NULL) {
             kr_hdi_get_value_from_cache(ptHDI, ptData);
         } else if (kr_hdi_compute(ptHDI, ptData) != 0) {
-            KR_LOG(KR_LOGDEBUG, "kr_hdi_compute [%d] unset!", hid);
+            KR_LOG(KR_LOGDEBUG, "kr_hdi_compute [%ld] unset!", ptHDI->lHDIId);
             return NULL;
         }
         ptHDI->ptCurrRec = ptData->ptCurrRec;
     } else {
-        KR_LOG(KR_LOGDEBUG, "Get HDI [%d] value record cached!", hid);
+        KR_LOG(KR_LOGDEBUG, "Get HDI [%ld] value record cached!", ptHDI->lHDIId);
     }
     
     if (ptHDI->eValueInd == KR_VALUE_SETED) {
@@ -388,3 +385,16 @@ void *kr_hdi_get_value(int hid, T_KRData *ptData)
     return NULL;
 }
 
+
+void *kr_hdi_get_value(int hid, T_KRData *ptData)
+{
+    if (ptData == NULL) return NULL;
+    
+    long lHID = (long )hid;
+    T_KRHDITable *ptHdiTable = ptData->ptHdiTable;
+    T_KRHDI *ptHDI = kr_hashtable_lookup(ptHdiTable->ptHDITable, &lHID);
+    if (ptHDI == NULL) return NULL;
+
+    return kr_hdi_get_item_value(ptHDI, ptData);
+}
+
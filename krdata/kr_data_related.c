@@ -0,0 +1,60 @@
+#include "kr_data_related.h"
+
+/*locations kept before the vector first grows*/
+#define KR_RELATED_INIT_CAP  16
+
+
+T_KRRelated *kr_related_new(void)
+{
+    T_KRRelated *ptRelated = kr_calloc(sizeof(T_KRRelated));
+    if (ptRelated == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptRelated failed!");
+        return NULL;
+    }
+    return ptRelated;
+}
+
+
+void kr_related_free(T_KRRelated *ptRelated)
+{
+    if (ptRelated) {
+        kr_free(ptRelated->puiLoc);
+        kr_free(ptRelated);
+    }
+}
+
+
+/* the vector is kept, so refilling it stops allocating */
+void kr_related_reset(T_KRRelated *ptRelated)
+{
+    ptRelated->bCaptured = FALSE;
+    ptRelated->ptTable = NULL;
+    ptRelated->uiCnt = 0;
+}
+
+
+void kr_related_add(T_KRRelated *ptRelated, T_KRRecord *ptRecord)
+{
+    if (ptRelated->ptTable == NULL) {
+        ptRelated->ptTable = ptRecord->ptTable;
+    } else if (ptRelated->ptTable != ptRecord->ptTable) {
+        KR_LOG(KR_LOGERROR, "related record of table [%d] not [%d]!", 
+                ((T_KRTable *)ptRecord->ptTable)->iTableId, 
+                ptRelated->ptTable->iTableId);
+        return;
+    }
+
+    if (ptRelated->uiCnt == ptRelated->uiCap) {
+        unsigned int uiCap = ptRelated->uiCap ? \
+            ptRelated->uiCap*2 : KR_RELATED_INIT_CAP;
+        unsigned int *puiLoc = \
+            kr_realloc(ptRelated->puiLoc, sizeof(unsigned int)*uiCap);
+        if (puiLoc == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_realloc puiLoc [%u] failed!", uiCap);
+            return;
+        }
+        ptRelated->puiLoc = puiLoc;
+        ptRelated->uiCap = uiCap;
+    }
+    ptRelated->puiLoc[ptRelated->uiCnt++] = kr_record_loc(ptRecord);
+}
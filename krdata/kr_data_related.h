@@ -0,0 +1,43 @@
+#ifndef __KR_DATA_RELATED_H__
+#define __KR_DATA_RELATED_H__
+
+#include "krutils/kr_utils.h"
+#include "krdb/kr_db.h"
+
+/*whether data items keep the records they aggregated*/
+typedef enum {
+    KR_RELATED_OFF      = '0',  /*never*/
+    KR_RELATED_ONFIRE   = '1',  /*computed again once a rule fired*/
+    KR_RELATED_ALWAYS   = '2'   /*while computing*/
+}E_KRRelatedMode;
+
+/*records an item aggregated, append-only vector of 
+ *their locations in the ring or segments of the statistics table
+ */
+typedef struct _kr_related_t
+{
+    kr_bool               bCaptured;    /*filled by the last compute*/
+    T_KRTable             *ptTable;
+    unsigned int          uiCnt;
+    unsigned int          uiCap;
+    unsigned int          *puiLoc;
+}T_KRRelated;
+
+
+T_KRRelated *kr_related_new(void);
+void kr_related_free(T_KRRelated *ptRelated);
+void kr_related_reset(T_KRRelated *ptRelated);
+void kr_related_add(T_KRRelated *ptRelated, T_KRRecord *ptRecord);
+
+static inline unsigned int kr_related_count(T_KRRelated *ptRelated)
+{
+    return ptRelated->uiCnt;
+}
+
+static inline T_KRRecord *kr_related_get(T_KRRelated *ptRelated, 
+        unsigned int i)
+{
+    return kr_record_at(ptRelated->ptTable, ptRelated->puiLoc[i]);
+}
+
+#endif /* __KR_DATA_RELATED_H__ */
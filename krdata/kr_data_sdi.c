@@ -13,6 +13,7 @@ T_KRSDI *kr_sdi_construct(T_KRParamSDIDef *ptParamSDIDef, T_KRModule *ptModule,
     ptSDI->lSDIId = ptParamSDIDef->lSdiId;
     ptSDI->ptSDICalc = kr_calc_construct(ptParamSDIDef->caSdiFilterFormat[0], \
             ptParamSDIDef->caSdiFilterString, pfGetType, pfGetValue);
+    kr_data_bind_calc(ptSDI->ptSDICalc);
     ptSDI->eValueType = ptParamSDIDef->caSdiValueType[0];
     if (ptParamSDIDef->caSdiAggrFunc[0] != '\0') {
         ptSDI->pfSDIAggr = (KRSDIAggrFunc )kr_module_symbol(ptModule, 
@@ -24,7 +25,7 @@ T_KRSDI *kr_sdi_construct(T_KRParamSDIDef *ptParamSDIDef, T_KRModule *ptModule,
         }
     }
     ptSDI->eValueInd = KR_VALUE_UNSET;
-    ptSDI->ptRelated = kr_hashtable_new(kr_pointer_hash, kr_pointer_equal);
+    ptSDI->ptRelated = kr_related_new();
     
     return ptSDI;
 }
@@ -33,17 +34,15 @@ void kr_sdi_init(T_KRSDI *ptSDI)
 {
     /*initialize first*/
     ptSDI->eValueInd = KR_VALUE_UNSET;
-    kr_hashtable_remove_all(ptSDI->ptRelated);
+    kr_related_reset(ptSDI->ptRelated);
 
-    /*string comes from kr_strdup, need kr_free*/
-    if (ptSDI->eValueType == KR_TYPE_STRING)
-        kr_free(ptSDI->uValue.s);
+    /*string comes from the event arena, released with it*/
     memset(&ptSDI->uValue, 0x00, sizeof(ptSDI->uValue));
 }
 
 void kr_sdi_destruct(T_KRSDI *ptSDI)
 {
-    kr_hashtable_destroy(ptSDI->ptRelated);
+    kr_related_free(ptSDI->ptRelated);
     kr_calc_destruct(ptSDI->ptSDICalc);
     kr_free(ptSDI);
 }
@@ -73,6 +72,12 @@ T_KRSDITable *kr_sdi_table_construct(T_KRParamSDI *ptParamSDI, T_KRModule *ptMod
             kr_free(ptSdiTable);
             return NULL;
         }
+        /*record-invariant filters get a bit in each record's header*/
+        ptSDI->iFilterBit = -1;
+        if (i < KR_FILTER_BITS_MAX && 
+                kr_data_record_invariant(ptSDI->ptSDICalc)) {
+            ptSDI->iFilterBit = i;
+        }
         kr_hashtable_insert(ptSdiTable->ptSDITable, &ptSDI->lSDIId, ptSDI);
     }
     ptSdiTable->tConstructTime = ptParamSDI->tLastLoadTime;
@@ -5,6 +5,7 @@
 #include "krparam/kr_param.h"
 #include "krcalc/kr_calc.h"
 #include "krdb/kr_db.h"
+#include "kr_data_related.h"
 
 typedef int  (*KRSDIAggrFunc)(void *p1, void *p2);
 
@@ -13,17 +14,18 @@ typedef struct _kr_sdi_t
     T_KRParamSDIDef       *ptParamSDIDef;
     long                  lSDIId;
     T_KRCalc              *ptSDICalc;
+    int                   iFilterBit;   /*record filter bit, -1 if none*/
     E_KRType              eValueType;
     KRSDIAggrFunc         pfSDIAggr;
     
     T_KRRecord            *ptCurrRec;
     E_KRType              eKeyType;
     void                  *pKeyValue;
-    T_KRList              *ptRecList;
+    T_KRDBCursor          stCursor;     /*key's records, latest first*/
 
     E_KRValueInd          eValueInd;
     U_KRValue             uValue;
-    T_KRHashTable         *ptRelated;
+    T_KRRelated           *ptRelated;
 }T_KRSDI;
 
 typedef struct _kr_sdi_table_t
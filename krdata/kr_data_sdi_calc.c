@@ -5,42 +5,77 @@ typedef enum {
     KR_LOC_RELATIVE     = '1'  
 }E_KRLocProp;
 
+static void _kr_sdi_filter_record(void *key, T_KRSDI *ptSDI, T_KRData *ptData)
+{
+    T_KRRecord *ptRecord = ptData->ptRecord;
+    int iPassed = 0;
+
+    if (ptSDI->iFilterBit < 0) return;
+    if (((T_KRTable *)ptRecord->ptTable)->iTableId != \
+        ptSDI->ptParamSDIDef->lStatisticsDatasrc) {
+        return;
+    }
+
+    if (kr_calc_eval(ptSDI->ptSDICalc, ptData) != 0) {
+        KR_LOG(KR_LOGERROR, "kr_calc_eval [%ld] failed!", ptSDI->lSDIId);
+    } else if (kr_calc_type(ptSDI->ptSDICalc) != KR_TYPE_BOOL) {
+        KR_LOG(KR_LOGERROR, "result_type of sdi_calc must be boolean!");
+    } else if (kr_calc_ind(ptSDI->ptSDICalc) == KR_VALUE_SETED) {
+        iPassed = kr_calc_value(ptSDI->ptSDICalc)->b;
+    }
+    kr_record_filter_set(ptRecord, KR_FILTERSET_SDI, ptSDI->iFilterBit, iPassed);
+}
+
+/* set filter bits of ptData->ptRecord, stamped with construct time */
+void kr_sdi_table_filter(T_KRSDITable *ptSdiTable, T_KRData *ptData)
+{
+    if (ptSdiTable->tConstructTime == 0) return;
+
+    kr_hashtable_foreach(ptSdiTable->ptSDITable, 
+            (KRHFunc )_kr_sdi_filter_record, ptData);
+    kr_record_filter_stamp(ptData->ptRecord, KR_FILTERSET_SDI, 
+            (long )ptSdiTable->tConstructTime);
+}
+
+
 int kr_sdi_aggr_func(T_KRSDI *ptSDI, T_KRData *ptData)
 {
     int iResult = -1;
+    int iPassed = 0;
     int iAbsLoc = -1;
     int iRelLoc = -1;
     
-    T_KRListNode *node = ptSDI->ptRecList->tail;
-    while(node)
+    while((ptData->ptRecord = kr_db_cursor_next(&ptSDI->stCursor)) != NULL)
     {
-        ptData->ptRecord = (T_KRRecord *)kr_list_value(node);
-        
         iAbsLoc++; 
                 
         if (ptSDI->ptParamSDIDef->caLocationProperty[0] == KR_LOC_ABSOLUTE) {
             if (ptSDI->ptParamSDIDef->lStatisticsLocation != iAbsLoc) {
-                node = node->prev;
                 continue;
             }
         }
         
         if (((T_KRTable *)ptData->ptRecord->ptTable)->iTableId != \
             ptSDI->ptParamSDIDef->lStatisticsDatasrc) {
-            node = node->prev;
             continue;
         }
         
-        iResult = kr_calc_eval(ptSDI->ptSDICalc, ptData);
-        if (iResult != 0) {
-            KR_LOG(KR_LOGERROR, "kr_calc_eval [%ld] failed!", ptSDI->lSDIId);
-            return -1;
-        } else if (kr_calc_type(ptSDI->ptSDICalc) != KR_TYPE_BOOL) {
-            KR_LOG(KR_LOGERROR, "result_type of sdi_calc must be boolean!");
-            return -1;
-        } else if (kr_calc_ind(ptSDI->ptSDICalc) != KR_VALUE_SETED ||
-                   !kr_calc_value(ptSDI->ptSDICalc)->b) {
-            node = node->prev;
+        /*test the bit set while inserting, evaluate if not there*/
+        iPassed = kr_record_filter_test(ptData->ptRecord, KR_FILTERSET_SDI, 
+                (long )ptData->ptSdiTable->tConstructTime, ptSDI->iFilterBit);
+        if (iPassed < 0) {
+            iResult = kr_calc_eval(ptSDI->ptSDICalc, ptData);
+            if (iResult != 0) {
+                KR_LOG(KR_LOGERROR, "kr_calc_eval [%ld] failed!", ptSDI->lSDIId);
+                return -1;
+            } else if (kr_calc_type(ptSDI->ptSDICalc) != KR_TYPE_BOOL) {
+                KR_LOG(KR_LOGERROR, "result_type of sdi_calc must be boolean!");
+                return -1;
+            }
+            iPassed = (kr_calc_ind(ptSDI->ptSDICalc) == KR_VALUE_SETED &&
+                       kr_calc_value(ptSDI->ptSDICalc)->b);
+        }
+        if (!iPassed) {
             continue;
         }
     
@@ -48,7 +83,6 @@ int kr_sdi_aggr_func(T_KRSDI *ptSDI, T_KRData *ptData)
             
         if (ptSDI->ptParamSDIDef->caLocationProperty[0] == KR_LOC_RELATIVE) {
             if (ptSDI->ptParamSDIDef->lStatisticsLocation != iRelLoc) {
-                node = node->prev;
                 continue;
             }
         }
@@ -67,7 +101,7 @@ int kr_sdi_aggr_func(T_KRSDI *ptSDI, T_KRData *ptData)
                 ptSDI->uValue.d = *(double *)val;
                 break;
             case KR_TYPE_STRING:
-                ptSDI->uValue.s = kr_strdup(val);
+                ptSDI->uValue.s = kr_data_strndup(ptData, val, strlen(val));
                 break;
             default:
                 KR_LOG(KR_LOGERROR, "Bad FieldType [%c]!", ptSDI->eValueType);
@@ -75,16 +109,15 @@ int kr_sdi_aggr_func(T_KRSDI *ptSDI, T_KRData *ptData)
         }
 
         /*add this record to related*/
-        kr_hashtable_insert(ptSDI->ptRelated, \
-                ptData->ptRecord, ptData->ptRecord);
+        if (ptSDI->ptRelated->bCaptured) {
+            kr_related_add(ptSDI->ptRelated, ptData->ptRecord);
+        }
     
         /* This is what the difference between SDI and DDI:
          * SDI only set once, while DDI still need to traversal all the list
          */
         ptSDI->eValueInd = KR_VALUE_SETED;
         break;
-        
-        node = node->prev;
     }
     
     return 0;
@@ -95,6 +128,7 @@ int kr_sdi_compute(T_KRSDI *ptSDI, T_KRData *ptData)
 {
     /*initialize first*/
     kr_sdi_init(ptSDI);
+    ptSDI->ptRelated->bCaptured = ptData->bRelatedCapture;
     
     int iIndexId = ptSDI->ptParamSDIDef->lStatisticsIndex;
     
@@ -113,15 +147,14 @@ int kr_sdi_compute(T_KRSDI *ptSDI, T_KRData *ptData)
         kr_field_get_type(ptCurrRec, ptIndexTable->iIndexFieldId);
     ptSDI->pKeyValue = \
         kr_field_get_value(ptCurrRec, ptIndexTable->iIndexFieldId);
-    //FIXME:
-    /*
-    ptSDI->ptRecList = \
-        kr_db_select(ptDB, iIndexId, ptData->pKeyValue);
-        */
+    kr_db_cursor_init(&ptSDI->stCursor, ptIndexTable->ptIndex, 
+            ptSDI->pKeyValue, KR_CURSOR_REVERSE);
 
     if (ptSDI->pfSDIAggr == NULL) 
         ptSDI->pfSDIAggr = (KRSDIAggrFunc )kr_sdi_aggr_func;
-    if (ptSDI->pfSDIAggr(ptSDI, ptData) != 0) {
+    int iResult = ptSDI->pfSDIAggr(ptSDI, ptData);
+    kr_db_cursor_close(&ptSDI->stCursor);
+    if (iResult != 0) {
         KR_LOG(KR_LOGERROR, "Run SDI[%ld] AggrFunc failed!", ptSDI->lSDIId);
         return -1;
     }
@@ -142,24 +175,18 @@ E_KRType kr_sdi_get_type(int sid, T_KRData *ptData)
     return ptSDI->eValueType;
 }
 
-void *kr_sdi_get_value(int sid, T_KRData *ptData)
+/* value of a bound sdi, computed once per current record */
+void *kr_sdi_get_item_value(T_KRSDI *ptSDI, T_KRData *ptData)
 {
-    if (ptData == NULL) return NULL;
-        
-    long lSID = (long )sid;
-    T_KRSDITable *ptSdiTable = ptData->ptSdiTable;
-    T_KRSDI *ptSDI = kr_hashtable_lookup(ptSdiTable->ptSDITable, &lSID);
-    if (ptSDI == NULL) return NULL;
-    
     if (ptSDI->ptCurrRec != ptData->ptCurrRec) {
         kr_sdi_compute(ptSDI, ptData);
         if (ptSDI->eValueInd != KR_VALUE_SETED) {
-            KR_LOG(KR_LOGDEBUG, "kr_sdi_compute [%d] unset!", sid);
+            KR_LOG(KR_LOGDEBUG, "kr_sdi_compute [%ld] unset!", ptSDI->lSDIId);
             return NULL;
         }
         ptSDI->ptCurrRec = ptData->ptCurrRec;
     } else {
-        KR_LOG(KR_LOGDEBUG, "Get SDI [%d] value record cached!", sid);
+        KR_LOG(KR_LOGDEBUG, "Get SDI [%ld] value record cached!", ptSDI->lSDIId);
     }
     
     if (ptSDI->eValueInd == KR_VALUE_SETED) {
@@ -168,3 +195,44 @@ void *kr_sdi_get_value(int sid, T_KRData *ptData)
     return NULL;
 }
 
+
+void *kr_sdi_get_value(int sid, T_KRData *ptData)
+{
+    if (ptData == NULL) return NULL;
+        
+    long lSID = (long )sid;
+    T_KRSDITable *ptSdiTable = ptData->ptSdiTable;
+    T_KRSDI *ptSDI = kr_hashtable_lookup(ptSdiTable->ptSDITable, &lSID);
+    if (ptSDI == NULL) return NULL;
+
+    return kr_sdi_get_item_value(ptSDI, ptData);
+}
+
+
+
+/* records aggregated into ptSDI's current value, 
+ * computed again capturing them if they were not kept
+ */
+T_KRRelated *kr_sdi_related(T_KRSDI *ptSDI, T_KRData *ptData)
+{
+    if (ptData->eRelatedMode == KR_RELATED_OFF || 
+        ptSDI->eValueInd != KR_VALUE_SETED) {
+        return NULL;
+    }
+
+    if (!ptSDI->ptRelated->bCaptured) {
+        T_KRRecord *ptSavedRec = ptData->ptRecord;
+        kr_bool bSavedCapture = ptData->bRelatedCapture;
+        ptData->bRelatedCapture = TRUE;
+        int iResult = kr_sdi_compute(ptSDI, ptData);
+        ptData->bRelatedCapture = bSavedCapture;
+        ptData->ptRecord = ptSavedRec;
+        if (iResult != 0) {
+            KR_LOG(KR_LOGERROR, "SDI[%ld] capture related failed!", 
+                    ptSDI->lSDIId);
+            return NULL;
+        }
+    }
+    
+    return ptSDI->ptRelated;
+}
@@ -32,43 +32,72 @@ T_KRDB* kr_db_new(char *psDBName, T_DbsEnv *ptDbsEnv, T_KRModule *ptModule)
 
 void kr_db_free(T_KRDB *ptDB)
 {
+    /*rows queued flushed first*/
+    kr_db_persist_stop(ptDB);
     kr_db_drop(ptDB);
 }
 
 
+/* return 0 if inserted in time, E_KRInsertResult of late ones,
+ * for a single thread writing, see kr_db_ingest otherwise
+ */
 int kr_db_insert(T_KRDB *ptDB, T_KRRecord *ptRecord)
 {
     /*insert into memory, internal*/
-    kr_record_insert(ptRecord);
+    E_KRInsertResult eResult = kr_record_insert(ptRecord);
+    if (eResult == KR_INSERT_DIVERTED) {
+        return eResult;
+    }
     
-    /*TODO:persist to database, external*/
+    /*persist to database, external, behind*/
+    if (ptDB->ptPersist != NULL) {
+        T_KRTable *ptTable = (T_KRTable *)ptRecord->ptTable;
+        kr_persist_put(ptDB->ptPersist, ptTable, ptRecord->pRecBuf, 
+                ptTable->iRecordSize-sizeof(T_KRRecord));
+    }
     
-    return 0;
+    return eResult;
 }
 
 
-
-T_KRList* kr_db_select(T_KRDB *ptDB, int iIndexId, void *key, time_t tBeginTime, time_t tEndTime, int iSortFieldId)
+/* insert a record of iTableId copied from pRecBuf, from any thread,
+ * records of tables sharing indexes are applied by one writer in turn,
+ * return 0 if inserted in time, E_KRInsertResult of late ones, -1 if failed
+ */
+int kr_db_ingest(T_KRDB *ptDB, int iTableId, char *pRecBuf, size_t ulLen, T_KRRecord **pptRecord)
 {
-    /*alloc return record list*/
-    T_KRList *pRecList=kr_list_new();
-    kr_list_set_compare(pRecList, (KRCompareDataFunc)kr_record_compare);
-    
-    /*get index first*/
-    T_KRIndex *ptIndex = kr_index_get(ptDB, iIndexId);
-    if (ptIndex == NULL) {
-        KR_LOG(KR_LOGERROR, "kr_index_get[%d] Error!", iIndexId);
-        return NULL;
+    T_KRTable *ptTable = kr_table_get(ptDB, iTableId);
+    if (ptTable == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_table_get [%d] Error!", iTableId);
+        return -1;
     }
-    
-    /*get records from internal*/
-    T_KRIndexSolt *ptIndexSlot = kr_hashtable_lookup(ptIndex->pHashTable, key);
 
-    /*get records from external*/
-    
-    return pRecList;
-}
+    /*insert into memory, internal*/
+    int iResult = kr_table_ingest(ptTable, pRecBuf, ulLen, pptRecord);
+    if (iResult != KR_INSERT_INTIME && iResult != KR_INSERT_LATE) {
+        return iResult;
+    }
+
+    /*persist to database, external, behind*/
+    if (ptDB->ptPersist != NULL) {
+        kr_persist_put(ptDB->ptPersist, ptTable, pRecBuf, ulLen);
+    }
 
+    return iResult;
+}
 
 
+/* shard of a record of iTableId, records of one shard only touch its 
+ * ring segment and index hashtables, so a dispatcher keeping each shard 
+ * on one worker keeps those cache lines on one core, -1 if failed
+ */
+int kr_db_shard_of(T_KRDB *ptDB, int iTableId, char *pRecBuf, size_t ulLen)
+{
+    T_KRTable *ptTable = kr_table_get(ptDB, iTableId);
+    if (ptTable == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_table_get [%d] Error!", iTableId);
+        return -1;
+    }
 
+    return kr_table_shard_of(ptTable, pRecBuf, ulLen);
+}
@@ -3,6 +3,12 @@
 
 #include "kr_db_define.h"
 #include "kr_db_internal.h"
+#include "kr_db_ingest.h"
+#include "kr_db_store.h"
+#include "kr_db_persist.h"
+#include "kr_db_select.h"
+#include "kr_db_cursor.h"
+#include "kr_db_column.h"
 #include "kr_db_external.h"
 
 
@@ -10,6 +16,7 @@ extern T_KRDB* kr_db_new(char *psDBName, T_DbsEnv *ptDbsEnv, T_KRModule *ptModul
 extern void kr_db_free(T_KRDB *ptDB);
 
 extern int kr_db_insert(T_KRDB *ptDB, T_KRRecord *ptRecord);
-extern T_KRList* kr_db_select(T_KRDB *ptDB, int iIndexId, void *key, time_t tBeginTime, time_t tEndTime, int iSortFieldId);
+extern int kr_db_ingest(T_KRDB *ptDB, int iTableId, char *pRecBuf, size_t ulLen, T_KRRecord **pptRecord);
+extern int kr_db_shard_of(T_KRDB *ptDB, int iTableId, char *pRecBuf, size_t ulLen);
 
 #endif /* __KR_DB_H__ */
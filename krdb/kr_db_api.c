@@ -8,6 +8,56 @@ cJSON *kr_db_info(T_KRDB *krdb)
 			kr_list_length(krdb->pTableList));
 	cJSON_AddNumberToObject(db, "index_number", 
 			kr_list_length(krdb->pIndexList));
+
+	/*sizes of shards, records of tables and keys of indexes*/
+	cJSON *tables = cJSON_CreateArray();
+	T_KRListNode *node = krdb->pTableList->head;
+	for (; node; node=node->next) {
+		T_KRTable *krtable = (T_KRTable *)kr_list_value(node);
+		cJSON *table = cJSON_CreateObject();
+		cJSON_AddNumberToObject(table, "id", krtable->iTableId);
+		cJSON *shards = cJSON_CreateArray();
+		for (int i=0; i<krtable->iShardCnt; i++) {
+			cJSON_AddItemToArray(shards, 
+					cJSON_CreateNumber(krtable->ptShard[i].uiRecordNum));
+		}
+		cJSON_AddItemToObject(table, "shard_records", shards);
+		cJSON_AddItemToArray(tables, table);
+	}
+	cJSON_AddItemToObject(db, "tables", tables);
+
+	cJSON *indexes = cJSON_CreateArray();
+	for (node = krdb->pIndexList->head; node; node=node->next) {
+		T_KRIndex *krindex = (T_KRIndex *)kr_list_value(node);
+		cJSON *index = cJSON_CreateObject();
+		cJSON_AddNumberToObject(index, "id", krindex->iIndexId);
+		cJSON *shards = cJSON_CreateArray();
+		for (int i=0; i<krindex->iShardCnt; i++) {
+			cJSON_AddItemToArray(shards, cJSON_CreateNumber(
+					kr_keytable_size(krindex->ptShard[i].ptKeyTable)));
+		}
+		cJSON_AddItemToObject(index, "shard_keys", shards);
+		cJSON_AddItemToArray(indexes, index);
+	}
+	cJSON_AddItemToObject(db, "indexes", indexes);
+
+	/*write-behind to the database*/
+	T_KRPersist *krpersist = krdb->ptPersist;
+	if (krpersist != NULL) {
+		cJSON *persist = cJSON_CreateObject();
+		cJSON_AddNumberToObject(persist, "queued", krpersist->ulTail);
+		cJSON_AddNumberToObject(persist, "pending", 
+				krpersist->ulTail - krpersist->ulHead);
+		cJSON_AddNumberToObject(persist, "dropped", krpersist->ulDropped);
+		cJSON_AddNumberToObject(persist, "committed", krpersist->ulCommitted);
+		cJSON_AddNumberToObject(persist, "batches", krpersist->ulBatches);
+		cJSON_AddNumberToObject(persist, "retries", krpersist->ulRetries);
+		cJSON_AddNumberToObject(persist, "failed", krpersist->ulFailed);
+		cJSON_AddNumberToObject(persist, "last_commit", krpersist->tLastCommit);
+		cJSON_AddNumberToObject(persist, "last_flush_usec", 
+				krpersist->lLastFlushUsec);
+		cJSON_AddItemToObject(db, "persist", persist);
+	}
 	return db;
 }
 
@@ -22,6 +72,36 @@ cJSON *kr_db_table_info(T_KRTable *krtable)
 	cJSON_AddNumberToObject(table, "record_size", krtable->iRecordSize);
 	cJSON_AddNumberToObject(table, "record_number", krtable->uiRecordNum);
 	cJSON_AddNumberToObject(table, "record_location", krtable->uiRecordLoc);
+	if (krtable->ptStore != NULL) {
+		cJSON_AddStringToObject(table, "store_path", krtable->ptStore->caPath);
+		cJSON_AddNumberToObject(table, "store_remapped", krtable->ptStore->uiRemapped);
+	}
+	if (krtable->eKeepMode == KR_SIZEKEEPMODE_TIME) {
+		cJSON_AddNumberToObject(table, "segment_number", 
+				krtable->uiSegNext - krtable->uiSegHead);
+		cJSON_AddNumberToObject(table, "segment_alloc", krtable->ulSegAllocCnt);
+		cJSON_AddNumberToObject(table, "segment_free", krtable->ulSegFreeCnt);
+	}
+	cJSON_AddNumberToObject(table, "transtime_slack", krtable->lTransTimeSlack);
+	cJSON_AddNumberToObject(table, "late_policy", krtable->eLatePolicy);
+	cJSON_AddNumberToObject(table, "allowed_lateness", krtable->lAllowedLateness);
+	cJSON_AddNumberToObject(table, "watermark", krtable->tWatermark);
+	cJSON_AddNumberToObject(table, "late_count", krtable->ulLateCnt);
+	/*of the write domain, shared by tables indexed together*/
+	cJSON_AddNumberToObject(table, "ingest_applied", krtable->ptIngest->ulApplied);
+	cJSON_AddNumberToObject(table, "ingest_batches", krtable->ptIngest->ulBatches);
+
+	cJSON *shards = cJSON_CreateArray();
+	for (int i=0; i<krtable->iShardCnt; i++) {
+		T_KRTableShard *ptShard = &krtable->ptShard[i];
+		cJSON *shard = cJSON_CreateObject();
+		cJSON_AddNumberToObject(shard, "record_base", ptShard->uiRecordBase);
+		cJSON_AddNumberToObject(shard, "record_capacity", ptShard->uiRecordCap);
+		cJSON_AddNumberToObject(shard, "record_number", ptShard->uiRecordNum);
+		cJSON_AddNumberToObject(shard, "record_location", ptShard->uiRecordLoc);
+		cJSON_AddItemToArray(shards, shard);
+	}
+	cJSON_AddItemToObject(table, "shards", shards);
 
 	cJSON *fields = cJSON_CreateArray();
 	T_KRFieldDef *ptFieldDef = &krtable->ptFieldDef[0];
@@ -43,6 +123,7 @@ cJSON *kr_db_index_info(T_KRIndex *krindex)
 	cJSON_AddNumberToObject(index, "id", krindex->iIndexId);
 	cJSON_AddStringToObject(index, "name", krindex->caIndexName);
 	cJSON_AddNumberToObject(index, "field_type", krindex->eIndexFieldType);
+	cJSON_AddNumberToObject(index, "shard_count", krindex->iShardCnt);
 	return index;
 }
 
@@ -0,0 +1,279 @@
+#include "kr_db_column.h"
+
+
+/* mirror a numeric field of this index table's records per key,
+ * appended to every slot's columns from the next insert of its key,
+ * return the column location in the table's columns, -1 if failed
+ */
+int kr_index_column_register(T_KRIndexTable *ptIndexTable, int iFieldId)
+{
+    T_KRTable *ptTable = ptIndexTable->ptTable;
+    int iColumnId = -1;
+
+    if (iFieldId < 0 || iFieldId >= ptTable->iFieldCnt) {
+        KR_LOG(KR_LOGERROR, "table [%d] field [%d] not found!", \
+                ptTable->iTableId, iFieldId);
+        return -1;
+    }
+    E_KRType eType = ptTable->ptFieldDef[iFieldId].type;
+    if (eType != KR_TYPE_INT && eType != KR_TYPE_LONG &&
+        eType != KR_TYPE_DOUBLE) {
+        KR_LOG(KR_LOGERROR, "table [%d] field [%d] type [%c] not numeric!", \
+                ptTable->iTableId, iFieldId, eType);
+        return -1;
+    }
+
+    kr_table_lock(ptTable);
+    for (int i=0; i<ptIndexTable->iColumnDefCnt; i++) {
+        if (ptIndexTable->ptColumnDef[i].iFieldId == iFieldId) {
+            iColumnId = i;
+            goto UNLOCK;
+        }
+    }
+
+    /*appended to a copy, the writer may be reading the old one*/
+    int iDefCnt = ptIndexTable->iColumnDefCnt;
+    T_KRColumnDef *ptColumnDefs = kr_calloc(sizeof(T_KRColumnDef)*(iDefCnt+1));
+    if (ptColumnDefs == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptColumnDef failed!");
+        goto UNLOCK;
+    }
+    if (iDefCnt > 0) {
+        memcpy(ptColumnDefs, ptIndexTable->ptColumnDef,
+                sizeof(T_KRColumnDef)*iDefCnt);
+    }
+    ptColumnDefs[iDefCnt].iFieldId = iFieldId;
+    ptColumnDefs[iDefCnt].eType = eType;
+    if (ptIndexTable->iColumnsId < 0) {
+        ptIndexTable->iColumnsId = \
+            __sync_fetch_and_add(&ptIndexTable->ptIndex->iColumnsCnt, 1);
+    }
+    kr_epoch_retire(ptTable->ptDB->ptEpoch, ptIndexTable->ptColumnDef, kr_free);
+    ptIndexTable->ptColumnDef = ptColumnDefs;
+    __sync_synchronize();
+    ptIndexTable->iColumnDefCnt++;
+    iColumnId = iDefCnt;
+
+UNLOCK:
+    kr_table_unlock(ptTable);
+    return iColumnId;
+}
+
+
+void kr_columns_free(T_KRColumns *ptColumns)
+{
+    if (ptColumns == NULL) return;
+
+    for (int i=0; i<ptColumns->iFieldCnt; i++) {
+        kr_free(ptColumns->ppValue[i]);
+    }
+    kr_free(ptColumns->ppValue);
+    kr_free(ptColumns->ptTransTime);
+    kr_free(ptColumns->pptRecord);
+    kr_free(ptColumns);
+}
+
+
+/*resize every array to uiCap entries*/
+static int kr_columns_resize(T_KRColumns *ptColumns, unsigned int uiCap)
+{
+    void *p = kr_realloc(ptColumns->pptRecord, sizeof(T_KRRecord *)*uiCap);
+    if (p == NULL) return -1;
+    ptColumns->pptRecord = p;
+    p = kr_realloc(ptColumns->ptTransTime, sizeof(time_t)*uiCap);
+    if (p == NULL) return -1;
+    ptColumns->ptTransTime = p;
+    for (int i=0; i<ptColumns->iFieldCnt; i++) {
+        /*long and double are both 8 bytes*/
+        p = kr_realloc(ptColumns->ppValue[i], sizeof(long)*uiCap);
+        if (p == NULL) return -1;
+        ptColumns->ppValue[i] = p;
+    }
+    ptColumns->uiCap = uiCap;
+    return 0;
+}
+
+
+/*make room for one more at the end, moved down if half removed*/
+static int kr_columns_reserve(T_KRColumns *ptColumns)
+{
+    if (ptColumns->uiHead + ptColumns->uiCnt < ptColumns->uiCap) {
+        return 0;
+    }
+    if (ptColumns->uiHead < ptColumns->uiCap/2) {
+        return kr_columns_resize(ptColumns, ptColumns->uiCap*2);
+    }
+
+    unsigned int uiHead = ptColumns->uiHead;
+    unsigned int uiCnt = ptColumns->uiCnt;
+    memmove(ptColumns->pptRecord, ptColumns->pptRecord+uiHead,
+            sizeof(T_KRRecord *)*uiCnt);
+    memmove(ptColumns->ptTransTime, ptColumns->ptTransTime+uiHead,
+            sizeof(time_t)*uiCnt);
+    for (int i=0; i<ptColumns->iFieldCnt; i++) {
+        long *plValue = (long *)ptColumns->ppValue[i];
+        memmove(plValue, plValue+uiHead, sizeof(long)*uiCnt);
+    }
+    ptColumns->uiHead = 0;
+    return 0;
+}
+
+
+static int kr_columns_add(T_KRColumns *ptColumns,
+        T_KRColumnDef *ptColumnDef, T_KRRecord *ptRecord)
+{
+    if (kr_columns_reserve(ptColumns) != 0) {
+        return -1;
+    }
+
+    unsigned int uiPos = ptColumns->uiHead + ptColumns->uiCnt;
+    ptColumns->pptRecord[uiPos] = ptRecord;
+    ptColumns->ptTransTime[uiPos] = kr_get_transtime(ptRecord);
+    for (int i=0; i<ptColumns->iFieldCnt; i++) {
+        void *val = kr_field_get_value(ptRecord, ptColumnDef[i].iFieldId);
+        switch(ptColumnDef[i].eType)
+        {
+            case KR_TYPE_INT:
+                ((long *)ptColumns->ppValue[i])[uiPos] = *(int *)val;
+                break;
+            case KR_TYPE_LONG:
+                ((long *)ptColumns->ppValue[i])[uiPos] = *(long *)val;
+                break;
+            default:
+                ((double *)ptColumns->ppValue[i])[uiPos] = *(double *)val;
+                break;
+        }
+    }
+    ptColumns->uiCnt++;
+    return 0;
+}
+
+
+/* columns of iDefCnt defs for the table's records in the slot's list,
+ * NULL if failed
+ */
+static T_KRColumns *kr_columns_build(T_KRIndexTable *ptIndexTable,
+        T_KRIndexSolt *ptIndexSlot, T_KRColumnDef *ptColumnDef, int iDefCnt)
+{
+    T_KRColumns *ptColumns = kr_calloc(sizeof(T_KRColumns));
+    if (ptColumns == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptColumns failed!");
+        return NULL;
+    }
+    ptColumns->ppValue = kr_calloc(sizeof(void *)*iDefCnt);
+    if (ptColumns->ppValue == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ppValue failed!");
+        kr_free(ptColumns);
+        return NULL;
+    }
+    ptColumns->iFieldCnt = iDefCnt;
+
+    unsigned int uiCap = KR_COLUMNS_MIN_CAP;
+    while (uiCap <= kr_list_length(ptIndexSlot->pRecList)) uiCap *= 2;
+    if (kr_columns_resize(ptColumns, uiCap) != 0) {
+        KR_LOG(KR_LOGERROR, "kr_columns_resize [%u] failed!", uiCap);
+        kr_columns_free(ptColumns);
+        return NULL;
+    }
+
+    T_KRListNode *node = ptIndexSlot->pRecList->head;
+    for (; node; node=node->next) {
+        T_KRRecord *ptRecord = (T_KRRecord *)kr_list_value(node);
+        if (ptRecord->ptTable != ptIndexTable->ptTable) continue;
+        kr_columns_add(ptColumns, ptColumnDef, ptRecord);
+    }
+    return ptColumns;
+}
+
+
+/* mirror ptRecord into the slot's columns of its table, before it is
+ * added to the slot's list, columns built again from the list if fields
+ * registered since, dropped if out of memory until the next insert
+ */
+void kr_columns_append(T_KRIndexTable *ptIndexTable,
+        T_KRIndexSolt *ptIndexSlot, T_KRRecord *ptRecord)
+{
+    /*defs before the count, see kr_index_column_register*/
+    int iDefCnt = ptIndexTable->iColumnDefCnt;
+    __sync_synchronize();
+    T_KRColumnDef *ptColumnDef = ptIndexTable->ptColumnDef;
+    int iColumnsId = ptIndexTable->iColumnsId;
+
+    /*column groups registered after this slot created*/
+    int iColumnsCnt = ptIndexTable->ptIndex->iColumnsCnt;
+    if (ptIndexSlot->iColumnsCnt < iColumnsCnt) {
+        T_KRColumns **pptColumns = kr_realloc(ptIndexSlot->pptColumns,
+                sizeof(T_KRColumns *)*iColumnsCnt);
+        if (pptColumns == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_realloc pptColumns failed!");
+            return;
+        }
+        memset(&pptColumns[ptIndexSlot->iColumnsCnt], 0x00,
+                sizeof(T_KRColumns *)*(iColumnsCnt-ptIndexSlot->iColumnsCnt));
+        ptIndexSlot->pptColumns = pptColumns;
+        ptIndexSlot->iColumnsCnt = iColumnsCnt;
+    }
+
+    T_KRColumns **pptColumns = &ptIndexSlot->pptColumns[iColumnsId];
+    if (*pptColumns == NULL || (*pptColumns)->iFieldCnt < iDefCnt) {
+        kr_columns_free(*pptColumns);
+        *pptColumns = kr_columns_build(ptIndexTable, ptIndexSlot,
+                ptColumnDef, iDefCnt);
+        if (*pptColumns == NULL) return;
+    }
+    if (kr_columns_add(*pptColumns, ptColumnDef, ptRecord) != 0) {
+        KR_LOG(KR_LOGERROR, "kr_columns_add failed, columns dropped!");
+        kr_columns_free(*pptColumns);
+        *pptColumns = NULL;
+    }
+}
+
+
+/* drop ptRecord from the slot's columns of its table, it's nearly
+ * always the first, those before it are moved up by one
+ */
+void kr_columns_remove(T_KRIndexTable *ptIndexTable,
+        T_KRIndexSolt *ptIndexSlot, T_KRRecord *ptRecord)
+{
+    int iColumnsId = ptIndexTable->iColumnsId;
+    if (iColumnsId < 0 || iColumnsId >= ptIndexSlot->iColumnsCnt) return;
+    T_KRColumns *ptColumns = ptIndexSlot->pptColumns[iColumnsId];
+    if (ptColumns == NULL) return;
+
+    T_KRRecord **pptRecord = kr_columns_record(ptColumns);
+    unsigned int i = 0;
+    while (i < ptColumns->uiCnt && pptRecord[i] != ptRecord) i++;
+    if (i == ptColumns->uiCnt) return;
+
+    unsigned int uiHead = ptColumns->uiHead;
+    if (i > 0) {
+        memmove(ptColumns->pptRecord+uiHead+1, ptColumns->pptRecord+uiHead,
+                sizeof(T_KRRecord *)*i);
+        memmove(ptColumns->ptTransTime+uiHead+1, ptColumns->ptTransTime+uiHead,
+                sizeof(time_t)*i);
+        for (int j=0; j<ptColumns->iFieldCnt; j++) {
+            long *plValue = (long *)ptColumns->ppValue[j];
+            memmove(plValue+uiHead+1, plValue+uiHead, sizeof(long)*i);
+        }
+    }
+    ptColumns->uiHead++;
+    ptColumns->uiCnt--;
+    if (ptColumns->uiCnt == 0) ptColumns->uiHead = 0;
+}
+
+
+/* lock key's slot and return its columns of this index table,
+ * NULL if not built yet, *pptIndexSlot released by the caller if set
+ */
+T_KRColumns *kr_index_columns_hold(T_KRIndexTable *ptIndexTable,
+        void *key, T_KRIndexSolt **pptIndexSlot)
+{
+    T_KRIndexSolt *ptIndexSlot = kr_index_slot_hold(ptIndexTable->ptIndex, key);
+    *pptIndexSlot = ptIndexSlot;
+    int iColumnsId = ptIndexTable->iColumnsId;
+    if (ptIndexSlot == NULL || iColumnsId < 0 ||
+        iColumnsId >= ptIndexSlot->iColumnsCnt) {
+        return NULL;
+    }
+    return ptIndexSlot->pptColumns[iColumnsId];
+}
@@ -0,0 +1,56 @@
+#ifndef __KR_DB_COLUMN_H__
+#define __KR_DB_COLUMN_H__
+
+#include "kr_db_internal.h"
+
+/*columns allocated at least, doubled when full*/
+#define KR_COLUMNS_MIN_CAP   16
+
+/* numeric fields of an index table's records mirrored per key, in
+ * insertion order like the slot's list, packed from uiHead so that
+ * aggregations run over them without touching the rows,
+ * changed only by the table's writer under the slot's lock
+ */
+struct _kr_columns_t
+{
+    int              iFieldCnt;         /* defs mirrored when built */
+    unsigned int     uiHead;            /* first kept */
+    unsigned int     uiCnt;             /* kept */
+    unsigned int     uiCap;             /* allocated */
+    T_KRRecord       **pptRecord;       /* rows, for filters and related */
+    time_t           *ptTransTime;
+    void             **ppValue;         /* per def, long or double */
+};
+
+static inline T_KRRecord **kr_columns_record(T_KRColumns *ptColumns)
+{
+    return ptColumns->pptRecord + ptColumns->uiHead;
+}
+
+static inline time_t *kr_columns_transtime(T_KRColumns *ptColumns)
+{
+    return ptColumns->ptTransTime + ptColumns->uiHead;
+}
+
+/*values of an INT or LONG field*/
+static inline long *kr_columns_long(T_KRColumns *ptColumns, int iColumnId)
+{
+    return (long *)ptColumns->ppValue[iColumnId] + ptColumns->uiHead;
+}
+
+/*values of a DOUBLE field*/
+static inline double *kr_columns_double(T_KRColumns *ptColumns, int iColumnId)
+{
+    return (double *)ptColumns->ppValue[iColumnId] + ptColumns->uiHead;
+}
+
+extern int kr_index_column_register(T_KRIndexTable *ptIndexTable, int iFieldId);
+extern T_KRColumns *kr_index_columns_hold(T_KRIndexTable *ptIndexTable,
+        void *key, T_KRIndexSolt **pptIndexSlot);
+extern void kr_columns_append(T_KRIndexTable *ptIndexTable,
+        T_KRIndexSolt *ptIndexSlot, T_KRRecord *ptRecord);
+extern void kr_columns_remove(T_KRIndexTable *ptIndexTable,
+        T_KRIndexSolt *ptIndexSlot, T_KRRecord *ptRecord);
+extern void kr_columns_free(T_KRColumns *ptColumns);
+
+#endif /* __KR_DB_COLUMN_H__ */
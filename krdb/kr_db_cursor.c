@@ -0,0 +1,163 @@
+#include "kr_db_cursor.h"
+#include <limits.h>
+
+
+/* walk key's records of ptIndex in direction eDir,
+ * every transtime and table until set otherwise
+ */
+void kr_db_cursor_init(T_KRDBCursor *ptCursor, T_KRIndex *ptIndex,
+        void *key, E_KRCursorDir eDir)
+{
+    memset(ptCursor, 0x00, sizeof(T_KRDBCursor));
+    ptCursor->ptIndex = ptIndex;
+    ptCursor->key = key;
+    ptCursor->eDir = eDir;
+    ptCursor->tBeginTime = 0;
+    ptCursor->tEndTime = (time_t )LONG_MAX;
+    ptCursor->bEnd = (ptIndex == NULL || key == NULL);
+}
+
+
+/* only records with transtime in [tBeginTime, tEndTime], bStopEarly
+ * ends the walk at a record past the range by more than the table's
+ * lTransTimeSlack, only with a table set since it holds per table
+ */
+void kr_db_cursor_set_range(T_KRDBCursor *ptCursor,
+        time_t tBeginTime, time_t tEndTime, kr_bool bStopEarly)
+{
+    ptCursor->tBeginTime = tBeginTime;
+    ptCursor->tEndTime = tEndTime;
+    ptCursor->bStopEarly = bStopEarly;
+}
+
+
+void kr_db_cursor_set_table(T_KRDBCursor *ptCursor, T_KRTable *ptTable)
+{
+    ptCursor->ptTable = ptTable;
+}
+
+
+static inline T_KRListNode *kr_cursor_step(T_KRDBCursor *ptCursor,
+        T_KRListNode *node)
+{
+    return ptCursor->eDir == KR_CURSOR_FORWARD ? node->next : node->prev;
+}
+
+
+static inline T_KRListNode *kr_cursor_start(T_KRDBCursor *ptCursor,
+        T_KRIndexSolt *ptIndexSlot)
+{
+    return ptCursor->eDir == KR_CURSOR_FORWARD ? \
+        ptIndexSlot->pRecList->head : ptIndexSlot->pRecList->tail;
+}
+
+
+/*node to examine next in the slot held, NULL if the walk can't go on*/
+static T_KRListNode *kr_cursor_resume(T_KRDBCursor *ptCursor,
+        T_KRIndexSolt *ptIndexSlot)
+{
+    if (ptCursor->ptLast == NULL) {
+        return kr_cursor_start(ptCursor, ptIndexSlot);
+    }
+    /*the slot walked was removed, its records with it*/
+    if (ptIndexSlot != ptCursor->ptIndexSlot) {
+        return NULL;
+    }
+    if (ptIndexSlot->ulRemoveStamp == ptCursor->ulRemoveStamp) {
+        return ptCursor->ptNode;
+    }
+
+    /*the node left may be freed, find the record examined last again*/
+    T_KRListNode *node = kr_cursor_start(ptCursor, ptIndexSlot);
+    for (; node; node=kr_cursor_step(ptCursor, node)) {
+        if (kr_list_value(node) == ptCursor->ptLast) {
+            return kr_cursor_step(ptCursor, node);
+        }
+    }
+    return NULL;
+}
+
+
+/*whether no record after one of tTransTime in this direction is in range*/
+static inline int kr_cursor_passed(T_KRDBCursor *ptCursor,
+        time_t tTransTime)
+{
+    long lSlack = ptCursor->ptTable->lTransTimeSlack;
+    if (ptCursor->eDir == KR_CURSOR_FORWARD) {
+        return tTransTime > ptCursor->tEndTime + lSlack;
+    } else {
+        return tTransTime < ptCursor->tBeginTime - lSlack;
+    }
+}
+
+
+/*refer to the next batch of records under the slot's lock*/
+static void kr_cursor_fill(T_KRDBCursor *ptCursor)
+{
+    ptCursor->iCnt = 0;
+    ptCursor->iPos = 0;
+    if (ptCursor->bEnd) return;
+
+    T_KRIndexSolt *ptIndexSlot = \
+        kr_index_slot_hold(ptCursor->ptIndex, ptCursor->key);
+    if (ptIndexSlot == NULL) {
+        ptCursor->bEnd = TRUE;
+        return;
+    }
+
+    T_KRListNode *node = kr_cursor_resume(ptCursor, ptIndexSlot);
+    while (node && ptCursor->iCnt < KR_CURSOR_BATCH) {
+        T_KRRecord *ptRecord = (T_KRRecord *)kr_list_value(node);
+        ptCursor->ptLast = ptRecord;
+        node = kr_cursor_step(ptCursor, node);
+
+        if (ptCursor->ptTable != NULL && ptRecord->ptTable != ptCursor->ptTable) {
+            continue;
+        }
+        time_t tTransTime = kr_get_transtime(ptRecord);
+        if (tTransTime < ptCursor->tBeginTime ||
+                tTransTime > ptCursor->tEndTime) {
+            if (ptCursor->bStopEarly && ptCursor->ptTable != NULL &&
+                    kr_cursor_passed(ptCursor, tTransTime)) {
+                node = NULL;
+            }
+            continue;
+        }
+        if (kr_record_ref_set(&ptCursor->stRef[ptCursor->iCnt], ptRecord) == 0) {
+            ptCursor->iCnt++;
+        }
+    }
+
+    ptCursor->ptIndexSlot = ptIndexSlot;
+    ptCursor->ulRemoveStamp = ptIndexSlot->ulRemoveStamp;
+    ptCursor->ptNode = node;
+    ptCursor->bEnd = (node == NULL);
+    kr_index_slot_release(ptIndexSlot);
+}
+
+
+/* copy of the key's next record, valid until the next call 
+ * or the cursor closed, NULL when the walk ends
+ */
+T_KRRecord *kr_db_cursor_next(T_KRDBCursor *ptCursor)
+{
+    for (;;) {
+        if (ptCursor->iPos >= ptCursor->iCnt) {
+            kr_cursor_fill(ptCursor);
+            if (ptCursor->iCnt == 0) return NULL;
+        }
+        T_KRRecord *ptRecord = kr_record_ref_read(\
+                &ptCursor->stRef[ptCursor->iPos++], ptCursor->ptIndex, 
+                ptCursor->key, &ptCursor->pCopy, &ptCursor->ulCopySize);
+        if (ptRecord != NULL) return ptRecord;
+    }
+}
+
+
+/*free the copy of the record handed out last*/
+void kr_db_cursor_close(T_KRDBCursor *ptCursor)
+{
+    kr_free(ptCursor->pCopy);
+    ptCursor->pCopy = NULL;
+    ptCursor->ulCopySize = 0;
+}
@@ -0,0 +1,48 @@
+#ifndef __KR_DB_CURSOR_H__
+#define __KR_DB_CURSOR_H__
+
+#include "kr_db_internal.h"
+
+#define KR_CURSOR_BATCH 32
+
+typedef enum {
+    KR_CURSOR_FORWARD      = 0,   /*inserted earliest first*/
+    KR_CURSOR_REVERSE      = 1    /*inserted latest first*/
+}E_KRCursorDir;
+
+/* records of an index key kept in memory, on the caller's stack:
+ * up to KR_CURSOR_BATCH records are referred to under the slot's lock
+ * and read one at a time after it released, so cursors may nest, 
+ * one rewritten meanwhile is skipped, the next batch resumes 
+ * from the node left unless a record of the slot removed since
+ */
+typedef struct _kr_db_cursor_t
+{
+    T_KRIndex        *ptIndex;
+    void             *key;             /* the caller's, while walking */
+    T_KRTable        *ptTable;         /* only its records, NULL for all */
+    time_t           tBeginTime;
+    time_t           tEndTime;
+    E_KRCursorDir    eDir;
+    kr_bool          bStopEarly;       /* stop once past the range */
+    T_KRIndexSolt    *ptIndexSlot;     /* compared only, never dereferenced */
+    unsigned long    ulRemoveStamp;    /* of the slot when batch copied */
+    T_KRListNode     *ptNode;          /* next to examine, NULL at the end */
+    T_KRRecord       *ptLast;          /* examined last */
+    kr_bool          bEnd;
+    int              iCnt;
+    int              iPos;
+    T_KRRecordRef    stRef[KR_CURSOR_BATCH];
+    char             *pCopy;           /* record handed out last */
+    size_t           ulCopySize;
+}T_KRDBCursor;
+
+extern void kr_db_cursor_init(T_KRDBCursor *ptCursor, T_KRIndex *ptIndex,
+        void *key, E_KRCursorDir eDir);
+extern void kr_db_cursor_set_range(T_KRDBCursor *ptCursor,
+        time_t tBeginTime, time_t tEndTime, kr_bool bStopEarly);
+extern void kr_db_cursor_set_table(T_KRDBCursor *ptCursor, T_KRTable *ptTable);
+extern T_KRRecord *kr_db_cursor_next(T_KRDBCursor *ptCursor);
+extern void kr_db_cursor_close(T_KRDBCursor *ptCursor);
+
+#endif /* __KR_DB_CURSOR_H__ */
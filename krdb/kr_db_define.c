@@ -84,6 +84,10 @@ int _kr_table_load_field_def(T_KRTable *ptTable, T_DbsEnv *dbsenv)
     /*compute record size, alloc record buffer*/
     ptTable->iRecordSize = sizeof(T_KRRecord)+ulFieldOffset;
     ptTable->iRecordSize = KR_MEMALIGN(ptTable->iRecordSize);
+    /*records kept by time are allocated in segments while inserting*/
+    if (ptTable->eKeepMode == KR_SIZEKEEPMODE_TIME) {
+        return iFlag;
+    }
     ptTable->pRecordBuff = \
         (char *)kr_calloc(ptTable->iRecordSize*ptTable->lKeepValue);
     if (ptTable->pRecordBuff == NULL) {
@@ -4,6 +4,7 @@
 #include "dbs/dbs/record_ins.h"
 #include "dbs/dbs/record_proctime_cur.h"
 #include "dbs/dbs/record_transtime_cur.h"
+#include "dbs/dbs/record_key_cur.h"
 
 
 static int kr_db_external_select_with_transtime(T_KRList *pRecList, 
@@ -128,6 +129,46 @@ static int kr_db_external_select_with_proctime(T_KRList *pRecList,
 }
 
 
+/*KEY_VALUE of a field's value, strings cut to the column*/
+static void kr_db_external_key_value(T_KRFieldDef *ptFieldDef, void *val,
+        char *psKeyValue)
+{
+    switch(ptFieldDef->type) {
+    case KR_TYPE_INT:
+        snprintf(psKeyValue, KR_EXTERNAL_KEY_SIZE+1, "%d", *(int *)val);
+        break;
+    case KR_TYPE_LONG:
+        snprintf(psKeyValue, KR_EXTERNAL_KEY_SIZE+1, "%ld", *(long *)val);
+        break;
+    case KR_TYPE_DOUBLE:
+        snprintf(psKeyValue, KR_EXTERNAL_KEY_SIZE+1, "%.17g", *(double *)val);
+        break;
+    case KR_TYPE_STRING:
+        snprintf(psKeyValue, KR_EXTERNAL_KEY_SIZE+1, "%.*s", 
+                ptFieldDef->length, (char *)val);
+        break;
+    default:
+        psKeyValue[0] = '\0';
+        break;
+    }
+}
+
+
+/* KEY_VALUE of a row of ptTable, the key of its first index, 
+ * the only one its rows can be selected by, empty if none
+ */
+void kr_db_external_key(T_KRTable *ptTable, char *pRecBuf, char *psKeyValue)
+{
+    psKeyValue[0] = '\0';
+    if (kr_list_length(ptTable->pIndexTableList) == 0) return;
+
+    T_KRIndexTable *ptIndexTable = \
+        (T_KRIndexTable *)kr_list_value(ptTable->pIndexTableList->head);
+    T_KRFieldDef *ptFieldDef = &ptTable->ptFieldDef[ptIndexTable->iIndexFieldId];
+    kr_db_external_key_value(ptFieldDef, pRecBuf+ptFieldDef->offset, psKeyValue);
+}
+
+
 int kr_db_external_insert(T_KRRecord *ptRecord, T_DbsEnv *dbsenv)
 {
     int iResult = 0;
@@ -136,6 +177,8 @@ int kr_db_external_insert(T_KRRecord *ptRecord, T_DbsEnv *dbsenv)
     stRecordIns.lInDatasrcId = ptRecord->ptTable->iTableId;
     stRecordIns.lInProcTime = kr_get_proctime(ptRecord);
     stRecordIns.lInTransTime = kr_get_transtime(ptRecord);
+    kr_db_external_key(ptRecord->ptTable, ptRecord->pRecBuf, 
+            stRecordIns.caInKeyValue);
     stRecordIns.lInRecordLength = \
         ptRecord->ptTable->iRecordSize-sizeof(T_KRRecord);
     memcpy(stRecordIns.caInRecordBuffer, ptRecord->pRecBuf, 
@@ -151,6 +194,179 @@ int kr_db_external_insert(T_KRRecord *ptRecord, T_DbsEnv *dbsenv)
 }
 
 
+/* insert iRows rows ulStride bytes apart with one execute, 
+ * parameters bound row-wise to the rows themselves, not committed,
+ * return 0 if all inserted, -1 if failed
+ */
+int kr_db_external_insert_rows(T_KRExternalRow *ptRows, size_t ulStride,
+        int iRows, T_DbsEnv *dbsenv)
+{
+    static char *psSql = "insert into kr_tbl_record "
+        "(DATASRC_ID, PROC_TIME, TRANS_TIME, KEY_VALUE, "
+        "RECORD_LENGTH, RECORD_BUFFER) values (?, ?, ?, ?, ?, ?)";
+    SQLHSTMT hstmt = SQL_NULL_HSTMT;
+    SQLULEN ulProcessed = 0;
+
+    SQLRETURN rc = SQLAllocHandle(SQL_HANDLE_STMT, dbsenv->hdbc, &hstmt);
+    if (!SQL_SUCCEEDED(rc)) {
+        KR_LOG(KR_LOGERROR, "SQLAllocHandle STMT Error[%d]!", rc);
+        return -1;
+    }
+
+    rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PARAM_BIND_TYPE, 
+            (SQLPOINTER )ulStride, 0);
+    if (SQL_SUCCEEDED(rc)) {
+        rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE, 
+                (SQLPOINTER )(SQLULEN )iRows, 0);
+    }
+    if (SQL_SUCCEEDED(rc)) {
+        rc = SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR, 
+                &ulProcessed, 0);
+    }
+    if (SQL_SUCCEEDED(rc)) {
+        rc = SQLPrepare(hstmt, (SQLCHAR *)psSql, SQL_NTS);
+    }
+    if (SQL_SUCCEEDED(rc)) {
+        rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_SBIGINT, 
+                SQL_BIGINT, 0, 0, &ptRows->lDatasrcId, 0, NULL);
+    }
+    if (SQL_SUCCEEDED(rc)) {
+        rc = SQLBindParameter(hstmt, 2, SQL_PARAM_INPUT, SQL_C_SBIGINT, 
+                SQL_BIGINT, 0, 0, &ptRows->lProcTime, 0, NULL);
+    }
+    if (SQL_SUCCEEDED(rc)) {
+        rc = SQLBindParameter(hstmt, 3, SQL_PARAM_INPUT, SQL_C_SBIGINT, 
+                SQL_BIGINT, 0, 0, &ptRows->lTransTime, 0, NULL);
+    }
+    if (SQL_SUCCEEDED(rc)) {
+        rc = SQLBindParameter(hstmt, 4, SQL_PARAM_INPUT, SQL_C_CHAR, 
+                SQL_CHAR, KR_EXTERNAL_KEY_SIZE, 0, ptRows->caKeyValue, 
+                KR_EXTERNAL_KEY_SIZE+1, &ptRows->iKeyInd);
+    }
+    if (SQL_SUCCEEDED(rc)) {
+        rc = SQLBindParameter(hstmt, 5, SQL_PARAM_INPUT, SQL_C_SBIGINT, 
+                SQL_BIGINT, 0, 0, &ptRows->lRecordLength, 0, NULL);
+    }
+    if (SQL_SUCCEEDED(rc)) {
+        rc = SQLBindParameter(hstmt, 6, SQL_PARAM_INPUT, SQL_C_CHAR, 
+                SQL_CHAR, KR_EXTERNAL_RECORD_SIZE, 0, ptRows->caRecordBuffer, 
+                KR_EXTERNAL_RECORD_SIZE, &ptRows->iRecordInd);
+    }
+    if (SQL_SUCCEEDED(rc)) {
+        rc = SQLExecute(hstmt);
+    }
+    if (!SQL_SUCCEEDED(rc)) {
+        dbsGetError(dbsenv, hstmt);
+        KR_LOG(KR_LOGERROR, "insert [%d] rows Error[%d], [%lu] processed![%s]:[%s]",
+                iRows, rc, (unsigned long )ulProcessed, 
+                dbsenv->sqlstate, dbsenv->sqlerrmsg);
+        SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+        return -1;
+    }
+
+    SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+    return 0;
+}
+
+
+struct _kr_external_cursor_t
+{
+    T_KRTable             *ptTable;
+    T_DbsEnv              *dbsenv;
+    T_RecordKeyCur        stRecordKeyCur;
+    T_KRRecord            *ptRecord;      /* buffer of the one fetched */
+};
+
+
+/* open a cursor over the records of key in ptIndexTable's table 
+ * in the transtime range, fetched newest first as the statement 
+ * orders them, refused for any index but the one whose key its 
+ * rows keep, see kr_db_external_key, NULL if failed
+ */
+T_KRExternalCursor *kr_db_external_cursor_open(T_KRIndexTable *ptIndexTable,
+        void *key, time_t tBeginTransTime, time_t tEndTransTime, 
+        T_DbsEnv *dbsenv)
+{
+    T_KRTable *ptTable = ptIndexTable->ptTable;
+    if (kr_list_value(ptTable->pIndexTableList->head) != ptIndexTable) {
+        KR_LOG(KR_LOGERROR, "table [%d] rows keep no key of index [%d]!", \
+                ptTable->iTableId, ptIndexTable->ptIndex->iIndexId);
+        return NULL;
+    }
+
+    T_KRExternalCursor *ptCursor = kr_calloc(sizeof(T_KRExternalCursor));
+    if (ptCursor == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptCursor error!");
+        return NULL;
+    }
+    ptCursor->ptRecord = kr_calloc(ptTable->iRecordSize);
+    if (ptCursor->ptRecord == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptRecord error!");
+        kr_free(ptCursor);
+        return NULL;
+    }
+    ptCursor->ptRecord->ptTable = ptTable;
+    ptCursor->ptRecord->pRecBuf = (char *)ptCursor->ptRecord+sizeof(T_KRRecord);
+    ptCursor->ptTable = ptTable;
+    ptCursor->dbsenv = dbsenv;
+
+    T_RecordKeyCur *ptCur = &ptCursor->stRecordKeyCur;
+    ptCur->lInDatasrcId = ptTable->iTableId;
+    kr_db_external_key_value(&ptTable->ptFieldDef[ptIndexTable->iIndexFieldId],
+            key, ptCur->caInKeyValue);
+    ptCur->lInBeginTransTime = tBeginTransTime;
+    ptCur->lInEndTransTime = tEndTransTime;
+    int iResult = dbsRecordKeyCur(dbsenv, KR_DBCUROPEN, ptCur);
+    if (iResult != KR_DBOK) {
+        KR_LOG(KR_LOGERROR, "dbsRecordKeyCur Open Error!");
+        kr_free(ptCursor->ptRecord);
+        kr_free(ptCursor);
+        return NULL;
+    }
+
+    return ptCursor;
+}
+
+
+/* fetch the next record into the cursor's buffer, 
+ * valid until fetched again, NULL at the end or if failed
+ */
+T_KRRecord *kr_db_external_cursor_next(T_KRExternalCursor *ptCursor)
+{
+    T_RecordKeyCur *ptCur = &ptCursor->stRecordKeyCur;
+    T_DbsEnv *dbsenv = ptCursor->dbsenv;
+
+    int iResult = dbsRecordKeyCur(dbsenv, KR_DBCURFETCH, ptCur);
+    if (iResult == KR_DBNOTFOUND) {
+        return NULL;
+    } else if (iResult != KR_DBOK) {
+        KR_LOG(KR_LOGERROR, "dbsRecordKeyCur Fetch Error[%d]![%s]:[%s]", 
+                iResult, dbsenv->sqlstate, dbsenv->sqlerrmsg);
+        return NULL;
+    }
+
+    size_t ulSize = ptCursor->ptTable->iRecordSize-sizeof(T_KRRecord);
+    if ((size_t )ptCur->lOutRecordLength < ulSize) {
+        ulSize = ptCur->lOutRecordLength;
+    }
+    memcpy(ptCursor->ptRecord->pRecBuf, ptCur->caOutRecordBuffer, ulSize);
+    return ptCursor->ptRecord;
+}
+
+
+void kr_db_external_cursor_close(T_KRExternalCursor *ptCursor)
+{
+    if (ptCursor == NULL) return;
+
+    if (dbsRecordKeyCur(ptCursor->dbsenv, KR_DBCURCLOSE, 
+                &ptCursor->stRecordKeyCur) != KR_DBOK) {
+        KR_LOG(KR_LOGERROR, "dbsRecordKeyCur Close Error!");
+    }
+    kr_free(ptCursor->ptRecord);
+    kr_free(ptCursor);
+}
+
+
 int kr_db_external_select(T_KRList *pRecList, T_KRTable *ptTable, 
         E_KRPublicFieldId eQueryFieldId, time_t tBeginTime, time_t tEndTime, 
         int iSortFieldId, T_DbsEnv *dbsenv)
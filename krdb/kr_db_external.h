@@ -1,9 +1,39 @@
 #ifndef __KR_DB_EXTERNAL_H__
 #define __KR_DB_EXTERNAL_H__
 
-#include "kr_db.h"
+#include "kr_db_internal.h"
 
+/*RECORD_BUFFER of kr_tbl_record*/
+#define KR_EXTERNAL_RECORD_SIZE   4096
+/*KEY_VALUE of kr_tbl_record*/
+#define KR_EXTERNAL_KEY_SIZE      64
+
+/*one row of kr_tbl_record, bound row-wise by kr_db_external_insert_rows*/
+typedef struct _kr_external_row_t
+{
+    long             lDatasrcId;
+    long             lProcTime;
+    long             lTransTime;
+    char             caKeyValue[KR_EXTERNAL_KEY_SIZE+1];
+    SQLLEN           iKeyInd;
+    long             lRecordLength;
+    SQLLEN           iRecordInd;        /* bytes of caRecordBuffer */
+    char             caRecordBuffer[KR_EXTERNAL_RECORD_SIZE];
+}T_KRExternalRow;
+
+extern void kr_db_external_key(T_KRTable *ptTable, char *pRecBuf, 
+        char *psKeyValue);
 extern int kr_db_external_insert(T_KRRecord *ptRecord, T_DbsEnv *dbsenv);
+extern int kr_db_external_insert_rows(T_KRExternalRow *ptRows, size_t ulStride,
+        int iRows, T_DbsEnv *dbsenv);
+/*records of an index key in a transtime range, fetched one at a time*/
+typedef struct _kr_external_cursor_t T_KRExternalCursor;
+
+extern T_KRExternalCursor *kr_db_external_cursor_open(
+        T_KRIndexTable *ptIndexTable, void *key,
+        time_t tBeginTransTime, time_t tEndTransTime, T_DbsEnv *dbsenv);
+extern T_KRRecord *kr_db_external_cursor_next(T_KRExternalCursor *ptCursor);
+extern void kr_db_external_cursor_close(T_KRExternalCursor *ptCursor);
 extern int kr_db_external_select(T_KRList *pRecList, T_KRTable *ptTable,
         E_KRPublicFieldId eQueryFieldId, time_t tBeginTime, time_t tEndTime,
         int iSortFieldId, T_DbsEnv *dbsenv);
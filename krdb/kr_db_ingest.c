@@ -0,0 +1,166 @@
+#include "kr_db_ingest.h"
+#include <sched.h>
+
+
+T_KRIngest *kr_ingest_new(T_KRDB *ptDB)
+{
+    T_KRIngest *ptIngest = kr_calloc(sizeof(T_KRIngest));
+    if (ptIngest == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptIngest failed!");
+        return NULL;
+    }
+    ptIngest->ptEpoch = ptDB->ptEpoch;
+    ptIngest->ptReader = kr_epoch_register(ptDB->ptEpoch);
+    if (ptIngest->ptReader == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_epoch_register failed!");
+        kr_free(ptIngest);
+        return NULL;
+    }
+    for (int i=0; i<KR_INGEST_RING_SIZE; i++) {
+        ptIngest->stCell[i].ulTicket = i;
+    }
+    ptIngest->iRefCnt = 1;
+
+    return ptIngest;
+}
+
+
+void kr_ingest_release(T_KRIngest *ptIngest)
+{
+    if (ptIngest && --ptIngest->iRefCnt == 0) {
+        kr_epoch_unregister(ptIngest->ptReader);
+        kr_free(ptIngest);
+    }
+}
+
+
+/* tables of ptFrom written by ptInto from now on,
+ * while building the db only, nothing may be ingesting
+ */
+void kr_ingest_merge(T_KRDB *ptDB, T_KRIngest *ptInto, T_KRIngest *ptFrom)
+{
+    T_KRListNode *node = ptDB->pTableList->head;
+    for (; node; node=node->next) {
+        T_KRTable *ptTable = (T_KRTable *)kr_list_value(node);
+        if (ptTable->ptIngest == ptFrom) {
+            ptTable->ptIngest = ptInto;
+            ptInto->iRefCnt++;
+            kr_ingest_release(ptFrom);
+        }
+    }
+}
+
+
+static void kr_ingest_apply(T_KRIngestCell *ptCell)
+{
+    T_KRTable *ptTable = ptCell->ptTable;
+
+    /*late records kept out take no location in the ring*/
+    if (kr_record_divert(ptTable, ptCell->pRecBuf, ptCell->ulLen)) {
+        ptCell->iResult = KR_INSERT_DIVERTED;
+        ptCell->ptRecord = NULL;
+        return;
+    }
+
+    int iShard = kr_table_shard_of(ptTable, ptCell->pRecBuf, ptCell->ulLen);
+    T_KRRecord *ptRecord = kr_record_shard_new(ptTable, iShard);
+    if (ptRecord == NULL) {
+        ptCell->iResult = -1;
+        ptCell->ptRecord = NULL;
+        return;
+    }
+    size_t ulSize = ptTable->iRecordSize - sizeof(T_KRRecord);
+    memcpy(ptRecord->pRecBuf, ptCell->pRecBuf, MIN(ptCell->ulLen, ulSize));
+
+    ptCell->iResult = kr_record_insert(ptRecord);
+    ptCell->ptRecord = \
+        ptCell->iResult == KR_INSERT_DIVERTED ? NULL : ptRecord;
+}
+
+
+/*become the writer if nobody is, and apply cells filled in ticket order*/
+static void kr_ingest_drain(T_KRIngest *ptIngest)
+{
+    if (ptIngest->iWriting || 
+        !__sync_bool_compare_and_swap(&ptIngest->iWriting, 0, 1)) {
+        return;
+    }
+
+    kr_epoch_enter(ptIngest->ptEpoch, ptIngest->ptReader);
+    unsigned long ulApplied = 0;
+    /*a lap at most, leave the rest to their producers*/
+    while (ulApplied < KR_INGEST_RING_SIZE) {
+        unsigned long ulHead = ptIngest->ulHead;
+        T_KRIngestCell *ptCell = \
+            &ptIngest->stCell[ulHead % KR_INGEST_RING_SIZE];
+        if (ptCell->ulTicket != ulHead || 
+            ptCell->iState != KR_INGEST_CELL_FILLED) {
+            break;
+        }
+        __sync_synchronize();
+        kr_ingest_apply(ptCell);
+        __sync_synchronize();
+        ptCell->iState = KR_INGEST_CELL_APPLIED;
+        ptIngest->ulHead = ulHead + 1;
+        ulApplied++;
+    }
+    kr_epoch_exit(ptIngest->ptReader);
+
+    if (ulApplied > 0) {
+        ptIngest->ulApplied += ulApplied;
+        ptIngest->ulBatches++;
+        /*memory unlinked by this batch, or by readers registering*/
+        kr_epoch_reclaim(ptIngest->ptEpoch);
+    }
+
+    __sync_synchronize();
+    ptIngest->iWriting = 0;
+}
+
+
+/* copy ulLen bytes of pRecBuf into a new record of ptTable and insert it,
+ * safe from any thread, callers of the same write domain are applied 
+ * in the order they got their tickets,
+ * *pptRecord is valid until the table's ring wraps around, 
+ * return E_KRInsertResult, -1 if failed
+ */
+int kr_table_ingest(T_KRTable *ptTable, char *pRecBuf, size_t ulLen, 
+        T_KRRecord **pptRecord)
+{
+    T_KRIngest *ptIngest = ptTable->ptIngest;
+
+    unsigned long ulTicket = __sync_fetch_and_add(&ptIngest->ulTail, 1);
+    T_KRIngestCell *ptCell = &ptIngest->stCell[ulTicket % KR_INGEST_RING_SIZE];
+
+    /*ring full, help the writer*/
+    while (ptCell->ulTicket != ulTicket) {
+        kr_ingest_drain(ptIngest);
+        sched_yield();
+    }
+
+    ptCell->ptTable = ptTable;
+    ptCell->pRecBuf = pRecBuf;
+    ptCell->ulLen = ulLen;
+    ptCell->ptRecord = NULL;
+    ptCell->iResult = -1;
+    __sync_synchronize();
+    ptCell->iState = KR_INGEST_CELL_FILLED;
+
+    /*applied by us, or by the writer combining ours*/
+    for (;;) {
+        kr_ingest_drain(ptIngest);
+        if (ptCell->iState == KR_INGEST_CELL_APPLIED) break;
+        sched_yield();
+    }
+    __sync_synchronize();
+
+    int iResult = ptCell->iResult;
+    if (pptRecord) *pptRecord = ptCell->ptRecord;
+
+    /*next lap's producer may fill it*/
+    ptCell->iState = KR_INGEST_CELL_FREE;
+    __sync_synchronize();
+    ptCell->ulTicket = ulTicket + KR_INGEST_RING_SIZE;
+
+    return iResult;
+}
@@ -0,0 +1,53 @@
+#ifndef __KR_DB_INGEST_H__
+#define __KR_DB_INGEST_H__
+
+#include "kr_db_internal.h"
+
+/*records waiting to be applied by one write domain*/
+#define KR_INGEST_RING_SIZE  1024
+
+typedef enum {
+    KR_INGEST_CELL_FREE     = 0,   /*waiting for its ticket*/
+    KR_INGEST_CELL_FILLED   = 1,   /*record copied in, not applied*/
+    KR_INGEST_CELL_APPLIED  = 2    /*result set for its producer*/
+}E_KRIngestCellState;
+
+typedef struct _kr_ingest_cell_t
+{
+    volatile unsigned long ulTicket;   /* ticket allowed to fill it */
+    volatile int     iState;
+    T_KRTable        *ptTable;
+    char             *pRecBuf;         /* producer's, until applied */
+    size_t           ulLen;
+    T_KRRecord       *ptRecord;        /* NULL if diverted or failed */
+    int              iResult;          /* E_KRInsertResult, -1 if failed */
+}T_KRIngestCell;
+
+/* write domain of the tables sharing indexes:
+ * producers of any thread take tickets and fill cells of one ring,
+ * whoever gets the writing flag applies filled cells in ticket order,
+ * so records of the domain are inserted by one writer at a time
+ * without a lock around insert, and readers never block it,
+ * see kr_index_slot_hold and kr_record_read_begin
+ */
+struct _kr_ingest_t
+{
+    volatile unsigned long ulTail;     /* next ticket taken */
+    char             caPad[64-sizeof(unsigned long)];
+    unsigned long    ulHead;           /* next ticket applied, writer only */
+    volatile int     iWriting;
+    int              iRefCnt;          /* tables of this domain */
+    T_KREpoch        *ptEpoch;
+    T_KREpochReader  *ptReader;        /* of whoever is writing */
+    unsigned long    ulApplied;        /* records applied */
+    unsigned long    ulBatches;        /* writer turns applying any */
+    T_KRIngestCell   stCell[KR_INGEST_RING_SIZE];
+};
+
+extern T_KRIngest *kr_ingest_new(T_KRDB *ptDB);
+extern void kr_ingest_release(T_KRIngest *ptIngest);
+extern void kr_ingest_merge(T_KRDB *ptDB, T_KRIngest *ptInto, T_KRIngest *ptFrom);
+extern int kr_table_ingest(T_KRTable *ptTable, char *pRecBuf, size_t ulLen, 
+        T_KRRecord **pptRecord);
+
+#endif /* __KR_DB_INGEST_H__ */
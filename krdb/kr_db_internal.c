@@ -1,4 +1,9 @@
 #include "kr_db_internal.h"
+#include "kr_db_ingest.h"
+#include "kr_db_segment.h"
+#include "kr_db_store.h"
+#include "kr_db_column.h"
+#include <math.h>
 
 
 
@@ -21,14 +26,29 @@ int kr_record_compare(T_KRRecord *ptRec1, T_KRRecord *ptRec2, int iFieldId)
 }
 
 
-T_KRRecord* kr_record_new(T_KRTable *ptTable)
+/* new record in shard iShard's part of the ring, see kr_table_shard_of,
+ * NULL if the table is kept by time and allocating failed
+ */
+T_KRRecord* kr_record_shard_new(T_KRTable *ptTable, int iShard)
 {
+    if (ptTable->eKeepMode == KR_SIZEKEEPMODE_TIME) {
+        return kr_segment_record_new(ptTable);
+    }
+
+    T_KRTableShard *ptShard = &ptTable->ptShard[iShard];
+
     /*get current record address*/
-    size_t ulCurrRecOffset = ptTable->uiRecordLoc*ptTable->iRecordSize;
+    unsigned int uiLoc = ptShard->uiRecordBase + ptShard->uiRecordLoc;
+    size_t ulCurrRecOffset = (size_t )uiLoc*ptTable->iRecordSize;
     char *psCurrRecAddr = &ptTable->pRecordBuff[ulCurrRecOffset];
     
-    /*delete and free old record*/
+    /*readers of the old record retry from now on, till inserted*/
     T_KRRecord *ptRecord = (T_KRRecord *)psCurrRecAddr;
+    unsigned int uiSeq = ptRecord->uiSeq | 1;
+    ptRecord->uiSeq = uiSeq;
+    __sync_synchronize();
+
+    /*delete and free old record*/
     if (ptRecord->ptTable != NULL) {
         kr_record_delete(ptRecord);
         kr_record_free(ptRecord);
@@ -36,17 +56,27 @@ T_KRRecord* kr_record_new(T_KRTable *ptTable)
     
     /*create and set new record*/
     memset(psCurrRecAddr, 0x00, ptTable->iRecordSize);
+    ptRecord->uiSeq = uiSeq;
+    ptRecord->uiLoc = uiLoc;
     ptRecord->pfFree = NULL;
     ptRecord->ptTable = ptTable;
     ptRecord->pRecBuf = psCurrRecAddr+sizeof(T_KRRecord);
 
     /*move record location to the next*/
-    ptTable->uiRecordLoc = (++ptTable->uiRecordLoc)%ptTable->lKeepValue;
+    ptShard->uiRecordLoc = (ptShard->uiRecordLoc+1)%ptShard->uiRecordCap;
+    ptTable->uiRecordLoc = ptShard->uiRecordBase + ptShard->uiRecordLoc;
 
     return ptRecord;
 }
 
 
+/*new record of an unsharded table, or of the first segment*/
+T_KRRecord* kr_record_new(T_KRTable *ptTable)
+{
+    return kr_record_shard_new(ptTable, 0);
+}
+
+
 void kr_record_free(T_KRRecord *ptRecord)
 {
     if (ptRecord->pfFree) {
@@ -55,27 +85,534 @@ void kr_record_free(T_KRRecord *ptRecord)
 }
 
 
-static void kr_rebuild_index_ins(T_KRIndexTable *ptIndextable, T_KRRecord *ptRecord)
+/*end the rewrite kr_record_new started*/
+static inline void kr_record_publish(T_KRRecord *ptRecord)
+{
+    if (ptRecord->uiSeq & 1) {
+        kr_seq_write_unlock(&ptRecord->uiSeq);
+    }
+}
+
+
+/*field of ptTable keyed by ptIndex, -1 if not indexed by it*/
+static int kr_index_key_field(T_KRIndex *ptIndex, T_KRTable *ptTable)
+{
+    T_KRListNode *node = ptIndex->pIndexTableList->head;
+    for (; node; node=node->next) {
+        T_KRIndexTable *ptIndexTable = (T_KRIndexTable *)kr_list_value(node);
+        if (ptIndexTable->ptTable == ptTable) {
+            return ptIndexTable->iIndexFieldId;
+        }
+    }
+    return -1;
+}
+
+
+/* copy of the record ptRef refers to, read under its seqlock into
+ * *ppCopy, grown as needed and valid until read into again,
+ * NULL if rewritten since seen, for another key maybe
+ */
+T_KRRecord *kr_record_ref_read(T_KRRecordRef *ptRef, T_KRIndex *ptIndex,
+        void *key, char **ppCopy, size_t *pulCopySize)
+{
+    T_KRTable *ptTable = ptRef->ptTable;
+    size_t ulSize = (size_t )ptTable->iRecordSize;
+    if (*pulCopySize < ulSize) {
+        char *pCopy = kr_realloc(*ppCopy, ulSize);
+        if (pCopy == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_realloc record copy [%zu] failed!", ulSize);
+            return NULL;
+        }
+        *ppCopy = pCopy;
+        *pulCopySize = ulSize;
+    }
+
+    T_KRRecord *ptCopy = (T_KRRecord *)*ppCopy;
+    memcpy(ptCopy, ptRef->ptRecord, ulSize);
+    if (kr_record_read_retry(ptRef->ptRecord, ptRef->uiSeq)) {
+        return NULL;
+    }
+    ptCopy->pfFree = NULL;
+    ptCopy->pRecBuf = (char *)ptCopy + sizeof(T_KRRecord);
+    if (ptCopy->uiLoc != ptRef->uiLoc || ptCopy->ptTable != ptTable) {
+        return NULL;
+    }
+
+    int iKeyFieldId = kr_index_key_field(ptIndex, ptTable);
+    KRCompareFunc pfKeyCompare = kr_get_compare_func(ptIndex->eIndexFieldType);
+    if (iKeyFieldId < 0 ||
+            pfKeyCompare(kr_field_get_value(ptCopy, iKeyFieldId), key) != 0) {
+        return NULL;
+    }
+    return ptCopy;
+}
+
+
+/*string keys shorter than this are kept in index keytables*/
+static size_t guiKeyInline = KR_KEYTABLE_STR_INLINE;
+
+void kr_index_set_key_inline(size_t uiKeyInline)
+{
+    guiKeyInline = uiKeyInline;
+}
+
+
+/*free a slot removed from its index, once no reader can reach it*/
+static void kr_index_slot_free(T_KRIndexSolt *ptIndexSlot)
+{
+    kr_list_clear(ptIndexSlot->pRecList);
+    kr_free(ptIndexSlot->ptDecay);
+    kr_free(ptIndexSlot->ptRun);
+    for (int i=0; i<ptIndexSlot->iTopKCnt; i++) {
+        if (ptIndexSlot->pptTopK[i]) kr_topk_free(ptIndexSlot->pptTopK[i]);
+    }
+    kr_free(ptIndexSlot->pptTopK);
+    for (int i=0; i<ptIndexSlot->iQuantileCnt; i++) {
+        T_KRQuantile *ptQuantile = ptIndexSlot->pptQuantile[i];
+        if (ptQuantile == NULL) continue;
+        for (int j=0; j<KR_QUANTILE_PANES+1; j++) {
+            kr_tdigest_free(ptQuantile->ptDigest[j]);
+        }
+        kr_free(ptQuantile);
+    }
+    kr_free(ptIndexSlot->pptQuantile);
+    for (int i=0; i<ptIndexSlot->iSequenceCnt; i++) {
+        if (ptIndexSlot->pptSequence[i]) {
+            kr_sequence_free(ptIndexSlot->pptSequence[i]);
+        }
+    }
+    kr_free(ptIndexSlot->pptSequence);
+    for (int i=0; i<ptIndexSlot->iColumnsCnt; i++) {
+        kr_columns_free(ptIndexSlot->pptColumns[i]);
+    }
+    kr_free(ptIndexSlot->pptColumns);
+    kr_slab_free(ptIndexSlot->ptPool, ptIndexSlot);
+}
+
+
+/*slot of key, the index may be changed by its writer meanwhile*/
+static T_KRIndexSolt *kr_index_slot_get(T_KRIndex *ptIndex, void *key)
+{
+    T_KRIndexShard *ptShard = kr_index_shard(ptIndex, key);
+    T_KRIndexSolt *ptIndexSlot;
+    unsigned int s;
+    do {
+        s = kr_seq_read_begin(&ptShard->uiSeq);
+        ptIndexSlot = kr_keytable_lookup(ptShard->ptKeyTable, key);
+    } while (kr_seq_read_retry(&ptShard->uiSeq, s));
+    return ptIndexSlot;
+}
+
+
+/* lock key's slot against its writer and other holders,
+ * NULL if key not indexed, release it soon since inserts wait
+ */
+T_KRIndexSolt *kr_index_slot_hold(T_KRIndex *ptIndex, void *key)
+{
+    for (;;) {
+        T_KRIndexSolt *ptIndexSlot = kr_index_slot_get(ptIndex, key);
+        if (ptIndexSlot == NULL) {
+            return NULL;
+        }
+        kr_seq_write_lock(&ptIndexSlot->uiSeq);
+        if (!ptIndexSlot->iRemoved) {
+            return ptIndexSlot;
+        }
+        /*removed after looked up*/
+        kr_seq_write_unlock(&ptIndexSlot->uiSeq);
+    }
+}
+
+
+void kr_index_slot_release(T_KRIndexSolt *ptIndexSlot)
+{
+    kr_seq_write_unlock(&ptIndexSlot->uiSeq);
+}
+
+
+static double kr_decay_weight(T_KRRecord *ptRecord, int iFieldId)
+{
+    if (iFieldId < 0) return 1.0;
+
+    void *val = kr_field_get_value(ptRecord, iFieldId);
+    switch(kr_field_get_type(ptRecord, iFieldId))
+    {
+        case KR_TYPE_INT:
+            return (double )*(int *)val;
+        case KR_TYPE_LONG:
+            return (double )*(long *)val;
+        case KR_TYPE_DOUBLE:
+            return *(double *)val;
+        default:
+            return 1.0;
+    }
+}
+
+
+/*decay the counter to the later transtime, then add this record,
+ *a late record is added with its weight decayed instead*/
+static void kr_decay_update(T_KRIndexSolt *ptIndexSlot, 
+        T_KRDecayDef *ptDecayDef, T_KRRecord *ptRecord)
+{
+    T_KRDecay *ptDecay = &ptIndexSlot->ptDecay[ptDecayDef->iDecayId];
+    double dWeight = kr_decay_weight(ptRecord, ptDecayDef->iFieldId);
+    time_t tTransTime = kr_get_transtime(ptRecord);
+
+    if (tTransTime >= ptDecay->tUpdated) {
+        ptDecay->dValue = ptDecay->dValue * \
+            exp(-ptDecayDef->dLambda * (tTransTime - ptDecay->tUpdated)) + dWeight;
+        ptDecay->tUpdated = tTransTime;
+    } else {
+        ptDecay->dValue += dWeight * \
+            exp(-ptDecayDef->dLambda * (ptDecay->tUpdated - tTransTime));
+    }
+
+    /*kept until decayed below epsilon, within some half lives*/
+    time_t tExpire = ptDecay->tUpdated;
+    double dValue = fabs(ptDecay->dValue);
+    if (dValue > KR_DECAY_EPSILON) {
+        double dKeep = log(dValue/KR_DECAY_EPSILON) / ptDecayDef->dLambda;
+        tExpire += (time_t )MIN(ceil(dKeep), 
+                (double )ptDecayDef->lHalfLife*KR_DECAY_HALFLIVES);
+    }
+    if (tExpire > ptIndexSlot->tExpire) {
+        ptIndexSlot->tExpire = tExpire;
+    }
+}
+
+
+static void kr_rebuild_index_decay(T_KRIndexTable *ptIndextable, 
+        T_KRIndexSolt *ptIndexSlot, T_KRRecord *ptRecord)
+{
+    /*defs before counters, a def published has its counter counted*/
+    int iDecayDefCnt = ptIndextable->iDecayDefCnt;
+    __sync_synchronize();
+    T_KRDecayDef *ptDecayDef = ptIndextable->ptDecayDef;
+
+    /*counters registered after this slot created,
+     *grown into a copy, readers may still see the old one*/
+    T_KRIndex *ptIndex = ptIndextable->ptIndex;
+    int iDecayCnt = ptIndex->iDecayCnt;
+    if (ptIndexSlot->iDecayCnt < iDecayCnt) {
+        T_KRDecay *ptDecay = kr_calloc(sizeof(T_KRDecay)*iDecayCnt);
+        if (ptDecay == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_calloc ptDecay failed!");
+            return;
+        }
+        if (ptIndexSlot->iDecayCnt > 0) {
+            memcpy(ptDecay, ptIndexSlot->ptDecay, 
+                    sizeof(T_KRDecay)*ptIndexSlot->iDecayCnt);
+        }
+        kr_epoch_retire(ptIndex->ptDB->ptEpoch, ptIndexSlot->ptDecay, kr_free);
+        ptIndexSlot->ptDecay = ptDecay;
+        __sync_synchronize();
+        ptIndexSlot->iDecayCnt = iDecayCnt;
+    }
+
+    for (int i=0; i<iDecayDefCnt; i++) {
+        kr_decay_update(ptIndexSlot, &ptDecayDef[i], ptRecord);
+    }
+}
+
+
+static void kr_rebuild_index_topk(T_KRIndexTable *ptIndextable, 
+        T_KRIndexSolt *ptIndexSlot, T_KRRecord *ptRecord)
+{
+    int iTopKDefCnt = ptIndextable->iTopKDefCnt;
+    __sync_synchronize();
+    T_KRTopKDef *ptTopKDefs = ptIndextable->ptTopKDef;
+
+    /*sketches registered after this slot created*/
+    int iTopKCnt = ptIndextable->ptIndex->iTopKCnt;
+    if (ptIndexSlot->iTopKCnt < iTopKCnt) {
+        T_KRTopK **pptTopK = kr_realloc(ptIndexSlot->pptTopK,
+                sizeof(T_KRTopK *)*iTopKCnt);
+        if (pptTopK == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_realloc pptTopK failed!");
+            return;
+        }
+        memset(&pptTopK[ptIndexSlot->iTopKCnt], 0x00,
+                sizeof(T_KRTopK *)*(iTopKCnt-ptIndexSlot->iTopKCnt));
+        ptIndexSlot->pptTopK = pptTopK;
+        ptIndexSlot->iTopKCnt = iTopKCnt;
+    }
+
+    for (int i=0; i<iTopKDefCnt; i++) {
+        T_KRTopKDef *ptTopKDef = &ptTopKDefs[i];
+        T_KRTopK **pptTopK = &ptIndexSlot->pptTopK[ptTopKDef->iTopKId];
+        if (*pptTopK == NULL) {
+            *pptTopK = kr_topk_new(ptTopKDef->uiCapacity);
+            if (*pptTopK == NULL) continue;
+        }
+        kr_topk_add(*pptTopK, 
+                kr_field_get_value(ptRecord, ptTopKDef->iFieldId), 
+                kr_field_get_size(ptRecord, ptTopKDef->iFieldId));
+    }
+
+    if (iTopKDefCnt > 0 && 
+        kr_get_transtime(ptRecord) + KR_TOPK_HORIZON > ptIndexSlot->tExpire) {
+        ptIndexSlot->tExpire = kr_get_transtime(ptRecord) + KR_TOPK_HORIZON;
+    }
+}
+
+
+/*seconds of a quantile's pane, the window is cut in KR_QUANTILE_PANES*/
+static inline long kr_quantile_span(long lWindow)
+{
+    return (lWindow + KR_QUANTILE_PANES - 1) / KR_QUANTILE_PANES;
+}
+
+
+/*add this record to the digest of its pane, the oldest pane's digest 
+ *is reused by a new one, a record of a pane reused already is dropped*/
+static void kr_quantile_update(T_KRIndexSolt *ptIndexSlot, 
+        T_KRQuantileDef *ptQuantileDef, T_KRRecord *ptRecord)
+{
+    T_KRQuantile **pptQuantile = \
+        &ptIndexSlot->pptQuantile[ptQuantileDef->iQuantileId];
+    if (*pptQuantile == NULL) {
+        *pptQuantile = kr_calloc(sizeof(T_KRQuantile));
+        if (*pptQuantile == NULL) return;
+    }
+    T_KRQuantile *ptQuantile = *pptQuantile;
+    long lSpan = kr_quantile_span(ptQuantileDef->lWindow);
+    time_t tTransTime = kr_get_transtime(ptRecord);
+    time_t tPane = tTransTime - tTransTime % lSpan;
+    int i = (int )((tTransTime / lSpan) % (KR_QUANTILE_PANES+1));
+
+    if (ptQuantile->ptDigest[i] == NULL) {
+        ptQuantile->ptDigest[i] = kr_tdigest_new(ptQuantileDef->dCompression);
+        if (ptQuantile->ptDigest[i] == NULL) return;
+        ptQuantile->tPane[i] = tPane;
+    } else if (ptQuantile->tPane[i] < tPane) {
+        kr_tdigest_reset(ptQuantile->ptDigest[i]);
+        ptQuantile->tPane[i] = tPane;
+    } else if (ptQuantile->tPane[i] > tPane) {
+        return;
+    }
+    kr_tdigest_add(ptQuantile->ptDigest[i], 
+            kr_decay_weight(ptRecord, ptQuantileDef->iFieldId), 1);
+
+    /*kept while the pane is in the window of a later record*/
+    if (tPane + lSpan + ptQuantileDef->lWindow > ptIndexSlot->tExpire) {
+        ptIndexSlot->tExpire = tPane + lSpan + ptQuantileDef->lWindow;
+    }
+}
+
+
+static void kr_rebuild_index_quantile(T_KRIndexTable *ptIndextable, 
+        T_KRIndexSolt *ptIndexSlot, T_KRRecord *ptRecord)
+{
+    int iQuantileDefCnt = ptIndextable->iQuantileDefCnt;
+    __sync_synchronize();
+    T_KRQuantileDef *ptQuantileDefs = ptIndextable->ptQuantileDef;
+
+    /*digests registered after this slot created*/
+    int iQuantileCnt = ptIndextable->ptIndex->iQuantileCnt;
+    if (ptIndexSlot->iQuantileCnt < iQuantileCnt) {
+        T_KRQuantile **pptQuantile = kr_realloc(ptIndexSlot->pptQuantile, 
+                sizeof(T_KRQuantile *)*iQuantileCnt);
+        if (pptQuantile == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_realloc pptQuantile failed!");
+            return;
+        }
+        memset(&pptQuantile[ptIndexSlot->iQuantileCnt], 0x00, 
+                sizeof(T_KRQuantile *)*(iQuantileCnt-ptIndexSlot->iQuantileCnt));
+        ptIndexSlot->pptQuantile = pptQuantile;
+        ptIndexSlot->iQuantileCnt = iQuantileCnt;
+    }
+
+    for (int i=0; i<iQuantileDefCnt; i++) {
+        kr_quantile_update(ptIndexSlot, &ptQuantileDefs[i], ptRecord);
+    }
+}
+
+
+/*strictly after ptLast by bFalling, or the record breaks the run*/
+static int kr_run_continues(T_KRRunDef *ptRunDef, 
+        U_KRValue *ptLast, U_KRValue *ptValue)
+{
+    int iCmp = 0;
+    switch(ptRunDef->eType)
+    {
+        case KR_TYPE_INT:
+            iCmp = (ptValue->i > ptLast->i) - (ptValue->i < ptLast->i);
+            break;
+        case KR_TYPE_LONG:
+            iCmp = (ptValue->l > ptLast->l) - (ptValue->l < ptLast->l);
+            break;
+        case KR_TYPE_DOUBLE:
+            iCmp = (ptValue->d > ptLast->d) - (ptValue->d < ptLast->d);
+            break;
+        default:
+            return 0;
+    }
+    return ptRunDef->bFalling ? iCmp < 0 : iCmp > 0;
+}
+
+
+/*extend the run with this record, or start another one after it,
+ *no key statistics need the slot kept once its records are gone*/
+static void kr_run_update(T_KRIndexSolt *ptIndexSlot, 
+        T_KRRunDef *ptRunDef, T_KRRecord *ptRecord)
+{
+    T_KRRun *ptRun = &ptIndexSlot->ptRun[ptRunDef->iRunId];
+    time_t tTransTime = kr_get_transtime(ptRecord);
+    void *val = kr_field_get_value(ptRecord, ptRunDef->iFieldId);
+    U_KRValue stValue;
+
+    switch(ptRunDef->eType)
+    {
+        case KR_TYPE_INT:
+            stValue.i = *(int *)val;
+            break;
+        case KR_TYPE_LONG:
+            stValue.l = *(long *)val;
+            break;
+        case KR_TYPE_DOUBLE:
+            stValue.d = *(double *)val;
+            break;
+        default:
+            return;
+    }
+
+    if (ptRun->lLength > 0 && 
+        kr_run_continues(ptRunDef, &ptRun->uLast, &stValue)) {
+        ptRun->lLength++;
+        if (tTransTime < ptRun->tMinTransTime) {
+            ptRun->tMinTransTime = tTransTime;
+        }
+        if (tTransTime > ptRun->tMaxTransTime) {
+            ptRun->tMaxTransTime = tTransTime;
+        }
+    } else {
+        ptRun->tBefore = ptRun->lLength > 0 ? ptRun->tLast : 0;
+        ptRun->bPartial = FALSE;
+        ptRun->lLength = 1;
+        ptRun->tMinTransTime = ptRun->tMaxTransTime = tTransTime;
+    }
+    ptRun->uLast = stValue;
+    ptRun->tLast = tTransTime;
+}
+
+
+static void kr_rebuild_index_run(T_KRIndexTable *ptIndextable, 
+        T_KRIndexSolt *ptIndexSlot, T_KRRecord *ptRecord)
+{
+    int iRunDefCnt = ptIndextable->iRunDefCnt;
+    __sync_synchronize();
+    T_KRRunDef *ptRunDefs = ptIndextable->ptRunDef;
+
+    /*runs registered after this slot created, grown as counters are*/
+    T_KRIndex *ptIndex = ptIndextable->ptIndex;
+    int iRunCnt = ptIndex->iRunCnt;
+    if (ptIndexSlot->iRunCnt < iRunCnt) {
+        T_KRRun *ptRun = kr_calloc(sizeof(T_KRRun)*iRunCnt);
+        if (ptRun == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_calloc ptRun failed!");
+            return;
+        }
+        if (ptIndexSlot->iRunCnt > 0) {
+            memcpy(ptRun, ptIndexSlot->ptRun, 
+                    sizeof(T_KRRun)*ptIndexSlot->iRunCnt);
+        }
+        /*records inserted before registered are not in these runs*/
+        for (int i=ptIndexSlot->iRunCnt; i<iRunCnt; i++) {
+            ptRun[i].bPartial = kr_list_length(ptIndexSlot->pRecList) > 0;
+        }
+        kr_epoch_retire(ptIndex->ptDB->ptEpoch, ptIndexSlot->ptRun, kr_free);
+        ptIndexSlot->ptRun = ptRun;
+        __sync_synchronize();
+        ptIndexSlot->iRunCnt = iRunCnt;
+    }
+
+    for (int i=0; i<iRunDefCnt; i++) {
+        kr_run_update(ptIndexSlot, &ptRunDefs[i], ptRecord);
+    }
+}
+
+
+/*no records left and key statistics expired at tNow*/
+static inline int kr_index_slot_idle(T_KRIndexSolt *ptIndexSlot, time_t tNow)
+{
+    return kr_list_length(ptIndexSlot->pRecList) == 0 &&
+        ptIndexSlot->tExpire < tNow;
+}
+
+
+/*take key's slot held out of its index and unlock it, 
+ *freed once readers may have looked it up already*/
+static void kr_index_slot_remove(T_KRIndex *ptIndex, void *key, 
+        T_KRIndexSolt *ptIndexSlot)
+{
+    T_KRIndexShard *ptShard = kr_index_shard(ptIndex, key);
+    kr_seq_write_lock(&ptShard->uiSeq);
+    kr_keytable_remove(ptShard->ptKeyTable, key);
+    kr_seq_write_unlock(&ptShard->uiSeq);
+    ptIndexSlot->iRemoved = 1;
+    kr_seq_write_unlock(&ptIndexSlot->uiSeq);
+    kr_epoch_retire(ptIndex->ptDB->ptEpoch, ptIndexSlot, 
+            (KRFreeFunc )kr_index_slot_free);
+}
+
+
+/*slots emptied while their key statistics were alive are freed
+ *by later inserts going through their shard*/
+static void kr_index_slot_sweep(void *key, void *value, void *data)
+{
+    T_KRIndexTable *ptIndextable = (T_KRIndexTable *)data;
+    T_KRIndexSolt *ptIndexSlot = (T_KRIndexSolt *)value;
+
+    kr_seq_write_lock(&ptIndexSlot->uiSeq);
+    if (kr_index_slot_idle(ptIndexSlot, ptIndextable->ptTable->tMaxTransTime)) {
+        kr_index_slot_remove(ptIndextable->ptIndex, key, ptIndexSlot);
+        return;
+    }
+    kr_seq_write_unlock(&ptIndexSlot->uiSeq);
+}
+
+
+/*only the writer of the table changes its indexes, 
+ *slots and the hashtable under their seqlocks for readers*/
+void kr_rebuild_index_ins(T_KRIndexTable *ptIndextable, T_KRRecord *ptRecord)
 {
     void *key = kr_field_get_value(ptRecord, ptIndextable->iIndexFieldId);
-    T_KRHashTable *pHashTable = ptIndextable->ptIndex->pHashTable;
+    T_KRIndex *ptIndex = ptIndextable->ptIndex;
+    T_KRIndexShard *ptShard = kr_index_shard(ptIndex, key);
+    T_KRKeyTable *ptKeyTable = ptShard->ptKeyTable;
 
-    T_KRIndexSolt *ptIndexSlot = kr_hashtable_lookup(pHashTable, key);
+    T_KRIndexSolt *ptIndexSlot = kr_keytable_lookup(ptKeyTable, key);
     if (ptIndexSlot == NULL) {
-        /*create slot if not found*/
-        ptIndexSlot = kr_calloc(sizeof(*ptIndexSlot));
+        /*create slot if not found, its key copied into the keytable*/
+        ptIndexSlot = kr_slab_alloc(ptIndex->ptSlotPool);
+        if (ptIndexSlot == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_slab_alloc index [%d] slot failed!", \
+                    ptIndex->iIndexId);
+            return;
+        }
+        ptIndexSlot->ptPool = ptIndex->ptSlotPool;
         ptIndexSlot->eKeyType = 
             kr_field_get_type(ptRecord, ptIndextable->iIndexFieldId);
-        KRDupFunc pfKeyDup = kr_get_dup_func(ptIndexSlot->eKeyType);
-        ptIndexSlot->pKeyValue = pfKeyDup(key);
         ptIndexSlot->tLocMinProcTime = kr_get_proctime(ptRecord);
         ptIndexSlot->tLocMinTransTime = kr_get_transtime(ptRecord);
-        ptIndexSlot->tExtMaxProcTime = kr_get_proctime(ptRecord);
-        ptIndexSlot->tExtMaxTransTime = kr_get_transtime(ptRecord);
-        ptIndexSlot->pRecList = kr_list_new();
-        kr_hashtable_insert(pHashTable, ptIndexSlot->pKeyValue, ptIndexSlot);
+        /*none of the key left memory yet, external has only older ones*/
+        ptIndexSlot->tExtMaxProcTime = kr_get_proctime(ptRecord) - 1;
+        ptIndexSlot->tExtMaxTransTime = kr_get_transtime(ptRecord) - 1;
+        kr_list_init(&ptIndexSlot->stRecList);
+        ptIndexSlot->pRecList = &ptIndexSlot->stRecList;
+        ptIndexSlot->ulRemoveStamp = ++ptIndex->ulRemoveStamp;
+        kr_seq_write_lock(&ptShard->uiSeq);
+        int iResult = kr_keytable_insert(ptKeyTable, key, ptIndexSlot);
+        kr_seq_write_unlock(&ptShard->uiSeq);
+        if (iResult != 0) {
+            KR_LOG(KR_LOGERROR, "kr_keytable_insert index [%d] failed!", \
+                    ptIndex->iIndexId);
+            kr_slab_free(ptIndex->ptSlotPool, ptIndexSlot);
+            return;
+        }
     }
 
+    kr_seq_write_lock(&ptIndexSlot->uiSeq);
     /*modify statistical fields of local*/
     if (kr_get_proctime(ptRecord) < ptIndexSlot->tLocMinProcTime) {
         ptIndexSlot->tLocMinProcTime = kr_get_proctime(ptRecord);
@@ -84,18 +621,44 @@ static void kr_rebuild_index_ins(T_KRIndexTable *ptIndextable, T_KRRecord *ptRec
         ptIndexSlot->tLocMinTransTime = kr_get_transtime(ptRecord);
     }
 
+    /*decayed counters don't depend on records kept*/
+    if (ptIndextable->iDecayDefCnt > 0) {
+        kr_rebuild_index_decay(ptIndextable, ptIndexSlot, ptRecord);
+    }
+    if (ptIndextable->iTopKDefCnt > 0) {
+        kr_rebuild_index_topk(ptIndextable, ptIndexSlot, ptRecord);
+    }
+    if (ptIndextable->iQuantileDefCnt > 0) {
+        kr_rebuild_index_quantile(ptIndextable, ptIndexSlot, ptRecord);
+    }
+    if (ptIndextable->iRunDefCnt > 0) {
+        kr_rebuild_index_run(ptIndextable, ptIndexSlot, ptRecord);
+    }
+
+    /*columns are built again from the list without this record*/
+    if (ptIndextable->iColumnDefCnt > 0) {
+        kr_columns_append(ptIndextable, ptIndexSlot, ptRecord);
+    }
+
     /*add record to list*/
     kr_list_add_tail(ptIndexSlot->pRecList, ptRecord);
+    kr_seq_write_unlock(&ptIndexSlot->uiSeq);
+
+    kr_keytable_sweep(ptKeyTable, &ptShard->uiSweep, KR_SLOT_SWEEP_COUNT,
+            kr_index_slot_sweep, ptIndextable);
 }
 
 
 static void kr_rebuild_index_del(T_KRIndexTable *ptIndextable, T_KRRecord *ptRecord)
 {
     void *key = kr_field_get_value(ptRecord, ptIndextable->iIndexFieldId);
-    T_KRHashTable *pHashTable = ptIndextable->ptIndex->pHashTable;
+    T_KRIndex *ptIndex = ptIndextable->ptIndex;
+    T_KRIndexShard *ptShard = kr_index_shard(ptIndex, key);
+    T_KRKeyTable *ptKeyTable = ptShard->ptKeyTable;
 
-    T_KRIndexSolt *ptIndexSlot = kr_hashtable_lookup(pHashTable, key);
+    T_KRIndexSolt *ptIndexSlot = kr_keytable_lookup(ptKeyTable, key);
     if (ptIndexSlot != NULL) {
+        kr_seq_write_lock(&ptIndexSlot->uiSeq);
         /*modify statistical fields of external*/
         if (kr_get_proctime(ptRecord) > ptIndexSlot->tExtMaxProcTime) {
             ptIndexSlot->tExtMaxProcTime = kr_get_proctime(ptRecord);
@@ -103,32 +666,139 @@ static void kr_rebuild_index_del(T_KRIndexTable *ptIndextable, T_KRRecord *ptRec
         if (kr_get_transtime(ptRecord) > ptIndexSlot->tExtMaxTransTime) {
             ptIndexSlot->tExtMaxTransTime = kr_get_transtime(ptRecord);
         }
-        /*remove record from list*/
+        /*remove record from list, nodes cursors left may be freed*/
         kr_list_remove(ptIndexSlot->pRecList, ptRecord);
-
-        /*free this slot if there is no records*/
-        if (kr_list_length(ptIndexSlot->pRecList) == 0 ) {
-            kr_hashtable_remove(pHashTable, ptIndexSlot->pKeyValue);
-            kr_list_destroy(ptIndexSlot->pRecList);
-            kr_free(ptIndexSlot->pKeyValue);
-            kr_free(ptIndexSlot);
+        ptIndexSlot->ulRemoveStamp = ++ptIndex->ulRemoveStamp;
+        kr_columns_remove(ptIndextable, ptIndexSlot, ptRecord);
+
+        /*free this slot if there is no records and no key statistics,
+         *one with statistics alive is left to kr_index_slot_sweep*/
+        if (kr_index_slot_idle(ptIndexSlot, ptIndextable->ptTable->tMaxTransTime)) {
+            kr_index_slot_remove(ptIndex, key, ptIndexSlot);
+            return;
         }
+        kr_seq_write_unlock(&ptIndexSlot->uiSeq);
     }
 }
 
 
-void kr_record_insert(T_KRRecord *ptRecord)
+void kr_freq_add(T_KRFreq *ptFreq, T_KRRecord *ptRecord)
+{
+    uint64_t hash = kr_distinct_hash(
+            kr_field_get_value(ptRecord, ptFreq->iFieldId), 
+            kr_field_get_size(ptRecord, ptFreq->iFieldId));
+    kr_cmsketch_add(ptFreq->ptSketch, hash, kr_get_transtime(ptRecord));
+}
+
+
+/* divert a record of ptTable copied from pRecBuf if it is older than
+ * the table's watermark and the late policy keeps it out, before it
+ * takes a location, so no record kept is evicted for it,
+ * return 1 if diverted
+ */
+int kr_record_divert(T_KRTable *ptTable, char *pRecBuf, size_t ulLen)
+{
+    if (ptTable->eLatePolicy != KR_LATEPOLICY_DROP &&
+        ptTable->eLatePolicy != KR_LATEPOLICY_SIDE) {
+        return 0;
+    }
+
+    /*bytes not copied are zeroes in a record*/
+    long lTransTime = 0;
+    size_t ulOffset = ptTable->ptFieldDef[KR_FIELDID_TRANSTIME].offset;
+    if (ulOffset + sizeof(long) <= ulLen) {
+        memcpy(&lTransTime, &pRecBuf[ulOffset], sizeof(long));
+    }
+    if ((time_t )lTransTime >= ptTable->tWatermark) {
+        return 0;
+    }
+
+    __sync_fetch_and_add(&ptTable->ulLateCnt, 1);
+    if (ptTable->eLatePolicy == KR_LATEPOLICY_SIDE && ptTable->pfLateOutput) {
+        T_KRRecord *ptRecord = ptTable->ptLateRecord;
+        size_t ulSize = ptTable->iRecordSize - sizeof(T_KRRecord);
+        memset(ptRecord, 0x00, ptTable->iRecordSize);
+        ptRecord->ptTable = ptTable;
+        ptRecord->pRecBuf = (char *)ptRecord + sizeof(T_KRRecord);
+        memcpy(ptRecord->pRecBuf, pRecBuf, MIN(ulLen, ulSize));
+        ptTable->pfLateOutput(ptRecord);
+    }
+    return 1;
+}
+
+
+/* insert ptRecord into its table's indexes, unless it is older than 
+ * the table's watermark and the late policy diverts it,
+ * a diverted record is freed and its location reused by kr_record_new,
+ * kr_table_ingest diverts them by kr_record_divert before that
+ */
+E_KRInsertResult kr_record_insert(T_KRRecord *ptRecord)
 {    
     T_KRTable *ptTable = ptRecord->ptTable;
+    E_KRInsertResult eResult = KR_INSERT_INTIME;
+    
+    if (kr_record_is_late(ptRecord)) {
+        __sync_fetch_and_add(&ptTable->ulLateCnt, 1);
+        switch(ptTable->eLatePolicy)
+        {
+            case KR_LATEPOLICY_SIDE:
+                if (ptTable->pfLateOutput) ptTable->pfLateOutput(ptRecord);
+                /*fall through*/
+            case KR_LATEPOLICY_DROP:
+                kr_record_free(ptRecord);
+                ptRecord->ptTable = NULL;
+                kr_record_publish(ptRecord);
+                return KR_INSERT_DIVERTED;
+            default:
+                eResult = KR_INSERT_LATE;
+                break;
+        }
+    }
+    
+    /*widen the out-of-order bound before record gets visible,
+     *records diverted above never widen it past allowed lateness*/
+    time_t tTransTime = kr_get_transtime(ptRecord);
+    if (tTransTime > ptTable->tMaxTransTime) {
+        ptTable->tMaxTransTime = tTransTime;
+        if (ptTable->eLatePolicy != KR_LATEPOLICY_ACCEPT) {
+            ptTable->tWatermark = tTransTime - ptTable->lAllowedLateness;
+        }
+    } else if (ptTable->tMaxTransTime - tTransTime > ptTable->lTransTimeSlack) {
+        ptTable->lTransTimeSlack = ptTable->tMaxTransTime - tTransTime;
+    }
     
     /*first:rebuild all hash-indexes of this table with insert*/
     kr_list_foreach(ptTable->pIndexTableList, \
             (KRForEachFunc )kr_rebuild_index_ins, ptRecord);
+    
+    /*count global frequencies, kept no matter records evicted*/
+    kr_list_foreach(ptTable->pFreqList, \
+            (KRForEachFunc )kr_freq_add, ptRecord);
 
     /*secord:increase table records number*/
+    if (ptTable->eKeepMode == KR_SIZEKEEPMODE_TIME) {
+        /*not bounded, segments freed by their max transtime*/
+        ptTable->uiRecordNum++;
+        ptTable->ptShard[0].uiRecordNum++;
+        T_KRSegment *ptSegment = kr_table_segment(ptTable, 
+                kr_record_loc(ptRecord) / KR_SEGMENT_RECORDS);
+        if (tTransTime > ptSegment->tMaxTransTime) {
+            ptSegment->tMaxTransTime = tTransTime;
+        }
+        kr_record_publish(ptRecord);
+        return eResult;
+    }
     if (++ptTable->uiRecordNum > ptTable->lKeepValue) {
         ptTable->uiRecordNum = ptTable->lKeepValue;
     }
+    T_KRTableShard *ptShard = \
+        &ptTable->ptShard[kr_table_shard_at(ptTable, kr_record_loc(ptRecord))];
+    if (++ptShard->uiRecordNum > ptShard->uiRecordCap) {
+        ptShard->uiRecordNum = ptShard->uiRecordCap;
+    }
+
+    kr_record_publish(ptRecord);
+    return eResult;
 }
 
 
@@ -144,9 +814,89 @@ void kr_record_delete(T_KRRecord *ptRecord)
     if (--ptTable->uiRecordNum < 0) {
         ptTable->uiRecordNum = 0;
     }
+    T_KRTableShard *ptShard = \
+        &ptTable->ptShard[kr_table_shard_at(ptTable, kr_record_loc(ptRecord))];
+    if (ptShard->uiRecordNum > 0) {
+        --ptShard->uiRecordNum;
+    }
+}
+
+
+static void kr_index_retire_nodes(void *data, void *ptr)
+{
+    kr_epoch_retire((T_KREpoch *)data, ptr, kr_free);
+}
+
+
+static void kr_index_slot_drop(void *key, void *value, void *data)
+{
+    kr_index_slot_free((T_KRIndexSolt *)value);
+}
+
+
+/*slots still in shards are freed too*/
+static void kr_index_shards_free(T_KRIndexShard *ptShard, int iShardCnt)
+{
+    for (int i=0; i<iShardCnt; i++) {
+        if (ptShard[i].ptKeyTable == NULL) continue;
+        kr_keytable_foreach(ptShard[i].ptKeyTable, kr_index_slot_drop, NULL);
+        kr_keytable_destroy(ptShard[i].ptKeyTable);
+    }
+    kr_free(ptShard);
 }
 
 
+static T_KRIndexShard *kr_index_shards_new(T_KRIndex *ptIndex, int iShardCnt)
+{
+    T_KRIndexShard *ptShard = kr_calloc(sizeof(T_KRIndexShard)*iShardCnt);
+    if (ptShard == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptShard failed!");
+        return NULL;
+    }
+    for (int i=0; i<iShardCnt; i++) {
+        ptShard[i].ptKeyTable = kr_keytable_new(ptIndex->eIndexFieldType, 
+                ptIndex->uiKeyInline);
+        if (ptShard[i].ptKeyTable == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_keytable_new shard [%d] failed!", i);
+            kr_index_shards_free(ptShard, iShardCnt);
+            return NULL;
+        }
+        kr_keytable_set_retire(ptShard[i].ptKeyTable, 
+                kr_index_retire_nodes, ptIndex->ptDB->ptEpoch);
+    }
+    return ptShard;
+}
+
+
+/*split an index's keys into iShardCnt hashtables, only while empty*/
+static int kr_index_set_shards(T_KRIndex *ptIndex, int iShardCnt)
+{
+    if (ptIndex->iShardCnt == iShardCnt) {
+        return 0;
+    }
+    if (ptIndex->iShardCnt > 1) {
+        KR_LOG(KR_LOGERROR, "index [%d] split into [%d] shards already!", \
+                ptIndex->iIndexId, ptIndex->iShardCnt);
+        return -1;
+    }
+    for (int i=0; i<ptIndex->iShardCnt; i++) {
+        if (kr_keytable_size(ptIndex->ptShard[i].ptKeyTable) > 0) {
+            KR_LOG(KR_LOGERROR, "index [%d] has keys in [%d] shards!", \
+                    ptIndex->iIndexId, ptIndex->iShardCnt);
+            return -1;
+        }
+    }
+
+    T_KRIndexShard *ptShard = kr_index_shards_new(ptIndex, iShardCnt);
+    if (ptShard == NULL) {
+        return -1;
+    }
+    kr_index_shards_free(ptIndex->ptShard, ptIndex->iShardCnt);
+    ptIndex->ptShard = ptShard;
+    ptIndex->iShardCnt = iShardCnt;
+    return 0;
+}
+
 static inline int kr_table_indexid_match(void *ptr, void *key)
 {
     T_KRIndexTable *ptIndexTable = (T_KRIndexTable *)ptr; 
@@ -166,9 +916,22 @@ T_KRIndex* kr_index_create(T_KRDB *ptDB,
     ptIndex->iIndexId = iIndexId;
     strncpy(ptIndex->caIndexName, psIndexName, sizeof(ptIndex->caIndexName));
     ptIndex->eIndexFieldType = eIndexFieldType;
-    KRHashFunc hash_func = (KRHashFunc )kr_get_hash_func(eIndexFieldType);
-    KREqualFunc equal_func = (KREqualFunc )kr_get_equal_func(eIndexFieldType);
-    ptIndex->pHashTable = kr_hashtable_new(hash_func, equal_func);
+    ptIndex->pfKeyHash = (KRHashFunc )kr_get_hash_func(eIndexFieldType);
+    ptIndex->uiKeyInline = guiKeyInline;
+    ptIndex->ptSlotPool = kr_slab_new(sizeof(T_KRIndexSolt), KR_SLOT_SLAB_COUNT);
+    if (ptIndex->ptSlotPool == NULL) {
+        fprintf(stderr, "kr_slab_new ptSlotPool failed!\n");
+        kr_free(ptIndex);
+        return NULL;
+    }
+    ptIndex->ptShard = kr_index_shards_new(ptIndex, 1);
+    if (ptIndex->ptShard == NULL) {
+        fprintf(stderr, "kr_index_shards_new failed!\n");
+        kr_slab_destroy(ptIndex->ptSlotPool);
+        kr_free(ptIndex);
+        return NULL;
+    }
+    ptIndex->iShardCnt = 1;
 
     ptIndex->pIndexTableList = kr_list_new();
     kr_list_set_match(ptIndex->pIndexTableList, 
@@ -182,8 +945,9 @@ T_KRIndex* kr_index_create(T_KRDB *ptDB,
 
 void kr_index_drop(T_KRIndex *ptIndex)
 {
-    kr_list_remove(ptIndex->ptDB->pIndexList, ptIndex);
-    kr_hashtable_destroy(ptIndex->pHashTable);
+    kr_index_shards_free(ptIndex->ptShard, ptIndex->iShardCnt);
+    /*slots retired come back to the pool after this*/
+    kr_slab_destroy(ptIndex->ptSlotPool);
     kr_list_destroy(ptIndex->pIndexTableList);
     kr_free(ptIndex);
 }
@@ -233,10 +997,33 @@ T_KRTable* kr_table_create(T_KRDB *ptDB,
     ptTable->lKeepValue = lKeepValue;
     ptTable->uiRecordNum = 0;
     ptTable->uiRecordLoc = 0;
+    ptTable->tMaxTransTime = 0;
+    ptTable->lTransTimeSlack = 0;
+    ptTable->eLatePolicy = KR_LATEPOLICY_ACCEPT;
+    ptTable->iShardCnt = 1;
+    ptTable->ptShard = kr_calloc(sizeof(T_KRTableShard));
+    if (ptTable->ptShard == NULL) {
+        fprintf(stderr, "kr_calloc ptShard failed!\n");
+        pthread_mutex_destroy(&ptTable->tLock);
+        kr_free(ptTable);
+        return NULL;
+    }
+    if (eKeepMode != KR_SIZEKEEPMODE_TIME) {
+        ptTable->ptShard[0].uiRecordCap = (unsigned int )lKeepValue;
+    }
+    ptTable->ptIngest = kr_ingest_new(ptDB);
+    if (ptTable->ptIngest == NULL) {
+        fprintf(stderr, "kr_ingest_new failed!\n");
+        pthread_mutex_destroy(&ptTable->tLock);
+        kr_free(ptTable->ptShard);
+        kr_free(ptTable);
+        return NULL;
+    }
 
     ptTable->pIndexTableList = kr_list_new();
     kr_list_set_match(ptTable->pIndexTableList, 
             (KRCompareFunc )kr_index_tableid_match);
+    ptTable->pFreqList = kr_list_new();
 
     kr_list_add_tail(ptDB->pTableList, ptTable);
 
@@ -246,10 +1033,19 @@ T_KRTable* kr_table_create(T_KRDB *ptDB,
 
 void kr_table_drop(T_KRTable *ptTable)
 {
-    kr_list_remove(ptTable->ptDB->pTableList, ptTable);
     pthread_mutex_destroy(&ptTable->tLock);
+    kr_ingest_release(ptTable->ptIngest);
+    /*a stored ring and its shards are in the mapping*/
+    if (ptTable->ptStore != NULL) {
+        kr_table_store_close(ptTable);
+    } else {
+        kr_free(ptTable->ptShard);
+        kr_free(ptTable->pRecordBuff);
+    }
+    kr_segment_drop(ptTable);
     kr_list_destroy(ptTable->pIndexTableList);
-    kr_free(ptTable->pRecordBuff);
+    kr_list_destroy(ptTable->pFreqList);
+    kr_free(ptTable->ptLateRecord);
     kr_free(ptTable->ptFieldDef);
     kr_free(ptTable);
 }
@@ -266,6 +1062,147 @@ T_KRTable* kr_table_get(T_KRDB *ptDB, int iTableId)
 }
 
 
+/* records older than max transtime minus lAllowedLateness are late,
+ * and handled by eLatePolicy, pfLateOutput is only for side output
+ */
+int kr_table_set_late_policy(T_KRTable *ptTable, 
+        E_KRLatePolicy eLatePolicy, long lAllowedLateness, 
+        KRLateOutputFunc pfLateOutput)
+{
+    switch(eLatePolicy)
+    {
+        case KR_LATEPOLICY_ACCEPT:
+        case KR_LATEPOLICY_DROP:
+        case KR_LATEPOLICY_SIDE:
+        case KR_LATEPOLICY_RETRACT:
+            break;
+        default:
+            KR_LOG(KR_LOGERROR, "bad late policy [%c]!", eLatePolicy);
+            return -1;
+    }
+    if (lAllowedLateness < 0) {
+        KR_LOG(KR_LOGERROR, "bad allowed lateness [%ld]!", lAllowedLateness);
+        return -1;
+    }
+    /*kept till the table dropped, the writer may be using it*/
+    if (eLatePolicy == KR_LATEPOLICY_SIDE && ptTable->ptLateRecord == NULL) {
+        ptTable->ptLateRecord = kr_calloc(ptTable->iRecordSize);
+        if (ptTable->ptLateRecord == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_calloc ptLateRecord failed!");
+            return -1;
+        }
+    }
+
+    kr_table_lock(ptTable);
+    ptTable->lAllowedLateness = lAllowedLateness;
+    ptTable->pfLateOutput = pfLateOutput;
+    ptTable->tWatermark = ptTable->tMaxTransTime - lAllowedLateness;
+    ptTable->eLatePolicy = eLatePolicy;
+    kr_table_unlock(ptTable);
+
+    return 0;
+}
+
+
+/* split ptTable's ring into iShardCnt segments and the keys of its 
+ * indexes into as many hashtables, a record goes to the segment of its
+ * iIndexId key's shard, so a worker fed the keys of one shard only 
+ * touches that segment and hashtable,
+ * only before any record inserted, indexes shared with another
+ * table must be split the same way
+ */
+int kr_table_set_shards(T_KRTable *ptTable, int iShardCnt, int iIndexId)
+{
+    if (iShardCnt < 1 || iShardCnt > KR_SHARD_MAX) {
+        KR_LOG(KR_LOGERROR, "bad shard count [%d]!", iShardCnt);
+        return -1;
+    }
+    if (ptTable->eKeepMode == KR_SIZEKEEPMODE_TIME) {
+        KR_LOG(KR_LOGERROR, "table [%d] kept by time, not sharded!", \
+                ptTable->iTableId);
+        return -1;
+    }
+    if (ptTable->ptStore != NULL) {
+        KR_LOG(KR_LOGERROR, "table [%d] stored, shard it before!", \
+                ptTable->iTableId);
+        return -1;
+    }
+    if (ptTable->lKeepValue < iShardCnt) {
+        KR_LOG(KR_LOGERROR, "table [%d] keeps [%ld] records, [%d] shards!", \
+                ptTable->iTableId, ptTable->lKeepValue, iShardCnt);
+        return -1;
+    }
+    T_KRIndexTable *ptShardIndexTable = \
+        kr_index_table_get(ptTable->ptDB, iIndexId, ptTable->iTableId);
+    if (ptShardIndexTable == NULL) {
+        KR_LOG(KR_LOGERROR, "table [%d] index [%d] not found!", \
+                ptTable->iTableId, iIndexId);
+        return -1;
+    }
+
+    int iResult = -1;
+    kr_table_lock(ptTable);
+    if (ptTable->uiRecordNum > 0) {
+        KR_LOG(KR_LOGERROR, "table [%d] has records!", ptTable->iTableId);
+        goto UNLOCK;
+    }
+
+    T_KRTableShard *ptShard = kr_calloc(sizeof(T_KRTableShard)*iShardCnt);
+    if (ptShard == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptShard failed!");
+        goto UNLOCK;
+    }
+    unsigned int uiCap = (unsigned int )(ptTable->lKeepValue / iShardCnt);
+    for (int i=0; i<iShardCnt; i++) {
+        ptShard[i].uiRecordBase = uiCap * i;
+        ptShard[i].uiRecordCap = uiCap;
+    }
+    /*the last one takes the remainder*/
+    ptShard[iShardCnt-1].uiRecordCap = \
+        (unsigned int )ptTable->lKeepValue - uiCap * (iShardCnt-1);
+
+    T_KRListNode *node = ptTable->pIndexTableList->head;
+    for (; node; node=node->next) {
+        T_KRIndexTable *ptIndexTable = (T_KRIndexTable *)kr_list_value(node);
+        if (kr_index_set_shards(ptIndexTable->ptIndex, iShardCnt) != 0) {
+            KR_LOG(KR_LOGERROR, "kr_index_set_shards [%d] failed!", \
+                    ptIndexTable->ptIndex->iIndexId);
+            kr_free(ptShard);
+            goto UNLOCK;
+        }
+    }
+
+    kr_free(ptTable->ptShard);
+    ptTable->ptShard = ptShard;
+    ptTable->iShardCnt = iShardCnt;
+    ptTable->ptShardIndexTable = ptShardIndexTable;
+    ptTable->uiRecordLoc = 0;
+    iResult = 0;
+
+UNLOCK:
+    kr_table_unlock(ptTable);
+    return iResult;
+}
+
+
+/* shard of a record buffer laid out as ptTable's records,
+ * for dispatching its key to the worker of that shard,
+ * the first one if the buffer is too short to have the key
+ */
+int kr_table_shard_of(T_KRTable *ptTable, char *pRecBuf, size_t ulLen)
+{
+    if (ptTable->iShardCnt == 1) return 0;
+
+    T_KRIndexTable *ptIndexTable = ptTable->ptShardIndexTable;
+    T_KRFieldDef *ptFieldDef = &ptTable->ptFieldDef[ptIndexTable->iIndexFieldId];
+    if (ptFieldDef->offset + ptFieldDef->length > ulLen) {
+        return 0;
+    }
+    return kr_index_shard_id(ptIndexTable->ptIndex, 
+            &pRecBuf[ptFieldDef->offset]);
+}
+
+
 T_KRIndexTable* kr_index_table_create(T_KRDB *ptDB,
         int iIndexId, int iTableId,
         int iIndexFieldId, int iSortFieldId)
@@ -292,6 +1229,22 @@ T_KRIndexTable* kr_index_table_create(T_KRDB *ptDB,
     ptIndexTable->ptTable = ptTable;
     ptIndexTable->iIndexFieldId = iIndexFieldId;
     ptIndexTable->iSortFieldId = iSortFieldId;
+    ptIndexTable->iColumnsId = -1;
+    if (ptTable->iShardCnt > 1 &&
+        kr_index_set_shards(ptIndex, ptTable->iShardCnt) != 0) {
+        fprintf(stderr, "kr_index_set_shards [%d] failed!\n", iIndexId);
+        kr_free(ptIndexTable);
+        return NULL;
+    }
+
+    /*tables sharing an index get one writer*/
+    T_KRListNode *node = ptIndex->pIndexTableList->head;
+    for (; node; node=node->next) {
+        T_KRTable *ptOther = ((T_KRIndexTable *)kr_list_value(node))->ptTable;
+        if (ptOther->ptIngest != ptTable->ptIngest) {
+            kr_ingest_merge(ptDB, ptTable->ptIngest, ptOther->ptIngest);
+        }
+    }
     
     kr_list_add_tail(ptIndex->pIndexTableList, ptIndexTable);
     kr_list_add_tail(ptTable->pIndexTableList, ptIndexTable);
@@ -301,18 +1254,551 @@ T_KRIndexTable* kr_index_table_create(T_KRDB *ptDB,
 }
 
 
+/* those lists match by id, remove this very node */
+static void kr_index_table_unlink(T_KRList *ptList, T_KRIndexTable *ptIndexTable)
+{
+    T_KRListNode *node = ptList->head;
+    while (node) {
+        if (kr_list_value(node) == ptIndexTable) {
+            kr_list_delete(ptList, node);
+            return;
+        }
+        node = node->next;
+    }
+}
+
+
 void kr_index_table_drop(T_KRIndexTable *ptIndexTable)
 {
     T_KRTable *ptTable = ptIndexTable->ptTable;
     T_KRIndex *ptIndex = ptIndexTable->ptIndex;
 
-    kr_list_remove(ptIndex->pIndexTableList, ptIndexTable);
-    kr_list_remove(ptTable->pIndexTableList, ptIndexTable);
+    kr_index_table_unlink(ptIndex->pIndexTableList, ptIndexTable);
+    kr_index_table_unlink(ptTable->pIndexTableList, ptIndexTable);
 
+    kr_free(ptIndexTable->ptDecayDef);
+    kr_free(ptIndexTable->ptTopKDef);
+    kr_free(ptIndexTable->ptQuantileDef);
+    kr_free(ptIndexTable->ptRunDef);
+    kr_free(ptIndexTable->ptSequenceDef);
+    kr_free(ptIndexTable->ptColumnDef);
     kr_free(ptIndexTable);
 }
 
 
+/* register a decayed counter of this index table, 
+ * the same field and half-life share one counter,
+ * return the counter location in slots, -1 if failed
+ */
+int kr_index_decay_register(T_KRIndexTable *ptIndexTable, 
+        int iFieldId, long lHalfLife)
+{
+    T_KRTable *ptTable = ptIndexTable->ptTable;
+    int iDecayId = -1;
+
+    if (lHalfLife <= 0) {
+        KR_LOG(KR_LOGERROR, "bad half-life [%ld]!", lHalfLife);
+        return -1;
+    }
+    if (iFieldId >= ptTable->iFieldCnt) {
+        KR_LOG(KR_LOGERROR, "table [%d] field [%d] not found!", \
+                ptTable->iTableId, iFieldId);
+        return -1;
+    }
+
+    kr_table_lock(ptTable);
+    for (int i=0; i<ptIndexTable->iDecayDefCnt; i++) {
+        T_KRDecayDef *ptDecayDef = &ptIndexTable->ptDecayDef[i];
+        if (ptDecayDef->iFieldId == iFieldId && 
+            ptDecayDef->lHalfLife == lHalfLife) {
+            iDecayId = ptDecayDef->iDecayId;
+            goto UNLOCK;
+        }
+    }
+
+    /*appended to a copy, the writer may be reading the old one*/
+    int iDefCnt = ptIndexTable->iDecayDefCnt;
+    T_KRDecayDef *ptDecayDefs = kr_calloc(sizeof(T_KRDecayDef)*(iDefCnt+1));
+    if (ptDecayDefs == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptDecayDef failed!");
+        goto UNLOCK;
+    }
+    if (iDefCnt > 0) {
+        memcpy(ptDecayDefs, ptIndexTable->ptDecayDef, sizeof(T_KRDecayDef)*iDefCnt);
+    }
+    T_KRDecayDef *ptDecayDef = &ptDecayDefs[iDefCnt];
+    ptDecayDef->iDecayId = \
+        __sync_fetch_and_add(&ptIndexTable->ptIndex->iDecayCnt, 1);
+    ptDecayDef->iFieldId = iFieldId;
+    ptDecayDef->lHalfLife = lHalfLife;
+    ptDecayDef->dLambda = M_LN2 / lHalfLife;
+    kr_epoch_retire(ptTable->ptDB->ptEpoch, ptIndexTable->ptDecayDef, kr_free);
+    ptIndexTable->ptDecayDef = ptDecayDefs;
+    __sync_synchronize();
+    ptIndexTable->iDecayDefCnt++;
+    iDecayId = ptDecayDef->iDecayId;
+
+UNLOCK:
+    kr_table_unlock(ptTable);
+    return iDecayId;
+}
+
+
+/* value of key's decayed counter at tTime, 0 if nothing added,
+ * read without blocking the writer
+ */
+double kr_index_decay_value(T_KRIndex *ptIndex, int iDecayId, 
+        long lHalfLife, void *key, time_t tTime)
+{
+    T_KRIndexSolt *ptIndexSlot = kr_index_slot_get(ptIndex, key);
+    if (ptIndexSlot == NULL) {
+        return 0.0;
+    }
+
+    T_KRDecay stDecay = {0.0, 0};
+    unsigned int s;
+    do {
+        s = kr_seq_read_begin(&ptIndexSlot->uiSeq);
+        int iDecayCnt = ptIndexSlot->iDecayCnt;
+        __sync_synchronize();
+        T_KRDecay *ptDecay = ptIndexSlot->ptDecay;
+        if (iDecayId < iDecayCnt) {
+            stDecay = ptDecay[iDecayId];
+        }
+    } while (kr_seq_read_retry(&ptIndexSlot->uiSeq, s));
+
+    if (tTime <= stDecay.tUpdated) {
+        return stDecay.dValue;
+    }
+    return stDecay.dValue * \
+        exp(-M_LN2 / lHalfLife * (tTime - stDecay.tUpdated));
+}
+
+
+/* register a heavy hitters sketch of this index table,
+ * the same field and capacity share one sketch,
+ * return the sketch location in slots, -1 if failed
+ */
+int kr_index_topk_register(T_KRIndexTable *ptIndexTable, 
+        int iFieldId, unsigned int uiCapacity)
+{
+    T_KRTable *ptTable = ptIndexTable->ptTable;
+    int iTopKId = -1;
+
+    if (iFieldId < 0 || iFieldId >= ptTable->iFieldCnt) {
+        KR_LOG(KR_LOGERROR, "table [%d] field [%d] not found!", \
+                ptTable->iTableId, iFieldId);
+        return -1;
+    }
+
+    kr_table_lock(ptTable);
+    for (int i=0; i<ptIndexTable->iTopKDefCnt; i++) {
+        T_KRTopKDef *ptTopKDef = &ptIndexTable->ptTopKDef[i];
+        if (ptTopKDef->iFieldId == iFieldId && 
+            ptTopKDef->uiCapacity == uiCapacity) {
+            iTopKId = ptTopKDef->iTopKId;
+            goto UNLOCK;
+        }
+    }
+
+    /*appended to a copy, the writer may be reading the old one*/
+    int iDefCnt = ptIndexTable->iTopKDefCnt;
+    T_KRTopKDef *ptTopKDefs = kr_calloc(sizeof(T_KRTopKDef)*(iDefCnt+1));
+    if (ptTopKDefs == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptTopKDef failed!");
+        goto UNLOCK;
+    }
+    if (iDefCnt > 0) {
+        memcpy(ptTopKDefs, ptIndexTable->ptTopKDef, sizeof(T_KRTopKDef)*iDefCnt);
+    }
+    T_KRTopKDef *ptTopKDef = &ptTopKDefs[iDefCnt];
+    ptTopKDef->iTopKId = \
+        __sync_fetch_and_add(&ptIndexTable->ptIndex->iTopKCnt, 1);
+    ptTopKDef->iFieldId = iFieldId;
+    ptTopKDef->uiCapacity = uiCapacity;
+    kr_epoch_retire(ptTable->ptDB->ptEpoch, ptIndexTable->ptTopKDef, kr_free);
+    ptIndexTable->ptTopKDef = ptTopKDefs;
+    __sync_synchronize();
+    ptIndexTable->iTopKDefCnt++;
+    iTopKId = ptTopKDef->iTopKId;
+
+UNLOCK:
+    kr_table_unlock(ptTable);
+    return iTopKId;
+}
+
+
+/* key's heavy hitters sketch, NULL if nothing added,
+ * the sketch is read under key's slot held in *pptIndexSlot,
+ * which must be released if not NULL
+ */
+T_KRTopK *kr_index_topk_hold(T_KRIndex *ptIndex, int iTopKId, void *key,
+        T_KRIndexSolt **pptIndexSlot)
+{
+    T_KRIndexSolt *ptIndexSlot = kr_index_slot_hold(ptIndex, key);
+    *pptIndexSlot = ptIndexSlot;
+    if (ptIndexSlot == NULL || iTopKId >= ptIndexSlot->iTopKCnt) {
+        return NULL;
+    }
+    return ptIndexSlot->pptTopK[iTopKId];
+}
+
+
+/* register a value digest of a numeric field of this index table,
+ * the same field, window and compression share one digest,
+ * return the digest location in slots, -1 if failed
+ */
+int kr_index_quantile_register(T_KRIndexTable *ptIndexTable, 
+        int iFieldId, long lWindow, double dCompression)
+{
+    T_KRTable *ptTable = ptIndexTable->ptTable;
+    int iQuantileId = -1;
+
+    if (lWindow <= 0) {
+        KR_LOG(KR_LOGERROR, "bad quantile window [%ld]!", lWindow);
+        return -1;
+    }
+    if (iFieldId < 0 || iFieldId >= ptTable->iFieldCnt) {
+        KR_LOG(KR_LOGERROR, "table [%d] field [%d] not found!", \
+                ptTable->iTableId, iFieldId);
+        return -1;
+    }
+    E_KRType eType = ptTable->ptFieldDef[iFieldId].type;
+    if (eType != KR_TYPE_INT && eType != KR_TYPE_LONG && 
+        eType != KR_TYPE_DOUBLE) {
+        KR_LOG(KR_LOGERROR, "table [%d] field [%d] not numeric!", \
+                ptTable->iTableId, iFieldId);
+        return -1;
+    }
+
+    kr_table_lock(ptTable);
+    for (int i=0; i<ptIndexTable->iQuantileDefCnt; i++) {
+        T_KRQuantileDef *ptQuantileDef = &ptIndexTable->ptQuantileDef[i];
+        if (ptQuantileDef->iFieldId == iFieldId && 
+            ptQuantileDef->lWindow == lWindow &&
+            ptQuantileDef->dCompression == dCompression) {
+            iQuantileId = ptQuantileDef->iQuantileId;
+            goto UNLOCK;
+        }
+    }
+
+    /*appended to a copy, the writer may be reading the old one*/
+    int iDefCnt = ptIndexTable->iQuantileDefCnt;
+    T_KRQuantileDef *ptQuantileDefs = \
+        kr_calloc(sizeof(T_KRQuantileDef)*(iDefCnt+1));
+    if (ptQuantileDefs == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptQuantileDef failed!");
+        goto UNLOCK;
+    }
+    if (iDefCnt > 0) {
+        memcpy(ptQuantileDefs, ptIndexTable->ptQuantileDef, 
+                sizeof(T_KRQuantileDef)*iDefCnt);
+    }
+    T_KRQuantileDef *ptQuantileDef = &ptQuantileDefs[iDefCnt];
+    ptQuantileDef->iQuantileId = \
+        __sync_fetch_and_add(&ptIndexTable->ptIndex->iQuantileCnt, 1);
+    ptQuantileDef->iFieldId = iFieldId;
+    ptQuantileDef->lWindow = lWindow;
+    ptQuantileDef->dCompression = dCompression;
+    kr_epoch_retire(ptTable->ptDB->ptEpoch, ptIndexTable->ptQuantileDef, kr_free);
+    ptIndexTable->ptQuantileDef = ptQuantileDefs;
+    __sync_synchronize();
+    ptIndexTable->iQuantileDefCnt++;
+    iQuantileId = ptQuantileDef->iQuantileId;
+
+UNLOCK:
+    kr_table_unlock(ptTable);
+    return iQuantileId;
+}
+
+
+/* merge key's digests of the panes in the window ending at tTime
+ * into ptTDigest, a pane partly in it is merged whole,
+ * the writer waits while they are merged, 
+ * return the number of panes merged
+ */
+int kr_index_quantile_merge(T_KRIndex *ptIndex, int iQuantileId, 
+        long lWindow, void *key, time_t tTime, T_KRTDigest *ptTDigest)
+{
+    T_KRIndexSolt *ptIndexSlot = kr_index_slot_hold(ptIndex, key);
+    if (ptIndexSlot == NULL) {
+        return 0;
+    }
+
+    int iMerged = 0;
+    long lSpan = kr_quantile_span(lWindow);
+    if (iQuantileId < ptIndexSlot->iQuantileCnt && 
+        ptIndexSlot->pptQuantile[iQuantileId] != NULL) {
+        T_KRQuantile *ptQuantile = ptIndexSlot->pptQuantile[iQuantileId];
+        for (int i=0; i<KR_QUANTILE_PANES+1; i++) {
+            if (ptQuantile->ptDigest[i] == NULL ||
+                ptQuantile->tPane[i] > tTime ||
+                ptQuantile->tPane[i] + lSpan <= tTime - lWindow) {
+                continue;
+            }
+            kr_tdigest_merge(ptTDigest, ptQuantile->ptDigest[i]);
+            iMerged++;
+        }
+    }
+    kr_index_slot_release(ptIndexSlot);
+    return iMerged;
+}
+
+
+/* register a run of a numeric field of this index table,
+ * rising unless bFalling, the same field and direction share one run,
+ * return the run location in slots, -1 if failed
+ */
+int kr_index_run_register(T_KRIndexTable *ptIndexTable, 
+        int iFieldId, kr_bool bFalling)
+{
+    T_KRTable *ptTable = ptIndexTable->ptTable;
+    int iRunId = -1;
+
+    if (iFieldId < 0 || iFieldId >= ptTable->iFieldCnt) {
+        KR_LOG(KR_LOGERROR, "table [%d] field [%d] not found!", \
+                ptTable->iTableId, iFieldId);
+        return -1;
+    }
+    E_KRType eType = ptTable->ptFieldDef[iFieldId].type;
+    if (eType != KR_TYPE_INT && eType != KR_TYPE_LONG && 
+        eType != KR_TYPE_DOUBLE) {
+        KR_LOG(KR_LOGERROR, "table [%d] field [%d] not numeric!", \
+                ptTable->iTableId, iFieldId);
+        return -1;
+    }
+
+    kr_table_lock(ptTable);
+    for (int i=0; i<ptIndexTable->iRunDefCnt; i++) {
+        T_KRRunDef *ptRunDef = &ptIndexTable->ptRunDef[i];
+        if (ptRunDef->iFieldId == iFieldId && 
+            ptRunDef->bFalling == bFalling) {
+            iRunId = ptRunDef->iRunId;
+            goto UNLOCK;
+        }
+    }
+
+    /*appended to a copy, the writer may be reading the old one*/
+    int iDefCnt = ptIndexTable->iRunDefCnt;
+    T_KRRunDef *ptRunDefs = kr_calloc(sizeof(T_KRRunDef)*(iDefCnt+1));
+    if (ptRunDefs == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptRunDef failed!");
+        goto UNLOCK;
+    }
+    if (iDefCnt > 0) {
+        memcpy(ptRunDefs, ptIndexTable->ptRunDef, sizeof(T_KRRunDef)*iDefCnt);
+    }
+    T_KRRunDef *ptRunDef = &ptRunDefs[iDefCnt];
+    ptRunDef->iRunId = __sync_fetch_and_add(&ptIndexTable->ptIndex->iRunCnt, 1);
+    ptRunDef->iFieldId = iFieldId;
+    ptRunDef->eType = eType;
+    ptRunDef->bFalling = bFalling;
+    kr_epoch_retire(ptTable->ptDB->ptEpoch, ptIndexTable->ptRunDef, kr_free);
+    ptIndexTable->ptRunDef = ptRunDefs;
+    __sync_synchronize();
+    ptIndexTable->iRunDefCnt++;
+    iRunId = ptRunDef->iRunId;
+
+UNLOCK:
+    kr_table_unlock(ptTable);
+    return iRunId;
+}
+
+
+/* copy key's latest run into ptRun, zeroed if nothing added,
+ * partial if records it counts may not be kept,
+ * read without blocking the writer
+ */
+void kr_index_run_value(T_KRIndex *ptIndex, int iRunId, 
+        void *key, T_KRRun *ptRun)
+{
+    memset(ptRun, 0x00, sizeof(T_KRRun));
+    T_KRIndexSolt *ptIndexSlot = kr_index_slot_get(ptIndex, key);
+    if (ptIndexSlot == NULL) {
+        return;
+    }
+
+    time_t tExtMaxTransTime;
+    unsigned int s;
+    do {
+        s = kr_seq_read_begin(&ptIndexSlot->uiSeq);
+        tExtMaxTransTime = ptIndexSlot->tExtMaxTransTime;
+        int iRunCnt = ptIndexSlot->iRunCnt;
+        __sync_synchronize();
+        T_KRRun *ptRuns = ptIndexSlot->ptRun;
+        if (iRunId < iRunCnt) {
+            *ptRun = ptRuns[iRunId];
+        }
+    } while (kr_seq_read_retry(&ptIndexSlot->uiSeq, s));
+
+    /*a record removed may have been one of the run's*/
+    if (ptRun->lLength > 0 && tExtMaxTransTime >= ptRun->tMinTransTime) {
+        ptRun->bPartial = TRUE;
+    }
+}
+
+
+/* register a pattern NFA of this index table for lOwnerId,
+ * registered again with the same pattern shares the NFA,
+ * return the NFA location in slots, -1 if failed
+ */
+int kr_index_sequence_register(T_KRIndexTable *ptIndexTable, 
+        long lOwnerId, T_KRSeqPattern *ptPattern)
+{
+    T_KRTable *ptTable = ptIndexTable->ptTable;
+    int iSequenceId = -1;
+
+    if (ptPattern->steps <= 0 || ptPattern->steps > KR_SEQUENCE_STEPS_MAX ||
+        ptPattern->window <= 0) {
+        KR_LOG(KR_LOGERROR, "bad pattern steps [%d] window [%ld]!", \
+                ptPattern->steps, ptPattern->window);
+        return -1;
+    }
+
+    kr_table_lock(ptTable);
+    for (int i=0; i<ptIndexTable->iSequenceDefCnt; i++) {
+        T_KRSequenceDef *ptSequenceDef = &ptIndexTable->ptSequenceDef[i];
+        if (ptSequenceDef->lOwnerId == lOwnerId && 
+            memcmp(&ptSequenceDef->stPattern, ptPattern, 
+                sizeof(T_KRSeqPattern)) == 0) {
+            iSequenceId = ptSequenceDef->iSequenceId;
+            goto UNLOCK;
+        }
+    }
+
+    /*appended to a copy, the writer may be reading the old one*/
+    int iDefCnt = ptIndexTable->iSequenceDefCnt;
+    T_KRSequenceDef *ptSequenceDefs = kr_calloc(sizeof(T_KRSequenceDef)*(iDefCnt+1));
+    if (ptSequenceDefs == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptSequenceDef failed!");
+        goto UNLOCK;
+    }
+    if (iDefCnt > 0) {
+        memcpy(ptSequenceDefs, ptIndexTable->ptSequenceDef, sizeof(T_KRSequenceDef)*iDefCnt);
+    }
+    T_KRSequenceDef *ptSequenceDef = &ptSequenceDefs[iDefCnt];
+    ptSequenceDef->iSequenceId = \
+        __sync_fetch_and_add(&ptIndexTable->ptIndex->iSequenceCnt, 1);
+    ptSequenceDef->lOwnerId = lOwnerId;
+    memcpy(&ptSequenceDef->stPattern, ptPattern, sizeof(T_KRSeqPattern));
+    kr_epoch_retire(ptTable->ptDB->ptEpoch, ptIndexTable->ptSequenceDef, kr_free);
+    ptIndexTable->ptSequenceDef = ptSequenceDefs;
+    __sync_synchronize();
+    ptIndexTable->iSequenceDefCnt++;
+    iSequenceId = ptSequenceDef->iSequenceId;
+
+UNLOCK:
+    kr_table_unlock(ptTable);
+    return iSequenceId;
+}
+
+
+static T_KRSequenceDef *kr_index_sequence_def(T_KRIndexTable *ptIndexTable, 
+        int iSequenceId)
+{
+    int iSequenceDefCnt = ptIndexTable->iSequenceDefCnt;
+    __sync_synchronize();
+    T_KRSequenceDef *ptSequenceDef = ptIndexTable->ptSequenceDef;
+    for (int i=0; i<iSequenceDefCnt; i++) {
+        if (ptSequenceDef[i].iSequenceId == iSequenceId) {
+            return &ptSequenceDef[i];
+        }
+    }
+    return NULL;
+}
+
+
+/* feed the steps matched by a record of key inserted at tTime,
+ * partial matches are kept in key's slot, so they survive records removed
+ */
+void kr_index_sequence_advance(T_KRIndexTable *ptIndexTable, 
+        int iSequenceId, void *key, unsigned int uiMask, time_t tTime)
+{
+    T_KRSequenceDef *ptSequenceDef = \
+        kr_index_sequence_def(ptIndexTable, iSequenceId);
+    if (ptSequenceDef == NULL) {
+        return;
+    }
+    T_KRIndexSolt *ptIndexSlot = kr_index_slot_hold(ptIndexTable->ptIndex, key);
+    if (ptIndexSlot == NULL) {
+        return;
+    }
+
+    /*NFAs registered after this slot created*/
+    int iSequenceCnt = ptIndexTable->ptIndex->iSequenceCnt;
+    if (ptIndexSlot->iSequenceCnt < iSequenceCnt) {
+        T_KRSequence **pptSequence = kr_realloc(ptIndexSlot->pptSequence,
+                sizeof(T_KRSequence *)*iSequenceCnt);
+        if (pptSequence == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_realloc pptSequence failed!");
+            goto UNLOCK;
+        }
+        memset(&pptSequence[ptIndexSlot->iSequenceCnt], 0x00,
+                sizeof(T_KRSequence *)*(iSequenceCnt-ptIndexSlot->iSequenceCnt));
+        ptIndexSlot->pptSequence = pptSequence;
+        ptIndexSlot->iSequenceCnt = iSequenceCnt;
+    }
+
+    T_KRSequence **pptSequence = &ptIndexSlot->pptSequence[iSequenceId];
+    if (*pptSequence == NULL) {
+        /*nothing to keep until its first step matched*/
+        if (!(uiMask & 1U)) goto UNLOCK;
+        *pptSequence = kr_sequence_new(ptSequenceDef->stPattern.steps);
+        if (*pptSequence == NULL) goto UNLOCK;
+    }
+    kr_sequence_advance(*pptSequence, &ptSequenceDef->stPattern, uiMask, tTime);
+    /*partial matches started by now are gone a window later*/
+    if (tTime + ptSequenceDef->stPattern.window > ptIndexSlot->tExpire) {
+        ptIndexSlot->tExpire = tTime + ptSequenceDef->stPattern.window;
+    }
+
+UNLOCK:
+    kr_index_slot_release(ptIndexSlot);
+}
+
+
+/* forget key's partial matches, before replaying its records */
+void kr_index_sequence_reset(T_KRIndexTable *ptIndexTable, 
+        int iSequenceId, void *key)
+{
+    T_KRIndexSolt *ptIndexSlot = kr_index_slot_hold(ptIndexTable->ptIndex, key);
+    if (ptIndexSlot == NULL) {
+        return;
+    }
+    if (iSequenceId < ptIndexSlot->iSequenceCnt &&
+        ptIndexSlot->pptSequence[iSequenceId] != NULL) {
+        kr_sequence_reset(ptIndexSlot->pptSequence[iSequenceId]);
+    }
+    kr_index_slot_release(ptIndexSlot);
+}
+
+
+/* steps matched by key's most advanced partial match alive at tTime */
+int kr_index_sequence_progress(T_KRIndexTable *ptIndexTable, 
+        int iSequenceId, void *key, time_t tTime)
+{
+    int iProgress = 0;
+
+    T_KRSequenceDef *ptSequenceDef = \
+        kr_index_sequence_def(ptIndexTable, iSequenceId);
+    if (ptSequenceDef == NULL) {
+        return 0;
+    }
+    T_KRIndexSolt *ptIndexSlot = kr_index_slot_hold(ptIndexTable->ptIndex, key);
+    if (ptIndexSlot == NULL) {
+        return 0;
+    }
+    if (iSequenceId < ptIndexSlot->iSequenceCnt &&
+        ptIndexSlot->pptSequence[iSequenceId] != NULL) {
+        iProgress = kr_sequence_progress(ptIndexSlot->pptSequence[iSequenceId],
+                &ptSequenceDef->stPattern, tTime);
+    }
+    kr_index_slot_release(ptIndexSlot);
+
+    return iProgress;
+}
+
+
 static inline int kr_tableid_match(void *ptr, void *key)
 {
     T_KRTable *ptTable = (T_KRTable *)ptr; 
@@ -328,17 +1814,20 @@ static inline int kr_indexid_match(void *ptr, void *key)
 static inline int kr_index_table_match(void *ptr, void *key)
 {
     T_KRIndexTable *ptIndexTable1 = (T_KRIndexTable *)ptr; 
-    T_KRIndexTable *ptIndexTable2 = (T_KRIndexTable *)ptr;
+    T_KRIndexTable *ptIndexTable2 = (T_KRIndexTable *)key;
     T_KRIndex *ptIndex1 = ptIndexTable1->ptIndex;
     T_KRIndex *ptIndex2 = ptIndexTable2->ptIndex;
     T_KRTable *ptTable1 = ptIndexTable1->ptTable;
     T_KRTable *ptTable2 = ptIndexTable2->ptTable;
     
-    if (ptIndex1->iIndexId != ptIndex2->iIndexId) {
-        return (ptIndex1->iIndexId == ptIndex2->iIndexId);
-    } else {
-        return (ptTable1->iTableId == ptTable2->iTableId);
-    }
+    return (ptIndex1->iIndexId == ptIndex2->iIndexId &&
+            ptTable1->iTableId == ptTable2->iTableId);
+}
+
+static inline int kr_freqid_match(void *ptr, void *key)
+{
+    T_KRFreq *ptFreq = (T_KRFreq *)ptr; 
+    return (*((const int*)&ptFreq->iFreqId) == *((const int*) key));
 }
 
 T_KRDB* kr_db_create(char *psDBName, T_DbsEnv *ptDbsEnv, T_KRModule *ptModule)
@@ -350,6 +1839,12 @@ T_KRDB* kr_db_create(char *psDBName, T_DbsEnv *ptDbsEnv, T_KRModule *ptModule)
     }
     strncpy(ptDB->caDBName, psDBName, sizeof(ptDB->caDBName));
     ptDB->dbsenv = ptDbsEnv;
+    ptDB->ptEpoch = kr_epoch_new();
+    if (ptDB->ptEpoch == NULL) {
+        fprintf(stderr, "kr_epoch_new failed!\n");
+        kr_free(ptDB);
+        return NULL;
+    }
 
     ptDB->pTableList = kr_list_new();
     kr_list_set_match(ptDB->pTableList, (KRCompareFunc )kr_tableid_match);
@@ -363,6 +1858,9 @@ T_KRDB* kr_db_create(char *psDBName, T_DbsEnv *ptDbsEnv, T_KRModule *ptModule)
     kr_list_set_match(ptDB->pIndexTableList, (KRCompareFunc )kr_index_table_match);
     kr_list_set_free(ptDB->pIndexTableList, (KRFreeFunc )kr_index_table_drop);
 
+    ptDB->pFreqList = kr_list_new();
+    kr_list_set_match(ptDB->pFreqList, (KRCompareFunc )kr_freqid_match);
+    kr_list_set_free(ptDB->pFreqList, (KRFreeFunc )kr_freq_drop);
 
     return ptDB;
 }
@@ -370,9 +1868,14 @@ T_KRDB* kr_db_create(char *psDBName, T_DbsEnv *ptDbsEnv, T_KRModule *ptModule)
 
 void kr_db_drop(T_KRDB *ptDB)
 {
+    /*index tables and freqs refer to tables, dropped first,
+     *the lists' free funcs drop each, tables close their stores*/
+    kr_list_destroy(ptDB->pIndexTableList);
+    kr_list_destroy(ptDB->pFreqList);
     kr_list_destroy(ptDB->pTableList);
     kr_list_destroy(ptDB->pIndexList);
-    kr_list_destroy(ptDB->pIndexTableList);
+    /*last, retired memory may be of anything above*/
+    kr_epoch_free(ptDB->ptEpoch);
     kr_free(ptDB);
 }
 
@@ -400,3 +1903,73 @@ T_KRIndexTable* kr_index_table_get(T_KRDB *ptDB, int iIndexId, int iTableId)
     }
     return NULL;
 }
+
+
+T_KRFreq* kr_freq_create(T_KRDB *ptDB, int iFreqId, 
+        int iTableId, int iFieldId, long lWindow)
+{
+    T_KRTable *ptTable = kr_table_get(ptDB, iTableId);
+    if (ptTable == NULL) {
+        fprintf(stderr, "kr_table_get [%d] failed!\n", iTableId);
+        return NULL;
+    }
+    if (iFieldId < 0 || iFieldId >= ptTable->iFieldCnt || lWindow <= 0) {
+        fprintf(stderr, "bad field [%d] or window [%ld]!\n", iFieldId, lWindow);
+        return NULL;
+    }
+
+    T_KRFreq *ptFreq = kr_calloc(sizeof(T_KRFreq));
+    if (ptFreq == NULL) {
+        fprintf(stderr, "kr_calloc ptFreq failed!\n");
+        return NULL;
+    }
+    ptFreq->iFreqId = iFreqId;
+    ptFreq->ptTable = ptTable;
+    ptFreq->iFieldId = iFieldId;
+    ptFreq->lWindow = lWindow;
+    /*buckets cover the window, at least one second each*/
+    long lSpan = (lWindow + KR_FREQ_BUCKETS - 1) / KR_FREQ_BUCKETS;
+    ptFreq->ptSketch = kr_cmsketch_new(KR_FREQ_DEPTH, KR_FREQ_WIDTH, 
+            KR_FREQ_BUCKETS, lSpan);
+    if (ptFreq->ptSketch == NULL) {
+        fprintf(stderr, "kr_cmsketch_new failed!\n");
+        kr_free(ptFreq);
+        return NULL;
+    }
+
+    kr_table_lock(ptTable);
+    kr_list_add_tail(ptTable->pFreqList, ptFreq);
+    kr_table_unlock(ptTable);
+    kr_list_add_tail(ptDB->pFreqList, ptFreq);
+
+    return ptFreq;
+}
+
+
+void kr_freq_drop(T_KRFreq *ptFreq)
+{
+    kr_list_remove(ptFreq->ptTable->pFreqList, ptFreq);
+    kr_cmsketch_free(ptFreq->ptSketch);
+    kr_free(ptFreq);
+}
+
+
+T_KRFreq* kr_freq_get(T_KRDB *ptDB, int iFreqId)
+{
+    T_KRListNode *ptListNode = kr_list_search(ptDB->pFreqList, &iFreqId);
+    if (ptListNode != NULL) {
+        return (T_KRFreq *)kr_list_value(ptListNode);
+    }
+    return NULL;
+}
+
+
+/* times the field value of ptRecord seen in the window till its transtime */
+unsigned long kr_freq_estimate(T_KRFreq *ptFreq, T_KRRecord *ptRecord)
+{
+    uint64_t hash = kr_distinct_hash(
+            kr_field_get_value(ptRecord, ptFreq->iFieldId), 
+            kr_field_get_size(ptRecord, ptFreq->iFieldId));
+    return kr_cmsketch_estimate(ptFreq->ptSketch, hash, 
+            kr_get_transtime(ptRecord), ptFreq->lWindow);
+}
@@ -2,6 +2,15 @@
 #define __KR_DB_INTERNAL_H__
 
 #include "krutils/kr_utils.h"
+#include "krutils/kr_topk.h"
+#include "krutils/kr_tdigest.h"
+#include "krutils/kr_distinct.h"
+#include "krutils/kr_cmsketch.h"
+#include "krutils/kr_sequence.h"
+#include "krutils/kr_seqlock.h"
+#include "krutils/kr_epoch.h"
+#include "krutils/kr_keytable.h"
+#include "krutils/kr_slab.h"
 #include "dbs/dbs_basopr.h"
 
 typedef struct _kr_db_t T_KRDB;
@@ -9,10 +18,17 @@ typedef struct _kr_table_t T_KRTable;
 typedef struct _kr_index_t T_KRIndex;
 typedef struct _kr_index_table_t T_KRIndexTable;
 typedef struct _kr_index_slot_t T_KRIndexSolt;
+typedef struct _kr_freq_t T_KRFreq;
+typedef struct _kr_ingest_t T_KRIngest;
+typedef struct _kr_store_t T_KRStore;
+typedef struct _kr_persist_t T_KRPersist;
+typedef struct _kr_columns_t T_KRColumns;
 
 typedef struct _kr_field_def_t T_KRFieldDef;
 typedef struct _kr_record_t T_KRRecord;
 
+typedef void (*KRLateOutputFunc)(T_KRRecord *ptRecord);
+
 /*the two public fieldno of ptDB'field definition*/
 typedef enum {
     KR_FIELDID_PROCTIME    = 0,   /*timestamp of processing*/
@@ -25,6 +41,21 @@ typedef enum {
     KR_SIZEKEEPMODE_TIME    = '1'  /*keep transtime interval*/
 }E_KRSizeKeepMode;
 
+/*what to do with a record older than its table's watermark*/
+typedef enum {
+    KR_LATEPOLICY_ACCEPT    = 'A', /*insert as usual, no watermark*/
+    KR_LATEPOLICY_DROP      = 'D', /*discard it*/
+    KR_LATEPOLICY_SIDE      = 'S', /*hand it to the side output only*/
+    KR_LATEPOLICY_RETRACT   = 'R'  /*insert, state it touches re-aggregated*/
+}E_KRLatePolicy;
+
+/*result of kr_record_insert*/
+typedef enum {
+    KR_INSERT_INTIME        = 0,   /*inserted, not later than watermark*/
+    KR_INSERT_LATE          = 1,   /*inserted though late, retracting*/
+    KR_INSERT_DIVERTED      = 2    /*late, dropped or side output*/
+}E_KRInsertResult;
+
 /*field description*/
 struct _kr_field_def_t
 {
@@ -35,26 +66,230 @@ struct _kr_field_def_t
     size_t        offset;
 };
 
+/*record filter sets, one bitset for each kind of statistics item*/
+typedef enum {
+    KR_FILTERSET_SDI       = 0,   /*static dataitem filters*/
+    KR_FILTERSET_DDI       = 1,   /*dynamic dataitem filters*/
+    KR_FILTERSET_NUM       = 2
+}E_KRFilterSet;
+
+#define KR_FILTER_BITS_MAX  128
+
+/*filter results of a record, evaluated once while inserting,
+ *only valid while lStamp equals the stamp of the filters' owner
+ */
+typedef struct _kr_filter_bits_t
+{
+    long             lStamp;
+    unsigned char    caBits[KR_FILTER_BITS_MAX/8];
+}T_KRFilterBits;
+
 /*record stored in ptDB*/
 struct _kr_record_t
 {
+    T_KRSeqLock      uiSeq;          /*odd while its location is rewritten*/
+    unsigned int     uiLoc;          /*location in its table, kr_record_loc*/
     KRFreeFunc       pfFree;
     T_KRTable        *ptTable;
     char             *pRecBuf;
+    T_KRFilterBits   stFilter[KR_FILTERSET_NUM];
 };
 
-/*index's hashtable slot define*/
+/*exponentially decayed counter of one key, 16 bytes*/
+typedef struct _kr_decay_t
+{
+    double          dValue;             /* value at tUpdated */
+    time_t          tUpdated;           /* latest transtime added */
+}T_KRDecay;
+
+/*a counter decayed below this is zero, its slot may be freed*/
+#define KR_DECAY_EPSILON    1e-6
+/*half lives a counter is kept at most after its last record*/
+#define KR_DECAY_HALFLIVES  64
+
+/*decayed counter maintained by every insert of an index table*/
+typedef struct _kr_decay_def_t
+{
+    int             iDecayId;           /* slot's counter location */
+    int             iFieldId;           /* field added, -1 for counting */
+    long            lHalfLife;          /* seconds */
+    double          dLambda;            /* ln2/lHalfLife */
+}T_KRDecayDef;
+
+/*seconds heavy hitters of a key are kept after its last record*/
+#define KR_TOPK_HORIZON     (30*86400)
+
+/*heavy hitters of a field maintained by every insert of an index table*/
+typedef struct _kr_topk_def_t
+{
+    int             iTopKId;            /* slot's sketch location */
+    int             iFieldId;
+    unsigned int    uiCapacity;         /* keys counted */
+}T_KRTopKDef;
+
+/*panes a quantile's window is cut in, one more is kept for the pane
+ *partly out of the window*/
+#define KR_QUANTILE_PANES   4
+
+/*value distribution of a numeric field maintained by every insert 
+ *of an index table, by panes of lWindow/KR_QUANTILE_PANES seconds*/
+typedef struct _kr_quantile_def_t
+{
+    int             iQuantileId;        /* slot's digests location */
+    int             iFieldId;
+    long            lWindow;            /* seconds */
+    double          dCompression;       /* of each pane's digest */
+}T_KRQuantileDef;
+
+/*key's digests of the latest panes, in a ring by pane number*/
+typedef struct _kr_quantile_t
+{
+    time_t          tPane[KR_QUANTILE_PANES+1];     /* pane's first second */
+    T_KRTDigest     *ptDigest[KR_QUANTILE_PANES+1]; /* NULL if none added */
+}T_KRQuantile;
+
+/*latest run of a numeric field strictly rising or falling, 
+ *by the order records are inserted*/
+typedef struct _kr_run_def_t
+{
+    int             iRunId;             /* slot's run location */
+    int             iFieldId;
+    E_KRType        eType;              /* INT, LONG or DOUBLE */
+    kr_bool         bFalling;
+}T_KRRunDef;
+
+/*key's latest run, transtimes tell which records it covers*/
+typedef struct _kr_run_t
+{
+    long            lLength;            /* records in the run, 0 if none */
+    U_KRValue       uLast;              /* value of the latest one */
+    time_t          tLast;              /* transtime of the latest one */
+    time_t          tMinTransTime;
+    time_t          tMaxTransTime;
+    time_t          tBefore;            /* transtime of the record it 
+                                           started after, 0 if none */
+    kr_bool         bPartial;           /* records of it or before it
+                                           not seen or not kept */
+}T_KRRun;
+
+/*pattern matched per key, advanced by its owner with the steps
+ *a record matches, since predicates are not known here*/
+typedef struct _kr_sequence_def_t
+{
+    int             iSequenceId;        /* slot's NFA location */
+    long            lOwnerId;           /* id of the item registered it */
+    T_KRSeqPattern  stPattern;
+}T_KRSequenceDef;
+
+/*numeric field mirrored per key by every insert of an index table*/
+typedef struct _kr_column_def_t
+{
+    int             iFieldId;
+    E_KRType        eType;              /* INT, LONG or DOUBLE */
+}T_KRColumnDef;
+
+/*index's hashtable slot define,
+ *changed by the table's writer and sequence owners under uiSeq only,
+ *freed through the db's epoch once removed, back into its pool,
+ *its key is kept in the shard's keytable only
+ */
 struct _kr_index_slot_t
 {
+    T_KRSeqLock     uiSeq;
+    int             iRemoved;           /* out of the index, set under uiSeq */
     E_KRType        eKeyType;
-    void            *pKeyValue;
+    T_KRSlab        *ptPool;            /* allocated from, outlives the index */
     time_t          tLocMinProcTime;    /*set while add */
     time_t          tLocMinTransTime;   /*set while add */
     time_t          tExtMaxProcTime;    /*set while remove */
     time_t          tExtMaxTransTime;   /*set while remove */
-    T_KRList        *pRecList;
+    T_KRList        *pRecList;          /* stRecList */
+    T_KRList        stRecList;
+    unsigned long   ulRemoveStamp;      /* index's stamp when created or 
+                                           a record last removed */
+    time_t          tExpire;            /* transtime key statistics are
+                                           kept until with no records */
+    int             iDecayCnt;          /* counters allocated */
+    T_KRDecay       *ptDecay;           /* kept after records removed,
+                                           replaced when grown */
+    int             iTopKCnt;           /* sketches allocated */
+    T_KRTopK        **pptTopK;          /* kept after records removed */
+    int             iQuantileCnt;       /* digests allocated */
+    T_KRQuantile    **pptQuantile;      /* kept after records removed */
+    int             iRunCnt;            /* runs allocated */
+    T_KRRun         *ptRun;             /* replaced when grown */
+    int             iSequenceCnt;       /* NFAs allocated */
+    T_KRSequence    **pptSequence;      /* kept after records removed */
+    int             iColumnsCnt;        /* column groups allocated */
+    T_KRColumns     **pptColumns;       /* per index table, see kr_db_column.h */
 };
 
+/*global frequency sketch sizes*/
+#define KR_FREQ_DEPTH    4
+#define KR_FREQ_WIDTH    (1<<15)
+#define KR_FREQ_BUCKETS  12
+
+/*frequency of a field's values over all keys of a table,
+ *counted by every insert into a count-min sketch
+ */
+struct _kr_freq_t
+{
+    int              iFreqId;
+    T_KRTable        *ptTable;
+    int              iFieldId;
+    long             lWindow;             /* seconds */
+    T_KRCMSketch     *ptSketch;
+};
+
+/*most shards of a table or index*/
+#define KR_SHARD_MAX     64
+
+/*slots carved at a time from an index's pool*/
+#define KR_SLOT_SLAB_COUNT  256
+
+/*buckets of a shard looked at by an insert for slots expired*/
+#define KR_SLOT_SWEEP_COUNT 4
+
+/*keys of an index falling into one shard, see kr_index_shard*/
+typedef struct _kr_index_shard_t
+{
+    T_KRSeqLock      uiSeq;               /* bumped as slots added or removed */
+    T_KRKeyTable     *ptKeyTable;         /* key to slot, see kr_keytable_set_retire */
+    unsigned int     uiSweep;             /* bucket swept next by the writer */
+}T_KRIndexShard;
+
+/*segment of a table's ring, records located in 
+ *[uiRecordBase, uiRecordBase+uiRecordCap)*/
+typedef struct _kr_table_shard_t
+{
+    unsigned int     uiRecordBase;
+    unsigned int     uiRecordCap;
+    unsigned int     uiRecordLoc;         /* current location in segment */
+    unsigned int     uiRecordNum;         /* records number of segment */
+}T_KRTableShard;
+
+/*records of a segment, locations of a time kept table are
+ *its segment's number times this plus the record's place in it*/
+#define KR_SEGMENT_RECORDS   1024
+#define KR_SEGMENT_NO_MASK   (~0U/KR_SEGMENT_RECORDS)
+
+/*records of a time kept table are allocated a segment at a time,
+ *a segment is freed once all its records are older than keep value*/
+typedef struct _kr_segment_t
+{
+    unsigned int     uiSegNo;             /* masked by KR_SEGMENT_NO_MASK */
+    unsigned int     uiUsed;              /* records handed out */
+    time_t           tMaxTransTime;       /* of records inserted */
+    char             *pRecordBuff;
+}T_KRSegment;
+
+/*segments kept, by number modulo uiCap, replaced when grown*/
+typedef struct _kr_segment_dir_t
+{
+    unsigned int     uiCap;               /* power of two */
+    T_KRSegment      *ptSegment[];
+}T_KRSegmentDir;
+
 /*hash table index definition*/
 struct _kr_index_t
 {
@@ -63,8 +298,19 @@ struct _kr_index_t
     char             caIndexName[30+1];
     char             caIndexDesc[100+1];
     E_KRType         eIndexFieldType;
-    T_KRHashTable    *pHashTable;
+    KRHashFunc       pfKeyHash;
+    int              iShardCnt;           /* 1 unless sharded by a table */
+    T_KRIndexShard   *ptShard;            /* resized and locked separately */
+    size_t           uiKeyInline;         /* string key bytes in buckets */
+    T_KRSlab         *ptSlotPool;         /* slots of every shard */
     T_KRList         *pIndexTableList;    /* tables in this index */
+    unsigned long    ulRemoveStamp;       /* last stamped on a slot */
+    int              iDecayCnt;           /* decayed counters of slots */
+    int              iTopKCnt;            /* heavy hitters of slots */
+    int              iQuantileCnt;        /* value digests of slots */
+    int              iRunCnt;             /* field runs of slots */
+    int              iSequenceCnt;        /* pattern NFAs of slots */
+    int              iColumnsCnt;         /* column groups of slots */
 };
 
 struct _kr_table_t
@@ -79,10 +325,36 @@ struct _kr_table_t
     int              iFieldCnt;         /* field count of this table */
     T_KRFieldDef     *ptFieldDef;       /* field define of this table */
     int              iRecordSize;       /* record size needed to allocated */
-    char             *pRecordBuff;      /* pointer to this table's buffer */
-    unsigned int     uiRecordLoc;       /* current record location*/
+    char             *pRecordBuff;      /* pointer to this table's buffer,
+                                           NULL if kept by time */
+    T_KRStore        *ptStore;          /* file mapped as the buffer, 
+                                           see kr_db_store.h */
+    T_KRSegmentDir   *ptSegDir;         /* segments if kept by time */
+    unsigned int     uiSegHead;         /* oldest segment kept */
+    unsigned int     uiSegNext;         /* segment allocated next */
+    unsigned long    ulSegAllocCnt;
+    unsigned long    ulSegFreeCnt;
+    unsigned int     uiRecordLoc;       /* current record location
+                                           of the segment last written*/
     unsigned int     uiRecordNum;       /* total records number*/
+    int              iShardCnt;         /* ring segments, 1 unless sharded */
+    T_KRTableShard   *ptShard;
+    T_KRIndexTable   *ptShardIndexTable;/* whose key picks the segment */
+    time_t           tMaxTransTime;     /* max transtime ever inserted */
+    long             lTransTimeSlack;   /* max lateness of transtime, a record
+                                           is never older than any record
+                                           inserted before it minus this */
+    E_KRLatePolicy   eLatePolicy;
+    long             lAllowedLateness;  /* seconds behind tMaxTransTime */
+    time_t           tWatermark;        /* tMaxTransTime-lAllowedLateness */
+    KRLateOutputFunc pfLateOutput;      /* side output of late records */
+    T_KRRecord       *ptLateRecord;     /* late record copied for side 
+                                           output, writer only */
+    unsigned long    ulLateCnt;         /* records older than watermark */
     T_KRList         *pIndexTableList;  /* indexes of this table */
+    T_KRList         *pFreqList;        /* frequencies of this table */
+    T_KRIngest       *ptIngest;         /* writer, shared by tables indexed
+                                           together, see kr_db_ingest.h */
 };
 
 struct _kr_index_table_t
@@ -91,6 +363,20 @@ struct _kr_index_table_t
     T_KRTable        *ptTable;
     int              iIndexFieldId;
     int              iSortFieldId;
+    /*defs are only appended, into a copy published before the count*/
+    volatile int     iDecayDefCnt;
+    T_KRDecayDef     *ptDecayDef;         /* updated while insert */
+    volatile int     iTopKDefCnt;
+    T_KRTopKDef      *ptTopKDef;          /* updated while insert */
+    volatile int     iQuantileDefCnt;
+    T_KRQuantileDef  *ptQuantileDef;      /* updated while insert */
+    volatile int     iRunDefCnt;
+    T_KRRunDef       *ptRunDef;           /* updated while insert */
+    volatile int     iSequenceDefCnt;
+    T_KRSequenceDef  *ptSequenceDef;      /* advanced by owners */
+    int              iColumnsId;          /* slot's column group, -1 if none */
+    volatile int     iColumnDefCnt;
+    T_KRColumnDef    *ptColumnDef;        /* mirrored while insert */
 };
 
 struct _kr_db_t
@@ -100,6 +386,9 @@ struct _kr_db_t
     T_KRList         *pTableList;          /* tables in this db */
     T_KRList         *pIndexList;          /* indexes of this db */
     T_KRList         *pIndexTableList;     /* indexes of this db */
+    T_KRList         *pFreqList;           /* global frequencies */
+    T_KREpoch        *ptEpoch;             /* index memory freed through */
+    T_KRPersist      *ptPersist;           /* write-behind, NULL if off */
 };
 
 
@@ -125,6 +414,15 @@ static inline void* kr_field_get_value(T_KRRecord *ptRecord, int ifldid)
     return &ptRecord->pRecBuf[field_offset];
 }
 
+/*bytes of the field's value, strings without terminator*/
+static inline size_t kr_field_get_size(T_KRRecord *ptRecord, int ifldid)
+{
+    if (kr_field_get_type(ptRecord, ifldid) == KR_TYPE_STRING) {
+        return strlen((char *)kr_field_get_value(ptRecord, ifldid));
+    }
+    return (size_t )kr_field_get_length(ptRecord, ifldid);
+}
+
 static inline time_t kr_get_proctime(T_KRRecord *ptRecord)
 {
     time_t tProcTime;
@@ -141,23 +439,174 @@ static inline time_t kr_get_transtime(T_KRRecord *ptRecord)
     return tTransTime;
 }
 
+/*whether ptRecord is older than its table's watermark,
+ *the watermark never moves back, so a late record stays late*/
+static inline int kr_record_is_late(T_KRRecord *ptRecord)
+{
+    T_KRTable *ptTable = (T_KRTable *)ptRecord->ptTable;
+    return ptTable->eLatePolicy != KR_LATEPOLICY_ACCEPT &&
+           kr_get_transtime(ptRecord) < ptTable->tWatermark;
+}
+
+/*location of ptRecord in its table's ring or segments, 
+ *it names the same record until the ring wraps around,
+ *or its segment is freed*/
+static inline unsigned int kr_record_loc(T_KRRecord *ptRecord)
+{
+    return ptRecord->uiLoc;
+}
+
+/*segment numbered uiSegNo of a time kept table, NULL if freed*/
+static inline T_KRSegment *kr_table_segment(T_KRTable *ptTable, 
+        unsigned int uiSegNo)
+{
+    T_KRSegmentDir *ptSegDir = ptTable->ptSegDir;
+    if (ptSegDir == NULL) return NULL;
+    T_KRSegment *ptSegment = ptSegDir->ptSegment[uiSegNo & (ptSegDir->uiCap-1)];
+    if (ptSegment == NULL || ptSegment->uiSegNo != uiSegNo) return NULL;
+    return ptSegment;
+}
+
+/*record at uiLoc, NULL if its segment freed already*/
+static inline T_KRRecord *kr_record_at(T_KRTable *ptTable, unsigned int uiLoc)
+{
+    if (ptTable->eKeepMode == KR_SIZEKEEPMODE_TIME) {
+        T_KRSegment *ptSegment = \
+            kr_table_segment(ptTable, uiLoc / KR_SEGMENT_RECORDS);
+        if (ptSegment == NULL) return NULL;
+        return (T_KRRecord *)&ptSegment->pRecordBuff[\
+            (size_t )(uiLoc % KR_SEGMENT_RECORDS)*ptTable->iRecordSize];
+    }
+    return (T_KRRecord *)&ptTable->pRecordBuff[\
+        (size_t )uiLoc*ptTable->iRecordSize];
+}
+
+/*shard of an index key, the same key always in the same shard*/
+static inline int kr_index_shard_id(T_KRIndex *ptIndex, void *key)
+{
+    if (ptIndex->iShardCnt == 1) return 0;
+    /*hashtables of shards index with the low bits of the same hash*/
+    unsigned int h = ptIndex->pfKeyHash(key) * 2654435761U;
+    return (int )((h >> 16) % ptIndex->iShardCnt);
+}
+
+static inline T_KRIndexShard *kr_index_shard(T_KRIndex *ptIndex, void *key)
+{
+    return &ptIndex->ptShard[kr_index_shard_id(ptIndex, key)];
+}
+
+/*segment of the table's ring holding location uiLoc*/
+static inline int kr_table_shard_at(T_KRTable *ptTable, unsigned int uiLoc)
+{
+    if (ptTable->iShardCnt == 1) return 0;
+    unsigned int uiShard = uiLoc / ptTable->ptShard[0].uiRecordCap;
+    return (int )MIN(uiShard, (unsigned int )ptTable->iShardCnt-1);
+}
+
+/*records are rewritten in place once their table's ring wraps around,
+ *a reader checks it had ptRecord's values for the whole read*/
+static inline unsigned int kr_record_read_begin(T_KRRecord *ptRecord)
+{
+    return kr_seq_read_begin(&ptRecord->uiSeq);
+}
+
+static inline int kr_record_read_retry(T_KRRecord *ptRecord, unsigned int s)
+{
+    return kr_seq_read_retry(&ptRecord->uiSeq, s);
+}
+
+/*a record seen in a slot held, read after the slot released*/
+typedef struct _kr_record_ref_t
+{
+    T_KRRecord       *ptRecord;
+    T_KRTable        *ptTable;
+    unsigned int     uiSeq;            /* even when seen */
+    unsigned int     uiLoc;
+}T_KRRecordRef;
+
+/*refer to ptRecord of a slot held, -1 if it is being rewritten,
+ *its writer waits for the slot before changing more than uiSeq*/
+static inline int kr_record_ref_set(T_KRRecordRef *ptRef, T_KRRecord *ptRecord)
+{
+    unsigned int s = ptRecord->uiSeq;
+    if (s & 1) return -1;
+    ptRef->ptRecord = ptRecord;
+    ptRef->ptTable = ptRecord->ptTable;
+    ptRef->uiSeq = s;
+    ptRef->uiLoc = ptRecord->uiLoc;
+    return 0;
+}
+
+/*whether ptRecord is ptOther, or a copy of it read by kr_record_ref_read*/
+static inline int kr_record_is(T_KRRecord *ptRecord, T_KRRecord *ptOther)
+{
+    return ptRecord->ptTable == ptOther->ptTable &&
+           ptRecord->uiLoc == ptOther->uiLoc;
+}
+
+/*return 1 if passed, 0 if not, -1 if not evaluated with this stamp*/
+static inline int kr_record_filter_test(T_KRRecord *ptRecord, 
+        E_KRFilterSet eSet, long lStamp, int iBit)
+{
+    T_KRFilterBits *ptBits = &ptRecord->stFilter[eSet];
+    if (iBit < 0 || iBit >= KR_FILTER_BITS_MAX || 
+        lStamp == 0 || ptBits->lStamp != lStamp) {
+        return -1;
+    }
+    return (ptBits->caBits[iBit/8] >> (iBit%8)) & 1;
+}
+
+static inline void kr_record_filter_set(T_KRRecord *ptRecord, 
+        E_KRFilterSet eSet, int iBit, int iPassed)
+{
+    T_KRFilterBits *ptBits = &ptRecord->stFilter[eSet];
+    if (iBit < 0 || iBit >= KR_FILTER_BITS_MAX) return;
+    if (iPassed) {
+        ptBits->caBits[iBit/8] |= (unsigned char )(1 << (iBit%8));
+    } else {
+        ptBits->caBits[iBit/8] &= (unsigned char )~(1 << (iBit%8));
+    }
+}
+
+/*stamp after all bits set, bits become visible to readers*/
+static inline void kr_record_filter_stamp(T_KRRecord *ptRecord, 
+        E_KRFilterSet eSet, long lStamp)
+{
+    __sync_synchronize();
+    ptRecord->stFilter[eSet].lStamp = lStamp;
+}
+
 extern T_KRRecord* kr_record_new(T_KRTable *ptTable);
+extern T_KRRecord* kr_record_shard_new(T_KRTable *ptTable, int iShard);
 extern void kr_record_free(T_KRRecord *ptRecord);
 extern int kr_record_compare(T_KRRecord *ptRec1, T_KRRecord *ptRec2, int iFieldId);
-extern void kr_record_insert(T_KRRecord *ptRecord);
+extern E_KRInsertResult kr_record_insert(T_KRRecord *ptRecord);
+extern int kr_record_divert(T_KRTable *ptTable, char *pRecBuf, size_t ulLen);
 extern void kr_record_delete(T_KRRecord *ptRecord);
+extern T_KRRecord *kr_record_ref_read(T_KRRecordRef *ptRef, T_KRIndex *ptIndex,
+        void *key, char **ppCopy, size_t *pulCopySize);
+extern void kr_rebuild_index_ins(T_KRIndexTable *ptIndextable, T_KRRecord *ptRecord);
+extern void kr_freq_add(T_KRFreq *ptFreq, T_KRRecord *ptRecord);
 
 extern T_KRIndex* kr_index_create(T_KRDB *ptDB,
         int iIndexId, char *psIndexName, 
         E_KRType eIndexFieldType);
 extern void kr_index_drop(T_KRIndex *ptIndex);
 extern T_KRIndex* kr_index_get(T_KRDB *ptDB, int iIndexId);
+extern void kr_index_set_key_inline(size_t uiKeyInline);
 
 extern T_KRTable* kr_table_create(T_KRDB *ptDB,
         int iTableId, char *psTableName, 
         E_KRSizeKeepMode eKeepMode, long lKeepValue);
 extern void kr_table_drop(T_KRTable *ptTable);
 extern T_KRTable* kr_table_get(T_KRDB *ptDB, int iTableId);
+extern int kr_table_set_late_policy(T_KRTable *ptTable, 
+        E_KRLatePolicy eLatePolicy, long lAllowedLateness, 
+        KRLateOutputFunc pfLateOutput);
+extern int kr_table_set_shards(T_KRTable *ptTable, int iShardCnt, int iIndexId);
+extern void kr_table_lock(T_KRTable *ptTable);
+extern void kr_table_unlock(T_KRTable *ptTable);
+extern int kr_table_shard_of(T_KRTable *ptTable, char *pRecBuf, size_t ulLen);
 
 extern T_KRIndexTable* kr_index_table_create(T_KRDB *ptDB,
         int iIndexId, int iTableId,
@@ -165,7 +614,40 @@ extern T_KRIndexTable* kr_index_table_create(T_KRDB *ptDB,
 extern void kr_index_table_drop(T_KRIndexTable *ptIndexTable);
 extern T_KRIndexTable* kr_index_table_get(T_KRDB *ptDB, int iIndexId, int iTableId);
 
+extern int kr_index_decay_register(T_KRIndexTable *ptIndexTable, 
+        int iFieldId, long lHalfLife);
+extern double kr_index_decay_value(T_KRIndex *ptIndex, int iDecayId, 
+        long lHalfLife, void *key, time_t tTime);
+extern int kr_index_topk_register(T_KRIndexTable *ptIndexTable, 
+        int iFieldId, unsigned int uiCapacity);
+extern T_KRIndexSolt *kr_index_slot_hold(T_KRIndex *ptIndex, void *key);
+extern void kr_index_slot_release(T_KRIndexSolt *ptIndexSlot);
+extern T_KRTopK *kr_index_topk_hold(T_KRIndex *ptIndex, int iTopKId, void *key,
+        T_KRIndexSolt **pptIndexSlot);
+extern int kr_index_quantile_register(T_KRIndexTable *ptIndexTable, 
+        int iFieldId, long lWindow, double dCompression);
+extern int kr_index_quantile_merge(T_KRIndex *ptIndex, int iQuantileId, 
+        long lWindow, void *key, time_t tTime, T_KRTDigest *ptTDigest);
+extern int kr_index_run_register(T_KRIndexTable *ptIndexTable, 
+        int iFieldId, kr_bool bFalling);
+extern void kr_index_run_value(T_KRIndex *ptIndex, int iRunId, 
+        void *key, T_KRRun *ptRun);
+extern int kr_index_sequence_register(T_KRIndexTable *ptIndexTable, 
+        long lOwnerId, T_KRSeqPattern *ptPattern);
+extern void kr_index_sequence_advance(T_KRIndexTable *ptIndexTable, 
+        int iSequenceId, void *key, unsigned int uiMask, time_t tTime);
+extern void kr_index_sequence_reset(T_KRIndexTable *ptIndexTable, 
+        int iSequenceId, void *key);
+extern int kr_index_sequence_progress(T_KRIndexTable *ptIndexTable, 
+        int iSequenceId, void *key, time_t tTime);
+
 extern T_KRDB* kr_db_create(char *psDBName, T_DbsEnv *ptDbsEnv, T_KRModule *ptModule);
 extern void kr_db_drop(T_KRDB *ptDB);
 
+extern T_KRFreq* kr_freq_create(T_KRDB *ptDB, int iFreqId, 
+        int iTableId, int iFieldId, long lWindow);
+extern void kr_freq_drop(T_KRFreq *ptFreq);
+extern T_KRFreq* kr_freq_get(T_KRDB *ptDB, int iFreqId);
+extern unsigned long kr_freq_estimate(T_KRFreq *ptFreq, T_KRRecord *ptRecord);
+
 #endif /* __KR_DB_INTERNAL_H__ */
@@ -0,0 +1,264 @@
+#include "kr_db_persist.h"
+#include <sys/time.h>
+#include <unistd.h>
+#include <sched.h>
+
+
+/* copy a row of ptTable's record into the ring, never waits,
+ * return 0 if queued, -1 if dropped for the ring full
+ */
+int kr_persist_put(T_KRPersist *ptPersist, T_KRTable *ptTable,
+        char *pRecBuf, size_t ulLen)
+{
+    unsigned long ulTicket = ptPersist->ulTail;
+    T_KRPersistCell *ptCell = NULL;
+
+    for (;;) {
+        ptCell = &ptPersist->ptCell[ulTicket % ptPersist->uiCellCnt];
+        long lDiff = (long )(ptCell->ulTicket - ulTicket);
+        if (lDiff == 0) {
+            if (__sync_bool_compare_and_swap(&ptPersist->ulTail,
+                        ulTicket, ulTicket+1)) {
+                break;
+            }
+        } else if (lDiff < 0) {
+            /*not flushed yet a lap ago, the detect path never waits*/
+            __sync_fetch_and_add(&ptPersist->ulDropped, 1);
+            return -1;
+        }
+        ulTicket = ptPersist->ulTail;
+    }
+
+    size_t ulSize = ptTable->iRecordSize - sizeof(T_KRRecord);
+    if (ulLen < ulSize) ulSize = ulLen;
+
+    T_KRExternalRow *ptRow = &ptCell->stRow;
+    ptRow->lDatasrcId = ptTable->iTableId;
+    ptRow->lProcTime = *(long *)(pRecBuf + \
+            ptTable->ptFieldDef[KR_FIELDID_PROCTIME].offset);
+    ptRow->lTransTime = *(long *)(pRecBuf + \
+            ptTable->ptFieldDef[KR_FIELDID_TRANSTIME].offset);
+    kr_db_external_key(ptTable, pRecBuf, ptRow->caKeyValue);
+    ptRow->iKeyInd = SQL_NTS;
+    ptRow->lRecordLength = ulSize;
+    ptRow->iRecordInd = ulSize;
+    memcpy(ptRow->caRecordBuffer, pRecBuf, ulSize);
+    __sync_synchronize();
+    ptCell->iFilled = 1;
+
+    /*a batch worth queued, no need to wait for the timer*/
+    if ((ulTicket+1) % ptPersist->iBatchRows == 0) {
+        pthread_cond_signal(&ptPersist->tCond);
+    }
+
+    return 0;
+}
+
+
+/*insert and commit iRows cells from ptCell, retried on a new connection*/
+static int kr_persist_write(T_KRPersist *ptPersist,
+        T_KRPersistCell *ptCell, int iRows)
+{
+    T_DbsEnv *ptDbsEnv = ptPersist->ptDbsEnv;
+    struct timeval tvBegin, tvEnd;
+
+    gettimeofday(&tvBegin, NULL);
+    for (int i=0; i<=ptPersist->iRetries; i++) {
+        if (i > 0) {
+            ptPersist->ulRetries++;
+            usleep(i*ptPersist->iBatchMsec*1000);
+        }
+        if (ptPersist->dbsenv == NULL) {
+            ptPersist->dbsenv = dbsConnect((char *)ptDbsEnv->dsn,
+                    (char *)ptDbsEnv->user, (char *)ptDbsEnv->pass);
+            if (ptPersist->dbsenv == NULL) {
+                KR_LOG(KR_LOGERROR, "dbsConnect [%s] failed!", ptDbsEnv->dsn);
+                continue;
+            }
+        }
+
+        if (kr_db_external_insert_rows(&ptCell->stRow, sizeof(T_KRPersistCell),
+                    iRows, ptPersist->dbsenv) == 0 &&
+            dbsCommit(ptPersist->dbsenv) == KR_DBOK) {
+            gettimeofday(&tvEnd, NULL);
+            ptPersist->ulCommitted += iRows;
+            ptPersist->ulBatches++;
+            ptPersist->tLastCommit = tvEnd.tv_sec;
+            ptPersist->lLastFlushUsec = \
+                (tvEnd.tv_sec-tvBegin.tv_sec)*1000000L + \
+                (tvEnd.tv_usec-tvBegin.tv_usec);
+            return 0;
+        }
+
+        /*the connection may be broken, tried again on a new one*/
+        dbsRollback(ptPersist->dbsenv);
+        dbsDisconnect(ptPersist->dbsenv);
+        ptPersist->dbsenv = NULL;
+    }
+
+    KR_LOG(KR_LOGERROR, "[%d] rows given up after [%d] retries!", \
+            iRows, ptPersist->iRetries);
+    ptPersist->ulFailed += iRows;
+    return -1;
+}
+
+
+/* write runs of filled cells from the head, a run ends at a cell not
+ * filled yet, at iBatchRows rows, or at the end of the ring
+ */
+static void kr_persist_flush(T_KRPersist *ptPersist)
+{
+    for (;;) {
+        unsigned int uiStart = ptPersist->ulHead % ptPersist->uiCellCnt;
+        int iRows = 0;
+        while (iRows < ptPersist->iBatchRows &&
+                uiStart+iRows < ptPersist->uiCellCnt &&
+                ptPersist->ptCell[uiStart+iRows].iFilled) {
+            iRows++;
+        }
+        if (iRows == 0) return;
+        __sync_synchronize();
+
+        kr_persist_write(ptPersist, &ptPersist->ptCell[uiStart], iRows);
+
+        /*hand the cells to the tickets of the next lap*/
+        for (int i=0; i<iRows; i++) {
+            T_KRPersistCell *ptCell = &ptPersist->ptCell[uiStart+i];
+            ptCell->iFilled = 0;
+            __sync_synchronize();
+            ptCell->ulTicket = ptPersist->ulHead + i + ptPersist->uiCellCnt;
+        }
+        ptPersist->ulHead += iRows;
+    }
+}
+
+
+static void *kr_persist_writer(void *arg)
+{
+    T_KRPersist *ptPersist = (T_KRPersist *)arg;
+
+    for (;;) {
+        int iStopping = ptPersist->iStopping;
+        if (!iStopping) {
+            struct timeval tvNow;
+            struct timespec tsWait;
+            gettimeofday(&tvNow, NULL);
+            long lNsec = tvNow.tv_usec*1000L + ptPersist->iBatchMsec*1000000L;
+            tsWait.tv_sec = tvNow.tv_sec + lNsec/1000000000L;
+            tsWait.tv_nsec = lNsec%1000000000L;
+
+            pthread_mutex_lock(&ptPersist->tLock);
+            if (!ptPersist->iStopping &&
+                    ptPersist->ulTail-ptPersist->ulHead <
+                    (unsigned long )ptPersist->iBatchRows) {
+                pthread_cond_timedwait(&ptPersist->tCond,
+                        &ptPersist->tLock, &tsWait);
+            }
+            pthread_mutex_unlock(&ptPersist->tLock);
+        }
+
+        kr_persist_flush(ptPersist);
+
+        /*stopped once every ticket taken before is flushed*/
+        if (iStopping) {
+            if (ptPersist->ulHead == ptPersist->ulTail) break;
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+
+/* start persisting records inserted into ptDB with a writer thread,
+ * queued in a ring of uiCellCnt cells, return 0 if started, -1 if failed
+ */
+int kr_db_persist_start(T_KRDB *ptDB, int iBatchRows, int iBatchMsec,
+        unsigned int uiCellCnt, int iRetries)
+{
+    if (ptDB->ptPersist != NULL || ptDB->dbsenv == NULL) {
+        KR_LOG(KR_LOGERROR, "persist started or no database!");
+        return -1;
+    }
+    if (iBatchRows <= 0 || iBatchMsec <= 0 || iRetries < 0 ||
+            uiCellCnt < (unsigned int )iBatchRows) {
+        KR_LOG(KR_LOGERROR, "persist batch [%d] rows [%d] msec, [%u] cells, "\
+                "[%d] retries invalid!", iBatchRows, iBatchMsec, uiCellCnt,
+                iRetries);
+        return -1;
+    }
+
+    /*a record must fit the RECORD_BUFFER column*/
+    T_KRListNode *node = ptDB->pTableList->head;
+    for (; node; node=node->next) {
+        T_KRTable *ptTable = (T_KRTable *)kr_list_value(node);
+        if (ptTable->iRecordSize-sizeof(T_KRRecord) > KR_EXTERNAL_RECORD_SIZE) {
+            KR_LOG(KR_LOGERROR, "table [%d] record size [%d] too large!", \
+                    ptTable->iTableId, ptTable->iRecordSize);
+            return -1;
+        }
+    }
+
+    T_KRPersist *ptPersist = kr_calloc(sizeof(T_KRPersist));
+    if (ptPersist == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptPersist failed!");
+        return -1;
+    }
+    ptPersist->ptCell = kr_calloc(sizeof(T_KRPersistCell)*uiCellCnt);
+    if (ptPersist->ptCell == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc [%u] cells failed!", uiCellCnt);
+        kr_free(ptPersist);
+        return -1;
+    }
+    for (unsigned int i=0; i<uiCellCnt; i++) {
+        ptPersist->ptCell[i].ulTicket = i;
+    }
+    ptPersist->uiCellCnt = uiCellCnt;
+    ptPersist->iBatchRows = iBatchRows;
+    ptPersist->iBatchMsec = iBatchMsec;
+    ptPersist->iRetries = iRetries;
+    ptPersist->ptDbsEnv = ptDB->dbsenv;
+    pthread_mutex_init(&ptPersist->tLock, NULL);
+    pthread_cond_init(&ptPersist->tCond, NULL);
+
+    int iResult = pthread_create(&ptPersist->tWriter, NULL,
+            kr_persist_writer, ptPersist);
+    if (iResult != 0) {
+        KR_LOG(KR_LOGERROR, "pthread_create writer failed[%s]!", \
+                strerror(iResult));
+        pthread_cond_destroy(&ptPersist->tCond);
+        pthread_mutex_destroy(&ptPersist->tLock);
+        kr_free(ptPersist->ptCell);
+        kr_free(ptPersist);
+        return -1;
+    }
+    ptDB->ptPersist = ptPersist;
+
+    return 0;
+}
+
+
+/* stop persisting after the rows queued flushed,
+ * only when records no longer inserted
+ */
+void kr_db_persist_stop(T_KRDB *ptDB)
+{
+    T_KRPersist *ptPersist = ptDB->ptPersist;
+    if (ptPersist == NULL) return;
+
+    pthread_mutex_lock(&ptPersist->tLock);
+    ptPersist->iStopping = 1;
+    pthread_cond_signal(&ptPersist->tCond);
+    pthread_mutex_unlock(&ptPersist->tLock);
+    pthread_join(ptPersist->tWriter, NULL);
+
+    KR_LOG(KR_LOGDEBUG, "persist stopped, committed [%lu] dropped [%lu] "\
+            "failed [%lu]", ptPersist->ulCommitted, ptPersist->ulDropped,
+            ptPersist->ulFailed);
+    if (ptPersist->dbsenv != NULL) dbsDisconnect(ptPersist->dbsenv);
+    pthread_cond_destroy(&ptPersist->tCond);
+    pthread_mutex_destroy(&ptPersist->tLock);
+    kr_free(ptPersist->ptCell);
+    kr_free(ptPersist);
+    ptDB->ptPersist = NULL;
+}
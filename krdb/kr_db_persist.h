@@ -0,0 +1,54 @@
+#ifndef __KR_DB_PERSIST_H__
+#define __KR_DB_PERSIST_H__
+
+#include <pthread.h>
+#include "kr_db_internal.h"
+#include "kr_db_external.h"
+
+typedef struct _kr_persist_cell_t
+{
+    volatile unsigned long ulTicket;   /* ticket allowed to fill it */
+    volatile int     iFilled;
+    T_KRExternalRow  stRow;            /* bound in place by the writer */
+}T_KRPersistCell;
+
+/* write-behind of inserted records to kr_tbl_record:
+ * producers of any thread take tickets and copy rows into a bounded 
+ * ring of cells without waiting, a row finding the ring full is dropped,
+ * one writer thread with its own connection inserts runs of filled cells
+ * with array binding, every iBatchRows rows or iBatchMsec milliseconds,
+ * a batch failed is retried iRetries times before given up
+ */
+struct _kr_persist_t
+{
+    volatile unsigned long ulTail;     /* next ticket taken */
+    char             caPad[64-sizeof(unsigned long)];
+    unsigned long    ulHead;           /* next ticket flushed, writer only */
+    unsigned int     uiCellCnt;
+    int              iBatchRows;
+    int              iBatchMsec;
+    int              iRetries;
+    volatile int     iStopping;
+    pthread_t        tWriter;
+    pthread_mutex_t  tLock;            /* of tCond only */
+    pthread_cond_t   tCond;
+    T_DbsEnv         *ptDbsEnv;        /* whose dsn the writer connects */
+    T_DbsEnv         *dbsenv;          /* writer's own, NULL if broken */
+    /*durability counters*/
+    volatile unsigned long ulDropped;  /* rows not queued, ring full */
+    unsigned long    ulCommitted;      /* rows committed */
+    unsigned long    ulBatches;        /* batches committed */
+    unsigned long    ulRetries;        /* batches tried again */
+    unsigned long    ulFailed;         /* rows given up */
+    time_t           tLastCommit;
+    long             lLastFlushUsec;   /* of the last batch committed */
+    T_KRPersistCell  *ptCell;
+};
+
+extern int kr_db_persist_start(T_KRDB *ptDB, int iBatchRows, int iBatchMsec,
+        unsigned int uiCellCnt, int iRetries);
+extern void kr_db_persist_stop(T_KRDB *ptDB);
+extern int kr_persist_put(T_KRPersist *ptPersist, T_KRTable *ptTable, 
+        char *pRecBuf, size_t ulLen);
+
+#endif /* __KR_DB_PERSIST_H__ */
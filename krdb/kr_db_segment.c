@@ -0,0 +1,166 @@
+#include "kr_db_segment.h"
+
+
+static void kr_segment_free(T_KRSegment *ptSegment)
+{
+    kr_free(ptSegment->pRecordBuff);
+    kr_free(ptSegment);
+}
+
+
+/*directory of twice the segments, the old one freed through the epoch*/
+static int kr_segment_dir_grow(T_KRTable *ptTable)
+{
+    T_KRSegmentDir *ptOldDir = ptTable->ptSegDir;
+    unsigned int uiCap = ptOldDir ? ptOldDir->uiCap*2 : KR_SEGMENT_DIR_INIT;
+    if (uiCap > KR_SEGMENT_NO_MASK+1) {
+        KR_LOG(KR_LOGERROR, "table [%d] segments exceed [%u]!", \
+                ptTable->iTableId, KR_SEGMENT_NO_MASK+1);
+        return -1;
+    }
+
+    T_KRSegmentDir *ptSegDir = \
+        kr_calloc(sizeof(T_KRSegmentDir)+sizeof(T_KRSegment *)*uiCap);
+    if (ptSegDir == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptSegDir [%u] failed!", uiCap);
+        return -1;
+    }
+    ptSegDir->uiCap = uiCap;
+    for (unsigned int n=ptTable->uiSegHead; n!=ptTable->uiSegNext; n++) {
+        unsigned int uiSegNo = n & KR_SEGMENT_NO_MASK;
+        ptSegDir->ptSegment[uiSegNo & (uiCap-1)] = \
+            ptOldDir->ptSegment[uiSegNo & (ptOldDir->uiCap-1)];
+    }
+
+    /*readers may be looking up the old one*/
+    __sync_synchronize();
+    ptTable->ptSegDir = ptSegDir;
+    if (ptOldDir != NULL) {
+        kr_epoch_retire(ptTable->ptDB->ptEpoch, ptOldDir, kr_free);
+    }
+    return 0;
+}
+
+
+static T_KRSegment *kr_segment_add(T_KRTable *ptTable)
+{
+    unsigned int uiLive = ptTable->uiSegNext - ptTable->uiSegHead;
+    if (ptTable->ptSegDir == NULL || uiLive == ptTable->ptSegDir->uiCap) {
+        if (kr_segment_dir_grow(ptTable) != 0) {
+            return NULL;
+        }
+    }
+
+    T_KRSegment *ptSegment = kr_calloc(sizeof(T_KRSegment));
+    if (ptSegment == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptSegment failed!");
+        return NULL;
+    }
+    ptSegment->pRecordBuff = \
+        kr_calloc((size_t )ptTable->iRecordSize*KR_SEGMENT_RECORDS);
+    if (ptSegment->pRecordBuff == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc pRecordBuff failed!");
+        kr_free(ptSegment);
+        return NULL;
+    }
+    ptSegment->uiSegNo = ptTable->uiSegNext & KR_SEGMENT_NO_MASK;
+
+    __sync_synchronize();
+    T_KRSegmentDir *ptSegDir = ptTable->ptSegDir;
+    ptSegDir->ptSegment[ptSegment->uiSegNo & (ptSegDir->uiCap-1)] = ptSegment;
+    ptTable->uiSegNext++;
+    ptTable->ulSegAllocCnt++;
+    return ptSegment;
+}
+
+
+/* delete the records of the oldest segments, all older than 
+ * keep value behind the table's max transtime, and free them,
+ * never the last one, the table is writing into it
+ */
+static void kr_segment_expire(T_KRTable *ptTable)
+{
+    time_t tKeepTime = ptTable->tMaxTransTime - ptTable->lKeepValue;
+    unsigned long ulFreed = 0;
+
+    while (ptTable->uiSegNext - ptTable->uiSegHead > 1) {
+        unsigned int uiSegNo = ptTable->uiSegHead & KR_SEGMENT_NO_MASK;
+        T_KRSegment *ptSegment = kr_table_segment(ptTable, uiSegNo);
+        if (ptSegment->tMaxTransTime >= tKeepTime) {
+            break;
+        }
+
+        for (unsigned int i=0; i<ptSegment->uiUsed; i++) {
+            T_KRRecord *ptRecord = (T_KRRecord *)&ptSegment->pRecordBuff[\
+                (size_t )i*ptTable->iRecordSize];
+            /*diverted while inserting*/
+            if (ptRecord->ptTable == NULL) continue;
+            kr_seq_write_lock(&ptRecord->uiSeq);
+            kr_record_delete(ptRecord);
+            kr_record_free(ptRecord);
+            kr_seq_write_unlock(&ptRecord->uiSeq);
+        }
+
+        T_KRSegmentDir *ptSegDir = ptTable->ptSegDir;
+        ptSegDir->ptSegment[uiSegNo & (ptSegDir->uiCap-1)] = NULL;
+        ptTable->uiSegHead++;
+        ptTable->ulSegFreeCnt++;
+        /*readers may still have its records*/
+        kr_epoch_retire(ptTable->ptDB->ptEpoch, ptSegment, 
+                (KRFreeFunc )kr_segment_free);
+        ulFreed++;
+    }
+
+    if (ulFreed > 0) {
+        kr_epoch_reclaim(ptTable->ptDB->ptEpoch);
+    }
+}
+
+
+/* new record of a time kept table, in the last segment 
+ * or a new one if full, NULL if failed
+ */
+T_KRRecord *kr_segment_record_new(T_KRTable *ptTable)
+{
+    kr_segment_expire(ptTable);
+
+    T_KRSegment *ptSegment = NULL;
+    if (ptTable->uiSegNext != ptTable->uiSegHead) {
+        ptSegment = kr_table_segment(ptTable, 
+                (ptTable->uiSegNext-1) & KR_SEGMENT_NO_MASK);
+    }
+    if (ptSegment == NULL || ptSegment->uiUsed == KR_SEGMENT_RECORDS) {
+        ptSegment = kr_segment_add(ptTable);
+        if (ptSegment == NULL) {
+            return NULL;
+        }
+    }
+
+    unsigned int uiPlace = ptSegment->uiUsed++;
+    T_KRRecord *ptRecord = (T_KRRecord *)&ptSegment->pRecordBuff[\
+        (size_t )uiPlace*ptTable->iRecordSize];
+    /*never used, odd till inserted as a rewritten one*/
+    ptRecord->uiSeq = 1;
+    ptRecord->uiLoc = ptSegment->uiSegNo*KR_SEGMENT_RECORDS + uiPlace;
+    ptRecord->pfFree = NULL;
+    ptRecord->ptTable = ptTable;
+    ptRecord->pRecBuf = (char *)ptRecord+sizeof(T_KRRecord);
+
+    ptTable->uiRecordLoc = ptRecord->uiLoc + 1;
+
+    return ptRecord;
+}
+
+
+/*free segments of a dropped table, as its ring would be*/
+void kr_segment_drop(T_KRTable *ptTable)
+{
+    if (ptTable->ptSegDir == NULL) {
+        return;
+    }
+    for (unsigned int n=ptTable->uiSegHead; n!=ptTable->uiSegNext; n++) {
+        kr_segment_free(kr_table_segment(ptTable, n & KR_SEGMENT_NO_MASK));
+    }
+    kr_free(ptTable->ptSegDir);
+    ptTable->ptSegDir = NULL;
+}
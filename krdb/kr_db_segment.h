@@ -0,0 +1,12 @@
+#ifndef __KR_DB_SEGMENT_H__
+#define __KR_DB_SEGMENT_H__
+
+#include "kr_db_internal.h"
+
+/*segments first allocated for a time kept table*/
+#define KR_SEGMENT_DIR_INIT  16
+
+extern T_KRRecord *kr_segment_record_new(T_KRTable *ptTable);
+extern void kr_segment_drop(T_KRTable *ptTable);
+
+#endif /* __KR_DB_SEGMENT_H__ */
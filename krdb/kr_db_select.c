@@ -0,0 +1,213 @@
+#include "kr_db_select.h"
+
+
+/* fetch the source's next record of the key, NULL when exhausted,
+ * compared again since the column may keep strings cut
+ */
+static void kr_select_source_fetch(T_KRSelect *ptSelect,
+        T_KRSelectSource *ptSource)
+{
+    T_KRRecord *ptRecord = NULL;
+    while ((ptRecord = kr_db_external_cursor_next(ptSource->ptCursor)) != NULL) {
+        void *val = kr_field_get_value(ptRecord, ptSource->iKeyFieldId);
+        if (ptSelect->pfKeyCompare(val, ptSelect->key) == 0) {
+            break;
+        }
+    }
+    ptSource->ptRecord = ptRecord;
+}
+
+
+/* refer to the slot's records later than tBeginTime, newest first,
+ * taken from the tail they are nearly sorted already, each read
+ * only when returned, since the ring may rewrite it meanwhile
+ */
+static int kr_select_hold_local(T_KRSelect *ptSelect,
+        T_KRIndexSolt *ptIndexSlot, time_t tBeginTime)
+{
+    unsigned int uiLen = kr_list_length(ptIndexSlot->pRecList);
+    if (uiLen == 0) return 0;
+
+    ptSelect->ptLocRef = kr_malloc(uiLen*sizeof(T_KRRecordRef));
+    if (ptSelect->ptLocRef == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_malloc ptLocRef failed!");
+        return -1;
+    }
+
+    T_KRListNode *node = ptIndexSlot->pRecList->tail;
+    for (; node; node=node->prev) {
+        T_KRRecord *ptRecord = (T_KRRecord *)kr_list_value(node);
+        time_t tTransTime = kr_get_transtime(ptRecord);
+        if (tTransTime < tBeginTime || tTransTime > ptSelect->tEndTime) {
+            continue;
+        }
+        T_KRRecordRef stRef;
+        if (kr_record_ref_set(&stRef, ptRecord) != 0) {
+            continue;
+        }
+        unsigned int i = ptSelect->uiLocCnt++;
+        while (i > 0 && kr_get_transtime(\
+                    ptSelect->ptLocRef[i-1].ptRecord) < tTransTime) {
+            ptSelect->ptLocRef[i] = ptSelect->ptLocRef[i-1];
+            i--;
+        }
+        ptSelect->ptLocRef[i] = stRef;
+    }
+
+    return 0;
+}
+
+
+/* open a cursor of the key in each table of the index over 
+ * [tBeginTime, tExtEndTime], failed if a table's rows keep 
+ * another index's key, rather than scanning all of them
+ */
+static int kr_select_open_external(T_KRSelect *ptSelect, T_KRIndex *ptIndex,
+        T_DbsEnv *dbsenv)
+{
+    int iTableCnt = kr_list_length(ptIndex->pIndexTableList);
+    ptSelect->ptSource = kr_calloc(iTableCnt*sizeof(T_KRSelectSource));
+    if (ptSelect->ptSource == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptSource failed!");
+        return -1;
+    }
+
+    T_KRListNode *node = ptIndex->pIndexTableList->head;
+    for (; node; node=node->next) {
+        T_KRIndexTable *ptIndexTable = (T_KRIndexTable *)kr_list_value(node);
+        T_KRSelectSource *ptSource = &ptSelect->ptSource[ptSelect->iSourceCnt];
+        ptSource->iKeyFieldId = ptIndexTable->iIndexFieldId;
+        ptSource->ptCursor = kr_db_external_cursor_open(ptIndexTable,
+                ptSelect->key, ptSelect->tBeginTime, ptSelect->tExtEndTime, 
+                dbsenv);
+        if (ptSource->ptCursor == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_db_external_cursor_open [%d] failed!", \
+                    ptIndexTable->ptTable->iTableId);
+            return -1;
+        }
+        ptSelect->iSourceCnt++;
+        kr_select_source_fetch(ptSelect, ptSource);
+    }
+
+    return 0;
+}
+
+
+/* plan the records of key in index iIndexId with transtime in
+ * [tBeginTime, tEndTime]: the external tier only when the range
+ * reaches into what left the slot, and only for that interval,
+ * dbsenv NULL for memory only, key kept until closed, NULL if failed
+ */
+T_KRSelect *kr_db_select_open(T_KRDB *ptDB, int iIndexId, void *key,
+        time_t tBeginTime, time_t tEndTime, T_DbsEnv *dbsenv)
+{
+    T_KRIndex *ptIndex = kr_index_get(ptDB, iIndexId);
+    if (ptIndex == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_index_get[%d] Error!", iIndexId);
+        return NULL;
+    }
+
+    T_KRSelect *ptSelect = kr_calloc(sizeof(T_KRSelect));
+    if (ptSelect == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptSelect failed!");
+        return NULL;
+    }
+    ptSelect->ptIndex = ptIndex;
+    ptSelect->key = key;
+    ptSelect->pfKeyCompare = kr_get_compare_func(ptIndex->eIndexFieldType);
+    ptSelect->tBeginTime = tBeginTime;
+    ptSelect->tEndTime = tEndTime;
+    ptSelect->iFetchFrom = -1;
+
+    /*a key not in memory may still have older records external*/
+    T_KRIndexSolt *ptIndexSlot = kr_index_slot_hold(ptIndex, key);
+    time_t tExtMaxTime = tEndTime;
+    if (ptIndexSlot != NULL) {
+        tExtMaxTime = ptIndexSlot->tExtMaxTransTime;
+    }
+
+    int iResult = 0;
+    time_t tLocBeginTime = tBeginTime;
+    if (dbsenv != NULL && tBeginTime <= tExtMaxTime) {
+        ptSelect->tExtEndTime = tExtMaxTime < tEndTime ? tExtMaxTime : tEndTime;
+        /*records up to it are in the external tier, even those kept*/
+        tLocBeginTime = ptSelect->tExtEndTime + 1;
+    }
+    if (ptIndexSlot != NULL) {
+        /*none kept is older than tLocMinTransTime*/
+        if (tEndTime >= ptIndexSlot->tLocMinTransTime) {
+            iResult = kr_select_hold_local(ptSelect, ptIndexSlot, tLocBeginTime);
+        }
+        kr_index_slot_release(ptIndexSlot);
+    }
+    if (iResult == 0 && tLocBeginTime > tBeginTime) {
+        iResult = kr_select_open_external(ptSelect, ptIndex, dbsenv);
+    }
+    if (iResult != 0) {
+        kr_db_select_close(ptSelect);
+        return NULL;
+    }
+
+    return ptSelect;
+}
+
+
+/*copy of the slot's next record still kept, NULL if none left*/
+static T_KRRecord *kr_select_local(T_KRSelect *ptSelect)
+{
+    for (; ptSelect->uiLocPos < ptSelect->uiLocCnt; ptSelect->uiLocPos++) {
+        T_KRRecord *ptRecord = kr_record_ref_read(\
+                &ptSelect->ptLocRef[ptSelect->uiLocPos], ptSelect->ptIndex,
+                ptSelect->key, &ptSelect->pCopy, &ptSelect->ulCopySize);
+        if (ptRecord != NULL) return ptRecord;
+    }
+    return NULL;
+}
+
+
+/* next record, newest first, valid until the next call, 
+ * NULL when exhausted
+ */
+T_KRRecord *kr_db_select_next(T_KRSelect *ptSelect)
+{
+    /*the one returned last is in its cursor's buffer, fetched only now*/
+    if (ptSelect->iFetchFrom >= 0) {
+        kr_select_source_fetch(ptSelect,
+                &ptSelect->ptSource[ptSelect->iFetchFrom]);
+        ptSelect->iFetchFrom = -1;
+    }
+
+    T_KRRecord *ptNext = kr_select_local(ptSelect);
+    int iFrom = -1;
+    for (int i=0; i<ptSelect->iSourceCnt; i++) {
+        T_KRRecord *ptRecord = ptSelect->ptSource[i].ptRecord;
+        if (ptRecord != NULL && (ptNext == NULL ||
+                    kr_get_transtime(ptRecord) > kr_get_transtime(ptNext))) {
+            ptNext = ptRecord;
+            iFrom = i;
+        }
+    }
+
+    if (ptNext == NULL) {
+        return NULL;
+    } else if (iFrom < 0) {
+        ptSelect->uiLocPos++;
+    } else {
+        ptSelect->iFetchFrom = iFrom;
+    }
+    return ptNext;
+}
+
+
+void kr_db_select_close(T_KRSelect *ptSelect)
+{
+    if (ptSelect == NULL) return;
+
+    for (int i=0; i<ptSelect->iSourceCnt; i++) {
+        kr_db_external_cursor_close(ptSelect->ptSource[i].ptCursor);
+    }
+    kr_free(ptSelect->ptSource);
+    kr_free(ptSelect->ptLocRef);
+    kr_free(ptSelect->pCopy);
+    kr_free(ptSelect);
+}
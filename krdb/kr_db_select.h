@@ -0,0 +1,44 @@
+#ifndef __KR_DB_SELECT_H__
+#define __KR_DB_SELECT_H__
+
+#include "kr_db_internal.h"
+#include "kr_db_external.h"
+
+typedef struct _kr_select_t T_KRSelect;
+
+typedef struct _kr_select_source_t
+{
+    T_KRExternalCursor *ptCursor;
+    int              iKeyFieldId;      /* of the index in the cursor's table */
+    T_KRRecord       *ptRecord;        /* fetched, NULL when exhausted */
+}T_KRSelectSource;
+
+/* records of an index key in a transtime range, newest first:
+ * the slot keeps every record of the key later than its tExtMaxTransTime,
+ * so the external tier is only queried for the interval up to it, 
+ * the slot's records and each table's cursor are merged one at a time
+ */
+struct _kr_select_t
+{
+    T_KRIndex        *ptIndex;
+    void             *key;             /* the caller's, until closed */
+    KRCompareFunc    pfKeyCompare;
+    time_t           tBeginTime;
+    time_t           tEndTime;
+    time_t           tExtEndTime;      /* external up to it, memory after */
+    unsigned int     uiLocCnt;
+    unsigned int     uiLocPos;
+    T_KRRecordRef    *ptLocRef;        /* slot's in range, newest first */
+    char             *pCopy;           /* slot's record returned last */
+    size_t           ulCopySize;
+    int              iSourceCnt;       /* 0 if external not needed */
+    T_KRSelectSource *ptSource;        /* one per table of the index */
+    int              iFetchFrom;       /* source returned last, -1 if none */
+};
+
+extern T_KRSelect *kr_db_select_open(T_KRDB *ptDB, int iIndexId, void *key,
+        time_t tBeginTime, time_t tEndTime, T_DbsEnv *dbsenv);
+extern T_KRRecord *kr_db_select_next(T_KRSelect *ptSelect);
+extern void kr_db_select_close(T_KRSelect *ptSelect);
+
+#endif /* __KR_DB_SELECT_H__ */
@@ -0,0 +1,389 @@
+#include "kr_db_store.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+
+
+/*whether the file's header describes ptTable's ring as it is now*/
+static int kr_store_head_match(T_KRStoreHead *ptHead, T_KRTable *ptTable)
+{
+    if (memcmp(ptHead->caMagic, KR_STORE_MAGIC, sizeof(KR_STORE_MAGIC)) != 0 ||
+        ptHead->iVersion != KR_STORE_VERSION ||
+        ptHead->iTableId != ptTable->iTableId ||
+        ptHead->iRecordSize != ptTable->iRecordSize ||
+        ptHead->lKeepValue != ptTable->lKeepValue ||
+        ptHead->iShardCnt != ptTable->iShardCnt) {
+        return 0;
+    }
+    for (int i=0; i<ptTable->iShardCnt; i++) {
+        if (ptHead->stShard[i].uiRecordBase != ptTable->ptShard[i].uiRecordBase ||
+            ptHead->stShard[i].uiRecordCap != ptTable->ptShard[i].uiRecordCap) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+/* back ptTable's ring with the file at psPath, its records kept if
+ * the file was written by a table of the same layout, emptied if not,
+ * only before any record inserted and after sharded,
+ * return records found, -1 if failed
+ */
+int kr_table_store_open(T_KRTable *ptTable, char *psPath)
+{
+    if (ptTable->eKeepMode == KR_SIZEKEEPMODE_TIME) {
+        KR_LOG(KR_LOGERROR, "table [%d] kept by time, not stored!", \
+                ptTable->iTableId);
+        return -1;
+    }
+    if (ptTable->ptStore != NULL || ptTable->uiRecordNum > 0) {
+        KR_LOG(KR_LOGERROR, "table [%d] stored or has records!", \
+                ptTable->iTableId);
+        return -1;
+    }
+
+    T_KRStore *ptStore = kr_calloc(sizeof(T_KRStore));
+    if (ptStore == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptStore failed!");
+        return -1;
+    }
+    strncpy(ptStore->caPath, psPath, sizeof(ptStore->caPath)-1);
+    ptStore->ulMapSize = KR_STORE_HEAD_SIZE + \
+        (size_t )ptTable->iRecordSize*ptTable->lKeepValue;
+
+    int fd = open(psPath, O_RDWR|O_CREAT, 0644);
+    if (fd < 0) {
+        KR_LOG(KR_LOGERROR, "open [%s] failed[%s]!", psPath, strerror(errno));
+        kr_free(ptStore);
+        return -1;
+    }
+
+    /*a file of another layout is emptied, truncating zeroes it*/
+    T_KRStoreHead stHead;
+    memset(&stHead, 0x00, sizeof(stHead));
+    struct stat st;
+    int iMatched = fstat(fd, &st) == 0 &&
+        (size_t )st.st_size == ptStore->ulMapSize &&
+        pread(fd, &stHead, sizeof(stHead), 0) == sizeof(stHead) &&
+        kr_store_head_match(&stHead, ptTable);
+    if (!iMatched &&
+        (ftruncate(fd, 0) != 0 || ftruncate(fd, ptStore->ulMapSize) != 0)) {
+        KR_LOG(KR_LOGERROR, "ftruncate [%s] failed[%s]!", \
+                psPath, strerror(errno));
+        close(fd);
+        kr_free(ptStore);
+        return -1;
+    }
+
+    ptStore->pMap = mmap(NULL, ptStore->ulMapSize, PROT_READ|PROT_WRITE,
+            MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptStore->pMap == MAP_FAILED) {
+        KR_LOG(KR_LOGERROR, "mmap [%s] failed[%s]!", psPath, strerror(errno));
+        kr_free(ptStore);
+        return -1;
+    }
+    ptStore->ptHead = (T_KRStoreHead *)ptStore->pMap;
+
+    T_KRStoreHead *ptHead = ptStore->ptHead;
+    if (!iMatched) {
+        memcpy(ptHead->caMagic, KR_STORE_MAGIC, sizeof(KR_STORE_MAGIC));
+        ptHead->iVersion = KR_STORE_VERSION;
+        ptHead->iTableId = ptTable->iTableId;
+        ptHead->iRecordSize = ptTable->iRecordSize;
+        ptHead->lKeepValue = ptTable->lKeepValue;
+        ptHead->iShardCnt = ptTable->iShardCnt;
+        memcpy(ptHead->stShard, ptTable->ptShard,
+                sizeof(T_KRTableShard)*ptTable->iShardCnt);
+    }
+
+    /*shard locations are written into the header from now on*/
+    kr_free(ptTable->pRecordBuff);
+    kr_free(ptTable->ptShard);
+    ptTable->pRecordBuff = ptStore->pMap + KR_STORE_HEAD_SIZE;
+    ptTable->ptShard = ptHead->stShard;
+    ptTable->ptStore = ptStore;
+
+    for (int i=0; iMatched && i<ptTable->iShardCnt; i++) {
+        ptStore->uiRemapped += ptHead->stShard[i].uiRecordNum;
+    }
+    return (int )ptStore->uiRemapped;
+}
+
+
+/*unmap ptTable's ring, records stay in the file for the next start*/
+void kr_table_store_close(T_KRTable *ptTable)
+{
+    T_KRStore *ptStore = ptTable->ptStore;
+    if (ptStore == NULL) {
+        return;
+    }
+    if (msync(ptStore->pMap, ptStore->ulMapSize, MS_SYNC) != 0) {
+        KR_LOG(KR_LOGERROR, "msync [%s] failed[%s]!", \
+                ptStore->caPath, strerror(errno));
+    }
+    munmap(ptStore->pMap, ptStore->ulMapSize);
+    ptTable->pRecordBuff = NULL;
+    ptTable->ptShard = NULL;
+    ptTable->ptStore = NULL;
+    kr_free(ptStore);
+}
+
+
+/* i-th oldest location of shard iShard,
+ * locations never written are empty and skipped by callers
+ */
+static inline unsigned int kr_store_age_loc(T_KRTableShard *ptShard,
+        unsigned int i)
+{
+    return ptShard->uiRecordBase + \
+        (ptShard->uiRecordLoc + i) % ptShard->uiRecordCap;
+}
+
+
+/* restore the pointers of records mapped again, drop the ones
+ * a crash left half rewritten, and recount what inserts counted
+ */
+static void kr_table_store_recover(T_KRTable *ptTable)
+{
+    ptTable->uiRecordNum = 0;
+    for (int s=0; s<ptTable->iShardCnt; s++) {
+        T_KRTableShard *ptShard = &ptTable->ptShard[s];
+        time_t tMaxTransTime = 0;
+        ptShard->uiRecordNum = 0;
+        for (unsigned int i=0; i<ptShard->uiRecordCap; i++) {
+            unsigned int uiLoc = kr_store_age_loc(ptShard, i);
+            T_KRRecord *ptRecord = kr_record_at(ptTable, uiLoc);
+            if (ptRecord->ptTable == NULL) continue;
+            if ((ptRecord->uiSeq & 1) || ptRecord->uiLoc != uiLoc) {
+                ptRecord->ptTable = NULL;
+                ptRecord->uiSeq = (ptRecord->uiSeq | 1) + 1;
+                continue;
+            }
+            ptRecord->ptTable = ptTable;
+            ptRecord->pfFree = NULL;
+            ptRecord->pRecBuf = (char *)ptRecord+sizeof(T_KRRecord);
+            /*stamps of the last run mean nothing now*/
+            memset(ptRecord->stFilter, 0x00, sizeof(ptRecord->stFilter));
+            ptShard->uiRecordNum++;
+            ptTable->uiRecordNum++;
+
+            time_t tTransTime = kr_get_transtime(ptRecord);
+            if (tTransTime > tMaxTransTime) {
+                tMaxTransTime = tTransTime;
+            } else if (tMaxTransTime - tTransTime > ptTable->lTransTimeSlack) {
+                ptTable->lTransTimeSlack = tMaxTransTime - tTransTime;
+            }
+            kr_list_foreach(ptTable->pFreqList, \
+                    (KRForEachFunc )kr_freq_add, ptRecord);
+        }
+        if (tMaxTransTime > ptTable->tMaxTransTime) {
+            ptTable->tMaxTransTime = tMaxTransTime;
+        }
+    }
+    if (ptTable->eLatePolicy != KR_LATEPOLICY_ACCEPT) {
+        ptTable->tWatermark = \
+            ptTable->tMaxTransTime - ptTable->lAllowedLateness;
+    }
+    KR_LOG(KR_LOGINFO, "table [%d] recovered [%u] of [%u] records", \
+            ptTable->iTableId, ptTable->uiRecordNum,
+            ptTable->ptStore->uiRemapped);
+}
+
+
+/*keys of one shard of an index, rebuilt by one thread*/
+typedef struct _kr_rebuild_task_t
+{
+    T_KRIndex        *ptIndex;
+    int              iShard;
+}T_KRRebuildTask;
+
+typedef struct _kr_rebuild_t
+{
+    int              iTaskCnt;
+    T_KRRebuildTask  *ptTask;
+    volatile int     iNext;               /* task taken next */
+}T_KRRebuild;
+
+/*oldest record not inserted yet of a shard of one index table*/
+typedef struct _kr_rebuild_cursor_t
+{
+    T_KRIndexTable   *ptIndexTable;
+    T_KRTableShard   *ptShard;
+    unsigned int     i;
+    T_KRRecord       *ptRecord;           /* NULL if none left */
+}T_KRRebuildCursor;
+
+
+static void kr_rebuild_cursor_next(T_KRRebuildCursor *ptCursor,
+        T_KRRebuildTask *ptTask)
+{
+    T_KRIndexTable *ptIndexTable = ptCursor->ptIndexTable;
+    T_KRTable *ptTable = ptIndexTable->ptTable;
+    T_KRTableShard *ptShard = ptCursor->ptShard;
+
+    ptCursor->ptRecord = NULL;
+    while (ptCursor->i < ptShard->uiRecordCap) {
+        T_KRRecord *ptRecord = \
+            kr_record_at(ptTable, kr_store_age_loc(ptShard, ptCursor->i++));
+        if (ptRecord->ptTable == NULL) continue;
+        void *key = kr_field_get_value(ptRecord, ptIndexTable->iIndexFieldId);
+        if (kr_index_shard_id(ptTask->ptIndex, key) == ptTask->iShard) {
+            ptCursor->ptRecord = ptRecord;
+            return;
+        }
+    }
+}
+
+
+/* insert the task's keys oldest first, records of one table shard
+ * keep their order, several are merged by processing time
+ */
+static void kr_rebuild_task_run(T_KRRebuildTask *ptTask)
+{
+    int iCursorCnt = 0;
+    T_KRListNode *node = ptTask->ptIndex->pIndexTableList->head;
+    for (; node; node=node->next) {
+        T_KRIndexTable *ptIndexTable = (T_KRIndexTable *)kr_list_value(node);
+        if (ptIndexTable->ptTable->ptStore) {
+            iCursorCnt += ptIndexTable->ptTable->iShardCnt;
+        }
+    }
+    if (iCursorCnt == 0) return;
+
+    T_KRRebuildCursor *ptCursor = \
+        kr_calloc(sizeof(T_KRRebuildCursor)*iCursorCnt);
+    if (ptCursor == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptCursor failed!");
+        return;
+    }
+    int c = 0;
+    for (node = ptTask->ptIndex->pIndexTableList->head; node; node=node->next) {
+        T_KRIndexTable *ptIndexTable = (T_KRIndexTable *)kr_list_value(node);
+        T_KRTable *ptTable = ptIndexTable->ptTable;
+        if (ptTable->ptStore == NULL) continue;
+        for (int s=0; s<ptTable->iShardCnt; s++, c++) {
+            ptCursor[c].ptIndexTable = ptIndexTable;
+            ptCursor[c].ptShard = &ptTable->ptShard[s];
+            kr_rebuild_cursor_next(&ptCursor[c], ptTask);
+        }
+    }
+
+    for (;;) {
+        T_KRRebuildCursor *ptOldest = NULL;
+        for (c=0; c<iCursorCnt; c++) {
+            if (ptCursor[c].ptRecord == NULL) continue;
+            if (ptOldest == NULL || kr_get_proctime(ptCursor[c].ptRecord) <
+                    kr_get_proctime(ptOldest->ptRecord)) {
+                ptOldest = &ptCursor[c];
+            }
+        }
+        if (ptOldest == NULL) break;
+        kr_rebuild_index_ins(ptOldest->ptIndexTable, ptOldest->ptRecord);
+        kr_rebuild_cursor_next(ptOldest, ptTask);
+    }
+    kr_free(ptCursor);
+}
+
+
+static void *kr_rebuild_thread(void *arg)
+{
+    T_KRRebuild *ptRebuild = (T_KRRebuild *)arg;
+    for (;;) {
+        int i = __sync_fetch_and_add(&ptRebuild->iNext, 1);
+        if (i >= ptRebuild->iTaskCnt) break;
+        kr_rebuild_task_run(&ptRebuild->ptTask[i]);
+    }
+    return NULL;
+}
+
+
+/* recover the records of stored tables, then rebuild index hashtables
+ * from them, every shard of every index by one of iThreads threads,
+ * before the db is used
+ */
+int kr_db_rebuild(T_KRDB *ptDB, int iThreads)
+{
+    T_KRRebuild stRebuild = {0, NULL, 0};
+    T_KRListNode *node;
+
+    for (node = ptDB->pTableList->head; node; node=node->next) {
+        T_KRTable *ptTable = (T_KRTable *)kr_list_value(node);
+        if (ptTable->ptStore) kr_table_store_recover(ptTable);
+    }
+
+    for (node = ptDB->pIndexList->head; node; node=node->next) {
+        stRebuild.iTaskCnt += ((T_KRIndex *)kr_list_value(node))->iShardCnt;
+    }
+    if (stRebuild.iTaskCnt == 0) {
+        return 0;
+    }
+    stRebuild.ptTask = kr_calloc(sizeof(T_KRRebuildTask)*stRebuild.iTaskCnt);
+    if (stRebuild.ptTask == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_calloc ptTask failed!");
+        return -1;
+    }
+    int t = 0;
+    for (node = ptDB->pIndexList->head; node; node=node->next) {
+        T_KRIndex *ptIndex = (T_KRIndex *)kr_list_value(node);
+        for (int s=0; s<ptIndex->iShardCnt; s++, t++) {
+            stRebuild.ptTask[t].ptIndex = ptIndex;
+            stRebuild.ptTask[t].iShard = s;
+        }
+    }
+
+    if (iThreads <= 0) {
+        iThreads = (int )sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    iThreads = MAX(1, MIN(iThreads, stRebuild.iTaskCnt));
+    pthread_t *ptThreads = kr_calloc(sizeof(pthread_t)*iThreads);
+    int iStarted = 0;
+    for (; ptThreads && iStarted<iThreads; iStarted++) {
+        if (pthread_create(&ptThreads[iStarted], NULL,
+                    kr_rebuild_thread, &stRebuild) != 0) {
+            KR_LOG(KR_LOGERROR, "pthread_create rebuild [%d] failed!", iStarted);
+            break;
+        }
+    }
+    /*whatever is left, by the caller*/
+    kr_rebuild_thread(&stRebuild);
+    for (int i=0; i<iStarted; i++) {
+        pthread_join(ptThreads[i], NULL);
+    }
+    kr_free(ptThreads);
+    kr_free(stRebuild.ptTask);
+
+    KR_LOG(KR_LOGINFO, "rebuilt [%d] index shards by [%d] threads", \
+            t, iStarted+1);
+    return 0;
+}
+
+
+/* back every record kept table of ptDB with a file in psDir,
+ * and rebuild indexes from the records found there
+ */
+int kr_db_store_open(T_KRDB *ptDB, char *psDir, int iThreads)
+{
+    char caPath[256];
+    T_KRListNode *node = ptDB->pTableList->head;
+    for (; node; node=node->next) {
+        T_KRTable *ptTable = (T_KRTable *)kr_list_value(node);
+        if (ptTable->eKeepMode == KR_SIZEKEEPMODE_TIME) {
+            KR_LOG(KR_LOGINFO, "table [%d] kept by time, in memory only", \
+                    ptTable->iTableId);
+            continue;
+        }
+        snprintf(caPath, sizeof(caPath), "%s/%s.%d.krdb",
+                psDir, ptDB->caDBName, ptTable->iTableId);
+        if (kr_table_store_open(ptTable, caPath) < 0) {
+            KR_LOG(KR_LOGERROR, "kr_table_store_open [%s] failed!", caPath);
+            return -1;
+        }
+    }
+
+    return kr_db_rebuild(ptDB, iThreads);
+}
@@ -0,0 +1,41 @@
+#ifndef __KR_DB_STORE_H__
+#define __KR_DB_STORE_H__
+
+#include "kr_db_internal.h"
+
+#define KR_STORE_MAGIC       "KRSTORE"
+#define KR_STORE_VERSION     1
+/*records start at this offset of the file, page aligned*/
+#define KR_STORE_HEAD_SIZE   4096
+
+/* header of a table's store file, what it holds refers to records
+ * by location only, pointers inside records are restored from their
+ * location when the file is mapped again
+ */
+typedef struct _kr_store_head_t
+{
+    char             caMagic[8];
+    int              iVersion;
+    int              iTableId;
+    int              iRecordSize;
+    int              iShardCnt;
+    long             lKeepValue;
+    T_KRTableShard   stShard[KR_SHARD_MAX]; /* the table's, written in place */
+}T_KRStoreHead;
+
+/*ring of a table kept in a shared mapping of its file*/
+struct _kr_store_t
+{
+    char             caPath[256];
+    char             *pMap;
+    size_t           ulMapSize;
+    T_KRStoreHead    *ptHead;
+    unsigned int     uiRemapped;         /* records found when mapped */
+};
+
+extern int kr_table_store_open(T_KRTable *ptTable, char *psPath);
+extern void kr_table_store_close(T_KRTable *ptTable);
+extern int kr_db_store_open(T_KRDB *ptDB, char *psDir, int iThreads);
+extern int kr_db_rebuild(T_KRDB *ptDB, int iThreads);
+
+#endif /* __KR_DB_STORE_H__ */
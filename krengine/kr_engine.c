@@ -4,6 +4,7 @@
 #include "krutils/kr_cache.h"
 #include "krparam/kr_param.h"
 #include "krcalc/kr_calc.h"
+#include "krcalc/kr_calc_profile.h"
 #include "krdb/kr_db.h"
 #include "krdata/kr_data.h"
 #include "krflow/kr_flow.h"
@@ -26,6 +27,106 @@ struct _kr_engine_t
     T_KRThreadPool   *tp;           /* thread pool */
 };
 
+/* create global frequency sketches, 
+ * each "id:datasrc:field:window" with window in seconds
+ */
+static int kr_engine_create_freq(T_KRDB *ptDB, char *freq_sketches)
+{
+    char *spec = kr_strdup(freq_sketches);
+    char *save = NULL;
+    int id, datasrc, field, ret = 0;
+    long window;
+
+    for (char *tok = strtok_r(spec, ",", &save); tok != NULL;
+            tok = strtok_r(NULL, ",", &save)) {
+        if (sscanf(tok, "%d:%d:%d:%ld", &id, &datasrc, &field, &window) != 4) {
+            KR_LOG(KR_LOGERROR, "bad freq sketch [%s]!", tok);
+            ret = -1; break;
+        }
+        if (kr_freq_create(ptDB, id, datasrc, field, window) == NULL) {
+            KR_LOG(KR_LOGERROR, "kr_freq_create [%s] failed!", tok);
+            ret = -1; break;
+        }
+    }
+    kr_free(spec);
+    return ret;
+}
+
+
+/* set late policies of tables, each "datasrc:policy:lateness[:func]",
+ * policy is one of E_KRLatePolicy, lateness in seconds, 
+ * func is the side output in krdb's module
+ */
+static int kr_engine_set_late(T_KRDB *ptDB, T_KRModule *ptModule, 
+        char *late_policies)
+{
+    char *spec = kr_strdup(late_policies);
+    char *save = NULL;
+    char policy, func[64];
+    int datasrc, ret = 0;
+    long lateness;
+
+    for (char *tok = strtok_r(spec, ",", &save); tok != NULL;
+            tok = strtok_r(NULL, ",", &save)) {
+        func[0] = '\0';
+        if (sscanf(tok, "%d:%c:%ld:%63s", &datasrc, &policy, &lateness, func) < 3) {
+            KR_LOG(KR_LOGERROR, "bad late policy [%s]!", tok);
+            ret = -1; break;
+        }
+        T_KRTable *ptTable = kr_table_get(ptDB, datasrc);
+        if (ptTable == NULL) {
+            KR_LOG(KR_LOGERROR, "late policy table [%d] not found!", datasrc);
+            ret = -1; break;
+        }
+        KRLateOutputFunc pfLateOutput = NULL;
+        if (func[0] != '\0') {
+            pfLateOutput = (KRLateOutputFunc )kr_module_symbol(ptModule, func);
+            if (pfLateOutput == NULL) {
+                KR_LOG(KR_LOGERROR, "kr_module_symbol [%s] error!", func);
+                ret = -1; break;
+            }
+        }
+        if (kr_table_set_late_policy(ptTable, (E_KRLatePolicy )policy, 
+                    lateness, pfLateOutput) != 0) {
+            KR_LOG(KR_LOGERROR, "kr_table_set_late_policy [%s] failed!", tok);
+            ret = -1; break;
+        }
+    }
+    kr_free(spec);
+    return ret;
+}
+
+
+/* split tables into shards by an index's key,
+ * table_shards like "datasrc:shards:index,..."
+ */
+static int kr_engine_set_shards(T_KRDB *ptDB, char *table_shards)
+{
+    char *spec = kr_strdup(table_shards);
+    char *save = NULL;
+    int datasrc, shards, index, ret = 0;
+
+    for (char *tok = strtok_r(spec, ",", &save); tok != NULL;
+            tok = strtok_r(NULL, ",", &save)) {
+        if (sscanf(tok, "%d:%d:%d", &datasrc, &shards, &index) != 3) {
+            KR_LOG(KR_LOGERROR, "bad table shards [%s]!", tok);
+            ret = -1; break;
+        }
+        T_KRTable *ptTable = kr_table_get(ptDB, datasrc);
+        if (ptTable == NULL) {
+            KR_LOG(KR_LOGERROR, "table shards table [%d] not found!", datasrc);
+            ret = -1; break;
+        }
+        if (kr_table_set_shards(ptTable, shards, index) != 0) {
+            KR_LOG(KR_LOGERROR, "kr_table_set_shards [%s] failed!", tok);
+            ret = -1; break;
+        }
+    }
+    kr_free(spec);
+    return ret;
+}
+
+
 T_KREngine *kr_engine_startup(T_KREngineConfig *cfg, void *data)
 {
     KR_LOG(KR_LOGDEBUG, "kr_engine_startup...");
@@ -102,11 +203,77 @@ T_KREngine *kr_engine_startup(T_KREngineConfig *cfg, void *data)
     }
 
     /* Start up krdb */
+    if (cfg->index_key_inline > 0) {
+        kr_index_set_key_inline((size_t )cfg->index_key_inline);
+    }
     ctx_env->ptDB = kr_db_new("KRDB", ctx_env->ptDbsEnv, ctx_env->krdbModule);
     if (ctx_env->ptDB == NULL) {
         KR_LOG(KR_LOGERROR, "kr_db_startup failed!");
         goto FAILED;
     }
+    
+    if (cfg->freq_sketches && 
+            kr_engine_create_freq(ctx_env->ptDB, cfg->freq_sketches) != 0) {
+        KR_LOG(KR_LOGERROR, "kr_engine_create_freq failed!");
+        goto FAILED;
+    }
+
+    if (cfg->late_policies && 
+            kr_engine_set_late(ctx_env->ptDB, ctx_env->krdbModule, 
+                cfg->late_policies) != 0) {
+        KR_LOG(KR_LOGERROR, "kr_engine_set_late failed!");
+        goto FAILED;
+    }
+
+    if (cfg->table_shards && 
+            kr_engine_set_shards(ctx_env->ptDB, cfg->table_shards) != 0) {
+        KR_LOG(KR_LOGERROR, "kr_engine_set_shards failed!");
+        goto FAILED;
+    }
+
+    /* key statistics count the records remapped below too */
+    if (cfg->ddi_quantile_compression > 0) {
+        kr_ddi_set_quantile_compression(cfg->ddi_quantile_compression);
+    }
+    if (kr_data_register(ctx_env->ptParam, ctx_env->ptDB) != 0) {
+        KR_LOG(KR_LOGERROR, "kr_data_register failed!");
+        goto FAILED;
+    }
+
+    /* remap records kept by the last run, after tables sharded */
+    if (cfg->krdb_store_dir && cfg->krdb_store_dir[0] != '\0' &&
+            kr_db_store_open(ctx_env->ptDB, cfg->krdb_store_dir, 
+                cfg->thread_pool_size) != 0) {
+        KR_LOG(KR_LOGERROR, "kr_db_store_open [%s] failed!", \
+                cfg->krdb_store_dir);
+        goto FAILED;
+    }
+
+    /* write inserted records behind to the database */
+    if (cfg->krdb_persist && cfg->krdb_persist[0] != '\0') {
+        int rows, msec, cells, retries;
+        if (sscanf(cfg->krdb_persist, "%d:%d:%d:%d", 
+                    &rows, &msec, &cells, &retries) != 4 ||
+                kr_db_persist_start(ctx_env->ptDB, rows, msec, 
+                    (unsigned int )cells, retries) != 0) {
+            KR_LOG(KR_LOGERROR, "kr_db_persist_start [%s] failed!", \
+                    cfg->krdb_persist);
+            goto FAILED;
+        }
+    }
+
+    ctx_env->eRelatedMode = KR_RELATED_ALWAYS;
+    if (cfg->related_capture && cfg->related_capture[0] != '\0') {
+        if (strcmp(cfg->related_capture, "off") == 0) {
+            ctx_env->eRelatedMode = KR_RELATED_OFF;
+        } else if (strcmp(cfg->related_capture, "onfire") == 0) {
+            ctx_env->eRelatedMode = KR_RELATED_ONFIRE;
+        } else if (strcmp(cfg->related_capture, "always") != 0) {
+            KR_LOG(KR_LOGERROR, "related_capture [%s] invalid!", \
+                    cfg->related_capture);
+            goto FAILED;
+        }
+    }
 
     /* Create hdi cache */
     if (cfg->hdi_cache_size > 0) {
@@ -125,6 +292,13 @@ T_KREngine *kr_engine_startup(T_KREngineConfig *cfg, void *data)
         goto FAILED;
     }
     
+    /* enable calc profiling before any calc constructed */
+    if (cfg->calc_profile_rate > 0) {
+        kr_calc_profile_enable(cfg->calc_profile_rate);
+    }
+    
+    kr_ddi_set_columnar(cfg->ddi_columnar != 0);
+    
     /* initialize engine's context */
     if (cfg->thread_pool_size <= 0) {
         /* if no threadpool, initialize rule detecting context */
@@ -173,6 +347,9 @@ void kr_engine_shutdown(T_KREngine *engine)
         kr_threadpool_destroy(engine->tp);
     }
 
+    /* calcs all destructed with contexts */
+    kr_calc_profile_destroy();
+
     /* destroy rule detecting environment */
     if (engine->ctx_env) {
         T_KRContextEnv *ctx_env=engine->ctx_env;
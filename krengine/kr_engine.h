@@ -43,6 +43,19 @@ typedef struct _kr_engine_config_t
     int            hdi_cache_size;   /* hdi cache size */
     int            thread_pool_size; /* thread pool size */
     int            high_water_mark;  /* thread pool high water mark */
+    int            calc_profile_rate;/* profile 1 in N calcs, 0:disabled */
+    double         ddi_quantile_compression; /* 0:default */
+    int            ddi_columnar;     /* 1:fields aggregated mirrored per key */
+    int            index_key_inline; /* string index keys shorter kept in 
+                                        buckets, 0:default */
+    char          *freq_sketches;    /* "id:datasrc:field:window,..." */
+    char          *late_policies;    /* "datasrc:policy:lateness[:func],..." */
+    char          *table_shards;     /* "datasrc:shards:index,..." */
+    char          *krdb_store_dir;   /* tables mapped to files in it, 
+                                        "":in memory only */
+    char          *krdb_persist;     /* "rows:msec:cells:retries" of the
+                                        write-behind, "":not persisted */
+    char          *related_capture;  /* "off", "onfire" or "always":default */
 }T_KREngineConfig;
 
 
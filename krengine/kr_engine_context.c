@@ -30,6 +30,17 @@ T_KRContext *kr_context_init(T_KRContextEnv *ptEnv)
         kr_free(ptContext);
         return NULL;
     }
+    kr_data_set_related_mode(ptContext->ptData, ptEnv->eRelatedMode);
+
+    /* krdb is read along with its writers, within epochs */
+    ptContext->ptReader = kr_epoch_register(ptEnv->ptDB->ptEpoch);
+    if (ptContext->ptReader == NULL) {
+        KR_LOG(KR_LOGERROR, "kr_epoch_register failed!");
+        kr_data_destruct(ptContext->ptData);
+        dbsDisconnect(ptContext->ptDbsEnv);
+        kr_free(ptContext);
+        return NULL;
+    }
     
     /* construct flow */
     
@@ -50,6 +61,12 @@ int kr_context_set(T_KRContext *ptContext, void *ptArg)
     /* set argument */
     ptContext->ptArg = ptArg;
 
+    /* json built while handling comes from the per-event arena */
+    cJSON_BindArena(ptContext->ptData->ptArena);
+
+    /* krdb memory read while handling is kept till cleaned */
+    kr_epoch_enter(ptEnv->ptDB->ptEpoch, ptContext->ptReader);
+
     return 0;
 }
 
@@ -58,6 +75,13 @@ void kr_context_clean(T_KRContext *ptContext)
     /*initialize dynamic memory*/
     kr_data_init(ptContext->ptData);
 
+    /*release per-event scratch at once*/
+    cJSON_BindArena(NULL);
+    kr_arena_reset(ptContext->ptData->ptArena);
+
+    /*nothing of krdb held any more*/
+    kr_epoch_exit(ptContext->ptReader);
+
     /*initialize others*/
     ptContext->ptArg = NULL;
     ptContext->ptCurrRec = NULL;
@@ -66,6 +90,7 @@ void kr_context_clean(T_KRContext *ptContext)
 void kr_context_fini(T_KRContext *ptContext)
 {
     if (ptContext) {
+        kr_epoch_unregister(ptContext->ptReader);
         kr_data_destruct(ptContext->ptData);
         dbsDisconnect(ptContext->ptDbsEnv);
         kr_free(ptContext);
@@ -126,37 +151,52 @@ static void _set_cjson_record(T_KRRecord *krrecord, cJSON *json)
     }
 }
 
-static void _set_cjson_related(void *key, T_KRRecord *krrecord, cJSON *array)
+/*items dumped into array, with their related records if wanted*/
+typedef struct _kr_context_dump_t
 {
-    cJSON *record = cJSON_CreateObject();
-    _set_cjson_record(krrecord, record);
-    cJSON_AddItemToArray(array, record);
+    cJSON            *array;
+    T_KRData         *ptData;
+    kr_bool           bRelated;
+}T_KRContextDump;
+
+static void _set_cjson_related(T_KRRelated *ptRelated, cJSON *item)
+{
+    cJSON *related = cJSON_CreateArray();
+    for (unsigned int i=0; ptRelated && i<kr_related_count(ptRelated); i++) {
+        /*segment of a time kept table freed since*/
+        T_KRRecord *ptRecord = kr_related_get(ptRelated, i);
+        if (ptRecord == NULL) continue;
+        cJSON *record = cJSON_CreateObject();
+        _set_cjson_record(ptRecord, record);
+        cJSON_AddItemToArray(related, record);
+    }
+    cJSON_AddItemToObject(item, "related", related);
 }
 
-static void _add_sdi(void *key, T_KRSDI *krsdi, cJSON *sdis)
+static void _add_sdi(void *key, T_KRSDI *krsdi, T_KRContextDump *dump)
 {
     cJSON *sdi = cJSON_CreateObject();
     cJSON_AddNumberToObject(sdi, "id", krsdi->lSDIId);
     cJSON_AddNumberToObject(sdi, "valueind", krsdi->eValueInd);
     _set_cjson_field(krsdi->eValueType, "value", &krsdi->uValue, sdi);
     /*add related*/
-    cJSON *related = cJSON_CreateArray();
-    kr_hashtable_foreach(krsdi->ptRelated, (KRHFunc )_set_cjson_related, related);
-    cJSON_AddItemToObject(sdi, "related", related);
-    cJSON_AddItemToArray(sdis, sdi);
+    if (dump->bRelated) {
+        _set_cjson_related(kr_sdi_related(krsdi, dump->ptData), sdi);
+    }
+    cJSON_AddItemToArray(dump->array, sdi);
 }
 
-static void _add_ddi(void *key, T_KRDDI *krddi, cJSON *ddis)
+static void _add_ddi(void *key, T_KRDDI *krddi, T_KRContextDump *dump)
 {
     cJSON *ddi = cJSON_CreateObject();
     cJSON_AddNumberToObject(ddi, "id", krddi->lDDIId);
     cJSON_AddNumberToObject(ddi, "valueind", krddi->eValueInd);
     _set_cjson_field(krddi->eValueType, "value", &krddi->uValue, ddi);
     /*add related*/
-    cJSON *related = cJSON_CreateArray();
-    kr_hashtable_foreach(krddi->ptRelated, (KRHFunc )_set_cjson_related, related);
-    cJSON_AddItemToObject(ddi, "related", related);
-    cJSON_AddItemToArray(ddis, ddi);
+    if (dump->bRelated) {
+        _set_cjson_related(kr_ddi_related(krddi, dump->ptData), ddi);
+    }
+    cJSON_AddItemToArray(dump->array, ddi);
 }
 
 static void _add_hdi(void *key, T_KRHDI *krhdi, cJSON *hdis)
@@ -178,18 +218,20 @@ static void _add_rule(T_KRRule *krrule, cJSON *rules)
     cJSON_AddItemToArray(rules, rule);
 }
 
-static void _add_sdis_to_data(T_KRHashTable *ptSdiTable, cJSON *datas)
+static void _add_sdis_to_data(T_KRHashTable *ptSdiTable, 
+        T_KRContextDump *dump, cJSON *datas)
 {
-    cJSON *sdis = cJSON_CreateArray();
-    kr_hashtable_foreach(ptSdiTable, (KRHFunc )_add_sdi, sdis);
-    cJSON_AddItemToObject(datas, "sdis", sdis);
+    dump->array = cJSON_CreateArray();
+    kr_hashtable_foreach(ptSdiTable, (KRHFunc )_add_sdi, dump);
+    cJSON_AddItemToObject(datas, "sdis", dump->array);
 }
 
-static void _add_ddis_to_data(T_KRHashTable *ptDdiTable, cJSON *datas)
+static void _add_ddis_to_data(T_KRHashTable *ptDdiTable, 
+        T_KRContextDump *dump, cJSON *datas)
 {
-    cJSON *ddis = cJSON_CreateArray();
-    kr_hashtable_foreach(ptDdiTable, (KRHFunc )_add_ddi, ddis);
-    cJSON_AddItemToObject(datas, "ddis", ddis);
+    dump->array = cJSON_CreateArray();
+    kr_hashtable_foreach(ptDdiTable, (KRHFunc )_add_ddi, dump);
+    cJSON_AddItemToObject(datas, "ddis", dump->array);
 }
 
 static void _add_hdis_to_data(T_KRHashTable *ptHdiTable, cJSON *datas)
@@ -199,13 +241,45 @@ static void _add_hdis_to_data(T_KRHashTable *ptHdiTable, cJSON *datas)
     cJSON_AddItemToObject(datas, "hdis", hdis);
 }
 
+static void _add_computed_sdi(T_KRSDI *krsdi, T_KRContextDump *dump)
+{
+    if (krsdi->eValueInd == KR_VALUE_SETED) _add_sdi(NULL, krsdi, dump);
+}
+
+static void _add_computed_ddi(T_KRDDI *krddi, T_KRContextDump *dump)
+{
+    if (krddi->eValueInd == KR_VALUE_SETED) _add_ddi(NULL, krddi, dump);
+}
+
+static void _add_computed_hdi(T_KRHDI *krhdi, cJSON *hdis)
+{
+    if (krhdi->eValueInd == KR_VALUE_SETED) _add_hdi(NULL, krhdi, hdis);
+}
+
+/* items this event may have computed, of which only the computed ones */
+static void _add_deps_to_data(T_KRDataDeps *ptDeps, 
+        T_KRContextDump *dump, cJSON *datas)
+{
+    dump->array = cJSON_CreateArray();
+    kr_list_foreach(ptDeps->ptSDIList, (KRForEachFunc )_add_computed_sdi, dump);
+    cJSON_AddItemToObject(datas, "sdis", dump->array);
+    dump->array = cJSON_CreateArray();
+    kr_list_foreach(ptDeps->ptDDIList, (KRForEachFunc )_add_computed_ddi, dump);
+    cJSON_AddItemToObject(datas, "ddis", dump->array);
+    cJSON *hdis = cJSON_CreateArray();
+    kr_list_foreach(ptDeps->ptHDIList, (KRForEachFunc )_add_computed_hdi, hdis);
+    cJSON_AddItemToObject(datas, "hdis", hdis);
+}
+
 cJSON *kr_context_dump_json(T_KRContext *ptContext)
 {
     cJSON *alert = cJSON_CreateObject();
 
-    /*add group info*/
+    /*add group info, none if no group routed the event*/
     T_KRGroup *krgroup = ptContext->ptFlow->ptRoutedGroup;
-    cJSON_AddNumberToObject(alert, "groupid", krgroup->lGroupId);
+    if (krgroup != NULL) {
+        cJSON_AddNumberToObject(alert, "groupid", krgroup->lGroupId);
+    }
 
     /*add current record info*/
     cJSON *currec = cJSON_CreateObject();
@@ -213,17 +287,39 @@ cJSON *kr_context_dump_json(T_KRContext *ptContext)
     cJSON_AddItemToObject(alert, "currec", currec);
 
     /*add rules info*/
-    cJSON *rules = cJSON_CreateArray();
-    kr_list_foreach(krgroup->ptRuleList->ptRuleList, 
-            (KRForEachFunc )_add_rule, rules);
-    cJSON_AddItemToObject(alert, "rules", rules);
+    if (krgroup != NULL) {
+        cJSON *rules = cJSON_CreateArray();
+        kr_list_foreach(krgroup->ptRuleList->ptRuleList, 
+                (KRForEachFunc )_add_rule, rules);
+        cJSON_AddItemToObject(alert, "rules", rules);
+    }
 
-    /*add dataitems info*/
+    /*add dataitems info, related records only once a rule fired 
+     *unless always captured*/
     cJSON *datas = cJSON_CreateObject();
+    T_KRContextDump dump = {NULL, ptContext->ptData, FALSE};
+    switch(ptContext->ptData->eRelatedMode)
+    {
+        case KR_RELATED_ALWAYS:
+            dump.bRelated = TRUE;
+            break;
+        case KR_RELATED_ONFIRE:
+            dump.bRelated = (krgroup != NULL && 
+                    krgroup->ptRuleList->lFiredRules > 0);
+            break;
+        default:
+            break;
+    }
+    T_KRDataDeps *ptDeps = ptContext->ptData->ptDeps;
+    if (ptDeps != NULL && ptDeps->lBindStamp == ptContext->ptData->lBindStamp) {
+        _add_deps_to_data(ptDeps, &dump, datas);
+        cJSON_AddItemToObject(alert, "datas", datas);
+        return alert;
+    }
     T_KRHashTable *ptSdiTable = ptContext->ptData->ptSdiTable->ptSDITable;
-    _add_sdis_to_data(ptSdiTable, datas);
+    _add_sdis_to_data(ptSdiTable, &dump, datas);
     T_KRHashTable *ptDdiTable = ptContext->ptData->ptDdiTable->ptDDITable;
-    _add_ddis_to_data(ptDdiTable, datas);
+    _add_ddis_to_data(ptDdiTable, &dump, datas);
     T_KRHashTable *ptHdiTable = ptContext->ptData->ptHdiTable->ptHDITable;
     _add_hdis_to_data(ptHdiTable, datas);
     cJSON_AddItemToObject(alert, "datas", datas);
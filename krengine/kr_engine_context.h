@@ -21,6 +21,7 @@ typedef struct _kr_context_env_t
     T_KRDB           *ptDB;        /* krdb, read only in thread */
     T_KRCache        *ptHDICache;  /* hdi cache, need lock while mutli thread */
     T_KRFuncTable    *ptFuncTable; /* function table */
+    E_KRRelatedMode   eRelatedMode;/* related records of data items */
     void             *extra;       /* engine startup extra data */
 }T_KRContextEnv;
 
@@ -30,6 +31,7 @@ struct _kr_context_t
     T_DbsEnv         *ptDbsEnv;   /* db connection, one per thread */
     T_KRData         *ptData;     /* pointer to dynamic memory */
     T_KRFlow         *ptFlow;     /* pointer to dynamic memory */
+    T_KREpochReader  *ptReader;   /* of krdb's epoch, entered while set */
 
     void             *ptArg;      /* argument of krengine run */
     T_KRRecord       *ptCurrRec;  /* used for C_* */
@@ -2,6 +2,7 @@
 #include "kr_engine_context.h"
 
 #include "krparam/kr_param_api.h"
+#include "krcalc/kr_calc_profile.h"
 #include "krdb/kr_db_api.h"
 #include "krdata/kr_data_api.h"
 #include "krflow/kr_flow_api.h"
@@ -25,6 +26,7 @@ static void kr_engine_info_set(T_KRContext *krctx, T_KREngineArg *krarg);
 static void kr_engine_info_sdi(T_KRContext *krctx, T_KREngineArg *krarg);
 static void kr_engine_info_ddi(T_KRContext *krctx, T_KREngineArg *krarg);
 static void kr_engine_info_hdi(T_KRContext *krctx, T_KREngineArg *krarg);
+static void kr_engine_info_calc_profile(T_KRContext *krctx, T_KREngineArg *krarg);
 
 static void kr_engine_insert_event(T_KRContext *krctx, T_KREngineArg *krarg);
 static void kr_engine_detect_event(T_KRContext *krctx, T_KREngineArg *krarg);
@@ -54,6 +56,7 @@ int kr_engine_register_default(T_KREngine *krengine)
     kr_engine_register(krengine, "info_sdi", (KRHandleFunc )kr_engine_info_sdi);
     kr_engine_register(krengine, "info_ddi", (KRHandleFunc )kr_engine_info_ddi);
     kr_engine_register(krengine, "info_hdi", (KRHandleFunc )kr_engine_info_hdi);
+    kr_engine_register(krengine, "info_calc_profile", (KRHandleFunc )kr_engine_info_calc_profile);
     return 0;
 };
 
@@ -267,6 +270,11 @@ static void kr_engine_reload_param(T_KRContext *krctx, T_KREngineArg *krarg)
         reply->msgtype = KR_MSGTYPE_ERROR;
         return;
     }
+    if (kr_data_register(krctx->ptEnv->ptParam, krctx->ptEnv->ptDB) != 0) {
+        KR_LOG(KR_LOGERROR, "kr_data_register failed!");
+        reply->msgtype = KR_MSGTYPE_ERROR;
+        return;
+    }
     
     cJSON *json = cJSON_CreateObject();
     cJSON *shm = kr_param_info(krctx->ptEnv->ptParam);
@@ -460,24 +468,55 @@ static void kr_engine_info_hdi(T_KRContext *krctx, T_KREngineArg *krarg)
     cJSON_Delete(json);
 }
 
+static void kr_engine_info_calc_profile(T_KRContext *krctx, T_KREngineArg *krarg)
+{
+    T_KRMessage *apply = krarg->apply;
+    T_KRMessage *reply = krarg->reply;
+
+    int reset = 0;
+    if (apply->msgbuf != NULL && apply->msglen > 0) {
+        cJSON *apply_json = cJSON_Parse(apply->msgbuf);
+        if (apply_json == NULL) {
+            KR_LOG(KR_LOGERROR, "parse apply json failed!");
+            reply->msgtype = KR_MSGTYPE_ERROR;
+            return;
+        }
+        reset = (int )cJSON_GetNumber(apply_json, "reset");
+        cJSON_Delete(apply_json);
+    }
+
+    cJSON *json = kr_calc_profile_info_all();
+    /* reset counters after dumped if asked */
+    if (reset) kr_calc_profile_reset();
+
+    reply->msgbuf = cJSON_PrintUnformatted(json);
+    reply->msglen = strlen(reply->msgbuf)+1;
+    reply->msgtype = KR_MSGTYPE_SUCCESS;
+    cJSON_Delete(json);
+}
+
 
 static void kr_engine_insert_event(T_KRContext *krctx, T_KREngineArg *krarg)
 {
     T_KRMessage *apply = krarg->apply;
     T_KRMessage *reply = krarg->reply;
 
-    /* insert event into krdb */
+    /* insert event into krdb, from any worker thread */
     /*FIXME:convert message to record first
-    krctx->ptCurrRec = kr_db_insert(
-            krctx->ptEnv->ptDB, apply->datasrc, apply->msgbuf);
-    if (krctx->ptCurrRec == NULL) {
-        KR_LOG(KR_LOGERROR, "kr_db_insert [%d] [%s] failed!", 
+    if (kr_db_ingest(krctx->ptEnv->ptDB, apply->datasrc, 
+            apply->msgbuf, apply->msglen, &krctx->ptCurrRec) < 0) {
+        KR_LOG(KR_LOGERROR, "kr_db_ingest [%d] [%s] failed!", 
                 apply->datasrc, apply->msgbuf);
         reply->msgtype = KR_MSGTYPE_ERROR;
         return;
     }
     */
 
+    /* evaluate record-invariant statistics filters once */
+    if (krctx->ptCurrRec != NULL) {
+        kr_data_filter_record(krctx->ptData, krctx->ptCurrRec);
+    }
+
     reply->msgtype = KR_MSGTYPE_SUCCESS;
 }
 
@@ -486,24 +525,40 @@ static void kr_engine_detect_event(T_KRContext *krctx, T_KREngineArg *krarg)
     T_KRMessage *apply = krarg->apply;
     T_KRMessage *reply = krarg->reply;
 
-    /* insert event into krdb */
+    /* insert event into krdb, from any worker thread */
     /*FIXME:convert message to record first
-    krctx->ptCurrRec = kr_db_insert(
-            krctx->ptEnv->ptDB, apply->datasrc, apply->msgbuf);
-    if (krctx->ptCurrRec == NULL) {
-        KR_LOG(KR_LOGERROR, "kr_db_insert [%d] [%s] failed!", 
+    if (kr_db_ingest(krctx->ptEnv->ptDB, apply->datasrc, 
+            apply->msgbuf, apply->msglen, &krctx->ptCurrRec) < 0) {
+        KR_LOG(KR_LOGERROR, "kr_db_ingest [%d] [%s] failed!", 
                 apply->datasrc, apply->msgbuf);
         reply->msgtype = KR_MSGTYPE_ERROR;
         return;
     }
     */
 
+    /* evaluate record-invariant statistics filters once */
+    if (krctx->ptCurrRec != NULL) {
+        kr_data_filter_record(krctx->ptData, krctx->ptCurrRec);
+    }
+
     /* group route and rule detect */
+    unsigned int uiRecSeq = 0;
+    if (krctx->ptCurrRec != NULL) {
+        uiRecSeq = kr_record_read_begin(krctx->ptCurrRec);
+    }
     if (kr_flow_detect(krctx->ptFlow, krctx->ptCurrRec) != 0) {
         KR_LOG(KR_LOGERROR, "kr_engine_detect failed!");
         reply->msgtype = KR_MSGTYPE_ERROR;
         return;
     }
+    /* the table's ring wrapped around while detecting */
+    if (krctx->ptCurrRec != NULL && 
+        kr_record_read_retry(krctx->ptCurrRec, uiRecSeq)) {
+        KR_LOG(KR_LOGERROR, "record of datasrc [%d] overwritten while detecting!",
+                apply->datasrc);
+        reply->msgtype = KR_MSGTYPE_ERROR;
+        return;
+    }
 
     cJSON *json = kr_context_dump_json(krctx);
     reply->msgbuf = cJSON_PrintUnformatted(json);
@@ -17,6 +17,7 @@ static int kr_rule_detect(T_KRRule *ptRule, T_KRData *ptData)
 
     /*calculate rule string*/
     T_KRCalc *krcalc = ptRule->ptRuleCalc;
+    kr_data_bind_calc(krcalc);
     if (kr_calc_eval(krcalc, ptData) != 0) {
         KR_LOG(KR_LOGERROR, "kr_calc_eval rule[%ld] failed[%s]!", \
                 ptRule->lRuleId, kr_calc_errmsg(krcalc));
@@ -79,6 +80,7 @@ static int kr_rule_list_detect(T_KRRuleList *ptRuleList, T_KRData *ptData)
 static int kr_group_match(T_KRGroup *ptGroup, T_KRData *ptData)
 {
     /*calculate group string*/
+    kr_data_bind_calc(ptGroup->ptGroupCalc);
     if (kr_calc_eval(ptGroup->ptGroupCalc, ptData) != 0) {
         KR_LOG(KR_LOGERROR, "kr_calc_eval group [%ld] failed!", 
                 ptGroup->lGroupId);
@@ -98,9 +100,20 @@ static int kr_group_match(T_KRGroup *ptGroup, T_KRData *ptData)
 }
 
 
+static void kr_flow_set_deps(T_KRFlow *ptFlow, T_KRDataDeps *ptDeps)
+{
+    if (kr_data_deps_resolve(ptDeps, ptFlow->ptData) != 0) {
+        KR_LOG(KR_LOGERROR, "kr_data_deps_resolve failed!");
+        ptDeps = NULL;
+    }
+    ptFlow->ptData->ptDeps = ptDeps;
+}
+
+
 int kr_flow_detect(T_KRFlow *ptFlow, T_KRRecord *ptCurrRec)
 {
     ptFlow->ptData->ptCurrRec = ptCurrRec;
+    ptFlow->ptRoutedGroup = NULL;
     
     /* if no groups to be detected, return asap */
     T_KRGroupList *ptGroupList = ptFlow->ptGroupList;
@@ -108,6 +121,9 @@ int kr_flow_detect(T_KRFlow *ptFlow, T_KRRecord *ptCurrRec)
         KR_LOG(KR_LOGDEBUG, "no groups to be detected!");
         return 0;
     }
+
+    /* only items reachable from the groups get reset after this event */
+    kr_flow_set_deps(ptFlow, ptGroupList->ptDeps);
     
     /*traversal the group list*/
     T_KRListNode *node = ptGroupList->ptGroupList->head;
@@ -116,6 +132,7 @@ int kr_flow_detect(T_KRFlow *ptFlow, T_KRRecord *ptCurrRec)
         int ret = kr_group_match(ptGroup, ptFlow->ptData); 
         if (ret == 1) {
             ptFlow->ptRoutedGroup = ptGroup;
+            kr_flow_set_deps(ptFlow, ptGroup->ptDeps);
             /* rule list detect */
             if (kr_rule_list_detect(ptGroup->ptRuleList, ptFlow->ptData) != 0) {
                 KR_LOG(KR_LOGERROR, "kr_rule_list_detect failed!");
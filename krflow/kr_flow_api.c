@@ -1,5 +1,6 @@
 ﻿#include "kr_flow_api.h"
 #include "krparam/kr_param_api.h"
+#include "krcalc/kr_calc_profile.h"
 
 
 cJSON *kr_rule_info(T_KRRule *ptRule)
@@ -7,6 +8,10 @@ cJSON *kr_rule_info(T_KRRule *ptRule)
     cJSON *rule = cJSON_CreateObject();
     cJSON *def = kr_param_rule_info(ptRule->ptParamRuleDef);
     cJSON_AddItemToObject(rule, "def", def);
+    cJSON *profile = kr_calc_profile_info(ptRule->ptRuleCalc);
+    if (profile != NULL) {
+        cJSON_AddItemToObject(rule, "profile", profile);
+    }
     return rule;
 }
 
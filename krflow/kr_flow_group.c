@@ -39,12 +39,46 @@ void kr_group_init(T_KRGroup *ptGroup)
 
 void kr_group_destruct(T_KRGroup *ptGroup)
 {
+    kr_data_deps_free(ptGroup->ptDeps);
     kr_rule_list_destruct(ptGroup->ptRuleList);
     kr_calc_destruct(ptGroup->ptGroupCalc);
     kr_free(ptGroup);
 }
 
 
+/* groups are matched in order, so routing to a group evaluates
+ * the calcs of all groups before it
+ */
+static int kr_group_list_deps(T_KRGroupList *ptGroupList)
+{
+    ptGroupList->ptDeps = kr_data_deps_new();
+    if (ptGroupList->ptDeps == NULL) return -1;
+
+    T_KRListNode *node = ptGroupList->ptGroupList->head;
+    while(node) {
+        T_KRGroup *ptGroup = kr_list_value(node);
+        kr_data_deps_add_calc(ptGroupList->ptDeps, ptGroup->ptGroupCalc);
+
+        ptGroup->ptDeps = kr_data_deps_new();
+        if (ptGroup->ptDeps == NULL) return -1;
+        T_KRListNode *prev = ptGroupList->ptGroupList->head;
+        while(prev != node->next) {
+            kr_data_deps_add_calc(ptGroup->ptDeps, 
+                    ((T_KRGroup *)kr_list_value(prev))->ptGroupCalc);
+            prev = prev->next;
+        }
+        T_KRListNode *rule = ptGroup->ptRuleList->ptRuleList->head;
+        while(rule) {
+            kr_data_deps_add_calc(ptGroup->ptDeps, 
+                    ((T_KRRule *)kr_list_value(rule))->ptRuleCalc);
+            rule = rule->next;
+        }
+        node = node->next;
+    }
+    return 0;
+}
+
+
 T_KRGroupList *kr_group_list_construct(T_KRParamGroup *ptParamGroup, 
         KRGetTypeFunc pfGetType, KRGetValueFunc pfGetValue)
 {
@@ -78,6 +112,11 @@ T_KRGroupList *kr_group_list_construct(T_KRParamGroup *ptParamGroup,
         }
         kr_list_add_tail(ptGroupList->ptGroupList, ptGroup);
     }
+    if (kr_group_list_deps(ptGroupList) != 0) {
+        KR_LOG(KR_LOGERROR, "kr_group_list_deps failed!");
+        kr_group_list_destruct(ptGroupList);
+        return NULL;
+    }
     ptGroupList->tConstructTime = ptParamGroup->tLastLoadTime;
     
     return ptGroupList;
@@ -96,6 +135,7 @@ void kr_group_list_init(T_KRGroupList *ptGroupList)
 void kr_group_list_destruct(T_KRGroupList *ptGroupList)
 {
     kr_list_destroy(ptGroupList->ptGroupList);
+    kr_data_deps_free(ptGroupList->ptDeps);
     kr_free(ptGroupList);
 }
 
@@ -5,6 +5,7 @@
 #include "krparam/kr_param.h"
 #include "krcalc/kr_calc.h"
 #include "krdb/kr_db.h"
+#include "krdata/kr_data_deps.h"
 #include "kr_flow_rule.h"
 
 typedef int  (*KRGroupFunc)(void *p1, void *p2);
@@ -16,6 +17,8 @@ typedef struct _kr_group_t
     T_KRCalc              *ptGroupCalc;
     KRGroupFunc           GroupFunc; 
     T_KRRuleList          *ptRuleList;
+    T_KRDataDeps          *ptDeps;      /*items of routing to this group 
+                                          and of its rules*/
 }T_KRGroup;
 
 typedef struct _kr_group_list_t
@@ -24,6 +27,7 @@ typedef struct _kr_group_list_t
     long                  lGroupCnt;
     T_KRList              *ptGroupList;
     time_t                tConstructTime;
+    T_KRDataDeps          *ptDeps;      /*items of routing, none matched*/
 }T_KRGroupList;
 
 
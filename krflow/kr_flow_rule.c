@@ -16,7 +16,6 @@ T_KRRule *kr_rule_construct(T_KRParamRuleDef *ptParamRuleDef,
             ptParamRuleDef->caRuleCalcString, pfGetType, pfGetValue);
 
     ptRule->bViolated = FALSE;
-    ptRule->ptRelated = kr_hashtable_new(kr_pointer_hash, kr_pointer_equal);
 
     return ptRule;
 }
@@ -24,12 +23,10 @@ T_KRRule *kr_rule_construct(T_KRParamRuleDef *ptParamRuleDef,
 void kr_rule_init(T_KRRule *ptRule)
 {
     ptRule->bViolated = FALSE;
-    kr_hashtable_remove_all(ptRule->ptRelated);
 }
 
 void kr_rule_destruct(T_KRRule *ptRule)
 {
-    kr_hashtable_destroy(ptRule->ptRelated);
     kr_calc_destruct(ptRule->ptRuleCalc);
     kr_free(ptRule);
 }
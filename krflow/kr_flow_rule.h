@@ -17,7 +17,6 @@ typedef struct _kr_rule_t
     KRRuleFunc            RuleFunc;
 
     kr_bool               bViolated;
-    T_KRHashTable         *ptRelated;
 }T_KRRule;
 
 typedef struct _kr_rule_list_t
@@ -56,6 +56,16 @@ T_KRServerConfig *kr_server_config_parse(char *config_file)
     krengine->thread_pool_size = (int )cJSON_GetNumber(engine, "thread_pool_size");
     krengine->high_water_mark = (int )cJSON_GetNumber(engine, "high_water_mark");
     krengine->hdi_cache_size = (int )cJSON_GetNumber(engine, "hdi_cache_size");
+    krengine->calc_profile_rate = (int )cJSON_GetNumber(engine, "calc_profile_rate");
+    krengine->ddi_quantile_compression = cJSON_GetNumber(engine, "ddi_quantile_compression");
+    krengine->ddi_columnar = (int )cJSON_GetNumber(engine, "ddi_columnar");
+    krengine->index_key_inline = (int )cJSON_GetNumber(engine, "index_key_inline");
+    krengine->freq_sketches = _dupenv(cJSON_GetString(engine, "freq_sketches"));
+    krengine->late_policies = _dupenv(cJSON_GetString(engine, "late_policies"));
+    krengine->table_shards = _dupenv(cJSON_GetString(engine, "table_shards"));
+    krengine->krdb_store_dir = _dupenv(cJSON_GetString(engine, "krdb_store_dir"));
+    krengine->krdb_persist = _dupenv(cJSON_GetString(engine, "krdb_persist"));
+    krengine->related_capture = _dupenv(cJSON_GetString(engine, "related_capture"));
     krserver->engine = krengine;
 
     /*cluster config section*/
@@ -104,6 +114,12 @@ void kr_server_config_free(T_KRServerConfig *server)
         if (engine->krdb_module) kr_free(engine->krdb_module);
         if (engine->data_module) kr_free(engine->data_module);
         if (engine->rule_module) kr_free(engine->rule_module);
+        if (engine->freq_sketches) kr_free(engine->freq_sketches);
+        if (engine->late_policies) kr_free(engine->late_policies);
+        if (engine->table_shards) kr_free(engine->table_shards);
+        if (engine->krdb_store_dir) kr_free(engine->krdb_store_dir);
+        if (engine->krdb_persist) kr_free(engine->krdb_persist);
+        if (engine->related_capture) kr_free(engine->related_capture);
     }
 
     /*cluster config section*/
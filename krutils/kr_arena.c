@@ -0,0 +1,148 @@
+#include "kr_arena.h"
+#include "kr_alloc.h"
+#include <string.h>
+#include <stdint.h>
+
+#define KR_ARENA_ALIGN  16
+#define KR_ARENA_ROUND(n)  (((n) + KR_ARENA_ALIGN - 1) & ~(size_t)(KR_ARENA_ALIGN - 1))
+#define KR_ARENA_HEADER  KR_ARENA_ROUND(sizeof(T_KRArenaChunk))
+#define KR_ARENA_DATA(c)  ((char *)(c) + KR_ARENA_HEADER)
+
+
+static T_KRArenaChunk *kr_arena_chunk_new(T_KRArena *krarena, size_t size)
+{
+    T_KRArenaChunk *chunk = kr_malloc(KR_ARENA_HEADER + size);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->next = krarena->head;
+    chunk->size = size;
+    chunk->used = 0;
+    krarena->head = chunk;
+    krarena->capacity += size;
+    krarena->grows++;
+
+    return chunk;
+}
+
+
+static void kr_arena_chunks_free(T_KRArena *krarena)
+{
+    T_KRArenaChunk *chunk = krarena->head;
+    while (chunk) {
+        T_KRArenaChunk *next = chunk->next;
+        kr_free(chunk);
+        chunk = next;
+    }
+    krarena->head = NULL;
+    krarena->capacity = 0;
+}
+
+
+T_KRArena *kr_arena_new(size_t chunk_size)
+{
+    T_KRArena *krarena = kr_calloc(sizeof(T_KRArena));
+    if (krarena == NULL) {
+        return NULL;
+    }
+    krarena->chunk_size = KR_ARENA_ROUND(chunk_size > 0 ? chunk_size : 1);
+
+    return krarena;
+}
+
+
+void kr_arena_free(T_KRArena *krarena)
+{
+    if (krarena) {
+        kr_arena_chunks_free(krarena);
+        kr_free(krarena);
+    }
+}
+
+
+/* chunks outgrown in this period are merged into one */
+void kr_arena_reset(T_KRArena *krarena)
+{
+    if (krarena->used > krarena->peak) {
+        krarena->peak = krarena->used;
+    }
+    krarena->used = 0;
+
+    if (krarena->head != NULL && krarena->head->next != NULL) {
+        size_t size = krarena->capacity;
+        kr_arena_chunks_free(krarena);
+        kr_arena_chunk_new(krarena, size);
+    } else if (krarena->head != NULL) {
+        krarena->head->used = 0;
+    }
+}
+
+
+void *kr_arena_alloc(T_KRArena *krarena, size_t size)
+{
+    T_KRArenaChunk *chunk = krarena->head;
+    size_t pad = 0;
+
+    size = KR_ARENA_ROUND(size > 0 ? size : 1);
+    if (chunk != NULL) {
+        pad = -(uintptr_t )(KR_ARENA_DATA(chunk) + chunk->used) & \
+              (KR_ARENA_ALIGN - 1);
+    }
+    if (chunk == NULL || chunk->size - chunk->used < pad + size) {
+        /* at least double the arena, so outgrowing it is rare */
+        size_t chunk_size = krarena->chunk_size;
+        if (chunk_size < krarena->capacity) chunk_size = krarena->capacity;
+        while (chunk_size < size + KR_ARENA_ALIGN) chunk_size <<= 1;
+        chunk = kr_arena_chunk_new(krarena, chunk_size);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        pad = -(uintptr_t )KR_ARENA_DATA(chunk) & (KR_ARENA_ALIGN - 1);
+    }
+
+    void *ptr = KR_ARENA_DATA(chunk) + chunk->used + pad;
+    chunk->used += pad + size;
+    krarena->used += pad + size;
+
+    return ptr;
+}
+
+
+void *kr_arena_calloc(T_KRArena *krarena, size_t size)
+{
+    void *ptr = kr_arena_alloc(krarena, size);
+    if (ptr != NULL) {
+        memset(ptr, 0x00, size);
+    }
+    return ptr;
+}
+
+
+char *kr_arena_strndup(T_KRArena *krarena, const char *s, size_t len)
+{
+    char *copy = kr_arena_alloc(krarena, len + 1);
+    if (copy != NULL) {
+        memcpy(copy, s, len);
+        copy[len] = '\0';
+    }
+    return copy;
+}
+
+
+char *kr_arena_strdup(T_KRArena *krarena, const char *s)
+{
+    return kr_arena_strndup(krarena, s, strlen(s));
+}
+
+
+/* whether ptr was handed out by krarena, for memory shared with heap */
+int kr_arena_owns(T_KRArena *krarena, const void *ptr)
+{
+    const char *p = (const char *)ptr;
+    for (T_KRArenaChunk *chunk = krarena->head; chunk; chunk = chunk->next) {
+        if (p >= KR_ARENA_DATA(chunk) && p < KR_ARENA_DATA(chunk) + chunk->size) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+#ifndef __KR_ARENA_H__
+#define __KR_ARENA_H__
+
+#include <stddef.h>
+
+/* bump allocator for scratch memory of one event:
+ * nothing is freed alone, the whole arena is reset at once,
+ * after reset it is a single chunk big enough for the last period,
+ * so a steady workload stops allocating
+ */
+typedef struct _kr_arena_chunk_t
+{
+    struct _kr_arena_chunk_t *next;   /* older chunk */
+    size_t          size;        /* bytes usable */
+    size_t          used;
+}T_KRArenaChunk;
+
+typedef struct _kr_arena_t
+{
+    size_t          chunk_size;  /* least size of a new chunk */
+    T_KRArenaChunk *head;        /* chunk allocated from */
+    size_t          capacity;    /* bytes usable in all chunks */
+    size_t          used;        /* bytes handed out since reset */
+    size_t          peak;        /* most bytes handed out in a period */
+    unsigned long   grows;       /* chunks allocated */
+}T_KRArena;
+
+
+T_KRArena *kr_arena_new(size_t chunk_size);
+void kr_arena_free(T_KRArena *krarena);
+void kr_arena_reset(T_KRArena *krarena);
+
+void *kr_arena_alloc(T_KRArena *krarena, size_t size);
+void *kr_arena_calloc(T_KRArena *krarena, size_t size);
+char *kr_arena_strndup(T_KRArena *krarena, const char *s, size_t len);
+char *kr_arena_strdup(T_KRArena *krarena, const char *s);
+int kr_arena_owns(T_KRArena *krarena, const void *ptr);
+
+#endif /* __KR_ARENA_H__ */
@@ -0,0 +1,139 @@
+#include "kr_cmsketch.h"
+#include "kr_alloc.h"
+#include <string.h>
+
+T_KRCMSketch *kr_cmsketch_new(unsigned int depth, unsigned int width, 
+        unsigned int buckets, long span)
+{
+    if (depth == 0 || buckets == 0 || span <= 0) return NULL;
+
+    T_KRCMSketch *krcms = kr_calloc(sizeof(T_KRCMSketch));
+    if (krcms == NULL) {
+        return NULL;
+    }
+    krcms->depth = depth;
+    krcms->width = 1;
+    while (krcms->width < width) krcms->width <<= 1;
+    krcms->buckets = buckets;
+    krcms->span = span;
+
+    krcms->epochs = kr_calloc(sizeof(long) * buckets);
+    krcms->counters = kr_calloc(sizeof(uint32_t) * \
+            buckets * depth * krcms->width);
+    if (krcms->epochs == NULL || krcms->counters == NULL) {
+        kr_cmsketch_free(krcms);
+        return NULL;
+    }
+    /* no bucket holds any epoch yet */
+    for (unsigned int b = 0; b < buckets; b++) {
+        krcms->epochs[b] = -1;
+    }
+
+    return krcms;
+}
+
+
+void kr_cmsketch_free(T_KRCMSketch *krcms)
+{
+    if (krcms) {
+        kr_free(krcms->epochs);
+        kr_free(krcms->counters);
+        kr_free(krcms);
+    }
+}
+
+
+static inline uint32_t *kr_cmsketch_row(T_KRCMSketch *krcms, 
+        unsigned int bucket, unsigned int row)
+{
+    return &krcms->counters[((size_t )bucket * krcms->depth + row) * \
+        krcms->width];
+}
+
+/* double hashing, the i-th column from two halves of the hash */
+static inline unsigned int kr_cmsketch_column(T_KRCMSketch *krcms, 
+        uint64_t hash, unsigned int row)
+{
+    uint32_t h1 = (uint32_t )hash;
+    uint32_t h2 = (uint32_t )(hash >> 32) | 1;
+    return (h1 + row * h2) & (krcms->width - 1);
+}
+
+
+/* bucket of epoch, cleared if reused, -1 if already reused by a later one */
+static int kr_cmsketch_bucket(T_KRCMSketch *krcms, long epoch)
+{
+    unsigned int b = (unsigned int )(epoch % krcms->buckets);
+    long old = __atomic_load_n(&krcms->epochs[b], __ATOMIC_ACQUIRE);
+
+    while (old < epoch) {
+        if (__atomic_compare_exchange_n(&krcms->epochs[b], &old, epoch, 
+                    0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            /* adds racing with the clearing may get lost */
+            for (unsigned int i = 0; i < krcms->depth; i++) {
+                memset(kr_cmsketch_row(krcms, b, i), 0x00, 
+                        sizeof(uint32_t) * krcms->width);
+            }
+            return (int )b;
+        }
+    }
+    return (old == epoch) ? (int )b : -1;
+}
+
+
+void kr_cmsketch_add(T_KRCMSketch *krcms, uint64_t hash, time_t t)
+{
+    int b = kr_cmsketch_bucket(krcms, (long )t / krcms->span);
+    if (b < 0) return;
+
+    volatile int *lock = &krcms->locks[hash % KR_CMSKETCH_LOCKS];
+    while (__sync_lock_test_and_set(lock, 1)) {
+        while (*lock) ;
+    }
+
+    /* conservative update: only raise counters up to the new minimum */
+    uint32_t min = UINT32_MAX;
+    for (unsigned int i = 0; i < krcms->depth; i++) {
+        uint32_t *c = &kr_cmsketch_row(krcms, b, i)\
+                      [kr_cmsketch_column(krcms, hash, i)];
+        uint32_t v = __atomic_load_n(c, __ATOMIC_RELAXED);
+        if (v < min) min = v;
+    }
+    if (min < UINT32_MAX) min++;
+    for (unsigned int i = 0; i < krcms->depth; i++) {
+        uint32_t *c = &kr_cmsketch_row(krcms, b, i)\
+                      [kr_cmsketch_column(krcms, hash, i)];
+        uint32_t v = __atomic_load_n(c, __ATOMIC_RELAXED);
+        while (v < min && !__atomic_compare_exchange_n(c, &v, min, 
+                    0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) ;
+    }
+
+    __sync_lock_release(lock);
+}
+
+
+/* count of hash within (t-window, t], rounded up to whole buckets */
+unsigned long kr_cmsketch_estimate(T_KRCMSketch *krcms, uint64_t hash, 
+        time_t t, long window)
+{
+    long epoch = (long )t / krcms->span;
+    long nbuckets = (window + krcms->span - 1) / krcms->span;
+    unsigned long count = 0;
+
+    if (nbuckets > krcms->buckets) nbuckets = krcms->buckets;
+    for (long k = 0; k < nbuckets && epoch - k >= 0; k++) {
+        unsigned int b = (unsigned int )((epoch - k) % krcms->buckets);
+        if (__atomic_load_n(&krcms->epochs[b], __ATOMIC_ACQUIRE) != epoch - k) {
+            continue;
+        }
+        uint32_t min = UINT32_MAX;
+        for (unsigned int i = 0; i < krcms->depth; i++) {
+            uint32_t v = __atomic_load_n(&kr_cmsketch_row(krcms, b, i)\
+                    [kr_cmsketch_column(krcms, hash, i)], __ATOMIC_RELAXED);
+            if (v < min) min = v;
+        }
+        count += min;
+    }
+
+    return count;
+}
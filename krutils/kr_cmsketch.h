@@ -0,0 +1,37 @@
+#ifndef __KR_CMSKETCH_H__
+#define __KR_CMSKETCH_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+/* time-bucketed count-min sketch with conservative update:
+ * one depth*width counter matrix per bucket of span seconds,
+ * a bucket is cleared when reused, so memory is fixed,
+ * estimates never undercount while buckets are in the window.
+ * shared by threads: counters are atomic and updates of one key
+ * are serialized by a striped lock, reads take no lock
+ */
+#define KR_CMSKETCH_LOCKS  64
+
+typedef struct _kr_cmsketch_t
+{
+    unsigned int    depth;       /* rows, hash functions */
+    unsigned int    width;       /* counters per row, power of 2 */
+    unsigned int    buckets;     /* time buckets kept */
+    long            span;        /* seconds of each bucket */
+    long           *epochs;      /* time/span of each bucket's counters */
+    uint32_t       *counters;    /* buckets*depth*width */
+    volatile int    locks[KR_CMSKETCH_LOCKS];
+}T_KRCMSketch;
+
+
+T_KRCMSketch *kr_cmsketch_new(unsigned int depth, unsigned int width, 
+        unsigned int buckets, long span);
+void kr_cmsketch_free(T_KRCMSketch *krcms);
+
+void kr_cmsketch_add(T_KRCMSketch *krcms, uint64_t hash, time_t t);
+unsigned long kr_cmsketch_estimate(T_KRCMSketch *krcms, uint64_t hash, 
+        time_t t, long window);
+
+#endif /* __KR_CMSKETCH_H__ */
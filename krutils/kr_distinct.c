@@ -0,0 +1,169 @@
+#include "kr_distinct.h"
+#include "kr_alloc.h"
+#include <string.h>
+#include <math.h>
+
+T_KRDistinct *kr_distinct_new(unsigned int exact_max)
+{
+    T_KRDistinct *krdis = kr_calloc(sizeof(T_KRDistinct));
+    if (krdis == NULL) {
+        return NULL;
+    }
+
+    /* keep the exact set at most half full */
+    krdis->exact_max = exact_max;
+    krdis->exact_cap = 4;
+    while (krdis->exact_cap < exact_max * 2) krdis->exact_cap <<= 1;
+    krdis->exact = kr_calloc(sizeof(uint64_t) * krdis->exact_cap);
+    if (krdis->exact == NULL) {
+        kr_free(krdis);
+        return NULL;
+    }
+
+    return krdis;
+}
+
+
+void kr_distinct_free(T_KRDistinct *krdis)
+{
+    if (krdis) {
+        kr_free(krdis->exact);
+        kr_free(krdis->registers);
+        kr_free(krdis);
+    }
+}
+
+
+/* registers are kept after upgraded, so resetting never allocates */
+void kr_distinct_reset(T_KRDistinct *krdis)
+{
+    if (krdis->exact_cnt > 0) {
+        memset(krdis->exact, 0x00, sizeof(uint64_t) * krdis->exact_cap);
+        krdis->exact_cnt = 0;
+    }
+    if (krdis->upgraded) {
+        memset(krdis->registers, 0x00, KR_DISTINCT_HLL_REGISTERS);
+        krdis->upgraded = 0;
+    }
+}
+
+
+/* fnv-1a, then murmur3's finalizer to spread the high bits */
+uint64_t kr_distinct_hash(const void *data, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    uint64_t h = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+
+static void kr_distinct_hll_add(T_KRDistinct *krdis, uint64_t hash)
+{
+    unsigned int index = (unsigned int )(hash >> (64 - KR_DISTINCT_HLL_BITS));
+    uint64_t rest = (hash << KR_DISTINCT_HLL_BITS) | \
+                    (1ULL << (KR_DISTINCT_HLL_BITS - 1));
+    uint8_t rank = (uint8_t )(__builtin_clzll(rest) + 1);
+
+    if (rank > krdis->registers[index]) {
+        krdis->registers[index] = rank;
+    }
+}
+
+
+/* registers taken once the exact set overflows,
+ * left sparse if they can't be allocated
+ */
+static int kr_distinct_upgrade(T_KRDistinct *krdis)
+{
+    if (krdis->registers == NULL) {
+        krdis->registers = kr_calloc(KR_DISTINCT_HLL_REGISTERS);
+        if (krdis->registers == NULL) {
+            return -1;
+        }
+    } else {
+        memset(krdis->registers, 0x00, KR_DISTINCT_HLL_REGISTERS);
+    }
+
+    for (unsigned int i = 0; i < krdis->exact_cap; i++) {
+        if (krdis->exact[i] != 0) {
+            kr_distinct_hll_add(krdis, krdis->exact[i]);
+        }
+    }
+    memset(krdis->exact, 0x00, sizeof(uint64_t) * krdis->exact_cap);
+    krdis->exact_cnt = 0;
+    krdis->upgraded = 1;
+    return 0;
+}
+
+
+/* -1 if the exact set overflowed and couldn't be upgraded,
+ * hashes are then dropped once it is full
+ */
+int kr_distinct_add_hash(T_KRDistinct *krdis, uint64_t hash)
+{
+    if (krdis->upgraded) {
+        kr_distinct_hll_add(krdis, hash);
+        return 0;
+    }
+
+    /* 0 marks an empty slot */
+    if (hash == 0) hash = 1;
+
+    unsigned int mask = krdis->exact_cap - 1;
+    unsigned int i = (unsigned int )hash & mask;
+    while (krdis->exact[i] != 0) {
+        if (krdis->exact[i] == hash) return 0;
+        i = (i + 1) & mask;
+    }
+    /* one slot is always left empty to end probing */
+    if (krdis->exact_cnt + 1 >= krdis->exact_cap) {
+        return -1;
+    }
+    krdis->exact[i] = hash;
+
+    if (++krdis->exact_cnt > krdis->exact_max) {
+        return kr_distinct_upgrade(krdis);
+    }
+    return 0;
+}
+
+
+int kr_distinct_add(T_KRDistinct *krdis, const void *data, size_t len)
+{
+    return kr_distinct_add_hash(krdis, kr_distinct_hash(data, len));
+}
+
+
+unsigned long kr_distinct_count(T_KRDistinct *krdis)
+{
+    if (!krdis->upgraded) {
+        return krdis->exact_cnt;
+    }
+
+    double m = KR_DISTINCT_HLL_REGISTERS;
+    double sum = 0.0;
+    unsigned int zeros = 0;
+    for (unsigned int i = 0; i < KR_DISTINCT_HLL_REGISTERS; i++) {
+        sum += ldexp(1.0, -krdis->registers[i]);
+        if (krdis->registers[i] == 0) zeros++;
+    }
+
+    double estimate = (0.7213 / (1.0 + 1.079 / m)) * m * m / sum;
+    /* linear counting for the small range */
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * log(m / zeros);
+    }
+
+    return (unsigned long )(estimate + 0.5);
+}
@@ -0,0 +1,34 @@
+#ifndef __KR_DISTINCT_H__
+#define __KR_DISTINCT_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* distinct counter with bounded memory:
+ * an exact set of 64-bit hashes while small,
+ * upgraded to a hyperloglog sketch once it exceeds exact_max
+ */
+#define KR_DISTINCT_HLL_BITS       11
+#define KR_DISTINCT_HLL_REGISTERS  (1 << KR_DISTINCT_HLL_BITS)
+
+typedef struct _kr_distinct_t
+{
+    unsigned int    exact_max;   /* upgrade threshold */
+    unsigned int    exact_cap;   /* slots of exact set, power of 2 */
+    unsigned int    exact_cnt;   /* hashes in exact set */
+    uint64_t       *exact;       /* open addressing set, 0 for empty */
+    int             upgraded;    /* counted by registers */
+    uint8_t        *registers;   /* hyperloglog registers */
+}T_KRDistinct;
+
+
+T_KRDistinct *kr_distinct_new(unsigned int exact_max);
+void kr_distinct_free(T_KRDistinct *krdis);
+void kr_distinct_reset(T_KRDistinct *krdis);
+
+uint64_t kr_distinct_hash(const void *data, size_t len);
+int kr_distinct_add_hash(T_KRDistinct *krdis, uint64_t hash);
+int kr_distinct_add(T_KRDistinct *krdis, const void *data, size_t len);
+unsigned long kr_distinct_count(T_KRDistinct *krdis);
+
+#endif /* __KR_DISTINCT_H__ */
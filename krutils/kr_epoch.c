@@ -0,0 +1,128 @@
+#include "kr_epoch.h"
+#include "kr_alloc.h"
+#include <string.h>
+
+
+T_KREpoch *kr_epoch_new(void)
+{
+    T_KREpoch *krepoch = kr_calloc(sizeof(T_KREpoch));
+    if (krepoch == NULL) {
+        return NULL;
+    }
+    krepoch->epoch = 1;
+    pthread_mutex_init(&krepoch->lock, NULL);
+    return krepoch;
+}
+
+
+static void kr_epoch_free_list(T_KREpochRetired *retired)
+{
+    while (retired) {
+        T_KREpochRetired *next = retired->next;
+        retired->free_func(retired->ptr);
+        kr_free(retired);
+        retired = next;
+    }
+}
+
+
+/* no reader may be inside any more */
+void kr_epoch_free(T_KREpoch *krepoch)
+{
+    if (krepoch) {
+        kr_epoch_free_list(krepoch->retired);
+        pthread_mutex_destroy(&krepoch->lock);
+        kr_free(krepoch);
+    }
+}
+
+
+T_KREpochReader *kr_epoch_register(T_KREpoch *krepoch)
+{
+    for (int i=0; i<KR_EPOCH_READERS_MAX; i++) {
+        T_KREpochReader *reader = &krepoch->readers[i];
+        if (!reader->used && 
+            __sync_bool_compare_and_swap(&reader->used, 0, 1)) {
+            reader->epoch = 0;
+            /*readers scanned up to the highest slot ever taken*/
+            int n = krepoch->nreaders;
+            while (n < i+1 && 
+                   !__sync_bool_compare_and_swap(&krepoch->nreaders, n, i+1)) {
+                n = krepoch->nreaders;
+            }
+            return reader;
+        }
+    }
+    return NULL;
+}
+
+
+void kr_epoch_unregister(T_KREpochReader *reader)
+{
+    if (reader) {
+        kr_epoch_exit(reader);
+        reader->used = 0;
+    }
+}
+
+
+/* ptr must be unreachable for readers entering from now on */
+void kr_epoch_retire(T_KREpoch *krepoch, void *ptr, KRFreeFunc free_func)
+{
+    if (ptr == NULL) return;
+
+    T_KREpochRetired *retired = kr_malloc(sizeof(T_KREpochRetired));
+    if (retired == NULL) {
+        /*leaked rather than freed under a reader*/
+        return;
+    }
+    retired->ptr = ptr;
+    retired->free_func = free_func;
+
+    pthread_mutex_lock(&krepoch->lock);
+    retired->epoch = krepoch->epoch;
+    retired->next = krepoch->retired;
+    krepoch->retired = retired;
+    krepoch->pending++;
+    pthread_mutex_unlock(&krepoch->lock);
+}
+
+
+/* free what no reader can still see, and start a new epoch,
+ * return the number freed
+ */
+unsigned long kr_epoch_reclaim(T_KREpoch *krepoch)
+{
+    T_KREpochRetired *freeing = NULL;
+    unsigned long n = 0;
+
+    if (krepoch->retired == NULL) return 0;
+
+    pthread_mutex_lock(&krepoch->lock);
+    /*unlinked before retired, so pairs with kr_epoch_enter*/
+    __sync_synchronize();
+    unsigned long oldest = __sync_fetch_and_add(&krepoch->epoch, 1) + 1;
+    for (int i=0; i<krepoch->nreaders; i++) {
+        unsigned long epoch = krepoch->readers[i].epoch;
+        if (epoch != 0 && epoch < oldest) oldest = epoch;
+    }
+
+    T_KREpochRetired **link = &krepoch->retired;
+    while (*link) {
+        T_KREpochRetired *retired = *link;
+        if (retired->epoch < oldest) {
+            *link = retired->next;
+            retired->next = freeing;
+            freeing = retired;
+            n++;
+        } else {
+            link = &retired->next;
+        }
+    }
+    krepoch->pending -= n;
+    krepoch->freed += n;
+    pthread_mutex_unlock(&krepoch->lock);
+
+    kr_epoch_free_list(freeing);
+    return n;
+}
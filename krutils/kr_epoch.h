@@ -0,0 +1,59 @@
+#ifndef __KR_EPOCH_H__
+#define __KR_EPOCH_H__
+
+#include <pthread.h>
+#include "kr_types.h"
+
+#define KR_EPOCH_READERS_MAX  256
+
+/* epoch based reclamation:
+ * readers walk shared structures without locks between enter and exit,
+ * writers unlink memory and retire it instead of freeing,
+ * it is freed once every reader inside when it was retired has left
+ */
+typedef struct _kr_epoch_reader_t
+{
+    volatile unsigned long  epoch;   /* entered at, 0 while outside */
+    volatile int            used;
+}T_KREpochReader;
+
+typedef struct _kr_epoch_retired_t
+{
+    struct _kr_epoch_retired_t *next;
+    void                   *ptr;
+    KRFreeFunc              free_func;
+    unsigned long           epoch;   /* retired at */
+}T_KREpochRetired;
+
+typedef struct _kr_epoch_t
+{
+    volatile unsigned long  epoch;   /* current, starts at 1 */
+    volatile int            nreaders;/* readers slots ever used */
+    T_KREpochReader         readers[KR_EPOCH_READERS_MAX];
+    pthread_mutex_t         lock;    /* retired list only */
+    T_KREpochRetired       *retired;
+    unsigned long           pending; /* retired not freed yet */
+    unsigned long           freed;
+}T_KREpoch;
+
+
+T_KREpoch *kr_epoch_new(void);
+void kr_epoch_free(T_KREpoch *krepoch);
+T_KREpochReader *kr_epoch_register(T_KREpoch *krepoch);
+void kr_epoch_unregister(T_KREpochReader *reader);
+void kr_epoch_retire(T_KREpoch *krepoch, void *ptr, KRFreeFunc free_func);
+unsigned long kr_epoch_reclaim(T_KREpoch *krepoch);
+
+static inline void kr_epoch_enter(T_KREpoch *krepoch, T_KREpochReader *reader)
+{
+    reader->epoch = krepoch->epoch;
+    __sync_synchronize();
+}
+
+static inline void kr_epoch_exit(T_KREpochReader *reader)
+{
+    __sync_synchronize();
+    reader->epoch = 0;
+}
+
+#endif /* __KR_EPOCH_H__ */
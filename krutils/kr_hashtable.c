@@ -29,6 +29,9 @@ struct _kr_hashtable_t
     volatile int      ref_count;  /*currently not used...*/
     KRDestroyNotify   key_destroy_func;
     KRDestroyNotify   value_destroy_func;
+    int               min_size;   /* never shrunk below, see kr_hashtable_clear */
+    KRRetireFunc      retire_func;/* old nodes handed over, see kr_hashtable_set_retire */
+    void             *retire_data;
 };
 
 /* Each table size has an associated prime modulo (the first prime
@@ -116,7 +119,7 @@ kr_hashtable_set_shift_from_size(T_KRHashTable *hash_table, int size)
  * @hash_table: our #T_KRHashTable
  * @key: the key to lookup against
  * @hash_return: optional key hash return location
- * Return value: index of the described #T_KRHashNode
+ * Return value: the described #T_KRHashNode
  *
  * Performs a lookup in the hash table.  Virtually all hash operations
  * will use this function internally.
@@ -125,10 +128,15 @@ kr_hashtable_set_shift_from_size(T_KRHashTable *hash_table, int size)
  * user's hash function.
  *
  * If an entry in the table matching @key is found then this function
- * returns the index of that entry in the table, and if not, the
- * index of an empty node (never a tombstone).
+ * returns that entry in the table, and if not, an empty node 
+ * (never a tombstone).
+ *
+ * Lookups along with a writer, see kr_hashtable_set_retire(), may probe
+ * nodes full just before resized, so they give up after probing all.
  */
-static inline unsigned int 
+static T_KRHashNode kr_hashnode_unused;
+
+static inline T_KRHashNode *
 kr_hashtable_lookup_node(T_KRHashTable *hash_table, const void *key)
 {
     T_KRHashNode *node;
@@ -138,12 +146,24 @@ kr_hashtable_lookup_node(T_KRHashTable *hash_table, const void *key)
     
     /* Empty buckets have hash_value set to 0, and for tombstones, it's 1.
      * We need to make sure our hash value is not one of these. */
+    T_KRHashNode *nodes;
+    int mod;
+    unsigned int mask;
+    
     hash_value = (* hash_table->hash_func)(key);
     if (hash_value <= 1)
         hash_value = 2;
     
-    node_index = hash_value % hash_table->mod;
-    node = &hash_table->nodes[node_index];
+    /* the shape is published after the nodes on resize, 
+     * so nodes read after it are at least as big */
+    mod = hash_table->mod;
+    mask = hash_table->mask;
+    if (hash_table->retire_func)
+        __sync_synchronize();
+    nodes = hash_table->nodes;
+    
+    node_index = hash_value % mod;
+    node = &nodes[node_index];
     
     while (node->key_hash)
     {
@@ -165,12 +185,14 @@ kr_hashtable_lookup_node(T_KRHashTable *hash_table, const void *key)
         }
     
         step++;
+        if (step > mask)
+            return &kr_hashnode_unused;
         node_index += step;
-        node_index &= hash_table->mask;
-        node = &hash_table->nodes[node_index];
+        node_index &= mask;
+        node = &nodes[node_index];
     }
     
-    return node_index;
+    return node;
 }
 
 /*
@@ -280,9 +302,12 @@ kr_hashtable_remove_node (T_KRHashTable   *hash_table,
     /* Erect tombstone */
     node->key_hash = 1;
     
-    /* Be GC friendly */
-    node->key = NULL;
-    node->value = NULL;
+    /* Be GC friendly, unless readers may still be probing it */
+    if (!hash_table->retire_func)
+    {
+        node->key = NULL;
+        node->value = NULL;
+    }
     
     hash_table->nnodes--;
 }
@@ -342,13 +367,18 @@ static void
 kr_hashtable_resize (T_KRHashTable *hash_table)
 {
     T_KRHashNode *new_nodes;
+    T_KRHashTable shape;
     int old_size;
     int i;
     
     old_size = hash_table->size;
-    kr_hashtable_set_shift_from_size(hash_table, hash_table->nnodes * 2);
+    if (hash_table->retire_func)
+        kr_hashtable_set_shift_from_size(&shape, 
+                MAX(hash_table->nnodes * 2, old_size - 1));
+    else
+        kr_hashtable_set_shift_from_size(&shape, hash_table->nnodes * 2);
     
-    new_nodes = (T_KRHashNode *)kr_calloc(sizeof(T_KRHashNode)*hash_table->size);
+    new_nodes = (T_KRHashNode *)kr_calloc(sizeof(T_KRHashNode)*shape.size);
     
     for (i = 0; i < old_size; i++)
     {
@@ -360,22 +390,40 @@ kr_hashtable_resize (T_KRHashTable *hash_table)
         if (node->key_hash <= 1)
             continue;
     
-        hash_val = node->key_hash % hash_table->mod;
+        hash_val = node->key_hash % shape.mod;
         new_node = &new_nodes[hash_val];
     
         while (new_node->key_hash)
         {
             step++;
             hash_val += step;
-            hash_val &= hash_table->mask;
+            hash_val &= shape.mask;
             new_node = &new_nodes[hash_val];
         }
     
         *new_node = *node;
     }
     
-    kr_free(hash_table->nodes);
-    hash_table->nodes = new_nodes;
+    if (hash_table->retire_func)
+    {
+        /* nodes before the shape, see kr_hashtable_lookup_node */
+        T_KRHashNode *old_nodes = hash_table->nodes;
+        __sync_synchronize();
+        hash_table->nodes = new_nodes;
+        __sync_synchronize();
+        hash_table->size = shape.size;
+        hash_table->mod = shape.mod;
+        hash_table->mask = shape.mask;
+        hash_table->retire_func(hash_table->retire_data, old_nodes);
+    }
+    else
+    {
+        kr_free(hash_table->nodes);
+        hash_table->nodes = new_nodes;
+        hash_table->size = shape.size;
+        hash_table->mod = shape.mod;
+        hash_table->mask = shape.mask;
+    }
     hash_table->noccupied = hash_table->nnodes;
 }
 
@@ -394,7 +442,8 @@ kr_hashtable_maybe_resize (T_KRHashTable *hash_table)
     int noccupied = hash_table->noccupied;
     int size = hash_table->size;
 
-    if ((size > hash_table->nnodes * 4 && size > 1 << HASH_TABLE_MIN_SHIFT) ||
+    if ((size > hash_table->nnodes * 4 && size > 1 << HASH_TABLE_MIN_SHIFT &&
+         size > hash_table->min_size && !hash_table->retire_func) ||
         (size <= noccupied + (noccupied / 16)))
         kr_hashtable_resize(hash_table);
 }
@@ -502,13 +551,11 @@ void *
 kr_hashtable_lookup (T_KRHashTable   *hash_table, const void * key)
 {
     T_KRHashNode *node;
-    unsigned int      node_index;
     
     if (hash_table == NULL)
         return NULL;
     
-    node_index = kr_hashtable_lookup_node(hash_table, key);
-    node = &hash_table->nodes[node_index];
+    node = kr_hashtable_lookup_node(hash_table, key);
     
     return node->key_hash ? node->value : NULL;
 }
@@ -537,13 +584,11 @@ kr_hashtable_lookup_extended (T_KRHashTable    *hash_table,
                               void       **value)
 {
     T_KRHashNode *node;
-    unsigned int      node_index;
     
     if (hash_table == NULL)
         return FALSE;
     
-    node_index = kr_hashtable_lookup_node(hash_table, lookup_key);
-    node = &hash_table->nodes[node_index];
+    node = kr_hashtable_lookup_node(hash_table, lookup_key);
     
     if (!node->key_hash)
         return FALSE;
@@ -615,6 +660,8 @@ kr_hashtable_insert_internal (T_KRHashTable *hash_table,
     {
         node->key = key;
         node->value = value;
+        if (hash_table->retire_func)
+            __sync_synchronize();
         node->key_hash = key_hash;
       
         hash_table->nnodes++;
@@ -690,13 +737,11 @@ kr_hashtable_remove_internal (T_KRHashTable    *hash_table,
                               kr_bool        notify)
 {
     T_KRHashNode *node;
-    unsigned int node_index;
     
     if (hash_table == NULL)
         return FALSE;
     
-    node_index = kr_hashtable_lookup_node(hash_table, key);
-    node = &hash_table->nodes[node_index];
+    node = kr_hashtable_lookup_node(hash_table, key);
     
     /* kr_hashtable_lookup_node() never returns a tombstone, so this is safe */
     if (!node->key_hash)
@@ -768,6 +813,46 @@ kr_hashtable_remove_all (T_KRHashTable *hash_table)
     kr_hashtable_maybe_resize(hash_table);
 }
 
+/**
+ * kr_hashtable_clear:
+ * @hash_table: a #T_KRHashTable
+ *
+ * Like kr_hashtable_remove_all(), but the table is never shrunk below
+ * its current size afterwards, for tables emptied and refilled over
+ * and over again, which then stop allocating.
+ **/
+void
+kr_hashtable_clear (T_KRHashTable *hash_table)
+{
+    assert(hash_table != NULL);
+
+    if (hash_table->size > hash_table->min_size)
+        hash_table->min_size = hash_table->size;
+    if (hash_table->noccupied > 0)
+        kr_hashtable_remove_all_nodes(hash_table, TRUE);
+}
+
+/**
+ * kr_hashtable_set_retire:
+ * @hash_table: a #T_KRHashTable
+ * @retire_func: called with @retire_data and each node array replaced
+ *
+ * For tables read by lookups running along with one writer: 
+ * the table then only grows, node arrays are handed to @retire_func
+ * instead of being freed, and removed nodes keep their key and value,
+ * so a lookup never touches freed memory, though it may see a stale
+ * result the caller has to detect.
+ **/
+void
+kr_hashtable_set_retire (T_KRHashTable *hash_table, 
+                         KRRetireFunc retire_func, void *retire_data)
+{
+    assert(hash_table != NULL);
+
+    hash_table->retire_func = retire_func;
+    hash_table->retire_data = retire_data;
+}
+
 /**
  * kr_hashtable_steal_all:
  * @hash_table: a #T_KRHashTable.
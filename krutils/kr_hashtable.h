@@ -9,6 +9,7 @@ typedef struct _kr_hashtable_t  T_KRHashTable;
 
 typedef void (*KRHFunc)(void *key, void *value, void *data);
 typedef kr_bool  (*KRHRFunc)(void *key, void *value, void *user_data);
+typedef void (*KRRetireFunc)(void *data, void *ptr);
 
 /* Hash table operating functions */
 T_KRHashTable* kr_hashtable_new (KRHashFunc hash_func, KREqualFunc key_equal_func);
@@ -26,6 +27,10 @@ void         kr_hashtable_replace (T_KRHashTable    *hash_table,
 kr_bool      kr_hashtable_remove (T_KRHashTable       *hash_table,
                                   const void        *key);
 void         kr_hashtable_remove_all (T_KRHashTable  *hash_table);
+void         kr_hashtable_clear (T_KRHashTable  *hash_table);
+void         kr_hashtable_set_retire (T_KRHashTable  *hash_table,
+                                      KRRetireFunc    retire_func,
+                                      void           *retire_data);
 kr_bool      kr_hashtable_steal (T_KRHashTable     *hash_table,
                                  const void      *key);
 void         kr_hashtable_steal_all (T_KRHashTable    *hash_table);
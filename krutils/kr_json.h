@@ -60,6 +60,9 @@ typedef struct cJSON_Hooks {
 
 /* Supply malloc, realloc and free functions to cJSON */
 extern void cJSON_InitHooks(cJSON_Hooks* hooks);
+/* Build items of this thread from arena until bound to NULL, they must be deleted before it is reset */
+struct _kr_arena_t;
+extern void cJSON_BindArena(struct _kr_arena_t *arena);
 
 
 /* Supply a block of JSON, and this returns a cJSON object you can interrogate. Call cJSON_Delete when finished. */
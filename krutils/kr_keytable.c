@@ -0,0 +1,415 @@
+#include "kr_keytable.h"
+#include "kr_distinct.h"
+#include <string.h>
+#include <stdint.h>
+
+#define KR_KEYTABLE_MIN_SIZE  16
+
+/*bucket states in uiHash, a used one holds a hash of 2 or more*/
+#define KR_KEY_EMPTY      0
+#define KR_KEY_TOMBSTONE  1
+
+typedef struct _kr_keybucket_t
+{
+    uint32_t        uiHash;
+    uint32_t        uiOutline;    /* key is a pointer to a string copied */
+    void            *value;
+    char            key[];        /* uiKeySize bytes */
+}T_KRKeyBucket;
+
+/*buckets and their mask in one block, replaced as a whole*/
+typedef struct _kr_keybuckets_t
+{
+    unsigned int    uiMask;       /* buckets - 1, a power of 2 */
+    unsigned int    uiSize;       /* buckets, data stays 8 bytes aligned */
+    char            data[];       /* buckets of uiStride bytes */
+}T_KRKeyBuckets;
+
+struct _kr_keytable_t
+{
+    E_KRType        eKeyType;
+    size_t          uiKeySize;    /* bytes of a key in its bucket */
+    size_t          uiStride;     /* bytes of a bucket */
+    unsigned int    uiCnt;        /* keys */
+    unsigned int    uiOccupied;   /* keys and tombstones */
+    T_KRKeyBuckets  *volatile ptBuckets;
+    KRRetireFunc    pfRetire;     /* replaced buckets and keys handed over */
+    void            *pRetireData;
+};
+
+/*a key as looked for, a fixed one in the bytes kept in buckets*/
+typedef struct _kr_keyprobe_t
+{
+    uint32_t        uiHash;
+    uint64_t        uiFixed;
+    const char      *psKey;
+    size_t          uiLen;
+}T_KRKeyProbe;
+
+
+static inline T_KRKeyBucket *kr_keytable_bucket(T_KRKeyTable *ptKeyTable,
+        T_KRKeyBuckets *ptBuckets, unsigned int i)
+{
+    return (T_KRKeyBucket *)(ptBuckets->data + (size_t )i*ptKeyTable->uiStride);
+}
+
+
+static inline uint64_t kr_keytable_mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+
+static void kr_keytable_probe(T_KRKeyTable *ptKeyTable, const void *key,
+        T_KRKeyProbe *ptProbe)
+{
+    uint64_t h;
+    ptProbe->uiFixed = 0;
+    switch(ptKeyTable->eKeyType)
+    {
+        case KR_TYPE_STRING:
+            ptProbe->psKey = (const char *)key;
+            ptProbe->uiLen = strlen(ptProbe->psKey);
+            h = kr_distinct_hash(ptProbe->psKey, ptProbe->uiLen);
+            break;
+        case KR_TYPE_POINTER:
+            ptProbe->uiFixed = (uint64_t )(uintptr_t )key;
+            h = kr_keytable_mix(ptProbe->uiFixed);
+            break;
+        case KR_TYPE_DOUBLE: {
+            /*-0.0 equals 0.0*/
+            double d = *(const double *)key;
+            if (d == 0) d = 0;
+            memcpy(&ptProbe->uiFixed, &d, sizeof(d));
+            h = kr_keytable_mix(ptProbe->uiFixed);
+            break;
+        }
+        case KR_TYPE_INT:
+            memcpy(&ptProbe->uiFixed, key, sizeof(int));
+            h = kr_keytable_mix(ptProbe->uiFixed);
+            break;
+        default:
+            memcpy(&ptProbe->uiFixed, key, sizeof(long));
+            h = kr_keytable_mix(ptProbe->uiFixed);
+            break;
+    }
+    ptProbe->uiHash = (uint32_t )(h ^ (h >> 32));
+    if (ptProbe->uiHash <= KR_KEY_TOMBSTONE) ptProbe->uiHash += 2;
+}
+
+
+static inline int kr_keytable_match(T_KRKeyTable *ptKeyTable,
+        T_KRKeyBucket *ptBucket, T_KRKeyProbe *ptProbe)
+{
+    if (ptKeyTable->eKeyType != KR_TYPE_STRING) {
+        return *(uint64_t *)ptBucket->key == ptProbe->uiFixed;
+    }
+    if (ptProbe->uiLen < ptKeyTable->uiKeySize) {
+        return !ptBucket->uiOutline &&
+            memcmp(ptBucket->key, ptProbe->psKey, ptProbe->uiLen+1) == 0;
+    }
+    return ptBucket->uiOutline &&
+        strcmp(*(char **)ptBucket->key, ptProbe->psKey) == 0;
+}
+
+
+/* bucket of the key, NULL if not found, gives up after probing all
+ * since a lookup along with the writer may see them all used
+ */
+static T_KRKeyBucket *kr_keytable_find(T_KRKeyTable *ptKeyTable,
+        T_KRKeyBuckets *ptBuckets, T_KRKeyProbe *ptProbe)
+{
+    unsigned int uiMask = ptBuckets->uiMask;
+    unsigned int i = ptProbe->uiHash & uiMask;
+    for (unsigned int n=0; n<=uiMask; n++) {
+        T_KRKeyBucket *ptBucket = kr_keytable_bucket(ptKeyTable, ptBuckets, i);
+        uint32_t uiHash = ptBucket->uiHash;
+        if (uiHash == KR_KEY_EMPTY) {
+            return NULL;
+        }
+        if (uiHash == ptProbe->uiHash &&
+            kr_keytable_match(ptKeyTable, ptBucket, ptProbe)) {
+            return ptBucket;
+        }
+        i = (i + 1) & uiMask;
+    }
+    return NULL;
+}
+
+
+static T_KRKeyBuckets *kr_keybuckets_new(T_KRKeyTable *ptKeyTable,
+        unsigned int uiSize)
+{
+    T_KRKeyBuckets *ptBuckets = kr_calloc(sizeof(T_KRKeyBuckets) + \
+            (size_t )uiSize*ptKeyTable->uiStride);
+    if (ptBuckets == NULL) {
+        return NULL;
+    }
+    ptBuckets->uiMask = uiSize - 1;
+    ptBuckets->uiSize = uiSize;
+    return ptBuckets;
+}
+
+
+T_KRKeyTable *kr_keytable_new(E_KRType eKeyType, size_t uiStrInline)
+{
+    switch(eKeyType)
+    {
+        case KR_TYPE_INT:
+        case KR_TYPE_LONG:
+        case KR_TYPE_DOUBLE:
+        case KR_TYPE_POINTER:
+        case KR_TYPE_STRING:
+            break;
+        default:
+            return NULL;
+    }
+
+    T_KRKeyTable *ptKeyTable = kr_calloc(sizeof(T_KRKeyTable));
+    if (ptKeyTable == NULL) {
+        return NULL;
+    }
+    ptKeyTable->eKeyType = eKeyType;
+    ptKeyTable->uiKeySize = sizeof(uint64_t);
+    if (eKeyType == KR_TYPE_STRING) {
+        /*room for the pointer of one copied out of line*/
+        ptKeyTable->uiKeySize = \
+            (uiStrInline + 7) & ~(size_t )7;
+        if (ptKeyTable->uiKeySize < sizeof(char *)) {
+            ptKeyTable->uiKeySize = sizeof(char *);
+        }
+    }
+    ptKeyTable->uiStride = sizeof(T_KRKeyBucket) + ptKeyTable->uiKeySize;
+    ptKeyTable->ptBuckets = kr_keybuckets_new(ptKeyTable, KR_KEYTABLE_MIN_SIZE);
+    if (ptKeyTable->ptBuckets == NULL) {
+        kr_free(ptKeyTable);
+        return NULL;
+    }
+
+    return ptKeyTable;
+}
+
+
+/*no lookup may be running any more*/
+void kr_keytable_destroy(T_KRKeyTable *ptKeyTable)
+{
+    if (ptKeyTable == NULL) return;
+
+    T_KRKeyBuckets *ptBuckets = ptKeyTable->ptBuckets;
+    for (unsigned int i=0; i<=ptBuckets->uiMask; i++) {
+        T_KRKeyBucket *ptBucket = kr_keytable_bucket(ptKeyTable, ptBuckets, i);
+        if (ptBucket->uiHash > KR_KEY_TOMBSTONE && ptBucket->uiOutline) {
+            kr_free(*(char **)ptBucket->key);
+        }
+    }
+    kr_free(ptBuckets);
+    kr_free(ptKeyTable);
+}
+
+
+/* lookups may then run along with the writer: buckets replaced and
+ * keys copied out of line are handed to pfRetire instead of freed,
+ * tombstones are no longer reused until the buckets are replaced,
+ * so a lookup never reads a bucket half written with another key,
+ * it may still see a stale result the caller has to detect
+ */
+void kr_keytable_set_retire(T_KRKeyTable *ptKeyTable,
+        KRRetireFunc pfRetire, void *pRetireData)
+{
+    ptKeyTable->pfRetire = pfRetire;
+    ptKeyTable->pRetireData = pRetireData;
+}
+
+
+void *kr_keytable_lookup(T_KRKeyTable *ptKeyTable, const void *key)
+{
+    T_KRKeyProbe stProbe;
+    kr_keytable_probe(ptKeyTable, key, &stProbe);
+
+    /*mask and buckets published together*/
+    T_KRKeyBuckets *ptBuckets = ptKeyTable->ptBuckets;
+    T_KRKeyBucket *ptBucket = kr_keytable_find(ptKeyTable, ptBuckets, &stProbe);
+    return ptBucket ? ptBucket->value : NULL;
+}
+
+
+/*first bucket free for a key of uiHash, a tombstone unless retiring*/
+static T_KRKeyBucket *kr_keytable_vacant(T_KRKeyTable *ptKeyTable,
+        T_KRKeyBuckets *ptBuckets, uint32_t uiHash)
+{
+    unsigned int uiMask = ptBuckets->uiMask;
+    unsigned int i = uiHash & uiMask;
+    for (;;) {
+        T_KRKeyBucket *ptBucket = kr_keytable_bucket(ptKeyTable, ptBuckets, i);
+        if (ptBucket->uiHash == KR_KEY_EMPTY) return ptBucket;
+        if (ptBucket->uiHash == KR_KEY_TOMBSTONE &&
+            ptKeyTable->pfRetire == NULL) return ptBucket;
+        i = (i + 1) & uiMask;
+    }
+}
+
+
+/* keys moved into new buckets at most half used, tombstones dropped,
+ * the old ones retired if lookups may still probe them
+ */
+static int kr_keytable_resize(T_KRKeyTable *ptKeyTable)
+{
+    unsigned int uiSize = KR_KEYTABLE_MIN_SIZE;
+    while (uiSize < (ptKeyTable->uiCnt+1)*2) uiSize *= 2;
+
+    T_KRKeyBuckets *ptOld = ptKeyTable->ptBuckets;
+    T_KRKeyBuckets *ptNew = kr_keybuckets_new(ptKeyTable, uiSize);
+    if (ptNew == NULL) {
+        return -1;
+    }
+    for (unsigned int i=0; i<=ptOld->uiMask; i++) {
+        T_KRKeyBucket *ptBucket = kr_keytable_bucket(ptKeyTable, ptOld, i);
+        if (ptBucket->uiHash <= KR_KEY_TOMBSTONE) continue;
+        T_KRKeyBucket *ptVacant = \
+            kr_keytable_vacant(ptKeyTable, ptNew, ptBucket->uiHash);
+        memcpy(ptVacant, ptBucket, ptKeyTable->uiStride);
+    }
+
+    __sync_synchronize();
+    ptKeyTable->ptBuckets = ptNew;
+    ptKeyTable->uiOccupied = ptKeyTable->uiCnt;
+    if (ptKeyTable->pfRetire) {
+        ptKeyTable->pfRetire(ptKeyTable->pRetireData, ptOld);
+    } else {
+        kr_free(ptOld);
+    }
+    return 0;
+}
+
+
+/*key must not be in yet, -1 if out of memory*/
+int kr_keytable_insert(T_KRKeyTable *ptKeyTable, const void *key, void *value)
+{
+    T_KRKeyProbe stProbe;
+    kr_keytable_probe(ptKeyTable, key, &stProbe);
+
+    /*kept at most three quarters occupied*/
+    T_KRKeyBuckets *ptBuckets = ptKeyTable->ptBuckets;
+    if ((ptKeyTable->uiOccupied+1)*4 > (ptBuckets->uiMask+1)*3) {
+        if (kr_keytable_resize(ptKeyTable) != 0) {
+            return -1;
+        }
+        ptBuckets = ptKeyTable->ptBuckets;
+    }
+
+    char *psOutline = NULL;
+    if (ptKeyTable->eKeyType == KR_TYPE_STRING &&
+        stProbe.uiLen >= ptKeyTable->uiKeySize) {
+        psOutline = kr_strdup(stProbe.psKey);
+        if (psOutline == NULL) {
+            return -1;
+        }
+    }
+
+    T_KRKeyBucket *ptBucket = \
+        kr_keytable_vacant(ptKeyTable, ptBuckets, stProbe.uiHash);
+    if (ptBucket->uiHash == KR_KEY_EMPTY) {
+        ptKeyTable->uiOccupied++;
+    }
+    ptBucket->value = value;
+    if (psOutline != NULL) {
+        ptBucket->uiOutline = 1;
+        *(char **)ptBucket->key = psOutline;
+    } else if (ptKeyTable->eKeyType == KR_TYPE_STRING) {
+        ptBucket->uiOutline = 0;
+        memcpy(ptBucket->key, stProbe.psKey, stProbe.uiLen+1);
+    } else {
+        ptBucket->uiOutline = 0;
+        *(uint64_t *)ptBucket->key = stProbe.uiFixed;
+    }
+    /*the key before its hash, see kr_keytable_find*/
+    __sync_synchronize();
+    ptBucket->uiHash = stProbe.uiHash;
+    ptKeyTable->uiCnt++;
+    return 0;
+}
+
+
+/*value of the key removed, NULL if not found*/
+void *kr_keytable_remove(T_KRKeyTable *ptKeyTable, const void *key)
+{
+    T_KRKeyProbe stProbe;
+    kr_keytable_probe(ptKeyTable, key, &stProbe);
+
+    T_KRKeyBucket *ptBucket = \
+        kr_keytable_find(ptKeyTable, ptKeyTable->ptBuckets, &stProbe);
+    if (ptBucket == NULL) {
+        return NULL;
+    }
+
+    /*key kept in place for lookups probing it*/
+    ptBucket->uiHash = KR_KEY_TOMBSTONE;
+    if (ptBucket->uiOutline) {
+        char *psOutline = *(char **)ptBucket->key;
+        if (ptKeyTable->pfRetire) {
+            ptKeyTable->pfRetire(ptKeyTable->pRetireData, psOutline);
+        } else {
+            kr_free(psOutline);
+        }
+    }
+    ptKeyTable->uiCnt--;
+    return ptBucket->value;
+}
+
+
+unsigned int kr_keytable_size(T_KRKeyTable *ptKeyTable)
+{
+    return ptKeyTable->uiCnt;
+}
+
+
+/*memory of buckets, strings copied out of line not counted*/
+size_t kr_keytable_bytes(T_KRKeyTable *ptKeyTable)
+{
+    return sizeof(T_KRKeyTable) + sizeof(T_KRKeyBuckets) + \
+        (size_t )(ptKeyTable->ptBuckets->uiMask+1)*ptKeyTable->uiStride;
+}
+
+
+/*func is given the key as looked up, a pointer one by its value*/
+void kr_keytable_foreach(T_KRKeyTable *ptKeyTable, KRHFunc func, void *data)
+{
+    T_KRKeyBuckets *ptBuckets = ptKeyTable->ptBuckets;
+    for (unsigned int i=0; i<=ptBuckets->uiMask; i++) {
+        T_KRKeyBucket *ptBucket = kr_keytable_bucket(ptKeyTable, ptBuckets, i);
+        if (ptBucket->uiHash <= KR_KEY_TOMBSTONE) continue;
+        void *key = ptBucket->key;
+        if (ptBucket->uiOutline || ptKeyTable->eKeyType == KR_TYPE_POINTER) {
+            key = *(void **)ptBucket->key;
+        }
+        func(key, ptBucket->value, data);
+    }
+}
+
+
+/* visit uiCount buckets from *puiCursor on, which is moved past them,
+ * so a table is gone through a few keys at a time between inserts,
+ * func is given keys as kr_keytable_foreach and may remove the key
+ */
+void kr_keytable_sweep(T_KRKeyTable *ptKeyTable, unsigned int *puiCursor,
+        unsigned int uiCount, KRHFunc func, void *data)
+{
+    T_KRKeyBuckets *ptBuckets = ptKeyTable->ptBuckets;
+    unsigned int uiCursor = *puiCursor;
+    for (unsigned int n=0; n<uiCount && n<=ptBuckets->uiMask; n++) {
+        unsigned int i = uiCursor++ & ptBuckets->uiMask;
+        T_KRKeyBucket *ptBucket = kr_keytable_bucket(ptKeyTable, ptBuckets, i);
+        if (ptBucket->uiHash <= KR_KEY_TOMBSTONE) continue;
+        void *key = ptBucket->key;
+        if (ptBucket->uiOutline || ptKeyTable->eKeyType == KR_TYPE_POINTER) {
+            key = *(void **)ptBucket->key;
+        }
+        func(key, ptBucket->value, data);
+    }
+    *puiCursor = uiCursor;
+}
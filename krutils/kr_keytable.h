@@ -0,0 +1,32 @@
+#ifndef __KR_KEYTABLE_H__
+#define __KR_KEYTABLE_H__
+
+#include "kr_types.h"
+#include "kr_hashtable.h"
+
+/*string keys shorter than this are kept in buckets by default*/
+#define KR_KEYTABLE_STR_INLINE  32
+
+/* open addressing table of one type of keys, copied into its buckets:
+ * int, long, double and pointer keys in 8 bytes, strings shorter than
+ * the inline size given, longer ones copied out of line,
+ * one writer, lookups may run along with it once kr_keytable_set_retire
+ * is called, see kr_hashtable_set_retire
+ */
+typedef struct _kr_keytable_t  T_KRKeyTable;
+
+T_KRKeyTable *kr_keytable_new(E_KRType eKeyType, size_t uiStrInline);
+void kr_keytable_destroy(T_KRKeyTable *ptKeyTable);
+void kr_keytable_set_retire(T_KRKeyTable *ptKeyTable,
+        KRRetireFunc pfRetire, void *pRetireData);
+
+void *kr_keytable_lookup(T_KRKeyTable *ptKeyTable, const void *key);
+int kr_keytable_insert(T_KRKeyTable *ptKeyTable, const void *key, void *value);
+void *kr_keytable_remove(T_KRKeyTable *ptKeyTable, const void *key);
+unsigned int kr_keytable_size(T_KRKeyTable *ptKeyTable);
+size_t kr_keytable_bytes(T_KRKeyTable *ptKeyTable);
+void kr_keytable_foreach(T_KRKeyTable *ptKeyTable, KRHFunc func, void *data);
+void kr_keytable_sweep(T_KRKeyTable *ptKeyTable, unsigned int *puiCursor,
+        unsigned int uiCount, KRHFunc func, void *data);
+
+#endif /* __KR_KEYTABLE_H__ */
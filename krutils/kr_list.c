@@ -24,10 +24,22 @@ T_KRList *kr_list_new(void)
     return list;
 }
 
-/* Free the whole list.
+/* Initialize a list embedded in another structure, to be emptied
+ * with kr_list_clear() instead of freed. */
+void kr_list_init(T_KRList *list)
+{
+    list->head = list->tail = NULL;
+    list->len = 0;
+    list->dup = NULL;
+    list->free = NULL;
+    list->match = NULL;
+    list->compare = NULL;
+}
+
+/* Free all the nodes, the list itself is kept empty.
  *
  * This function can't fail. */
-void kr_list_destroy(T_KRList *list)
+void kr_list_clear(T_KRList *list)
 {
     unsigned int len;
     T_KRListNode *current, *next;
@@ -40,6 +52,16 @@ void kr_list_destroy(T_KRList *list)
         kr_free(current);
         current = next;
     }
+    list->head = list->tail = NULL;
+    list->len = 0;
+}
+
+/* Free the whole list.
+ *
+ * This function can't fail. */
+void kr_list_destroy(T_KRList *list)
+{
+    kr_list_clear(list);
     kr_free(list);
 }
 
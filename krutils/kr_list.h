@@ -45,6 +45,8 @@ typedef struct _kr_list_t
 
 /* Prototypes */
 T_KRList *kr_list_new(void);
+void kr_list_init(T_KRList *list);
+void kr_list_clear(T_KRList *list);
 void kr_list_destroy(T_KRList *list);
 T_KRList *kr_list_add_head(T_KRList *list, void *value);
 T_KRList *kr_list_add_tail(T_KRList *list, void *value);
@@ -0,0 +1,46 @@
+#ifndef __KR_SEQLOCK_H__
+#define __KR_SEQLOCK_H__
+
+#include <sched.h>
+
+/* sequence lock, odd while written:
+ * writers take it in turn, readers never block them, 
+ * they copy what they need and retry if a writer came meanwhile,
+ * memory they read must not be freed under them, see kr_epoch.h
+ */
+typedef volatile unsigned int T_KRSeqLock;
+
+static inline unsigned int kr_seq_read_begin(T_KRSeqLock *seq)
+{
+    unsigned int s;
+    while ((s = *seq) & 1) {
+        sched_yield();
+    }
+    __sync_synchronize();
+    return s;
+}
+
+static inline int kr_seq_read_retry(T_KRSeqLock *seq, unsigned int s)
+{
+    __sync_synchronize();
+    return *seq != s;
+}
+
+static inline void kr_seq_write_lock(T_KRSeqLock *seq)
+{
+    for (;;) {
+        unsigned int s = *seq;
+        if (!(s & 1) && __sync_bool_compare_and_swap(seq, s, s+1)) {
+            break;
+        }
+        sched_yield();
+    }
+}
+
+static inline void kr_seq_write_unlock(T_KRSeqLock *seq)
+{
+    __sync_synchronize();
+    (*seq)++;
+}
+
+#endif /* __KR_SEQLOCK_H__ */
@@ -0,0 +1,102 @@
+#include "kr_sequence.h"
+#include "kr_alloc.h"
+#include <string.h>
+
+
+T_KRSequence *kr_sequence_new(int steps)
+{
+    if (steps <= 0 || steps > KR_SEQUENCE_STEPS_MAX) return NULL;
+
+    T_KRSequence *krseq = kr_calloc(sizeof(T_KRSequence) + \
+            sizeof(T_KRSeqRun) * steps);
+    if (krseq == NULL) {
+        return NULL;
+    }
+    krseq->steps = steps;
+    kr_sequence_reset(krseq);
+
+    return krseq;
+}
+
+
+void kr_sequence_free(T_KRSequence *krseq)
+{
+    if (krseq) {
+        kr_free(krseq);
+    }
+}
+
+
+void kr_sequence_reset(T_KRSequence *krseq)
+{
+    krseq->live = 0;
+    memset(krseq->runs, 0x00, sizeof(T_KRSeqRun) * krseq->steps);
+}
+
+
+static inline int kr_sequence_expired(T_KRSeqRun *run,
+        T_KRSeqPattern *pattern, time_t t)
+{
+    return (t - run->start) > pattern->window;
+}
+
+
+/* move run into state i, unless a later started one is there */
+static inline void kr_sequence_enter(T_KRSequence *krseq, int i,
+        time_t start, time_t last)
+{
+    T_KRSeqRun *run = &krseq->runs[i];
+    if ((krseq->live & (1U << i)) && run->start > start) return;
+
+    run->start = start;
+    run->last = last;
+    krseq->live |= (1U << i);
+}
+
+
+/* feed an event matching the steps in mask at time t,
+ * states are walked from the last so an event advances a run once,
+ * a late event never advances a run past a later step
+ */
+void kr_sequence_advance(T_KRSequence *krseq, T_KRSeqPattern *pattern,
+        unsigned int mask, time_t t)
+{
+    int steps = krseq->steps;
+
+    for (int i = steps - 2; i >= 0; i--) {
+        if (!(krseq->live & (1U << i))) continue;
+
+        T_KRSeqRun *run = &krseq->runs[i];
+        if (kr_sequence_expired(run, pattern, t)) {
+            krseq->live &= ~(1U << i);
+            continue;
+        }
+        if (!(mask & (1U << (i+1))) || t < run->last) continue;
+        if (pattern->gap[i+1] > 0 && (t - run->last) > pattern->gap[i+1]) {
+            continue;
+        }
+
+        kr_sequence_enter(krseq, i+1, run->start, t);
+        krseq->live &= ~(1U << i);
+    }
+
+    if (mask & 1U) {
+        kr_sequence_enter(krseq, 0, t, t);
+    }
+}
+
+
+/* steps matched by the most advanced run alive at t,
+ * a complete match counts until its window passed
+ */
+int kr_sequence_progress(T_KRSequence *krseq, T_KRSeqPattern *pattern,
+        time_t t)
+{
+    for (int i = krseq->steps - 1; i >= 0; i--) {
+        if (!(krseq->live & (1U << i))) continue;
+        if (!kr_sequence_expired(&krseq->runs[i], pattern, t)) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+#ifndef __KR_SEQUENCE_H__
+#define __KR_SEQUENCE_H__
+
+#include <time.h>
+
+#define KR_SEQUENCE_STEPS_MAX  32
+
+/* ordered steps to be matched one after another,
+ * step i of an event is bit i of the mask passed in
+ */
+typedef struct _kr_seq_pattern_t
+{
+    int             steps;
+    long            window;      /* seconds from the first step to the last */
+    long            gap[KR_SEQUENCE_STEPS_MAX]; /* seconds since previous
+                                                   step, 0 if unbounded */
+}T_KRSeqPattern;
+
+typedef struct _kr_seq_run_t
+{
+    time_t          start;       /* time of its first step */
+    time_t          last;        /* time of its latest step */
+}T_KRSeqRun;
+
+/* NFA of a pattern, with skip-till-next-match semantics:
+ * runs[i] is the partial match with i+1 steps matched,
+ * of runs in one state only the latest started is kept,
+ * it expires no earlier than any other, so at most steps runs live
+ */
+typedef struct _kr_sequence_t
+{
+    int             steps;
+    unsigned int    live;        /* bit i set if runs[i] exists */
+    T_KRSeqRun      runs[];
+}T_KRSequence;
+
+
+T_KRSequence *kr_sequence_new(int steps);
+void kr_sequence_free(T_KRSequence *krseq);
+void kr_sequence_reset(T_KRSequence *krseq);
+
+void kr_sequence_advance(T_KRSequence *krseq, T_KRSeqPattern *pattern,
+        unsigned int mask, time_t t);
+int kr_sequence_progress(T_KRSequence *krseq, T_KRSeqPattern *pattern,
+        time_t t);
+
+#endif /* __KR_SEQUENCE_H__ */
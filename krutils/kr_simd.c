@@ -0,0 +1,540 @@
+#include "kr_simd.h"
+#include "kr_macros.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define KR_SIMD_X86  1
+#endif
+
+typedef long (*KRSimdCountFunc)(size_t n, const T_KRSimdSel *ptSel);
+typedef long (*KRSimdIntFunc)(const int *piValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc);
+typedef long (*KRSimdLongFunc)(const long *plValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc);
+typedef long (*KRSimdDoubleFunc)(const double *pdValue, size_t n,
+        const T_KRSimdSel *ptSel, double *pdAcc);
+
+typedef struct _kr_simd_kernels_t
+{
+    E_KRSimdLevel       eLevel;
+    KRSimdCountFunc     pfCount;
+    KRSimdIntFunc       pfSumInt;
+    KRSimdIntFunc       pfMinInt;
+    KRSimdIntFunc       pfMaxInt;
+    KRSimdLongFunc      pfSumLong;
+    KRSimdLongFunc      pfMinLong;
+    KRSimdLongFunc      pfMaxLong;
+    KRSimdDoubleFunc    pfSumDouble;
+    KRSimdDoubleFunc    pfMinDouble;
+    KRSimdDoubleFunc    pfMaxDouble;
+}T_KRSimdKernels;
+
+
+static inline int kr_simd_selected(const T_KRSimdSel *ptSel, size_t i)
+{
+    time_t tTime = ptSel->ptTime[i];
+    if (tTime < ptSel->tBegin || tTime > ptSel->tEnd) return 0;
+    return ptSel->puiMask == NULL || ((ptSel->puiMask[i>>6] >> (i&63)) & 1);
+}
+
+
+/* the plain loops, also the tails of vector kernels,
+ * step folds value v into acc
+ */
+static long kr_scalar_count(size_t n, const T_KRSimdSel *ptSel)
+{
+    long lCnt = 0;
+    for (size_t i=0; i<n; i++) {
+        lCnt += kr_simd_selected(ptSel, i);
+    }
+    return lCnt;
+}
+
+#define KR_SCALAR_KERNEL(name, T, A, step) \
+static long name(const T *pValue, size_t n, \
+        const T_KRSimdSel *ptSel, A *pAcc) \
+{ \
+    A acc = *pAcc; \
+    long lCnt = 0; \
+    for (size_t i=0; i<n; i++) { \
+        if (!kr_simd_selected(ptSel, i)) continue; \
+        A v = pValue[i]; \
+        step; \
+        lCnt++; \
+    } \
+    *pAcc = acc; \
+    return lCnt; \
+}
+
+KR_SCALAR_KERNEL(kr_scalar_sum_int, int, long, acc += v)
+KR_SCALAR_KERNEL(kr_scalar_min_int, int, long, acc = MIN(acc, v))
+KR_SCALAR_KERNEL(kr_scalar_max_int, int, long, acc = MAX(acc, v))
+KR_SCALAR_KERNEL(kr_scalar_sum_long, long, long, acc += v)
+KR_SCALAR_KERNEL(kr_scalar_min_long, long, long, acc = MIN(acc, v))
+KR_SCALAR_KERNEL(kr_scalar_max_long, long, long, acc = MAX(acc, v))
+KR_SCALAR_KERNEL(kr_scalar_sum_double, double, double, acc += v)
+KR_SCALAR_KERNEL(kr_scalar_min_double, double, double, acc = MIN(acc, v))
+KR_SCALAR_KERNEL(kr_scalar_max_double, double, double, acc = MAX(acc, v))
+
+static const T_KRSimdKernels gstScalarKernels = {
+    KR_SIMD_SCALAR, kr_scalar_count,
+    kr_scalar_sum_int, kr_scalar_min_int, kr_scalar_max_int,
+    kr_scalar_sum_long, kr_scalar_min_long, kr_scalar_max_long,
+    kr_scalar_sum_double, kr_scalar_min_double, kr_scalar_max_double
+};
+
+
+#ifdef KR_SIMD_X86
+
+/* two values a step, every lane 64 bits wide as time_t is,
+ * int values sign extended to long on load
+ */
+/*SSE2 has no 64 bits compare, signed high half then unsigned low half*/
+static inline __m128i kr_sse2_cmpgt_epi64(__m128i a, __m128i b)
+{
+    const __m128i vLowSign = _mm_set_epi32(0, (int )0x80000000, 0, (int )0x80000000);
+    a = _mm_xor_si128(a, vLowSign);
+    b = _mm_xor_si128(b, vLowSign);
+    __m128i vGt = _mm_cmpgt_epi32(a, b);
+    __m128i vEq = _mm_cmpeq_epi32(a, b);
+    __m128i vLowGt = _mm_shuffle_epi32(vGt, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128i vHighGt = _mm_shuffle_epi32(vGt, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128i vHighEq = _mm_shuffle_epi32(vEq, _MM_SHUFFLE(3, 3, 1, 1));
+    return _mm_or_si128(vHighGt, _mm_and_si128(vHighEq, vLowGt));
+}
+
+static inline __m128i kr_sse2_blend(__m128i a, __m128i b, __m128i vMask)
+{
+    return _mm_or_si128(_mm_and_si128(vMask, b), _mm_andnot_si128(vMask, a));
+}
+
+/*all ones in the lanes of values i and i+1 selected*/
+static inline __m128i kr_sse2_select(const T_KRSimdSel *ptSel, size_t i,
+        __m128i vBegin, __m128i vEnd)
+{
+    __m128i vTime = _mm_loadu_si128((const __m128i *)(ptSel->ptTime+i));
+    __m128i vOut = _mm_or_si128(kr_sse2_cmpgt_epi64(vBegin, vTime),
+            kr_sse2_cmpgt_epi64(vTime, vEnd));
+    __m128i vIn = _mm_set1_epi32(-1);
+    if (ptSel->puiMask != NULL) {
+        /*bit compared per half, a lane is in if both halves match*/
+        const __m128i vBit = _mm_set_epi64x(2, 1);
+        long long llBits = (long long )((ptSel->puiMask[i>>6] >> (i&63)) & 0x3);
+        vIn = _mm_cmpeq_epi32(
+                _mm_and_si128(_mm_set1_epi64x(llBits), vBit), vBit);
+        vIn = _mm_and_si128(vIn, _mm_shuffle_epi32(vIn, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+    return _mm_andnot_si128(vOut, vIn);
+}
+
+static inline __m128i kr_sse2_load_long(const long *p)
+{
+    return _mm_loadu_si128((const __m128i *)p);
+}
+
+static inline __m128i kr_sse2_load_int(const int *p)
+{
+    __m128i x = _mm_loadl_epi64((const __m128i *)p);
+    return _mm_unpacklo_epi32(x, _mm_srai_epi32(x, 31));
+}
+
+static long kr_sse2_count(size_t n, const T_KRSimdSel *ptSel)
+{
+    __m128i vBegin = _mm_set1_epi64x(ptSel->tBegin);
+    __m128i vEnd = _mm_set1_epi64x(ptSel->tEnd);
+    __m128i vCnt = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i+2<=n; i+=2) {
+        vCnt = _mm_sub_epi64(vCnt, kr_sse2_select(ptSel, i, vBegin, vEnd));
+    }
+    long long llCnt[2];
+    _mm_storeu_si128((__m128i *)llCnt, vCnt);
+    long lCnt = llCnt[0] + llCnt[1];
+    for (; i<n; i++) {
+        lCnt += kr_simd_selected(ptSel, i);
+    }
+    return lCnt;
+}
+
+/*vstep folds vVal's lanes in vSel into vAcc, step folds one v into acc*/
+#define KR_SSE2_LONG_KERNEL(name, T, load, vinit, vstep, step) \
+static long name(const T *pValue, size_t n, \
+        const T_KRSimdSel *ptSel, long *pAcc) \
+{ \
+    long acc = *pAcc; \
+    __m128i vBegin = _mm_set1_epi64x(ptSel->tBegin); \
+    __m128i vEnd = _mm_set1_epi64x(ptSel->tEnd); \
+    __m128i vAcc = vinit; \
+    __m128i vCnt = _mm_setzero_si128(); \
+    size_t i = 0; \
+    for (; i+2<=n; i+=2) { \
+        __m128i vSel = kr_sse2_select(ptSel, i, vBegin, vEnd); \
+        __m128i vVal = load(pValue+i); \
+        vstep; \
+        vCnt = _mm_sub_epi64(vCnt, vSel); \
+    } \
+    long long llLane[2], llCnt[2]; \
+    _mm_storeu_si128((__m128i *)llLane, vAcc); \
+    _mm_storeu_si128((__m128i *)llCnt, vCnt); \
+    long lCnt = llCnt[0] + llCnt[1]; \
+    for (int j=0; j<2; j++) { \
+        long v = llLane[j]; \
+        step; \
+    } \
+    for (; i<n; i++) { \
+        if (!kr_simd_selected(ptSel, i)) continue; \
+        long v = pValue[i]; \
+        step; \
+        lCnt++; \
+    } \
+    *pAcc = acc; \
+    return lCnt; \
+}
+
+#define KR_SSE2_DOUBLE_KERNEL(name, vinit, vstep, step) \
+static long name(const double *pValue, size_t n, \
+        const T_KRSimdSel *ptSel, double *pAcc) \
+{ \
+    double acc = *pAcc; \
+    __m128i vBegin = _mm_set1_epi64x(ptSel->tBegin); \
+    __m128i vEnd = _mm_set1_epi64x(ptSel->tEnd); \
+    __m128d vAcc = vinit; \
+    __m128i vCnt = _mm_setzero_si128(); \
+    size_t i = 0; \
+    for (; i+2<=n; i+=2) { \
+        __m128i vSel = kr_sse2_select(ptSel, i, vBegin, vEnd); \
+        __m128d vSelD = _mm_castsi128_pd(vSel); \
+        __m128d vVal = _mm_loadu_pd(pValue+i); \
+        vstep; \
+        vCnt = _mm_sub_epi64(vCnt, vSel); \
+    } \
+    double dLane[2]; \
+    long long llCnt[2]; \
+    _mm_storeu_pd(dLane, vAcc); \
+    _mm_storeu_si128((__m128i *)llCnt, vCnt); \
+    long lCnt = llCnt[0] + llCnt[1]; \
+    for (int j=0; j<2; j++) { \
+        double v = dLane[j]; \
+        step; \
+    } \
+    for (; i<n; i++) { \
+        if (!kr_simd_selected(ptSel, i)) continue; \
+        double v = pValue[i]; \
+        step; \
+        lCnt++; \
+    } \
+    *pAcc = acc; \
+    return lCnt; \
+}
+
+#define KR_SSE2_SUM  vAcc = _mm_add_epi64(vAcc, _mm_and_si128(vVal, vSel))
+#define KR_SSE2_MIN  vAcc = kr_sse2_blend(vAcc, vVal, \
+        _mm_and_si128(vSel, kr_sse2_cmpgt_epi64(vAcc, vVal)))
+#define KR_SSE2_MAX  vAcc = kr_sse2_blend(vAcc, vVal, \
+        _mm_and_si128(vSel, kr_sse2_cmpgt_epi64(vVal, vAcc)))
+
+KR_SSE2_LONG_KERNEL(kr_sse2_sum_int, int, kr_sse2_load_int,
+        _mm_setzero_si128(), KR_SSE2_SUM, acc += v)
+KR_SSE2_LONG_KERNEL(kr_sse2_min_int, int, kr_sse2_load_int,
+        _mm_set1_epi64x(acc), KR_SSE2_MIN, acc = MIN(acc, v))
+KR_SSE2_LONG_KERNEL(kr_sse2_max_int, int, kr_sse2_load_int,
+        _mm_set1_epi64x(acc), KR_SSE2_MAX, acc = MAX(acc, v))
+KR_SSE2_LONG_KERNEL(kr_sse2_sum_long, long, kr_sse2_load_long,
+        _mm_setzero_si128(), KR_SSE2_SUM, acc += v)
+KR_SSE2_LONG_KERNEL(kr_sse2_min_long, long, kr_sse2_load_long,
+        _mm_set1_epi64x(acc), KR_SSE2_MIN, acc = MIN(acc, v))
+KR_SSE2_LONG_KERNEL(kr_sse2_max_long, long, kr_sse2_load_long,
+        _mm_set1_epi64x(acc), KR_SSE2_MAX, acc = MAX(acc, v))
+
+KR_SSE2_DOUBLE_KERNEL(kr_sse2_sum_double, _mm_setzero_pd(),
+        vAcc = _mm_add_pd(vAcc, _mm_and_pd(vVal, vSelD)), acc += v)
+KR_SSE2_DOUBLE_KERNEL(kr_sse2_min_double, _mm_set1_pd(acc),
+        __m128d vLt = _mm_and_pd(vSelD, _mm_cmplt_pd(vVal, vAcc));
+        vAcc = _mm_or_pd(_mm_and_pd(vLt, vVal), _mm_andnot_pd(vLt, vAcc)),
+        acc = MIN(acc, v))
+KR_SSE2_DOUBLE_KERNEL(kr_sse2_max_double, _mm_set1_pd(acc),
+        __m128d vGt = _mm_and_pd(vSelD, _mm_cmpgt_pd(vVal, vAcc));
+        vAcc = _mm_or_pd(_mm_and_pd(vGt, vVal), _mm_andnot_pd(vGt, vAcc)),
+        acc = MAX(acc, v))
+
+static const T_KRSimdKernels gstSSE2Kernels = {
+    KR_SIMD_SSE2, kr_sse2_count,
+    kr_sse2_sum_int, kr_sse2_min_int, kr_sse2_max_int,
+    kr_sse2_sum_long, kr_sse2_min_long, kr_sse2_max_long,
+    kr_sse2_sum_double, kr_sse2_min_double, kr_sse2_max_double
+};
+
+
+/* four values a step, built for AVX2 whatever the compiler flags,
+ * only called if the cpu has it
+ */
+#define KR_AVX2  __attribute__((target("avx2")))
+
+KR_AVX2
+static inline __m256i kr_avx2_select(const T_KRSimdSel *ptSel, size_t i,
+        __m256i vBegin, __m256i vEnd)
+{
+    __m256i vTime = _mm256_loadu_si256((const __m256i *)(ptSel->ptTime+i));
+    __m256i vOut = _mm256_or_si256(_mm256_cmpgt_epi64(vBegin, vTime),
+            _mm256_cmpgt_epi64(vTime, vEnd));
+    __m256i vIn = _mm256_set1_epi64x(-1);
+    if (ptSel->puiMask != NULL) {
+        /*i is a multiple of 4, its bits are in one word*/
+        const __m256i vBit = _mm256_set_epi64x(8, 4, 2, 1);
+        long long llBits = (long long )((ptSel->puiMask[i>>6] >> (i&63)) & 0xF);
+        vIn = _mm256_cmpeq_epi64(
+                _mm256_and_si256(_mm256_set1_epi64x(llBits), vBit), vBit);
+    }
+    return _mm256_andnot_si256(vOut, vIn);
+}
+
+KR_AVX2
+static inline __m256i kr_avx2_load_long(const long *p)
+{
+    return _mm256_loadu_si256((const __m256i *)p);
+}
+
+KR_AVX2
+static inline __m256i kr_avx2_load_int(const int *p)
+{
+    return _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)p));
+}
+
+KR_AVX2
+static long kr_avx2_count(size_t n, const T_KRSimdSel *ptSel)
+{
+    __m256i vBegin = _mm256_set1_epi64x(ptSel->tBegin);
+    __m256i vEnd = _mm256_set1_epi64x(ptSel->tEnd);
+    __m256i vCnt = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i+4<=n; i+=4) {
+        vCnt = _mm256_sub_epi64(vCnt, kr_avx2_select(ptSel, i, vBegin, vEnd));
+    }
+    long long llCnt[4];
+    _mm256_storeu_si256((__m256i *)llCnt, vCnt);
+    long lCnt = llCnt[0] + llCnt[1] + llCnt[2] + llCnt[3];
+    for (; i<n; i++) {
+        lCnt += kr_simd_selected(ptSel, i);
+    }
+    return lCnt;
+}
+
+#define KR_AVX2_LONG_KERNEL(name, T, load, vinit, vstep, step) \
+KR_AVX2 \
+static long name(const T *pValue, size_t n, \
+        const T_KRSimdSel *ptSel, long *pAcc) \
+{ \
+    long acc = *pAcc; \
+    __m256i vBegin = _mm256_set1_epi64x(ptSel->tBegin); \
+    __m256i vEnd = _mm256_set1_epi64x(ptSel->tEnd); \
+    __m256i vAcc = vinit; \
+    __m256i vCnt = _mm256_setzero_si256(); \
+    size_t i = 0; \
+    for (; i+4<=n; i+=4) { \
+        __m256i vSel = kr_avx2_select(ptSel, i, vBegin, vEnd); \
+        __m256i vVal = load(pValue+i); \
+        vstep; \
+        vCnt = _mm256_sub_epi64(vCnt, vSel); \
+    } \
+    long long llLane[4], llCnt[4]; \
+    _mm256_storeu_si256((__m256i *)llLane, vAcc); \
+    _mm256_storeu_si256((__m256i *)llCnt, vCnt); \
+    long lCnt = llCnt[0] + llCnt[1] + llCnt[2] + llCnt[3]; \
+    for (int j=0; j<4; j++) { \
+        long v = llLane[j]; \
+        step; \
+    } \
+    for (; i<n; i++) { \
+        if (!kr_simd_selected(ptSel, i)) continue; \
+        long v = pValue[i]; \
+        step; \
+        lCnt++; \
+    } \
+    *pAcc = acc; \
+    return lCnt; \
+}
+
+#define KR_AVX2_DOUBLE_KERNEL(name, vinit, vstep, step) \
+KR_AVX2 \
+static long name(const double *pValue, size_t n, \
+        const T_KRSimdSel *ptSel, double *pAcc) \
+{ \
+    double acc = *pAcc; \
+    __m256i vBegin = _mm256_set1_epi64x(ptSel->tBegin); \
+    __m256i vEnd = _mm256_set1_epi64x(ptSel->tEnd); \
+    __m256d vAcc = vinit; \
+    __m256i vCnt = _mm256_setzero_si256(); \
+    size_t i = 0; \
+    for (; i+4<=n; i+=4) { \
+        __m256i vSel = kr_avx2_select(ptSel, i, vBegin, vEnd); \
+        __m256d vSelD = _mm256_castsi256_pd(vSel); \
+        __m256d vVal = _mm256_loadu_pd(pValue+i); \
+        vstep; \
+        vCnt = _mm256_sub_epi64(vCnt, vSel); \
+    } \
+    double dLane[4]; \
+    long long llCnt[4]; \
+    _mm256_storeu_pd(dLane, vAcc); \
+    _mm256_storeu_si256((__m256i *)llCnt, vCnt); \
+    long lCnt = llCnt[0] + llCnt[1] + llCnt[2] + llCnt[3]; \
+    for (int j=0; j<4; j++) { \
+        double v = dLane[j]; \
+        step; \
+    } \
+    for (; i<n; i++) { \
+        if (!kr_simd_selected(ptSel, i)) continue; \
+        double v = pValue[i]; \
+        step; \
+        lCnt++; \
+    } \
+    *pAcc = acc; \
+    return lCnt; \
+}
+
+#define KR_AVX2_SUM  vAcc = _mm256_add_epi64(vAcc, _mm256_and_si256(vVal, vSel))
+#define KR_AVX2_MIN  vAcc = _mm256_blendv_epi8(vAcc, vVal, \
+        _mm256_and_si256(vSel, _mm256_cmpgt_epi64(vAcc, vVal)))
+#define KR_AVX2_MAX  vAcc = _mm256_blendv_epi8(vAcc, vVal, \
+        _mm256_and_si256(vSel, _mm256_cmpgt_epi64(vVal, vAcc)))
+
+KR_AVX2_LONG_KERNEL(kr_avx2_sum_int, int, kr_avx2_load_int,
+        _mm256_setzero_si256(), KR_AVX2_SUM, acc += v)
+KR_AVX2_LONG_KERNEL(kr_avx2_min_int, int, kr_avx2_load_int,
+        _mm256_set1_epi64x(acc), KR_AVX2_MIN, acc = MIN(acc, v))
+KR_AVX2_LONG_KERNEL(kr_avx2_max_int, int, kr_avx2_load_int,
+        _mm256_set1_epi64x(acc), KR_AVX2_MAX, acc = MAX(acc, v))
+KR_AVX2_LONG_KERNEL(kr_avx2_sum_long, long, kr_avx2_load_long,
+        _mm256_setzero_si256(), KR_AVX2_SUM, acc += v)
+KR_AVX2_LONG_KERNEL(kr_avx2_min_long, long, kr_avx2_load_long,
+        _mm256_set1_epi64x(acc), KR_AVX2_MIN, acc = MIN(acc, v))
+KR_AVX2_LONG_KERNEL(kr_avx2_max_long, long, kr_avx2_load_long,
+        _mm256_set1_epi64x(acc), KR_AVX2_MAX, acc = MAX(acc, v))
+
+KR_AVX2_DOUBLE_KERNEL(kr_avx2_sum_double, _mm256_setzero_pd(),
+        vAcc = _mm256_add_pd(vAcc, _mm256_and_pd(vVal, vSelD)), acc += v)
+KR_AVX2_DOUBLE_KERNEL(kr_avx2_min_double, _mm256_set1_pd(acc),
+        vAcc = _mm256_blendv_pd(vAcc, vVal, _mm256_and_pd(vSelD,
+                _mm256_cmp_pd(vVal, vAcc, _CMP_LT_OQ))),
+        acc = MIN(acc, v))
+KR_AVX2_DOUBLE_KERNEL(kr_avx2_max_double, _mm256_set1_pd(acc),
+        vAcc = _mm256_blendv_pd(vAcc, vVal, _mm256_and_pd(vSelD,
+                _mm256_cmp_pd(vVal, vAcc, _CMP_GT_OQ))),
+        acc = MAX(acc, v))
+
+static const T_KRSimdKernels gstAVX2Kernels = {
+    KR_SIMD_AVX2, kr_avx2_count,
+    kr_avx2_sum_int, kr_avx2_min_int, kr_avx2_max_int,
+    kr_avx2_sum_long, kr_avx2_min_long, kr_avx2_max_long,
+    kr_avx2_sum_double, kr_avx2_min_double, kr_avx2_max_double
+};
+
+#endif /* KR_SIMD_X86 */
+
+
+/*set once by the first call, same for every thread racing on it*/
+static const T_KRSimdKernels *gptKernels = NULL;
+
+E_KRSimdLevel kr_simd_set_level(E_KRSimdLevel eLevel)
+{
+    const T_KRSimdKernels *ptKernels = &gstScalarKernels;
+#ifdef KR_SIMD_X86
+    __builtin_cpu_init();
+    if (eLevel >= KR_SIMD_AVX2 && __builtin_cpu_supports("avx2")) {
+        ptKernels = &gstAVX2Kernels;
+    } else if (eLevel >= KR_SIMD_SSE2) {
+        /*every x86_64 cpu has it*/
+        ptKernels = &gstSSE2Kernels;
+    }
+#endif
+    gptKernels = ptKernels;
+    return ptKernels->eLevel;
+}
+
+
+static inline const T_KRSimdKernels *kr_simd_kernels(void)
+{
+    if (gptKernels == NULL) {
+        kr_simd_set_level(KR_SIMD_AVX2);
+    }
+    return gptKernels;
+}
+
+
+E_KRSimdLevel kr_simd_get_level(void)
+{
+    return kr_simd_kernels()->eLevel;
+}
+
+
+const char *kr_simd_level_name(E_KRSimdLevel eLevel)
+{
+    switch(eLevel)
+    {
+        case KR_SIMD_AVX2:
+            return "avx2";
+        case KR_SIMD_SSE2:
+            return "sse2";
+        default:
+            return "scalar";
+    }
+}
+
+
+long kr_simd_count(size_t n, const T_KRSimdSel *ptSel)
+{
+    return kr_simd_kernels()->pfCount(n, ptSel);
+}
+
+long kr_simd_sum_int(const int *piValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc)
+{
+    return kr_simd_kernels()->pfSumInt(piValue, n, ptSel, plAcc);
+}
+
+long kr_simd_min_int(const int *piValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc)
+{
+    return kr_simd_kernels()->pfMinInt(piValue, n, ptSel, plAcc);
+}
+
+long kr_simd_max_int(const int *piValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc)
+{
+    return kr_simd_kernels()->pfMaxInt(piValue, n, ptSel, plAcc);
+}
+
+long kr_simd_sum_long(const long *plValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc)
+{
+    return kr_simd_kernels()->pfSumLong(plValue, n, ptSel, plAcc);
+}
+
+long kr_simd_min_long(const long *plValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc)
+{
+    return kr_simd_kernels()->pfMinLong(plValue, n, ptSel, plAcc);
+}
+
+long kr_simd_max_long(const long *plValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc)
+{
+    return kr_simd_kernels()->pfMaxLong(plValue, n, ptSel, plAcc);
+}
+
+long kr_simd_sum_double(const double *pdValue, size_t n,
+        const T_KRSimdSel *ptSel, double *pdAcc)
+{
+    return kr_simd_kernels()->pfSumDouble(pdValue, n, ptSel, pdAcc);
+}
+
+long kr_simd_min_double(const double *pdValue, size_t n,
+        const T_KRSimdSel *ptSel, double *pdAcc)
+{
+    return kr_simd_kernels()->pfMinDouble(pdValue, n, ptSel, pdAcc);
+}
+
+long kr_simd_max_double(const double *pdValue, size_t n,
+        const T_KRSimdSel *ptSel, double *pdAcc)
+{
+    return kr_simd_kernels()->pfMaxDouble(pdValue, n, ptSel, pdAcc);
+}
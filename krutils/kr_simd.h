@@ -0,0 +1,58 @@
+#ifndef __KR_SIMD_H__
+#define __KR_SIMD_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+/* masked aggregations over packed arrays, value i is selected if
+ * ptTime[i] is in [tBegin, tEnd] and, with puiMask set, bit i%64 of
+ * puiMask[i/64] is on. kernels are picked once by what the cpu runs:
+ * AVX2, SSE2 or plain loops, each returns the count selected and
+ * folds the values into *pAcc, which is its starting value too
+ */
+typedef enum {
+    KR_SIMD_SCALAR = 0,
+    KR_SIMD_SSE2,
+    KR_SIMD_AVX2
+}E_KRSimdLevel;
+
+typedef struct _kr_simd_sel_t
+{
+    const time_t    *ptTime;      /* per value */
+    time_t          tBegin;
+    time_t          tEnd;
+    const uint64_t  *puiMask;     /* per value, NULL selects all */
+}T_KRSimdSel;
+
+/*best level up to eLevel the cpu runs, returned*/
+E_KRSimdLevel kr_simd_set_level(E_KRSimdLevel eLevel);
+E_KRSimdLevel kr_simd_get_level(void);
+const char *kr_simd_level_name(E_KRSimdLevel eLevel);
+
+long kr_simd_count(size_t n, const T_KRSimdSel *ptSel);
+
+/*int values are folded as long*/
+long kr_simd_sum_int(const int *piValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc);
+long kr_simd_min_int(const int *piValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc);
+long kr_simd_max_int(const int *piValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc);
+
+long kr_simd_sum_long(const long *plValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc);
+long kr_simd_min_long(const long *plValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc);
+long kr_simd_max_long(const long *plValue, size_t n,
+        const T_KRSimdSel *ptSel, long *plAcc);
+
+/*sums are added in lanes, rounding may differ from a plain loop*/
+long kr_simd_sum_double(const double *pdValue, size_t n,
+        const T_KRSimdSel *ptSel, double *pdAcc);
+long kr_simd_min_double(const double *pdValue, size_t n,
+        const T_KRSimdSel *ptSel, double *pdAcc);
+long kr_simd_max_double(const double *pdValue, size_t n,
+        const T_KRSimdSel *ptSel, double *pdAcc);
+
+#endif /* __KR_SIMD_H__ */
@@ -0,0 +1,117 @@
+#include "kr_slab.h"
+#include "kr_alloc.h"
+#include <string.h>
+
+#define KR_SLAB_ALIGN  8
+#define KR_SLAB_ROUND(n)  (((n) + KR_SLAB_ALIGN - 1) & ~(size_t)(KR_SLAB_ALIGN - 1))
+/*a slab's link word, objects after it stay 16 bytes aligned*/
+#define KR_SLAB_HEADER  16
+
+
+T_KRSlab *kr_slab_new(size_t size, unsigned int count)
+{
+    T_KRSlab *krslab = kr_calloc(sizeof(T_KRSlab));
+    if (krslab == NULL) {
+        return NULL;
+    }
+    if (size < sizeof(void *)) size = sizeof(void *);
+    krslab->size = KR_SLAB_ROUND(size);
+    krslab->count = count > 0 ? count : 1;
+    pthread_mutex_init(&krslab->lock, NULL);
+
+    return krslab;
+}
+
+
+static void kr_slab_release(T_KRSlab *krslab)
+{
+    void *slab = krslab->slabs;
+    while (slab) {
+        void *next = *(void **)slab;
+        kr_free(slab);
+        slab = next;
+    }
+    pthread_mutex_destroy(&krslab->lock);
+    kr_free(krslab);
+}
+
+
+/* slabs freed now if no object is out,
+ * else by kr_slab_free of the last one
+ */
+void kr_slab_destroy(T_KRSlab *krslab)
+{
+    if (krslab == NULL) return;
+
+    pthread_mutex_lock(&krslab->lock);
+    krslab->destroyed = 1;
+    int done = (krslab->used == 0);
+    pthread_mutex_unlock(&krslab->lock);
+    if (done) kr_slab_release(krslab);
+}
+
+
+/*objects of a new slab onto the free list, with the lock held*/
+static int kr_slab_grow(T_KRSlab *krslab)
+{
+    char *slab = kr_malloc(KR_SLAB_HEADER + krslab->size * krslab->count);
+    if (slab == NULL) {
+        return -1;
+    }
+    *(void **)slab = krslab->slabs;
+    krslab->slabs = slab;
+    krslab->nslabs++;
+
+    char *obj = slab + KR_SLAB_HEADER;
+    for (unsigned int i = 0; i < krslab->count; i++) {
+        *(void **)obj = krslab->free_list;
+        krslab->free_list = obj;
+        obj += krslab->size;
+    }
+    return 0;
+}
+
+
+/*a zeroed object, NULL if out of memory*/
+void *kr_slab_alloc(T_KRSlab *krslab)
+{
+    void *obj = NULL;
+
+    pthread_mutex_lock(&krslab->lock);
+    if (krslab->free_list != NULL || kr_slab_grow(krslab) == 0) {
+        obj = krslab->free_list;
+        krslab->free_list = *(void **)obj;
+        krslab->used++;
+    }
+    pthread_mutex_unlock(&krslab->lock);
+
+    if (obj != NULL) memset(obj, 0x00, krslab->size);
+    return obj;
+}
+
+
+void kr_slab_free(T_KRSlab *krslab, void *ptr)
+{
+    if (ptr == NULL) return;
+
+    pthread_mutex_lock(&krslab->lock);
+    *(void **)ptr = krslab->free_list;
+    krslab->free_list = ptr;
+    krslab->used--;
+    int done = (krslab->destroyed && krslab->used == 0);
+    pthread_mutex_unlock(&krslab->lock);
+    if (done) kr_slab_release(krslab);
+}
+
+
+unsigned long kr_slab_used(T_KRSlab *krslab)
+{
+    return krslab->used;
+}
+
+
+/*memory held by slabs*/
+size_t kr_slab_bytes(T_KRSlab *krslab)
+{
+    return krslab->nslabs * (KR_SLAB_HEADER + krslab->size * krslab->count);
+}
@@ -0,0 +1,34 @@
+#ifndef __KR_SLAB_H__
+#define __KR_SLAB_H__
+
+#include <stddef.h>
+#include <pthread.h>
+
+/* pool of objects of one size carved from slabs of many:
+ * an object freed goes to a free list and is handed out again,
+ * slabs are kept until the pool is destroyed, which waits for
+ * the last object out, so objects may be freed after it,
+ * by any thread
+ */
+typedef struct _kr_slab_t
+{
+    size_t          size;        /* of an object, a pointer at least */
+    unsigned int    count;       /* objects per slab */
+    pthread_mutex_t lock;
+    void           *free_list;   /* linked by their first word */
+    void           *slabs;       /* linked by their first word */
+    unsigned long   nslabs;
+    unsigned long   used;        /* objects out */
+    int             destroyed;   /* freed once none out */
+}T_KRSlab;
+
+
+T_KRSlab *kr_slab_new(size_t size, unsigned int count);
+void kr_slab_destroy(T_KRSlab *krslab);
+
+void *kr_slab_alloc(T_KRSlab *krslab);
+void kr_slab_free(T_KRSlab *krslab, void *ptr);
+unsigned long kr_slab_used(T_KRSlab *krslab);
+size_t kr_slab_bytes(T_KRSlab *krslab);
+
+#endif /* __KR_SLAB_H__ */
@@ -0,0 +1,188 @@
+#include "kr_tdigest.h"
+#include "kr_alloc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* scale function k1 of the t-digest paper,
+ * keeps centroids small near both tails
+ */
+static inline double kr_tdigest_k(double q, double compression)
+{
+    return compression / (2 * M_PI) * asin(2 * q - 1);
+}
+
+static inline double kr_tdigest_q(double k, double compression)
+{
+    if (k >= compression / 4) return 1.0;
+    return (sin(k * 2 * M_PI / compression) + 1) / 2;
+}
+
+
+T_KRTDigest *kr_tdigest_new(double compression)
+{
+    if (compression < 10) compression = 10;
+
+    T_KRTDigest *krtd = kr_calloc(sizeof(T_KRTDigest));
+    if (krtd == NULL) {
+        return NULL;
+    }
+    krtd->compression = compression;
+    krtd->capacity = (int )ceil(compression) + 10;
+    krtd->buffer_size = (int )ceil(compression) * 5;
+    krtd->centroids = kr_calloc(sizeof(T_KRCentroid) * krtd->capacity);
+    krtd->buffer = kr_calloc(sizeof(T_KRCentroid) * krtd->buffer_size);
+    krtd->scratch = kr_calloc(sizeof(T_KRCentroid) * \
+            (krtd->capacity + krtd->buffer_size));
+    if (krtd->centroids == NULL || krtd->buffer == NULL ||
+            krtd->scratch == NULL) {
+        kr_tdigest_free(krtd);
+        return NULL;
+    }
+    kr_tdigest_reset(krtd);
+
+    return krtd;
+}
+
+
+void kr_tdigest_free(T_KRTDigest *krtd)
+{
+    if (krtd) {
+        kr_free(krtd->centroids);
+        kr_free(krtd->buffer);
+        kr_free(krtd->scratch);
+        kr_free(krtd);
+    }
+}
+
+
+void kr_tdigest_reset(T_KRTDigest *krtd)
+{
+    krtd->total = 0;
+    krtd->min = INFINITY;
+    krtd->max = -INFINITY;
+    krtd->merged = 0;
+    krtd->buffered = 0;
+}
+
+
+static int kr_centroid_compare(const void *a, const void *b)
+{
+    double ma = ((const T_KRCentroid *)a)->mean;
+    double mb = ((const T_KRCentroid *)b)->mean;
+    return (ma > mb) - (ma < mb);
+}
+
+/* merge buffered points into centroids */
+static void kr_tdigest_compress(T_KRTDigest *krtd)
+{
+    if (krtd->buffered == 0) return;
+
+    int n = krtd->merged + krtd->buffered;
+    memcpy(krtd->scratch, krtd->centroids,
+            sizeof(T_KRCentroid) * krtd->merged);
+    memcpy(krtd->scratch + krtd->merged, krtd->buffer,
+            sizeof(T_KRCentroid) * krtd->buffered);
+    qsort(krtd->scratch, n, sizeof(T_KRCentroid), kr_centroid_compare);
+
+    double total = krtd->total;
+    double so_far = 0;
+    double limit = total * \
+        kr_tdigest_q(kr_tdigest_k(0, krtd->compression) + 1, krtd->compression);
+    T_KRCentroid cur = krtd->scratch[0];
+    int out = 0;
+
+    for (int i = 1; i < n; i++) {
+        T_KRCentroid *next = &krtd->scratch[i];
+        if ((so_far + cur.weight + next->weight <= limit) ||
+                out == krtd->capacity - 1) {
+            cur.weight += next->weight;
+            cur.mean += (next->mean - cur.mean) * next->weight / cur.weight;
+        } else {
+            so_far += cur.weight;
+            krtd->centroids[out++] = cur;
+            limit = total * kr_tdigest_q(
+                    kr_tdigest_k(so_far / total, krtd->compression) + 1,
+                    krtd->compression);
+            cur = *next;
+        }
+    }
+    krtd->centroids[out++] = cur;
+
+    krtd->merged = out;
+    krtd->buffered = 0;
+}
+
+
+void kr_tdigest_add(T_KRTDigest *krtd, double value, double weight)
+{
+    if (isnan(value) || weight <= 0) return;
+
+    if (krtd->buffered == krtd->buffer_size) {
+        kr_tdigest_compress(krtd);
+    }
+    krtd->buffer[krtd->buffered].mean = value;
+    krtd->buffer[krtd->buffered].weight = weight;
+    krtd->buffered++;
+    krtd->total += weight;
+    if (value < krtd->min) krtd->min = value;
+    if (value > krtd->max) krtd->max = value;
+}
+
+
+/* digests are mergeable, other is left unchanged */
+void kr_tdigest_merge(T_KRTDigest *krtd, T_KRTDigest *other)
+{
+    kr_tdigest_compress(other);
+    for (int i = 0; i < other->merged; i++) {
+        kr_tdigest_add(krtd, other->centroids[i].mean,
+                other->centroids[i].weight);
+    }
+    if (other->min < krtd->min) krtd->min = other->min;
+    if (other->max > krtd->max) krtd->max = other->max;
+}
+
+
+double kr_tdigest_total(T_KRTDigest *krtd)
+{
+    return krtd->total;
+}
+
+
+/* interpolate between centroid centers, NAN if empty */
+double kr_tdigest_quantile(T_KRTDigest *krtd, double q)
+{
+    kr_tdigest_compress(krtd);
+
+    if (krtd->merged == 0) return NAN;
+    if (q <= 0) return krtd->min;
+    if (q >= 1) return krtd->max;
+    if (krtd->merged == 1) return krtd->centroids[0].mean;
+
+    T_KRCentroid *c = krtd->centroids;
+    int n = krtd->merged;
+    double index = q * krtd->total;
+
+    /* tails interpolate to the extremes */
+    if (index < c[0].weight / 2) {
+        return krtd->min + (c[0].mean - krtd->min) *
+            index / (c[0].weight / 2);
+    }
+    if (index > krtd->total - c[n-1].weight / 2) {
+        double rest = krtd->total - index;
+        return krtd->max - (krtd->max - c[n-1].mean) *
+            rest / (c[n-1].weight / 2);
+    }
+
+    double center = c[0].weight / 2;
+    for (int i = 0; i < n - 1; i++) {
+        double gap = (c[i].weight + c[i+1].weight) / 2;
+        if (index <= center + gap) {
+            return c[i].mean + (c[i+1].mean - c[i].mean) *
+                (index - center) / gap;
+        }
+        center += gap;
+    }
+
+    return c[n-1].mean;
+}
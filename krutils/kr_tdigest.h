@@ -0,0 +1,42 @@
+#ifndef __KR_TDIGEST_H__
+#define __KR_TDIGEST_H__
+
+/* merging t-digest for streaming quantiles:
+ * points are buffered and merged into at most about compression
+ * centroids, so memory is fixed once constructed
+ */
+typedef struct _kr_centroid_t
+{
+    double          mean;
+    double          weight;
+}T_KRCentroid;
+
+typedef struct _kr_tdigest_t
+{
+    double          compression;  /* delta, bigger is more accurate */
+    double          total;        /* total weight, buffered included */
+    double          min;
+    double          max;
+
+    int             capacity;     /* max merged centroids */
+    int             merged;       /* merged centroids */
+    T_KRCentroid   *centroids;    /* sorted by mean */
+
+    int             buffer_size;
+    int             buffered;     /* unmerged points */
+    T_KRCentroid   *buffer;
+
+    T_KRCentroid   *scratch;      /* capacity + buffer_size, for merging */
+}T_KRTDigest;
+
+
+T_KRTDigest *kr_tdigest_new(double compression);
+void kr_tdigest_free(T_KRTDigest *krtd);
+void kr_tdigest_reset(T_KRTDigest *krtd);
+
+void kr_tdigest_add(T_KRTDigest *krtd, double value, double weight);
+void kr_tdigest_merge(T_KRTDigest *krtd, T_KRTDigest *other);
+double kr_tdigest_quantile(T_KRTDigest *krtd, double q);
+double kr_tdigest_total(T_KRTDigest *krtd);
+
+#endif /* __KR_TDIGEST_H__ */
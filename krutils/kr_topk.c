@@ -0,0 +1,132 @@
+#include "kr_topk.h"
+#include "kr_alloc.h"
+#include "kr_distinct.h"
+#include <string.h>
+
+T_KRTopK *kr_topk_new(unsigned int capacity)
+{
+    if (capacity == 0) capacity = 1;
+
+    T_KRTopK *krtk = kr_calloc(sizeof(T_KRTopK));
+    if (krtk == NULL) {
+        return NULL;
+    }
+    krtk->capacity = capacity;
+    krtk->items = kr_calloc(sizeof(T_KRTopKItem) * capacity);
+    if (krtk->items == NULL) {
+        kr_free(krtk);
+        return NULL;
+    }
+
+    return krtk;
+}
+
+
+void kr_topk_free(T_KRTopK *krtk)
+{
+    if (krtk) {
+        for (unsigned int i = 0; i < krtk->capacity; i++) {
+            kr_free(krtk->items[i].key);
+        }
+        kr_free(krtk->items);
+        kr_free(krtk);
+    }
+}
+
+
+/* key buffers are kept for reuse */
+void kr_topk_reset(T_KRTopK *krtk)
+{
+    for (unsigned int i = 0; i < krtk->size; i++) {
+        krtk->items[i].count = 0;
+        krtk->items[i].error = 0;
+        krtk->items[i].len = 0;
+    }
+    krtk->size = 0;
+    krtk->total = 0;
+}
+
+
+static T_KRTopKItem *kr_topk_find(T_KRTopK *krtk, uint64_t hash, 
+        const void *key, size_t len)
+{
+    for (unsigned int i = 0; i < krtk->size; i++) {
+        T_KRTopKItem *item = &krtk->items[i];
+        if (item->hash == hash && item->len == len && 
+                memcmp(item->key, key, len) == 0) {
+            return item;
+        }
+    }
+    return NULL;
+}
+
+
+static int kr_topk_set_key(T_KRTopKItem *item, const void *key, size_t len)
+{
+    if (item->cap < len) {
+        char *buf = kr_realloc(item->key, len);
+        if (buf == NULL) return -1;
+        item->key = buf;
+        item->cap = len;
+    }
+    memcpy(item->key, key, len);
+    item->len = len;
+    return 0;
+}
+
+
+void kr_topk_add(T_KRTopK *krtk, const void *key, size_t len)
+{
+    uint64_t hash = kr_distinct_hash(key, len);
+    T_KRTopKItem *item = kr_topk_find(krtk, hash, key, len);
+
+    krtk->total++;
+    if (item != NULL) {
+        item->count++;
+        return;
+    }
+
+    if (krtk->size < krtk->capacity) {
+        item = &krtk->items[krtk->size];
+        if (kr_topk_set_key(item, key, len) != 0) return;
+        item->hash = hash;
+        item->count = 1;
+        item->error = 0;
+        krtk->size++;
+        return;
+    }
+
+    /*replace the least counted*/
+    item = &krtk->items[0];
+    for (unsigned int i = 1; i < krtk->size; i++) {
+        if (krtk->items[i].count < item->count) {
+            item = &krtk->items[i];
+        }
+    }
+    if (kr_topk_set_key(item, key, len) != 0) return;
+    item->hash = hash;
+    item->error = item->count;
+    item->count++;
+}
+
+
+/* the most counted key, NULL if empty */
+T_KRTopKItem *kr_topk_top(T_KRTopK *krtk)
+{
+    T_KRTopKItem *top = NULL;
+    for (unsigned int i = 0; i < krtk->size; i++) {
+        if (top == NULL || krtk->items[i].count > top->count) {
+            top = &krtk->items[i];
+        }
+    }
+    return top;
+}
+
+
+/* estimated count of key, 0 if not counted */
+unsigned long kr_topk_count(T_KRTopK *krtk, const void *key, size_t len)
+{
+    T_KRTopKItem *item = \
+        kr_topk_find(krtk, kr_distinct_hash(key, len), key, len);
+    return item ? item->count : 0;
+}
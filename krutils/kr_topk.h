@@ -0,0 +1,39 @@
+#ifndef __KR_TOPK_H__
+#define __KR_TOPK_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* space-saving heavy hitters:
+ * at most capacity keys are counted, a new key replaces the
+ * least counted one and inherits its count as error,
+ * any key more frequent than total/capacity is always kept
+ */
+typedef struct _kr_topk_item_t
+{
+    uint64_t        hash;
+    unsigned long   count;       /* estimated, never below the real */
+    unsigned long   error;       /* overestimation bound */
+    size_t          len;
+    size_t          cap;         /* allocated for key */
+    char           *key;
+}T_KRTopKItem;
+
+typedef struct _kr_topk_t
+{
+    unsigned int    capacity;
+    unsigned int    size;        /* keys counted */
+    unsigned long   total;       /* keys added */
+    T_KRTopKItem   *items;
+}T_KRTopK;
+
+
+T_KRTopK *kr_topk_new(unsigned int capacity);
+void kr_topk_free(T_KRTopK *krtk);
+void kr_topk_reset(T_KRTopK *krtk);
+
+void kr_topk_add(T_KRTopK *krtk, const void *key, size_t len);
+T_KRTopKItem *kr_topk_top(T_KRTopK *krtk);
+unsigned long kr_topk_count(T_KRTopK *krtk, const void *key, size_t len);
+
+#endif /* __KR_TOPK_H__ */
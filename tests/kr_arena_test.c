@@ -0,0 +1,60 @@
+#include "krutils/kr_utils.h"
+#include "krutils/kr_arena.h"
+#include <assert.h>
+
+
+int main(int argc, char *argv[])
+{
+    T_KRArena *krarena = kr_arena_new(256);
+    assert(krarena != NULL);
+    assert(krarena->grows == 0);
+
+    /* aligned, and never overlapping */
+    char *a = kr_arena_alloc(krarena, 3);
+    char *b = kr_arena_alloc(krarena, 5);
+    assert(((size_t )a % 16) == 0 && ((size_t )b % 16) == 0);
+    assert(b >= a + 3);
+    assert(kr_arena_owns(krarena, a) && kr_arena_owns(krarena, b));
+    assert(!kr_arena_owns(krarena, &krarena));
+
+    char *s = kr_arena_strdup(krarena, "hello");
+    assert(strcmp(s, "hello") == 0);
+    s = kr_arena_strndup(krarena, "hello", 4);
+    assert(strcmp(s, "hell") == 0);
+    long *l = kr_arena_calloc(krarena, sizeof(long)*4);
+    assert(l[0] == 0 && l[3] == 0);
+
+    /* bigger than a chunk, then outgrown */
+    void *big = kr_arena_alloc(krarena, 1000);
+    assert(big != NULL && kr_arena_owns(krarena, big));
+    for (int i = 0; i < 100; i++) {
+        assert(kr_arena_alloc(krarena, 64) != NULL);
+    }
+    unsigned long grows = krarena->grows;
+    assert(grows > 2);
+    printf("used %zu in %lu chunks\n", krarena->used, grows);
+
+    /* reset merges into one chunk holding the whole period */
+    size_t used = krarena->used;
+    kr_arena_reset(krarena);
+    assert(krarena->used == 0 && krarena->peak == used);
+    assert(krarena->head != NULL && krarena->head->next == NULL);
+    assert(!kr_arena_owns(krarena, big) || krarena->head->size >= used);
+
+    /* steady state never allocates again */
+    grows = krarena->grows;
+    for (int n = 0; n < 10; n++) {
+        kr_arena_alloc(krarena, 1000);
+        for (int i = 0; i < 100; i++) {
+            kr_arena_strdup(krarena, "steady state");
+            kr_arena_alloc(krarena, 48);
+        }
+        kr_arena_reset(krarena);
+    }
+    assert(krarena->grows == grows);
+
+    kr_arena_free(krarena);
+
+    printf("Success!\n");
+    return 0;
+}
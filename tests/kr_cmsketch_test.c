@@ -0,0 +1,78 @@
+#include "krutils/kr_utils.h"
+#include "krutils/kr_distinct.h"
+#include "krutils/kr_cmsketch.h"
+#include <assert.h>
+#include <pthread.h>
+
+#define THREAD_NUMBER  4
+#define ADD_NUMBER     100000
+
+static T_KRCMSketch *gptSketch = NULL;
+
+static void *add_thread(void *arg)
+{
+    long id = (long )arg;
+    for (long l = 0; l < ADD_NUMBER; l++) {
+        /* one shared hot key and a private tail */
+        long key = (l % 2) ? 42 : id * ADD_NUMBER + l;
+        kr_cmsketch_add(gptSketch, kr_distinct_hash(&key, sizeof(key)), 3600);
+    }
+    return NULL;
+}
+
+
+int main(int argc, char *argv[])
+{
+    pthread_t threads[THREAD_NUMBER];
+    char caKey[20];
+    unsigned long count;
+
+    /* 12 buckets of 5 minutes */
+    T_KRCMSketch *krcms = kr_cmsketch_new(4, 1<<12, 12, 300);
+    assert(krcms != NULL);
+
+    uint64_t dev1 = kr_distinct_hash("device_1", 8);
+    uint64_t dev2 = kr_distinct_hash("device_2", 8);
+    for (int i = 0; i < 10; i++) {
+        kr_cmsketch_add(krcms, dev1, 1000 + i * 60);
+    }
+    kr_cmsketch_add(krcms, dev2, 1500);
+
+    count = kr_cmsketch_estimate(krcms, dev1, 1540, 3600);
+    printf("device_1 in an hour => %lu\n", count);
+    assert(count == 10);
+    assert(kr_cmsketch_estimate(krcms, dev2, 1540, 3600) == 1);
+    /* the last bucket only */
+    count = kr_cmsketch_estimate(krcms, dev1, 1540, 300);
+    printf("device_1 in 5 minutes => %lu\n", count);
+    assert(count == 1);
+    /* expired once its buckets are out of the window */
+    assert(kr_cmsketch_estimate(krcms, dev1, 1000 + 3600 * 2, 3600) == 0);
+
+    /* never undercount with collisions */
+    for (int i = 0; i < 20000; i++) {
+        snprintf(caKey, sizeof(caKey), "ip_%d", i);
+        kr_cmsketch_add(krcms, kr_distinct_hash(caKey, strlen(caKey)), 2000);
+    }
+    assert(kr_cmsketch_estimate(krcms, dev1, 2000, 3600) >= 10);
+    kr_cmsketch_free(krcms);
+
+    /* shared by threads */
+    gptSketch = kr_cmsketch_new(4, 1<<16, 12, 300);
+    for (long i = 0; i < THREAD_NUMBER; i++) {
+        pthread_create(&threads[i], NULL, add_thread, (void *)i);
+    }
+    for (int i = 0; i < THREAD_NUMBER; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    long hot = 42;
+    count = kr_cmsketch_estimate(gptSketch, 
+            kr_distinct_hash(&hot, sizeof(hot)), 3600, 3600);
+    printf("hot key from %d threads => %lu\n", THREAD_NUMBER, count);
+    assert(count >= THREAD_NUMBER * ADD_NUMBER / 2);
+    assert(count < THREAD_NUMBER * ADD_NUMBER / 2 * 1.01);
+    kr_cmsketch_free(gptSketch);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#include "krutils/kr_utils.h"
+#include "krdb/kr_db.h"
+#include "krdata/kr_data.h"
+
+#define KEY_CNT    5
+#define WINDOW     20
+#define EVENT_CNT  600
+
+/*proctime, transtime, key, amount and price*/
+typedef struct _tradflow_t {
+    long   lProcTime;
+    long   lTransTime;
+    long   lKey;
+    long   lAmt;
+    double dPrice;
+}T_TradFlow;
+
+
+static T_KRTable *create_table(T_KRDB *ptDB, int iTableId, long lKeep)
+{
+    T_KRTable *ptTable = kr_table_create(ptDB, iTableId, "flow",
+            KR_SIZEKEEPMODE_RECORD, lKeep);
+    assert(ptTable != NULL);
+    ptTable->iFieldCnt = 5;
+    ptTable->ptFieldDef = kr_calloc(sizeof(T_KRFieldDef)*5);
+    for (int i=0; i<5; i++) {
+        ptTable->ptFieldDef[i].id = i;
+        ptTable->ptFieldDef[i].type = i == 4 ? KR_TYPE_DOUBLE : KR_TYPE_LONG;
+        ptTable->ptFieldDef[i].length = sizeof(long);
+        ptTable->ptFieldDef[i].offset = i*sizeof(long);
+    }
+    /*aligned as kr_db_define does*/
+    ptTable->iRecordSize = (sizeof(T_KRRecord)+sizeof(T_TradFlow)+0xf) & ~0xf;
+    ptTable->pRecordBuff = kr_calloc(ptTable->iRecordSize*lKeep);
+    assert(ptTable->pRecordBuff != NULL);
+    return ptTable;
+}
+
+
+static void define(T_KRParamDDI *ptParamDDI, long lDatasrc, char cType,
+        char cMethod, long lField, E_KRType eValueType)
+{
+    T_KRParamDDIDef *ptParamDDIDef = \
+        &ptParamDDI->stParamDDIDef[ptParamDDI->lDDIDefCnt++];
+    ptParamDDIDef->lDdiId = ptParamDDI->lDDIDefCnt;
+    ptParamDDIDef->lStatisticsDatasrc = lDatasrc;
+    ptParamDDIDef->lStatisticsIndex = 1;
+    ptParamDDIDef->lStatisticsField = lField;
+    ptParamDDIDef->lStatisticsValue = WINDOW;
+    ptParamDDIDef->caStatisticsType[0] = cType;
+    ptParamDDIDef->caStatisticsMethod[0] = cMethod;
+    ptParamDDIDef->caDdiFilterFormat[0] = KR_CALCFORMAT_FLEX;
+    ptParamDDIDef->caDdiValueType[0] = eValueType;
+    strcpy(ptParamDDIDef->caDdiFilterString, "F_3 > 10;");
+}
+
+
+/*DDI id computed through ptDdiTable, its cursor cleared to tell the path*/
+static T_KRDDI *compute(T_KRData *ptData, T_KRDDITable *ptDdiTable,
+        kr_bool bColumnar, int id)
+{
+    T_KRDDI *ptDDI = kr_ddi_lookup(ptDdiTable, id);
+    assert(ptDDI != NULL);
+    memset(&ptDDI->stCursor, 0x00, sizeof(ptDDI->stCursor));
+    kr_ddi_set_columnar(bColumnar);
+    ptData->ptDdiTable = ptDdiTable;
+    void *pValue = kr_data_get_value(KR_CALCKIND_DID, id, ptData);
+    assert((pValue != NULL) == (ptDDI->eValueInd == KR_VALUE_SETED));
+    return ptDDI;
+}
+
+
+/*the slot's columns mirror its list, table by table*/
+static void check_columns(T_KRDB *ptDB)
+{
+    for (int iTableId=1; iTableId<=2; iTableId++) {
+        T_KRIndexTable *ptIndexTable = kr_index_table_get(ptDB, 1, iTableId);
+        for (long lKey=0; lKey<KEY_CNT; lKey++) {
+            T_KRIndexSolt *ptIndexSlot = NULL;
+            T_KRColumns *ptColumns = \
+                kr_index_columns_hold(ptIndexTable, &lKey, &ptIndexSlot);
+            assert(ptIndexSlot != NULL && ptColumns != NULL);
+            T_KRRecord **pptRecord = kr_columns_record(ptColumns);
+            time_t *ptTransTime = kr_columns_transtime(ptColumns);
+            unsigned int m = 0;
+            T_KRListNode *node = ptIndexSlot->pRecList->head;
+            for (; node; node=node->next) {
+                T_KRRecord *ptRecord = (T_KRRecord *)kr_list_value(node);
+                if (ptRecord->ptTable != ptIndexTable->ptTable) continue;
+                assert(pptRecord[m] == ptRecord);
+                assert(ptTransTime[m] == kr_get_transtime(ptRecord));
+                m++;
+            }
+            assert(m == ptColumns->uiCnt);
+            kr_index_slot_release(ptIndexSlot);
+        }
+    }
+}
+
+
+int main(void)
+{
+    T_KRDB *ptDB = kr_db_create("test", NULL, NULL);
+    T_KRTable *ptTable1 = create_table(ptDB, 1, 60);
+    T_KRTable *ptTable2 = create_table(ptDB, 2, 80);
+    kr_index_create(ptDB, 1, "key", KR_TYPE_LONG);
+    assert(kr_index_table_create(ptDB, 1, 1, 2, 1) != NULL);
+    assert(kr_index_table_create(ptDB, 1, 2, 2, 1) != NULL);
+
+    /*every method read from the columns, long and double fields*/
+    T_KRParamDDI *ptParamDDI = kr_calloc(sizeof(T_KRParamDDI));
+    define(ptParamDDI, 1, KR_DDI_STATISTICS_INCLUDE, KR_DDI_METHOD_SUM, 3, KR_TYPE_LONG);
+    define(ptParamDDI, 1, KR_DDI_STATISTICS_INCLUDE, KR_DDI_METHOD_MIN, 3, KR_TYPE_LONG);
+    define(ptParamDDI, 1, KR_DDI_STATISTICS_INCLUDE, KR_DDI_METHOD_MAX, 3, KR_TYPE_LONG);
+    define(ptParamDDI, 1, KR_DDI_STATISTICS_INCLUDE, KR_DDI_METHOD_COUNT, 3, KR_TYPE_LONG);
+    define(ptParamDDI, 1, KR_DDI_STATISTICS_INCLUDE, KR_DDI_METHOD_SUM, 4, KR_TYPE_DOUBLE);
+    define(ptParamDDI, 1, KR_DDI_STATISTICS_EXCLUDE, KR_DDI_METHOD_SUM, 3, KR_TYPE_LONG);
+    define(ptParamDDI, 2, KR_DDI_STATISTICS_INCLUDE, KR_DDI_METHOD_MAX, 4, KR_TYPE_DOUBLE);
+    define(ptParamDDI, 2, KR_DDI_STATISTICS_EXCLUDE, KR_DDI_METHOD_COUNT, 3, KR_TYPE_INT);
+    ptParamDDI->tLastLoadTime = 1;
+
+    kr_ddi_set_columnar(TRUE);
+    T_KRDDITable *ptColumnTable = kr_ddi_table_construct(ptParamDDI, NULL,
+            kr_data_get_type, kr_data_get_value);
+    kr_ddi_set_columnar(FALSE);
+    T_KRDDITable *ptRowTable = kr_ddi_table_construct(ptParamDDI, NULL,
+            kr_data_get_type, kr_data_get_value);
+    assert(ptColumnTable != NULL && ptRowTable != NULL);
+
+    T_KRParamSDI *ptParamSDI = kr_calloc(sizeof(T_KRParamSDI));
+    T_KRData stData = {0};
+    stData.ptSdiTable = kr_sdi_table_construct(ptParamSDI, NULL,
+            kr_data_get_type, kr_data_get_value);
+
+    /*more than kept, transtime a little out of order*/
+    int iColumnar = 0, iTotal = 0;
+    srand(7);
+    for (int i=0; i<EVENT_CNT; i++) {
+        T_KRTable *ptTable = (rand()%3) ? ptTable1 : ptTable2;
+        T_KRRecord *ptRecord = kr_record_new(ptTable);
+        T_TradFlow *ptFlow = (T_TradFlow *)ptRecord->pRecBuf;
+        ptFlow->lProcTime = 1000+i;
+        ptFlow->lTransTime = 1000+i-rand()%4;
+        ptFlow->lKey = rand()%KEY_CNT;
+        ptFlow->lAmt = rand()%40-5;
+        ptFlow->dPrice = (rand()%1000)/10.0;
+        kr_record_insert(ptRecord);
+
+        stData.ptDdiTable = ptColumnTable;
+        kr_data_filter_record(&stData, ptRecord);
+        stData.ptCurrRec = ptRecord;
+
+        for (int id=1; id<=ptParamDDI->lDDIDefCnt; id++) {
+            T_KRDDI *ptColumnDDI = compute(&stData, ptColumnTable, TRUE, id);
+            T_KRDDI *ptRowDDI = compute(&stData, ptRowTable, FALSE, id);
+            iTotal++;
+            if (ptColumnDDI->stCursor.ptIndex == NULL) iColumnar++;
+
+            assert(ptColumnDDI->eValueInd == ptRowDDI->eValueInd);
+            switch(ptRowDDI->eValueType)
+            {
+                case KR_TYPE_DOUBLE:
+                    assert(fabs(ptColumnDDI->uValue.d - ptRowDDI->uValue.d) <=
+                            1e-9*(fabs(ptRowDDI->uValue.d)+1));
+                    break;
+                case KR_TYPE_INT:
+                    assert(ptColumnDDI->uValue.i == ptRowDDI->uValue.i);
+                    break;
+                default:
+                    assert(ptColumnDDI->uValue.l == ptRowDDI->uValue.l);
+                    break;
+            }
+        }
+    }
+
+    /*rows scanned only until the key's columns got built*/
+    printf("columnar %d of %d\n", iColumnar, iTotal);
+    assert(iColumnar > iTotal*8/10);
+    check_columns(ptDB);
+
+    kr_sdi_table_destruct(stData.ptSdiTable);
+    kr_ddi_table_destruct(ptColumnTable);
+    kr_ddi_table_destruct(ptRowTable);
+    kr_free(ptParamSDI);
+    kr_free(ptParamDDI);
+    kr_db_drop(ptDB);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <assert.h>
+
+#include "krutils/kr_utils.h"
+#include "krdb/kr_db.h"
+
+#define KEEP_CNT   100
+#define WALK_CNT   80
+
+/*proctime, transtime, key and amount, all long*/
+typedef struct _tradflow_t {
+    long lProcTime;
+    long lTransTime;
+    long lKey;
+    long lAmt;
+}T_TradFlow;
+
+typedef struct _remover_t {
+    T_KRTable *ptTable;
+    long      lCnt;
+}T_Remover;
+
+
+static T_KRTable *create_table(T_KRDB *ptDB, int iTableId, long lKeep)
+{
+    T_KRTable *ptTable = kr_table_create(ptDB, iTableId, "flow",
+            KR_SIZEKEEPMODE_RECORD, lKeep);
+    assert(ptTable != NULL);
+    ptTable->iFieldCnt = 4;
+    ptTable->ptFieldDef = kr_calloc(sizeof(T_KRFieldDef)*4);
+    for (int i=0; i<4; i++) {
+        ptTable->ptFieldDef[i].id = i;
+        ptTable->ptFieldDef[i].type = KR_TYPE_LONG;
+        ptTable->ptFieldDef[i].length = sizeof(long);
+        ptTable->ptFieldDef[i].offset = i*sizeof(long);
+    }
+    /*aligned as kr_db_define does*/
+    ptTable->iRecordSize = (sizeof(T_KRRecord)+sizeof(T_TradFlow)+0xf) & ~0xf;
+    ptTable->pRecordBuff = kr_calloc(ptTable->iRecordSize*lKeep);
+    assert(ptTable->pRecordBuff != NULL);
+    return ptTable;
+}
+
+
+static void ingest(T_KRTable *ptTable, long lTransTime, long lKey, long lAmt)
+{
+    T_TradFlow stFlow = {lTransTime, lTransTime, lKey, lAmt};
+    T_KRRecord *ptRecord = NULL;
+    assert(kr_table_ingest(ptTable, (char *)&stFlow, sizeof(stFlow),
+                &ptRecord) == 0);
+}
+
+
+static long amount(T_KRRecord *ptRecord)
+{
+    return ((T_TradFlow *)ptRecord->pRecBuf)->lAmt;
+}
+
+
+/*inserts of key 9 evicting the table's oldest records*/
+static void *remover(void *arg)
+{
+    T_Remover *ptRemover = (T_Remover *)arg;
+    for (long i=0; i<ptRemover->lCnt; i++) {
+        ingest(ptRemover->ptTable, 3000+i, 9, i);
+    }
+    return NULL;
+}
+
+
+static void remove_meanwhile(T_KRTable *ptTable, long lCnt)
+{
+    pthread_t tRemover;
+    T_Remover stRemover = {ptTable, lCnt};
+    assert(pthread_create(&tRemover, NULL, remover, &stRemover) == 0);
+    pthread_join(tRemover, NULL);
+}
+
+
+static unsigned long remove_stamp(T_KRIndex *ptIndex, long lKey)
+{
+    T_KRIndexSolt *ptIndexSlot = kr_index_slot_hold(ptIndex, &lKey);
+    assert(ptIndexSlot != NULL);
+    unsigned long ulRemoveStamp = ptIndexSlot->ulRemoveStamp;
+    kr_index_slot_release(ptIndexSlot);
+    return ulRemoveStamp;
+}
+
+
+/*more records than a batch, in either direction*/
+static void test_walk(T_KRIndex *ptIndex)
+{
+    long lKey = 7, n = 0;
+    T_KRDBCursor stCursor;
+    T_KRRecord *ptRecord;
+
+    kr_db_cursor_init(&stCursor, ptIndex, &lKey, KR_CURSOR_FORWARD);
+    while ((ptRecord = kr_db_cursor_next(&stCursor)) != NULL) {
+        assert(amount(ptRecord) == n++);
+    }
+    kr_db_cursor_close(&stCursor);
+    assert(n == WALK_CNT);
+
+    n = 0;
+    kr_db_cursor_init(&stCursor, ptIndex, &lKey, KR_CURSOR_REVERSE);
+    while ((ptRecord = kr_db_cursor_next(&stCursor)) != NULL) {
+        assert(amount(ptRecord) == WALK_CNT-1-n++);
+    }
+    kr_db_cursor_close(&stCursor);
+    assert(n == WALK_CNT);
+}
+
+
+/*records removed between batches, the walk resumes after the last one*/
+static void test_remove(T_KRIndex *ptIndex, T_KRTable *ptTable1)
+{
+    long lKey = 7, n = 0, lPrev = WALK_CNT;
+    T_KRDBCursor stCursor;
+    T_KRRecord *ptRecord;
+
+    /*table 1 holds the odd amounts, its oldest 20 evicted meanwhile*/
+    kr_db_cursor_init(&stCursor, ptIndex, &lKey, KR_CURSOR_REVERSE);
+    while ((ptRecord = kr_db_cursor_next(&stCursor)) != NULL) {
+        long lAmt = amount(ptRecord);
+        assert(lAmt < lPrev);
+        assert(lAmt >= 40 || lAmt%2 == 0);
+        lPrev = lAmt;
+        if (++n == KR_CURSOR_BATCH) {
+            assert(stCursor.iPos == stCursor.iCnt);
+            assert(amount(stCursor.ptLast) == 48);
+            remove_meanwhile(ptTable1, KEEP_CNT-WALK_CNT/2+20);
+            assert(remove_stamp(ptIndex, lKey) != stCursor.ulRemoveStamp);
+        }
+    }
+    kr_db_cursor_close(&stCursor);
+    assert(n == WALK_CNT-20 && lPrev == 0);
+
+    /*the record examined last evicted, the walk can't go on*/
+    n = 0;
+    kr_db_cursor_init(&stCursor, ptIndex, &lKey, KR_CURSOR_FORWARD);
+    while ((ptRecord = kr_db_cursor_next(&stCursor)) != NULL) {
+        if (++n == KR_CURSOR_BATCH) {
+            assert(amount(stCursor.ptLast) == 51);
+            remove_meanwhile(ptTable1, KEEP_CNT);
+        }
+    }
+    kr_db_cursor_close(&stCursor);
+    assert(n == KR_CURSOR_BATCH);
+
+    /*only table 2's are left*/
+    n = 0;
+    kr_db_cursor_init(&stCursor, ptIndex, &lKey, KR_CURSOR_FORWARD);
+    while ((ptRecord = kr_db_cursor_next(&stCursor)) != NULL) {
+        assert(amount(ptRecord) == 2*n++);
+    }
+    kr_db_cursor_close(&stCursor);
+    assert(n == WALK_CNT/2);
+}
+
+
+/*a record 10 seconds late, a walk stops 10 seconds past the range*/
+static void test_stop_early(T_KRIndex *ptIndex, T_KRTable *ptTable2)
+{
+    long lKey = 8, n = 0;
+    T_KRDBCursor stCursor;
+    T_KRRecord *ptRecord;
+
+    for (long i=0; i<100; i++) {
+        ingest(ptTable2, i == 50 ? 2039 : 2000+i, lKey, i);
+    }
+    assert(ptTable2->lTransTimeSlack == 10);
+
+    kr_db_cursor_init(&stCursor, ptIndex, &lKey, KR_CURSOR_REVERSE);
+    kr_db_cursor_set_range(&stCursor, 2080, 2089, TRUE);
+    kr_db_cursor_set_table(&stCursor, ptTable2);
+    while ((ptRecord = kr_db_cursor_next(&stCursor)) != NULL) {
+        assert(amount(ptRecord) == 89-n++);
+    }
+    assert(n == 10 && amount(stCursor.ptLast) == 69);
+    kr_db_cursor_close(&stCursor);
+
+    n = 0;
+    kr_db_cursor_init(&stCursor, ptIndex, &lKey, KR_CURSOR_FORWARD);
+    kr_db_cursor_set_range(&stCursor, 2000, 2009, TRUE);
+    kr_db_cursor_set_table(&stCursor, ptTable2);
+    while ((ptRecord = kr_db_cursor_next(&stCursor)) != NULL) {
+        assert(amount(ptRecord) == n++);
+    }
+    assert(n == 10 && amount(stCursor.ptLast) == 20);
+    kr_db_cursor_close(&stCursor);
+
+    /*without stopping early every record is examined*/
+    n = 0;
+    kr_db_cursor_init(&stCursor, ptIndex, &lKey, KR_CURSOR_FORWARD);
+    kr_db_cursor_set_range(&stCursor, 2000, 2009, FALSE);
+    kr_db_cursor_set_table(&stCursor, ptTable2);
+    while ((ptRecord = kr_db_cursor_next(&stCursor)) != NULL) n++;
+    assert(n == 10 && amount(stCursor.ptLast) == 99);
+    kr_db_cursor_close(&stCursor);
+}
+
+
+int main(void)
+{
+    T_KRDB *ptDB = kr_db_create("test", NULL, NULL);
+    T_KRTable *ptTable1 = create_table(ptDB, 1, KEEP_CNT);
+    T_KRTable *ptTable2 = create_table(ptDB, 2, 10*KEEP_CNT);
+    kr_index_create(ptDB, 1, "key", KR_TYPE_LONG);
+    assert(kr_index_table_create(ptDB, 1, 1, 2, 0) != NULL);
+    assert(kr_index_table_create(ptDB, 1, 2, 2, 0) != NULL);
+    T_KRIndex *ptIndex = kr_index_get(ptDB, 1);
+
+    /*odd amounts to table 1, even to table 2*/
+    for (long i=0; i<WALK_CNT; i++) {
+        ingest(i%2 ? ptTable1 : ptTable2, 1000+i, 7, i);
+    }
+
+    test_walk(ptIndex);
+    test_remove(ptIndex, ptTable1);
+    test_stop_early(ptIndex, ptTable2);
+
+    kr_db_drop(ptDB);
+
+    printf("Success!\n");
+    return 0;
+}
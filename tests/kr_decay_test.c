@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#include "krutils/kr_utils.h"
+#include "krdb/kr_db.h"
+#include "krdata/kr_data.h"
+
+#define HALF_LIFE  60
+#define KEEP_CNT   4
+
+/*proctime, transtime, key and amount, all long*/
+typedef struct _tradflow_t {
+    long lProcTime;
+    long lTransTime;
+    long lKey;
+    long lAmt;
+}T_TradFlow;
+
+
+static T_KRTable *create_table(T_KRDB *ptDB)
+{
+    T_KRTable *ptTable = kr_table_create(ptDB, 1, "flow",
+            KR_SIZEKEEPMODE_RECORD, KEEP_CNT);
+    assert(ptTable != NULL);
+    ptTable->iFieldCnt = 4;
+    ptTable->ptFieldDef = kr_calloc(sizeof(T_KRFieldDef)*4);
+    for (int i=0; i<4; i++) {
+        ptTable->ptFieldDef[i].id = i;
+        ptTable->ptFieldDef[i].type = KR_TYPE_LONG;
+        ptTable->ptFieldDef[i].length = sizeof(long);
+        ptTable->ptFieldDef[i].offset = i*sizeof(long);
+    }
+    /*aligned as kr_db_define does*/
+    ptTable->iRecordSize = (sizeof(T_KRRecord)+sizeof(T_TradFlow)+0xf) & ~0xf;
+    ptTable->pRecordBuff = kr_calloc(ptTable->iRecordSize*KEEP_CNT);
+    assert(ptTable->pRecordBuff != NULL);
+    return ptTable;
+}
+
+
+static void insert(T_KRTable *ptTable, long lKey, long lTransTime, long lAmt)
+{
+    T_KRRecord *ptRecord = kr_record_new(ptTable);
+    T_TradFlow *ptFlow = (T_TradFlow *)ptRecord->pRecBuf;
+    ptFlow->lProcTime = ptFlow->lTransTime = lTransTime;
+    ptFlow->lKey = lKey;
+    ptFlow->lAmt = lAmt;
+    kr_record_insert(ptRecord);
+}
+
+
+/*sum of weights decayed to tTime by hand*/
+static double decayed(long *plTime, long *plWeight, int iCnt, long tTime)
+{
+    double dSum = 0;
+    for (int i=0; i<iCnt; i++) {
+        dSum += plWeight[i] * exp(-log(2.0)/HALF_LIFE * (tTime - plTime[i]));
+    }
+    return dSum;
+}
+
+
+static void test_exponential(void)
+{
+    T_KRDB *ptDB = kr_db_create("test", NULL, NULL);
+    T_KRTable *ptTable = create_table(ptDB);
+    kr_index_create(ptDB, 1, "key", KR_TYPE_LONG);
+    T_KRIndexTable *ptIndexTable = kr_index_table_create(ptDB, 1, 1, 2, 1);
+    assert(ptIndexTable != NULL);
+
+    int iCount = kr_index_decay_register(ptIndexTable, -1, HALF_LIFE);
+    int iSum = kr_index_decay_register(ptIndexTable, 3, HALF_LIFE);
+    assert(iCount >= 0 && iSum >= 0 && iCount != iSum);
+    assert(kr_index_decay_register(ptIndexTable, -1, HALF_LIFE) == iCount);
+
+    /*more records than kept, one out of order, one negative*/
+    long lTime[] = {1000, 1013, 1060, 1061, 1200, 1150, 1300, 1301, 1420};
+    long lAmt[]  = {  10,   25,   -5,  100,    7,   40,    3,    1,   60};
+    long lOnes[] = {   1,    1,    1,    1,    1,    1,    1,    1,    1};
+    int iCnt = sizeof(lTime)/sizeof(lTime[0]);
+    long lKey = 7;
+    for (int i=0; i<iCnt; i++) {
+        insert(ptTable, lKey, lTime[i], lAmt[i]);
+        long tNow = lTime[i] > 1300 ? lTime[i] : 1300;
+        double dCount = kr_index_decay_value(ptIndexTable->ptIndex, iCount,
+                HALF_LIFE, &lKey, tNow);
+        double dSum = kr_index_decay_value(ptIndexTable->ptIndex, iSum,
+                HALF_LIFE, &lKey, tNow);
+        assert(fabs(dCount - decayed(lTime, lOnes, i+1, tNow)) < 1e-9);
+        assert(fabs(dSum - decayed(lTime, lAmt, i+1, tNow)) < 1e-9);
+    }
+    printf("count %.6f sum %.6f at %d\n",
+            kr_index_decay_value(ptIndexTable->ptIndex, iCount, HALF_LIFE, &lKey, 1500),
+            kr_index_decay_value(ptIndexTable->ptIndex, iSum, HALF_LIFE, &lKey, 1500),
+            1500);
+
+    /*other keys count nothing*/
+    long lOther = 8;
+    assert(kr_index_decay_value(ptIndexTable->ptIndex, iCount,
+                HALF_LIFE, &lOther, 1500) == 0.0);
+
+    kr_db_drop(ptDB);
+}
+
+
+static void test_register(void)
+{
+    T_KRDB *ptDB = kr_db_create("test", NULL, NULL);
+    T_KRTable *ptTable = create_table(ptDB);
+    kr_index_create(ptDB, 1, "key", KR_TYPE_LONG);
+    T_KRIndexTable *ptIndexTable = kr_index_table_create(ptDB, 1, 1, 2, 1);
+
+    T_KRParamDDI *ptParamDDI = kr_calloc(sizeof(T_KRParamDDI));
+    T_KRParamDDIDef *ptParamDDIDef = &ptParamDDI->stParamDDIDef[0];
+    ptParamDDI->lDDIDefCnt = 1;
+    ptParamDDIDef->lDdiId = 1;
+    ptParamDDIDef->lStatisticsDatasrc = 1;
+    ptParamDDIDef->lStatisticsIndex = 1;
+    ptParamDDIDef->lStatisticsField = 3;
+    ptParamDDIDef->lStatisticsValue = HALF_LIFE;
+    ptParamDDIDef->caStatisticsType[0] = KR_DDI_STATISTICS_DECAY;
+    ptParamDDIDef->caStatisticsMethod[0] = KR_DDI_METHOD_SUM;
+
+    /*decayed counters see every record, a filter is refused*/
+    strcpy(ptParamDDIDef->caDdiFilterString, "C_3 > 10");
+    assert(kr_ddi_table_register(ptParamDDI, ptDB) != 0);
+    ptParamDDIDef->caDdiFilterString[0] = '\0';
+    assert(kr_ddi_table_register(ptParamDDI, ptDB) == 0);
+
+    /*and heavy hitters', which have no window either*/
+    ptParamDDIDef->caStatisticsType[0] = KR_DDI_STATISTICS_INCLUDE;
+    ptParamDDIDef->caStatisticsMethod[0] = KR_DDI_METHOD_TOP_FREQ;
+    ptParamDDIDef->lStatisticsCount = 8;
+    assert(kr_ddi_table_register(ptParamDDI, ptDB) != 0);
+    ptParamDDIDef->lStatisticsValue = 0;
+    strcpy(ptParamDDIDef->caDdiFilterString, "C_3 > 10");
+    assert(kr_ddi_table_register(ptParamDDI, ptDB) != 0);
+    ptParamDDIDef->caDdiFilterString[0] = '\0';
+    ptParamDDIDef->caStatisticsType[0] = KR_DDI_STATISTICS_EXCLUDE;
+    assert(kr_ddi_table_register(ptParamDDI, ptDB) != 0);
+    ptParamDDIDef->caStatisticsType[0] = KR_DDI_STATISTICS_INCLUDE;
+    assert(kr_ddi_table_register(ptParamDDI, ptDB) == 0);
+    ptParamDDIDef->lStatisticsCount = 0;
+
+    ptParamDDIDef->caStatisticsType[0] = KR_DDI_STATISTICS_DECAY;
+    ptParamDDIDef->caStatisticsMethod[0] = KR_DDI_METHOD_SUM;
+    ptParamDDIDef->lStatisticsValue = HALF_LIFE;
+
+    /*registered at load counts records before any compute*/
+    long lKey = 7;
+    insert(ptTable, lKey, 1000, 10);
+    insert(ptTable, lKey, 1060, 20);
+    int iSum = kr_index_decay_register(ptIndexTable, 3, HALF_LIFE);
+    double dSum = kr_index_decay_value(ptIndexTable->ptIndex, iSum,
+            HALF_LIFE, &lKey, 1060);
+    assert(fabs(dSum - 25.0) < 1e-9);
+
+    kr_free(ptParamDDI);
+    kr_db_drop(ptDB);
+}
+
+
+int main()
+{
+    test_exponential();
+    test_register();
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include "krutils/kr_utils.h"
+#include "krutils/kr_distinct.h"
+#include <assert.h>
+#include <math.h>
+
+
+static unsigned long count_range(T_KRDistinct *krdis, long from, long to)
+{
+    kr_distinct_reset(krdis);
+    for (long l = from; l < to; l++) {
+        kr_distinct_add(krdis, &l, sizeof(l));
+        /* duplicates never count */
+        kr_distinct_add(krdis, &l, sizeof(l));
+    }
+    return kr_distinct_count(krdis);
+}
+
+
+int main(int argc, char *argv[])
+{
+    unsigned long count = 0;
+    char caKey[20];
+
+    T_KRDistinct *krdis = kr_distinct_new(64);
+    assert(krdis != NULL);
+    assert(kr_distinct_count(krdis) == 0);
+
+    /* exact below the threshold */
+    count = count_range(krdis, 0, 64);
+    printf("distinct 64 => %lu\n", count);
+    assert(count == 64);
+    assert(!krdis->upgraded);
+
+    kr_distinct_reset(krdis);
+    for (int i = 0; i < 100; i++) {
+        snprintf(caKey, sizeof(caKey), "merchant_%02d", i%10);
+        kr_distinct_add(krdis, caKey, strlen(caKey));
+    }
+    count = kr_distinct_count(krdis);
+    printf("distinct merchants => %lu\n", count);
+    assert(count == 10);
+
+    /* approximate above the threshold */
+    long sizes[] = {65, 1000, 10000, 100000};
+    for (int i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++) {
+        count = count_range(krdis, 1000000, 1000000+sizes[i]);
+        double error = fabs((double )count - sizes[i]) / sizes[i];
+        printf("distinct %ld => %lu, error %.4f\n", sizes[i], count, error);
+        assert(krdis->upgraded);
+        assert(error < 0.08);
+    }
+
+    /* reset back to exact */
+    count = count_range(krdis, 0, 10);
+    assert(count == 10);
+    assert(!krdis->upgraded);
+
+    kr_distinct_free(krdis);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include "krutils/kr_utils.h"
+#include "krutils/kr_epoch.h"
+#include "krutils/kr_seqlock.h"
+#include <assert.h>
+
+static int freed = 0;
+static void count_free(void *ptr)
+{
+    freed++;
+    kr_free(ptr);
+}
+
+
+static T_KREpoch *shared_epoch;
+static long * volatile shared_value;
+static T_KRSeqLock shared_seq;
+static long shared_pair[2];
+static volatile int stop = 0;
+
+static void *reader_thread(void *arg)
+{
+    T_KREpochReader *reader = kr_epoch_register(shared_epoch);
+    assert(reader != NULL);
+    while (!stop) {
+        kr_epoch_enter(shared_epoch, reader);
+        long *value = shared_value;
+        assert(*value >= 0);
+        kr_epoch_exit(reader);
+
+        long a, b;
+        unsigned int s;
+        do {
+            s = kr_seq_read_begin(&shared_seq);
+            a = shared_pair[0];
+            b = shared_pair[1];
+        } while (kr_seq_read_retry(&shared_seq, s));
+        assert(a == b);
+    }
+    kr_epoch_unregister(reader);
+    return NULL;
+}
+
+
+int main(int argc, char *argv[])
+{
+    T_KREpoch *krepoch = kr_epoch_new();
+    assert(krepoch != NULL);
+
+    /* kept while a reader entered before retiring is inside */
+    T_KREpochReader *r1 = kr_epoch_register(krepoch);
+    T_KREpochReader *r2 = kr_epoch_register(krepoch);
+    assert(r1 != NULL && r2 != NULL && r1 != r2);
+    kr_epoch_enter(krepoch, r1);
+    kr_epoch_retire(krepoch, kr_malloc(16), count_free);
+    assert(kr_epoch_reclaim(krepoch) == 0 && freed == 0);
+    /* readers entering later do not hold it */
+    kr_epoch_enter(krepoch, r2);
+    assert(kr_epoch_reclaim(krepoch) == 0);
+    kr_epoch_exit(r1);
+    assert(kr_epoch_reclaim(krepoch) == 1 && freed == 1);
+    kr_epoch_exit(r2);
+
+    /* idle readers hold nothing */
+    kr_epoch_retire(krepoch, kr_malloc(16), count_free);
+    assert(kr_epoch_reclaim(krepoch) == 1 && freed == 2);
+    assert(krepoch->pending == 0 && krepoch->freed == 2);
+
+    /* slots are reused once unregistered */
+    kr_epoch_unregister(r2);
+    assert(kr_epoch_register(krepoch) == r2);
+    kr_epoch_unregister(r2);
+    kr_epoch_unregister(r1);
+
+    /* freed along with the epoch */
+    kr_epoch_retire(krepoch, kr_malloc(16), count_free);
+    kr_epoch_free(krepoch);
+    assert(freed == 3);
+
+    /* one writer replacing and retiring, readers never see freed memory */
+    shared_epoch = kr_epoch_new();
+    shared_value = kr_calloc(sizeof(long));
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, reader_thread, NULL);
+    }
+    for (long i = 1; i <= 100000; i++) {
+        long *value = kr_malloc(sizeof(long));
+        *value = i;
+        long *old = shared_value;
+        shared_value = value;
+        kr_epoch_retire(shared_epoch, old, count_free);
+        if (i % 64 == 0) kr_epoch_reclaim(shared_epoch);
+
+        kr_seq_write_lock(&shared_seq);
+        shared_pair[0] = i;
+        shared_pair[1] = i;
+        kr_seq_write_unlock(&shared_seq);
+    }
+    stop = 1;
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    assert(!(shared_seq & 1));
+    printf("freed %lu pending %lu\n", shared_epoch->freed, shared_epoch->pending);
+    kr_free(shared_value);
+    kr_epoch_free(shared_epoch);
+    assert(freed == 3 + 100000);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "krutils/kr_utils.h"
+#include "krutils/kr_keytable.h"
+#include "krutils/kr_slab.h"
+
+#define KEY_NUMBER 10000
+
+typedef struct _retired {
+    int iCnt;
+    void *ptr[64];
+}T_Retired;
+
+
+/*kept aside, freed once no lookup runs*/
+static void Retire(void *data, void *ptr)
+{
+    T_Retired *ptRetired = data;
+    if (ptRetired->iCnt == 64) {
+        for (int i=0; i<ptRetired->iCnt; i++) kr_free(ptRetired->ptr[i]);
+        ptRetired->iCnt = 0;
+    }
+    ptRetired->ptr[ptRetired->iCnt++] = ptr;
+}
+
+
+static void CountFunc(void *key, void *value, void *data)
+{
+    long *plSum = data;
+    assert(*(long *)key == (long )value);
+    *plSum += *(long *)key;
+}
+
+
+static void test_long(void)
+{
+    T_KRKeyTable *ptKeyTable = kr_keytable_new(KR_TYPE_LONG, 0);
+    assert(ptKeyTable != NULL);
+
+    for (long i=1; i<=KEY_NUMBER; i++) {
+        assert(kr_keytable_insert(ptKeyTable, &i, (void *)i) == 0);
+    }
+    assert(kr_keytable_size(ptKeyTable) == KEY_NUMBER);
+    for (long i=1; i<=KEY_NUMBER; i++) {
+        assert(kr_keytable_lookup(ptKeyTable, &i) == (void *)i);
+    }
+    long lMiss = KEY_NUMBER + 1;
+    assert(kr_keytable_lookup(ptKeyTable, &lMiss) == NULL);
+
+    long lSum = 0;
+    kr_keytable_foreach(ptKeyTable, CountFunc, &lSum);
+    assert(lSum == (long )KEY_NUMBER * (KEY_NUMBER + 1) / 2);
+
+    /*half removed, their tombstones reused by the rest inserted again*/
+    for (long i=2; i<=KEY_NUMBER; i+=2) {
+        assert(kr_keytable_remove(ptKeyTable, &i) == (void *)i);
+        assert(kr_keytable_lookup(ptKeyTable, &i) == NULL);
+    }
+    assert(kr_keytable_remove(ptKeyTable, &lMiss) == NULL);
+    assert(kr_keytable_size(ptKeyTable) == KEY_NUMBER / 2);
+    for (long i=1; i<=KEY_NUMBER; i+=2) {
+        assert(kr_keytable_lookup(ptKeyTable, &i) == (void *)i);
+    }
+    for (long i=2; i<=KEY_NUMBER; i+=2) {
+        assert(kr_keytable_insert(ptKeyTable, &i, (void *)i) == 0);
+    }
+    assert(kr_keytable_size(ptKeyTable) == KEY_NUMBER);
+    printf("long keys: %.1f bytes per key\n",
+            (double )kr_keytable_bytes(ptKeyTable) / KEY_NUMBER);
+
+    kr_keytable_destroy(ptKeyTable);
+}
+
+
+static void test_int_double(void)
+{
+    T_KRKeyTable *ptInt = kr_keytable_new(KR_TYPE_INT, 0);
+    T_KRKeyTable *ptDouble = kr_keytable_new(KR_TYPE_DOUBLE, 0);
+    assert(ptInt != NULL && ptDouble != NULL);
+
+    for (int i=-100; i<100; i++) {
+        double d = i / 4.0;
+        assert(kr_keytable_insert(ptInt, &i, &ptInt) == 0);
+        assert(kr_keytable_insert(ptDouble, &d, &ptDouble) == 0);
+    }
+    for (int i=-100; i<100; i++) {
+        double d = i / 4.0;
+        assert(kr_keytable_lookup(ptInt, &i) == &ptInt);
+        assert(kr_keytable_lookup(ptDouble, &d) == &ptDouble);
+    }
+    double dZero = -0.0;
+    assert(kr_keytable_lookup(ptDouble, &dZero) == &ptDouble);
+    assert(kr_keytable_size(ptInt) == 200);
+
+    kr_keytable_destroy(ptInt);
+    kr_keytable_destroy(ptDouble);
+}
+
+
+static void test_string(void)
+{
+    T_Retired stRetired = {0};
+    T_KRKeyTable *ptKeyTable = kr_keytable_new(KR_TYPE_STRING, 16);
+    assert(ptKeyTable != NULL);
+    kr_keytable_set_retire(ptKeyTable, Retire, &stRetired);
+
+    /*short keys inline, long ones copied out of line*/
+    char caKey[64];
+    for (int i=0; i<KEY_NUMBER; i++) {
+        if (i % 3 == 0) {
+            snprintf(caKey, sizeof(caKey), "a_rather_long_key_%08d", i);
+        } else {
+            snprintf(caKey, sizeof(caKey), "k%d", i);
+        }
+        assert(kr_keytable_insert(ptKeyTable, caKey, (void *)(long )(i+1)) == 0);
+    }
+    for (int i=0; i<KEY_NUMBER; i++) {
+        if (i % 3 == 0) {
+            snprintf(caKey, sizeof(caKey), "a_rather_long_key_%08d", i);
+        } else {
+            snprintf(caKey, sizeof(caKey), "k%d", i);
+        }
+        assert(kr_keytable_lookup(ptKeyTable, caKey) == (void *)(long )(i+1));
+    }
+    /*the boundary of inline size either way*/
+    assert(kr_keytable_insert(ptKeyTable, "123456789012345", (void *)1) == 0);
+    assert(kr_keytable_insert(ptKeyTable, "1234567890123456", (void *)2) == 0);
+    assert(kr_keytable_lookup(ptKeyTable, "123456789012345") == (void *)1);
+    assert(kr_keytable_lookup(ptKeyTable, "1234567890123456") == (void *)2);
+    assert(kr_keytable_lookup(ptKeyTable, "12345678901234567") == NULL);
+    assert(kr_keytable_remove(ptKeyTable, "1234567890123456") == (void *)2);
+    assert(kr_keytable_lookup(ptKeyTable, "1234567890123456") == NULL);
+    assert(kr_keytable_size(ptKeyTable) == KEY_NUMBER + 1);
+    printf("string keys: %.1f bytes per key\n",
+            (double )kr_keytable_bytes(ptKeyTable) / (KEY_NUMBER + 1));
+
+    kr_keytable_destroy(ptKeyTable);
+    for (int i=0; i<stRetired.iCnt; i++) kr_free(stRetired.ptr[i]);
+}
+
+
+static void SweepFunc(void *key, void *value, void *data)
+{
+    T_KRKeyTable *ptKeyTable = data;
+    if (*(long *)key % 2 == 0) {
+        assert(kr_keytable_remove(ptKeyTable, key) == value);
+    }
+}
+
+
+static void test_sweep(void)
+{
+    T_KRKeyTable *ptKeyTable = kr_keytable_new(KR_TYPE_LONG, 0);
+    assert(ptKeyTable != NULL);
+    for (long i=1; i<=KEY_NUMBER; i++) {
+        assert(kr_keytable_insert(ptKeyTable, &i, (void *)i) == 0);
+    }
+
+    /*a few buckets at a time, keys removed as they are visited*/
+    unsigned int uiCursor = 0;
+    kr_keytable_sweep(ptKeyTable, &uiCursor, 10, SweepFunc, ptKeyTable);
+    assert(uiCursor == 10);
+    assert(kr_keytable_size(ptKeyTable) > KEY_NUMBER/2);
+    for (int i=0; i<KEY_NUMBER; i++) {
+        kr_keytable_sweep(ptKeyTable, &uiCursor, 10, SweepFunc, ptKeyTable);
+    }
+    assert(kr_keytable_size(ptKeyTable) == KEY_NUMBER/2);
+    for (long i=1; i<=KEY_NUMBER; i++) {
+        assert(kr_keytable_lookup(ptKeyTable, &i) == (i%2 ? (void *)i : NULL));
+    }
+
+    kr_keytable_destroy(ptKeyTable);
+}
+
+
+static void test_slab(void)
+{
+    void *ptr[1000];
+    T_KRSlab *ptSlab = kr_slab_new(20, 64);
+    assert(ptSlab != NULL);
+
+    for (int i=0; i<1000; i++) {
+        ptr[i] = kr_slab_alloc(ptSlab);
+        assert(ptr[i] != NULL);
+        assert(((long )ptr[i] & 7) == 0);
+        memset(ptr[i], i & 0xff, 20);
+    }
+    assert(kr_slab_used(ptSlab) == 1000);
+    assert(kr_slab_bytes(ptSlab) >= 1000 * 24);
+
+    /*freed objects handed out again, zeroed*/
+    size_t uiBytes = kr_slab_bytes(ptSlab);
+    for (int i=0; i<500; i++) kr_slab_free(ptSlab, ptr[i]);
+    for (int i=0; i<500; i++) {
+        ptr[i] = kr_slab_alloc(ptSlab);
+        for (int j=0; j<20; j++) assert(((char *)ptr[i])[j] == 0);
+    }
+    assert(kr_slab_bytes(ptSlab) == uiBytes);
+
+    /*destroyed with objects out, released by the last freed*/
+    kr_slab_destroy(ptSlab);
+    for (int i=0; i<1000; i++) kr_slab_free(ptSlab, ptr[i]);
+}
+
+
+int main()
+{
+    test_long();
+    test_int_double();
+    test_string();
+    test_sweep();
+    test_slab();
+
+    printf("Success!\n");
+    return 0;
+}
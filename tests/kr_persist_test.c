@@ -0,0 +1,305 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <assert.h>
+
+#include "krutils/kr_utils.h"
+#include "krdb/kr_db.h"
+
+#define BATCH_ROWS  4
+#define BATCH_MSEC  20
+#define CELL_CNT    8
+
+/*proctime, transtime, key and amount, all long*/
+typedef struct _tradflow_t {
+    long lProcTime;
+    long lTransTime;
+    long lKey;
+    long lAmt;
+}T_TradFlow;
+
+/*the driver manager, rows bound by kr_db_external_insert_rows kept*/
+static char           *gpsDatasrc;
+static char           *gpsKeyValue;
+static char           *gpsRecord;
+static SQLULEN        gulStride;
+static SQLULEN        gulRows;
+static SQLULEN        *gpulProcessed;
+static volatile int   giHold = 0;        /* executes wait while set */
+static volatile int   giHeld = 0;        /* an execute is waiting */
+static int            giFailCnt = 0;     /* executes failed from now */
+static int            giConnectCnt = 0;
+static int            giExecuteCnt = 0;
+static long           glRowCnt = 0;
+static SQLULEN        gulMaxRows = 0;
+static long           glAmt[64];
+static struct timeval gtvExecute[8];
+
+
+SQLRETURN SQLAllocHandle(SQLSMALLINT HandleType, SQLHANDLE InputHandle,
+        SQLHANDLE *OutputHandle)
+{
+    *OutputHandle = (SQLHANDLE )(long )(HandleType+1);
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLFreeHandle(SQLSMALLINT HandleType, SQLHANDLE Handle)
+{
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLSetEnvAttr(SQLHENV EnvironmentHandle, SQLINTEGER Attribute,
+        SQLPOINTER Value, SQLINTEGER StringLength)
+{
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLSetConnectAttr(SQLHDBC ConnectionHandle, SQLINTEGER Attribute,
+        SQLPOINTER Value, SQLINTEGER StringLength)
+{
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLConnect(SQLHDBC ConnectionHandle,
+        SQLCHAR *ServerName, SQLSMALLINT NameLength1,
+        SQLCHAR *UserName, SQLSMALLINT NameLength2,
+        SQLCHAR *Authentication, SQLSMALLINT NameLength3)
+{
+    giConnectCnt++;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLDisconnect(SQLHDBC ConnectionHandle)
+{
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLEndTran(SQLSMALLINT HandleType, SQLHANDLE Handle,
+        SQLSMALLINT CompletionType)
+{
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLGetDiagRec(SQLSMALLINT HandleType, SQLHANDLE Handle,
+        SQLSMALLINT RecNumber, SQLCHAR *Sqlstate, SQLINTEGER *NativeError,
+        SQLCHAR *MessageText, SQLSMALLINT BufferLength,
+        SQLSMALLINT *TextLength)
+{
+    return SQL_NO_DATA;
+}
+
+SQLRETURN SQLSetStmtAttr(SQLHSTMT StatementHandle, SQLINTEGER Attribute,
+        SQLPOINTER Value, SQLINTEGER StringLength)
+{
+    if (Attribute == SQL_ATTR_PARAM_BIND_TYPE) {
+        gulStride = (SQLULEN )Value;
+    } else if (Attribute == SQL_ATTR_PARAMSET_SIZE) {
+        gulRows = (SQLULEN )Value;
+    } else if (Attribute == SQL_ATTR_PARAMS_PROCESSED_PTR) {
+        gpulProcessed = (SQLULEN *)Value;
+    }
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLPrepare(SQLHSTMT StatementHandle, SQLCHAR *StatementText,
+        SQLINTEGER TextLength)
+{
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLBindParameter(SQLHSTMT hstmt, SQLUSMALLINT ipar,
+        SQLSMALLINT fParamType, SQLSMALLINT fCType, SQLSMALLINT fSqlType,
+        SQLULEN cbColDef, SQLSMALLINT ibScale, SQLPOINTER rgbValue,
+        SQLLEN cbValueMax, SQLLEN *pcbValue)
+{
+    /*DATASRC_ID, PROC_TIME, TRANS_TIME, KEY_VALUE, RECORD_LENGTH, ...*/
+    if (ipar == 1) gpsDatasrc = rgbValue;
+    else if (ipar == 4) gpsKeyValue = rgbValue;
+    else if (ipar == 6) gpsRecord = rgbValue;
+    return SQL_SUCCESS;
+}
+
+SQLRETURN SQLExecute(SQLHSTMT StatementHandle)
+{
+    giHeld = giHold;
+    while (giHold) usleep(1000);
+
+    gettimeofday(&gtvExecute[giExecuteCnt++ % 8], NULL);
+    if (giFailCnt > 0) {
+        giFailCnt--;
+        *gpulProcessed = 0;
+        return SQL_ERROR;
+    }
+
+    for (SQLULEN i=0; i<gulRows; i++) {
+        T_TradFlow *ptFlow = (T_TradFlow *)(gpsRecord + i*gulStride);
+        char caKeyValue[KR_EXTERNAL_KEY_SIZE+1];
+        snprintf(caKeyValue, sizeof(caKeyValue), "%ld", ptFlow->lKey);
+        assert(*(long *)(gpsDatasrc + i*gulStride) == 1);
+        assert(strcmp(gpsKeyValue + i*gulStride, caKeyValue) == 0);
+        glAmt[glRowCnt++] = ptFlow->lAmt;
+    }
+    if (gulRows > gulMaxRows) gulMaxRows = gulRows;
+    *gpulProcessed = gulRows;
+    return SQL_SUCCESS;
+}
+
+
+static T_KRTable *create_table(T_KRDB *ptDB)
+{
+    T_KRTable *ptTable = kr_table_create(ptDB, 1, "flow",
+            KR_SIZEKEEPMODE_RECORD, 16);
+    assert(ptTable != NULL);
+    ptTable->iFieldCnt = 4;
+    ptTable->ptFieldDef = kr_calloc(sizeof(T_KRFieldDef)*4);
+    for (int i=0; i<4; i++) {
+        ptTable->ptFieldDef[i].id = i;
+        ptTable->ptFieldDef[i].type = KR_TYPE_LONG;
+        ptTable->ptFieldDef[i].length = sizeof(long);
+        ptTable->ptFieldDef[i].offset = i*sizeof(long);
+    }
+    ptTable->iRecordSize = (sizeof(T_KRRecord)+sizeof(T_TradFlow)+0xf) & ~0xf;
+    ptTable->pRecordBuff = kr_calloc(ptTable->iRecordSize*16);
+    assert(ptTable->pRecordBuff != NULL);
+    return ptTable;
+}
+
+
+static int put(T_KRDB *ptDB, T_KRTable *ptTable, long lAmt)
+{
+    T_TradFlow stFlow = {1000+lAmt, 1000+lAmt, lAmt%3, lAmt};
+    return kr_persist_put(ptDB->ptPersist, ptTable,
+            (char *)&stFlow, sizeof(stFlow));
+}
+
+
+static void reset(void)
+{
+    giConnectCnt = giExecuteCnt = 0;
+    glRowCnt = 0;
+    gulMaxRows = 0;
+}
+
+
+/*a full ring drops rows instead of waiting for the writer*/
+static void test_drop(T_KRDB *ptDB, T_KRTable *ptTable)
+{
+    reset();
+    assert(kr_db_persist_start(ptDB, BATCH_ROWS, 1000, CELL_CNT, 0) == 0);
+    T_KRPersist *ptPersist = ptDB->ptPersist;
+
+    /*a batch worth wakes the writer, held inserting it*/
+    giHold = 1;
+    for (long i=0; i<BATCH_ROWS; i++) {
+        assert(put(ptDB, ptTable, i) == 0);
+    }
+    while (!giHeld) usleep(1000);
+
+    /*cells of the batch are not handed back until it is written*/
+    for (long i=BATCH_ROWS; i<CELL_CNT; i++) {
+        assert(put(ptDB, ptTable, i) == 0);
+    }
+    for (long i=CELL_CNT; i<CELL_CNT+3; i++) {
+        assert(put(ptDB, ptTable, i) == -1);
+    }
+    assert(ptPersist->ulDropped == 3);
+    giHold = 0;
+
+    kr_db_persist_stop(ptDB);
+    assert(glRowCnt == CELL_CNT);
+    for (long i=0; i<CELL_CNT; i++) {
+        assert(glAmt[i] == i);
+    }
+    assert(giExecuteCnt == 2);
+    assert(giConnectCnt == 1);
+}
+
+
+/*batches never exceed iBatchRows, rows are written in order*/
+static void test_batch(T_KRDB *ptDB, T_KRTable *ptTable)
+{
+    reset();
+    assert(kr_db_persist_start(ptDB, BATCH_ROWS, BATCH_MSEC, CELL_CNT, 0) == 0);
+    T_KRPersist *ptPersist = ptDB->ptPersist;
+
+    long lCnt = 0;
+    while (lCnt < 30) {
+        if (put(ptDB, ptTable, lCnt) == 0) lCnt++;
+        else usleep(1000);
+    }
+    /*the timer flushes what is left*/
+    while (ptPersist->ulCommitted < (unsigned long )lCnt) usleep(1000);
+    assert(ptPersist->ulBatches == (unsigned long )giExecuteCnt);
+    assert(gulMaxRows <= BATCH_ROWS);
+    assert(ptPersist->lLastFlushUsec >= 0);
+    assert(ptPersist->tLastCommit > 0);
+
+    kr_db_persist_stop(ptDB);
+    assert(glRowCnt == lCnt);
+    for (long i=0; i<lCnt; i++) {
+        assert(glAmt[i] == i);
+    }
+}
+
+
+/*a batch failed is tried again on a new connection, later each time*/
+static void test_retry(T_KRDB *ptDB, T_KRTable *ptTable)
+{
+    reset();
+    assert(kr_db_persist_start(ptDB, BATCH_ROWS, BATCH_MSEC, CELL_CNT, 3) == 0);
+    T_KRPersist *ptPersist = ptDB->ptPersist;
+    giFailCnt = 2;
+    for (long i=0; i<3; i++) {
+        assert(put(ptDB, ptTable, i) == 0);
+    }
+    kr_db_persist_stop(ptDB);
+    assert(glRowCnt == 3);
+    assert(giExecuteCnt == 3);
+    assert(giConnectCnt == 3);
+
+    /*waited BATCH_MSEC, then twice as long*/
+    for (int i=1; i<3; i++) {
+        long lUsec = (gtvExecute[i].tv_sec-gtvExecute[i-1].tv_sec)*1000000L +
+            (gtvExecute[i].tv_usec-gtvExecute[i-1].tv_usec);
+        assert(lUsec >= i*BATCH_MSEC*1000L);
+    }
+
+    /*given up after the retries, counted as failed*/
+    reset();
+    assert(kr_db_persist_start(ptDB, BATCH_ROWS, BATCH_MSEC, CELL_CNT, 1) == 0);
+    ptPersist = ptDB->ptPersist;
+    giFailCnt = 100;
+    for (long i=0; i<3; i++) {
+        assert(put(ptDB, ptTable, i) == 0);
+    }
+    while (ptPersist->ulFailed < 3) usleep(1000);
+    assert(ptPersist->ulRetries == 1);
+    assert(ptPersist->ulCommitted == 0);
+    kr_db_persist_stop(ptDB);
+    giFailCnt = 0;
+}
+
+
+int main(void)
+{
+    T_DbsEnv stDbsEnv = {0};
+    stDbsEnv.dsn = (SQLCHAR *)"test";
+    stDbsEnv.user = (SQLCHAR *)"test";
+    stDbsEnv.pass = (SQLCHAR *)"test";
+
+    T_KRDB *ptDB = kr_db_create("test", &stDbsEnv, NULL);
+    T_KRTable *ptTable = create_table(ptDB);
+    kr_index_create(ptDB, 1, "key", KR_TYPE_LONG);
+    assert(kr_index_table_create(ptDB, 1, 1, 2, 1) != NULL);
+
+    test_drop(ptDB, ptTable);
+    test_batch(ptDB, ptTable);
+    test_retry(ptDB, ptTable);
+
+    kr_db_drop(ptDB);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "krutils/kr_utils.h"
+#include "krdb/kr_db.h"
+#include "krdata/kr_data.h"
+
+#define KEEP_CNT   4
+#define WINDOW     400
+
+/*proctime, transtime, key and amount, all long*/
+typedef struct _tradflow_t {
+    long lProcTime;
+    long lTransTime;
+    long lKey;
+    long lAmt;
+}T_TradFlow;
+
+
+static T_KRTable *create_table(T_KRDB *ptDB)
+{
+    T_KRTable *ptTable = kr_table_create(ptDB, 1, "flow",
+            KR_SIZEKEEPMODE_RECORD, KEEP_CNT);
+    assert(ptTable != NULL);
+    ptTable->iFieldCnt = 4;
+    ptTable->ptFieldDef = kr_calloc(sizeof(T_KRFieldDef)*4);
+    for (int i=0; i<4; i++) {
+        ptTable->ptFieldDef[i].id = i;
+        ptTable->ptFieldDef[i].type = KR_TYPE_LONG;
+        ptTable->ptFieldDef[i].length = sizeof(long);
+        ptTable->ptFieldDef[i].offset = i*sizeof(long);
+    }
+    /*aligned as kr_db_define does*/
+    ptTable->iRecordSize = (sizeof(T_KRRecord)+sizeof(T_TradFlow)+0xf) & ~0xf;
+    ptTable->pRecordBuff = kr_calloc(ptTable->iRecordSize*KEEP_CNT);
+    assert(ptTable->pRecordBuff != NULL);
+    return ptTable;
+}
+
+
+static void insert(T_KRTable *ptTable, long lKey, long lTransTime, long lAmt)
+{
+    T_KRRecord *ptRecord = kr_record_new(ptTable);
+    T_TradFlow *ptFlow = (T_TradFlow *)ptRecord->pRecBuf;
+    ptFlow->lProcTime = ptFlow->lTransTime = lTransTime;
+    ptFlow->lKey = lKey;
+    ptFlow->lAmt = lAmt;
+    kr_record_insert(ptRecord);
+}
+
+
+/*min and max of key's values in the window ending at tTime*/
+static void window_range(T_KRIndex *ptIndex, int iQuantileId, long lKey, 
+        time_t tTime, double *pdMin, double *pdMax)
+{
+    T_KRTDigest *ptTDigest = kr_tdigest_new(100);
+    assert(kr_index_quantile_merge(ptIndex, iQuantileId, WINDOW, 
+                &lKey, tTime, ptTDigest) > 0);
+    *pdMin = kr_tdigest_quantile(ptTDigest, 0);
+    *pdMax = kr_tdigest_quantile(ptTDigest, 1);
+    kr_tdigest_free(ptTDigest);
+}
+
+
+static void test_quantile(void)
+{
+    T_KRDB *ptDB = kr_db_create("test", NULL, NULL);
+    T_KRTable *ptTable = create_table(ptDB);
+    kr_index_create(ptDB, 1, "key", KR_TYPE_LONG);
+    T_KRIndexTable *ptIndexTable = kr_index_table_create(ptDB, 1, 1, 2, 1);
+    T_KRIndex *ptIndex = ptIndexTable->ptIndex;
+
+    int iQuantileId = kr_index_quantile_register(ptIndexTable, 3, WINDOW, 100);
+    assert(iQuantileId >= 0);
+    assert(kr_index_quantile_register(ptIndexTable, 3, WINDOW, 100) == iQuantileId);
+    assert(kr_index_quantile_register(ptIndexTable, 3, 0, 100) < 0);
+
+    /*panes of WINDOW/4 seconds, one partly in the window is merged whole*/
+    double dMin, dMax;
+    insert(ptTable, 7, 1000, 5);
+    insert(ptTable, 7, 1150, 50);
+    insert(ptTable, 7, 1390, 7);
+    insert(ptTable, 7, 1420, 9);
+    window_range(ptIndex, iQuantileId, 7, 1420, &dMin, &dMax);
+    assert(dMin == 5 && dMax == 50);
+    window_range(ptIndex, iQuantileId, 7, 1560, &dMin, &dMax);
+    assert(dMin == 7 && dMax == 50);
+    window_range(ptIndex, iQuantileId, 7, 1600, &dMin, &dMax);
+    assert(dMin == 7 && dMax == 9);
+
+    /*records not kept any more still count, a late one of a pane 
+     *reused already is dropped*/
+    insert(ptTable, 7, 1510, 3);
+    insert(ptTable, 7, 1020, 1000);
+    window_range(ptIndex, iQuantileId, 7, 1520, &dMin, &dMax);
+    assert(dMin == 3 && dMax == 50);
+
+    long lOther = 8;
+    T_KRTDigest *ptTDigest = kr_tdigest_new(100);
+    assert(kr_index_quantile_merge(ptIndex, iQuantileId, WINDOW, 
+                &lOther, 1520, ptTDigest) == 0);
+    kr_tdigest_free(ptTDigest);
+
+    kr_db_drop(ptDB);
+}
+
+
+static void test_register(void)
+{
+    T_KRDB *ptDB = kr_db_create("test", NULL, NULL);
+    create_table(ptDB);
+    kr_index_create(ptDB, 1, "key", KR_TYPE_LONG);
+    T_KRIndexTable *ptIndexTable = kr_index_table_create(ptDB, 1, 1, 2, 1);
+
+    T_KRParamDDI *ptParamDDI = kr_calloc(sizeof(T_KRParamDDI));
+    T_KRParamDDIDef *ptParamDDIDef = &ptParamDDI->stParamDDIDef[0];
+    ptParamDDI->lDDIDefCnt = 1;
+    ptParamDDIDef->lDdiId = 1;
+    ptParamDDIDef->lStatisticsDatasrc = 1;
+    ptParamDDIDef->lStatisticsIndex = 1;
+    ptParamDDIDef->lStatisticsField = 3;
+    ptParamDDIDef->lStatisticsValue = WINDOW;
+    ptParamDDIDef->caStatisticsMethod[0] = KR_DDI_METHOD_QUANTILE;
+
+    /*panes see every record, the current one always included*/
+    ptParamDDIDef->caStatisticsType[0] = KR_DDI_STATISTICS_EXCLUDE;
+    assert(kr_ddi_table_register(ptParamDDI, ptDB) != 0);
+    ptParamDDIDef->caStatisticsType[0] = KR_DDI_STATISTICS_INCLUDE;
+    strcpy(ptParamDDIDef->caDdiFilterString, "C_3 > 10");
+    assert(kr_ddi_table_register(ptParamDDI, ptDB) != 0);
+    ptParamDDIDef->caDdiFilterString[0] = '\0';
+    assert(kr_ddi_table_register(ptParamDDI, ptDB) == 0);
+
+    /*registered at load, the same panes found again*/
+    assert(kr_index_quantile_register(ptIndexTable, 3, WINDOW, 100) == 0);
+
+    kr_free(ptParamDDI);
+    kr_db_drop(ptDB);
+}
+
+
+int main()
+{
+    test_quantile();
+    test_register();
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "krutils/kr_utils.h"
+#include "krdb/kr_db.h"
+#include "krdata/kr_data.h"
+
+#define KEY_CNT    5
+#define WINDOW     20
+#define EVENT_CNT  600
+
+/*proctime, transtime, key, amount and price*/
+typedef struct _tradflow_t {
+    long   lProcTime;
+    long   lTransTime;
+    long   lKey;
+    long   lAmt;
+    double dPrice;
+}T_TradFlow;
+
+
+static T_KRTable *create_table(T_KRDB *ptDB, int iTableId, long lKeep)
+{
+    T_KRTable *ptTable = kr_table_create(ptDB, iTableId, "flow",
+            KR_SIZEKEEPMODE_RECORD, lKeep);
+    assert(ptTable != NULL);
+    ptTable->iFieldCnt = 5;
+    ptTable->ptFieldDef = kr_calloc(sizeof(T_KRFieldDef)*5);
+    for (int i=0; i<5; i++) {
+        ptTable->ptFieldDef[i].id = i;
+        ptTable->ptFieldDef[i].type = i == 4 ? KR_TYPE_DOUBLE : KR_TYPE_LONG;
+        ptTable->ptFieldDef[i].length = sizeof(long);
+        ptTable->ptFieldDef[i].offset = i*sizeof(long);
+    }
+    /*aligned as kr_db_define does*/
+    ptTable->iRecordSize = (sizeof(T_KRRecord)+sizeof(T_TradFlow)+0xf) & ~0xf;
+    ptTable->pRecordBuff = kr_calloc(ptTable->iRecordSize*lKeep);
+    assert(ptTable->pRecordBuff != NULL);
+    return ptTable;
+}
+
+
+/*a run DDI, then the same one with a filter passing every record,
+ *which is scanned*/
+static void define(T_KRParamDDI *ptParamDDI, char cMethod, long lField)
+{
+    for (int i=0; i<2; i++) {
+        T_KRParamDDIDef *ptParamDDIDef = \
+            &ptParamDDI->stParamDDIDef[ptParamDDI->lDDIDefCnt++];
+        ptParamDDIDef->lDdiId = ptParamDDI->lDDIDefCnt;
+        ptParamDDIDef->lStatisticsDatasrc = 1;
+        ptParamDDIDef->lStatisticsIndex = 1;
+        ptParamDDIDef->lStatisticsField = lField;
+        ptParamDDIDef->lStatisticsValue = WINDOW;
+        ptParamDDIDef->caStatisticsType[0] = KR_DDI_STATISTICS_INCLUDE;
+        ptParamDDIDef->caStatisticsMethod[0] = cMethod;
+        ptParamDDIDef->caDdiFilterFormat[0] = KR_CALCFORMAT_FLEX;
+        ptParamDDIDef->caDdiValueType[0] = KR_TYPE_LONG;
+        if (i == 1) strcpy(ptParamDDIDef->caDdiFilterString, "F_0 > 0;");
+    }
+}
+
+
+/*DDI id computed, its cursor cleared to tell the path*/
+static T_KRDDI *compute(T_KRData *ptData, int id)
+{
+    T_KRDDI *ptDDI = kr_ddi_lookup(ptData->ptDdiTable, id);
+    assert(ptDDI != NULL);
+    memset(&ptDDI->stCursor, 0x00, sizeof(ptDDI->stCursor));
+    assert(kr_data_get_value(KR_CALCKIND_DID, id, ptData) != NULL);
+    return ptDDI;
+}
+
+
+int main(void)
+{
+    T_KRDB *ptDB = kr_db_create("test", NULL, NULL);
+    T_KRTable *ptTable1 = create_table(ptDB, 1, 60);
+    T_KRTable *ptTable2 = create_table(ptDB, 2, 80);
+    kr_index_create(ptDB, 1, "key", KR_TYPE_LONG);
+    assert(kr_index_table_create(ptDB, 1, 1, 2, 1) != NULL);
+    assert(kr_index_table_create(ptDB, 1, 2, 2, 1) != NULL);
+
+    T_KRParamDDI *ptParamDDI = kr_calloc(sizeof(T_KRParamDDI));
+    define(ptParamDDI, KR_DDI_METHOD_CON_INC, 3);
+    define(ptParamDDI, KR_DDI_METHOD_CON_DEC, 3);
+    define(ptParamDDI, KR_DDI_METHOD_CON_INC, 4);
+    ptParamDDI->tLastLoadTime = 1;
+
+    /*runs registered before any record inserted*/
+    T_KRDDITable *ptDdiTable = kr_ddi_table_construct(ptParamDDI, NULL,
+            kr_data_get_type, kr_data_get_value);
+    assert(ptDdiTable != NULL);
+    assert(kr_ddi_table_register(ptParamDDI, ptDB) == 0);
+
+    T_KRParamSDI *ptParamSDI = kr_calloc(sizeof(T_KRParamSDI));
+    T_KRData stData = {0};
+    stData.ptSdiTable = kr_sdi_table_construct(ptParamSDI, NULL,
+            kr_data_get_type, kr_data_get_value);
+    stData.ptDdiTable = ptDdiTable;
+
+    /*more than kept, transtime a little out of order*/
+    int iKept = 0, iTotal = 0;
+    srand(11);
+    for (int i=0; i<EVENT_CNT; i++) {
+        T_KRTable *ptTable = (rand()%3) ? ptTable1 : ptTable2;
+        T_KRRecord *ptRecord = kr_record_new(ptTable);
+        T_TradFlow *ptFlow = (T_TradFlow *)ptRecord->pRecBuf;
+        ptFlow->lProcTime = 1000+i;
+        ptFlow->lTransTime = 1000+i-rand()%4;
+        ptFlow->lKey = rand()%KEY_CNT;
+        ptFlow->lAmt = rand()%10;
+        ptFlow->dPrice = (rand()%100)/10.0;
+        kr_record_insert(ptRecord);
+
+        kr_data_filter_record(&stData, ptRecord);
+        stData.ptCurrRec = ptRecord;
+
+        for (int id=1; id<=ptParamDDI->lDDIDefCnt; id+=2) {
+            T_KRDDI *ptRunDDI = compute(&stData, id);
+            T_KRDDI *ptScanDDI = compute(&stData, id+1);
+            iTotal++;
+            if (ptRunDDI->stCursor.ptIndex == NULL) iKept++;
+            assert(ptRunDDI->uValue.l == ptScanDDI->uValue.l);
+        }
+    }
+
+    /*rows scanned only if the run left the window or a record of it*/
+    printf("kept %d of %d\n", iKept, iTotal);
+    assert(iKept > iTotal/2);
+
+    kr_sdi_table_destruct(stData.ptSdiTable);
+    kr_ddi_table_destruct(ptDdiTable);
+    kr_free(ptParamSDI);
+    kr_free(ptParamDDI);
+    kr_db_drop(ptDB);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "krutils/kr_utils.h"
+#include "krdb/kr_db.h"
+#include "krdb/kr_db_segment.h"
+
+#define KEEP_SECS  100
+#define KEY_CNT    7
+
+/*proctime, transtime, key and amount, all long*/
+typedef struct _tradflow_t {
+    long lProcTime;
+    long lTransTime;
+    long lKey;
+    long lAmt;
+}T_TradFlow;
+
+
+static T_KRTable *create_table(T_KRDB *ptDB)
+{
+    T_KRTable *ptTable = kr_table_create(ptDB, 1, "flow",
+            KR_SIZEKEEPMODE_TIME, KEEP_SECS);
+    assert(ptTable != NULL);
+    ptTable->iFieldCnt = 4;
+    ptTable->ptFieldDef = kr_calloc(sizeof(T_KRFieldDef)*4);
+    for (int i=0; i<4; i++) {
+        ptTable->ptFieldDef[i].id = i;
+        ptTable->ptFieldDef[i].type = KR_TYPE_LONG;
+        ptTable->ptFieldDef[i].length = sizeof(long);
+        ptTable->ptFieldDef[i].offset = i*sizeof(long);
+    }
+    /*aligned as kr_db_define does, segments are allocated on insert*/
+    ptTable->iRecordSize = (sizeof(T_KRRecord)+sizeof(T_TradFlow)+0xf) & ~0xf;
+    return ptTable;
+}
+
+
+static void insert(T_KRTable *ptTable, long lTransTime, long lAmt)
+{
+    T_KRRecord *ptRecord = kr_record_new(ptTable);
+    assert(ptRecord != NULL);
+    T_TradFlow *ptFlow = (T_TradFlow *)ptRecord->pRecBuf;
+    ptFlow->lProcTime = ptFlow->lTransTime = lTransTime;
+    ptFlow->lKey = lAmt % KEY_CNT;
+    ptFlow->lAmt = lAmt;
+    kr_record_insert(ptRecord);
+}
+
+
+/*records of every key in the index*/
+static long slot_records(T_KRIndex *ptIndex)
+{
+    long lCnt = 0;
+    for (long lKey=0; lKey<KEY_CNT; lKey++) {
+        T_KRIndexSolt *ptIndexSlot = kr_index_slot_hold(ptIndex, &lKey);
+        if (ptIndexSlot == NULL) continue;
+        lCnt += kr_list_length(ptIndexSlot->pRecList);
+        kr_index_slot_release(ptIndexSlot);
+    }
+    return lCnt;
+}
+
+
+int main(void)
+{
+    T_KRDB *ptDB = kr_db_create("test", NULL, NULL);
+    T_KRTable *ptTable = create_table(ptDB);
+    kr_index_create(ptDB, 1, "key", KR_TYPE_LONG);
+    T_KRIndexTable *ptIndexTable = kr_index_table_create(ptDB, 1, 1, 2, 1);
+    assert(ptIndexTable != NULL);
+    T_KREpoch *ptEpoch = ptDB->ptEpoch;
+
+    /*a reader inside keeps whatever is retired meanwhile*/
+    T_KREpochReader *ptReader = kr_epoch_register(ptEpoch);
+    kr_epoch_enter(ptEpoch, ptReader);
+
+    /*all within the keep value, the directory's segments fill up*/
+    long lAmt = 0;
+    long lFull = (long )KR_SEGMENT_DIR_INIT*KR_SEGMENT_RECORDS;
+    for (; lAmt<lFull; lAmt++) {
+        insert(ptTable, 1000+lAmt/1000, lAmt);
+    }
+    T_KRSegmentDir *ptOldDir = ptTable->ptSegDir;
+    assert(ptOldDir->uiCap == KR_SEGMENT_DIR_INIT);
+    assert(ptTable->ulSegAllocCnt == KR_SEGMENT_DIR_INIT);
+    assert(ptTable->ulSegFreeCnt == 0);
+    assert(ptEpoch->pending == 0);
+
+    /*one more segment grows it, the old one retired, not freed*/
+    for (; lAmt<lFull+10; lAmt++) {
+        insert(ptTable, 1000+lAmt/1000, lAmt);
+    }
+    assert(ptTable->ptSegDir != ptOldDir);
+    assert(ptTable->ptSegDir->uiCap == KR_SEGMENT_DIR_INIT*2);
+    assert(ptTable->ulSegAllocCnt == KR_SEGMENT_DIR_INIT+1);
+    assert(ptEpoch->pending == 1);
+    for (unsigned int n=0; n<KR_SEGMENT_DIR_INIT; n++) {
+        assert(ptOldDir->ptSegment[n] == kr_table_segment(ptTable, n));
+    }
+    assert(slot_records(ptIndexTable->ptIndex) == lAmt);
+
+    /*every record of a location is found through the new directory*/
+    T_KRRecord *ptFirst = kr_record_at(ptTable, 0);
+    assert(((T_TradFlow *)ptFirst->pRecBuf)->lAmt == 0);
+    T_KRRecord *ptLast = kr_record_at(ptTable, (unsigned int )lAmt-1);
+    assert(((T_TradFlow *)ptLast->pRecBuf)->lAmt == lAmt-1);
+    kr_epoch_exit(ptReader);
+
+    /*a record past the keep value expires every segment but the last*/
+    long lLate = 1000+lAmt/1000+KEEP_SECS+1;
+    insert(ptTable, lLate, lAmt++);
+    assert(ptTable->ulSegFreeCnt == 0);
+    insert(ptTable, lLate, lAmt++);
+    assert(ptTable->ulSegFreeCnt == KR_SEGMENT_DIR_INIT);
+    assert(ptTable->uiSegNext - ptTable->uiSegHead == 1);
+    assert(kr_table_segment(ptTable, 0) == NULL);
+    assert(slot_records(ptIndexTable->ptIndex) == 12);
+
+    /*nobody inside, the old directory and the segments are freed*/
+    assert(ptEpoch->pending == 0);
+    assert(ptEpoch->freed == KR_SEGMENT_DIR_INIT+1);
+
+    kr_epoch_unregister(ptReader);
+    kr_db_drop(ptDB);
+
+    printf("Success!\n");
+    return 0;
+}
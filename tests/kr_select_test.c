@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "krutils/kr_utils.h"
+#include "krdb/kr_db.h"
+#include "dbs/dbs/record_key_cur.h"
+
+#define KEEP_CNT   4
+#define EXT_MAX    32
+
+/*proctime, transtime, key and amount, all long*/
+typedef struct _tradflow_t {
+    long lProcTime;
+    long lTransTime;
+    long lKey;
+    long lAmt;
+}T_TradFlow;
+
+/*rows of kr_tbl_record, every record inserted is persisted*/
+typedef struct _ext_row_t {
+    long       lDatasrcId;
+    char       caKeyValue[KR_EXTERNAL_KEY_SIZE+1];
+    T_TradFlow stFlow;
+}T_ExtRow;
+
+static T_ExtRow  gstExtRow[EXT_MAX];
+static int       giExtCnt = 0;
+static int       giFetched[EXT_MAX];  /* rows the cursor returns in order */
+static int       giFetchCnt = 0;
+static int       giFetchPos = 0;
+static int       giOpenCnt = 0;
+static T_DbsEnv  gstDbsEnv;
+
+
+/*the cursor of t_dbs123_record_key_cur.cfg over gstExtRow*/
+int dbsRecordKeyCur(T_DbsEnv *dbsenv, int iFuncCode, T_RecordKeyCur *ptCur)
+{
+    switch(iFuncCode) {
+    case KR_DBCUROPEN:
+        giOpenCnt++;
+        giFetchCnt = giFetchPos = 0;
+        for (int i=0; i<giExtCnt; i++) {
+            T_ExtRow *ptRow = &gstExtRow[i];
+            if (ptRow->lDatasrcId != ptCur->lInDatasrcId ||
+                strcmp(ptRow->caKeyValue, ptCur->caInKeyValue) != 0 ||
+                ptRow->stFlow.lTransTime < ptCur->lInBeginTransTime ||
+                ptRow->stFlow.lTransTime > ptCur->lInEndTransTime) {
+                continue;
+            }
+            /*order by TRANS_TIME DESC*/
+            int j = giFetchCnt++;
+            while (j > 0 && gstExtRow[giFetched[j-1]].stFlow.lTransTime <
+                    ptRow->stFlow.lTransTime) {
+                giFetched[j] = giFetched[j-1];
+                j--;
+            }
+            giFetched[j] = i;
+        }
+        return KR_DBOK;
+    case KR_DBCURFETCH:
+        if (giFetchPos == giFetchCnt) return KR_DBNOTFOUND;
+        T_ExtRow *ptRow = &gstExtRow[giFetched[giFetchPos++]];
+        memcpy(ptCur->caOutRecordBuffer, &ptRow->stFlow, sizeof(T_TradFlow));
+        ptCur->lOutRecordLength = sizeof(T_TradFlow);
+        return KR_DBOK;
+    case KR_DBCURCLOSE:
+        return KR_DBOK;
+    default:
+        return -1;
+    }
+}
+
+
+static T_KRTable *create_table(T_KRDB *ptDB)
+{
+    T_KRTable *ptTable = kr_table_create(ptDB, 1, "flow",
+            KR_SIZEKEEPMODE_RECORD, KEEP_CNT);
+    assert(ptTable != NULL);
+    ptTable->iFieldCnt = 4;
+    ptTable->ptFieldDef = kr_calloc(sizeof(T_KRFieldDef)*4);
+    for (int i=0; i<4; i++) {
+        ptTable->ptFieldDef[i].id = i;
+        ptTable->ptFieldDef[i].type = KR_TYPE_LONG;
+        ptTable->ptFieldDef[i].length = sizeof(long);
+        ptTable->ptFieldDef[i].offset = i*sizeof(long);
+    }
+    /*aligned as kr_db_define does*/
+    ptTable->iRecordSize = (sizeof(T_KRRecord)+sizeof(T_TradFlow)+0xf) & ~0xf;
+    ptTable->pRecordBuff = kr_calloc(ptTable->iRecordSize*KEEP_CNT);
+    assert(ptTable->pRecordBuff != NULL);
+    return ptTable;
+}
+
+
+/*insert into memory and persist the row as kr_db_persist would*/
+static void insert(T_KRTable *ptTable, long lKey, long lTransTime)
+{
+    T_KRRecord *ptRecord = kr_record_new(ptTable);
+    T_TradFlow *ptFlow = (T_TradFlow *)ptRecord->pRecBuf;
+    ptFlow->lProcTime = ptFlow->lTransTime = lTransTime;
+    ptFlow->lKey = lKey;
+    ptFlow->lAmt = lTransTime*100;
+    kr_record_insert(ptRecord);
+
+    assert(giExtCnt < EXT_MAX);
+    T_ExtRow *ptRow = &gstExtRow[giExtCnt++];
+    ptRow->lDatasrcId = ptTable->iTableId;
+    kr_db_external_key(ptTable, ptRecord->pRecBuf, ptRow->caKeyValue);
+    memcpy(&ptRow->stFlow, ptFlow, sizeof(T_TradFlow));
+}
+
+
+/*transtimes selected, newest first, checked against plExpect*/
+static void check_select(T_KRDB *ptDB, int iIndexId, long lKey,
+        long lBegin, long lEnd, T_DbsEnv *dbsenv, long *plExpect, int iCnt)
+{
+    T_KRSelect *ptSelect = kr_db_select_open(ptDB, iIndexId, &lKey,
+            lBegin, lEnd, dbsenv);
+    assert(ptSelect != NULL);
+
+    int i = 0;
+    T_KRRecord *ptRecord = NULL;
+    while ((ptRecord = kr_db_select_next(ptSelect)) != NULL) {
+        T_TradFlow *ptFlow = (T_TradFlow *)ptRecord->pRecBuf;
+        assert(i < iCnt);
+        assert(ptFlow->lKey == lKey);
+        assert(ptFlow->lTransTime == plExpect[i]);
+        assert(ptFlow->lAmt == plExpect[i]*100);
+        i++;
+    }
+    assert(i == iCnt);
+    kr_db_select_close(ptSelect);
+}
+
+
+int main(void)
+{
+    T_KRDB *ptDB = kr_db_create("test", NULL, NULL);
+    T_KRTable *ptTable = create_table(ptDB);
+    kr_index_create(ptDB, 1, "key", KR_TYPE_LONG);
+    assert(kr_index_table_create(ptDB, 1, 1, 2, 1) != NULL);
+
+    /*the ring keeps the last four, key 7's 10 and 20 left memory*/
+    insert(ptTable, 7, 10);
+    insert(ptTable, 8, 15);
+    insert(ptTable, 7, 20);
+    insert(ptTable, 8, 25);
+    insert(ptTable, 7, 30);
+    insert(ptTable, 7, 40);
+    insert(ptTable, 8, 45);
+    insert(ptTable, 7, 50);
+    assert(strcmp(gstExtRow[0].caKeyValue, "7") == 0);
+
+    /*memory only, without dbsenv*/
+    long lLocal[] = {50, 40, 30};
+    check_select(ptDB, 1, 7, 0, 100, NULL, lLocal, 3);
+    assert(giOpenCnt == 0);
+
+    /*memory only, the range after what left memory*/
+    long lLocal2[] = {40, 30};
+    check_select(ptDB, 1, 7, 25, 45, &gstDbsEnv, lLocal2, 2);
+    assert(giOpenCnt == 0);
+
+    /*external only, none of key 8's rows fetched*/
+    long lExternal[] = {20, 10};
+    check_select(ptDB, 1, 7, 0, 25, &gstDbsEnv, lExternal, 2);
+    assert(giOpenCnt == 1);
+    assert(giFetchCnt == 2);
+
+    /*merged, external only up to what left memory*/
+    long lMerged[] = {50, 40, 30, 20, 10};
+    check_select(ptDB, 1, 7, 0, 100, &gstDbsEnv, lMerged, 5);
+    assert(giOpenCnt == 2);
+    assert(giFetchCnt == 2);
+
+    /*the rows keep index 1's key, another index can't select them*/
+    kr_index_create(ptDB, 2, "amt", KR_TYPE_LONG);
+    assert(kr_index_table_create(ptDB, 2, 1, 3, 1) != NULL);
+    long lAmt = 1000;
+    assert(kr_db_select_open(ptDB, 2, &lAmt, 0, 100, &gstDbsEnv) == NULL);
+    assert(giOpenCnt == 2);
+
+    kr_db_drop(ptDB);
+
+    printf("Success!\n");
+    return 0;
+}
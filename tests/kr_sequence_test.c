@@ -0,0 +1,77 @@
+#include "krutils/kr_utils.h"
+#include "krutils/kr_sequence.h"
+#include <assert.h>
+
+#define RESET   (1U << 0)
+#define NEWDEV  (1U << 1)
+#define TRANSF  (1U << 2)
+
+
+int main(int argc, char *argv[])
+{
+    /* password reset, new device login within 10 minutes,
+     * then large transfer, all within 30 minutes */
+    T_KRSeqPattern pattern = {0};
+    pattern.steps = 3;
+    pattern.window = 1800;
+    pattern.gap[1] = 600;
+
+    T_KRSequence *krseq = kr_sequence_new(pattern.steps);
+    assert(krseq != NULL);
+    assert(kr_sequence_new(KR_SEQUENCE_STEPS_MAX+1) == NULL);
+    assert(kr_sequence_progress(krseq, &pattern, 0) == 0);
+
+    kr_sequence_advance(krseq, &pattern, RESET, 1000);
+    assert(kr_sequence_progress(krseq, &pattern, 1000) == 1);
+    /* steps out of order are skipped */
+    kr_sequence_advance(krseq, &pattern, TRANSF, 1100);
+    assert(kr_sequence_progress(krseq, &pattern, 1100) == 1);
+    kr_sequence_advance(krseq, &pattern, NEWDEV, 1500);
+    assert(kr_sequence_progress(krseq, &pattern, 1500) == 2);
+    kr_sequence_advance(krseq, &pattern, TRANSF, 2700);
+    assert(kr_sequence_progress(krseq, &pattern, 2700) == 3);
+    printf("matched [%ld..%ld]\n", (long )krseq->runs[2].start,
+            (long )krseq->runs[2].last);
+    /* complete match lasts its window only */
+    assert(kr_sequence_progress(krseq, &pattern, 2800) == 3);
+    assert(kr_sequence_progress(krseq, &pattern, 2801) == 0);
+
+    /* too late for the whole window */
+    kr_sequence_reset(krseq);
+    kr_sequence_advance(krseq, &pattern, RESET, 0);
+    kr_sequence_advance(krseq, &pattern, NEWDEV, 500);
+    kr_sequence_advance(krseq, &pattern, TRANSF, 1801);
+    assert(kr_sequence_progress(krseq, &pattern, 1801) == 0);
+
+    /* step gap exceeded, a later reset restarts */
+    kr_sequence_reset(krseq);
+    kr_sequence_advance(krseq, &pattern, RESET, 0);
+    kr_sequence_advance(krseq, &pattern, NEWDEV, 601);
+    assert(kr_sequence_progress(krseq, &pattern, 601) == 1);
+    kr_sequence_advance(krseq, &pattern, RESET, 700);
+    kr_sequence_advance(krseq, &pattern, NEWDEV, 800);
+    kr_sequence_advance(krseq, &pattern, TRANSF, 900);
+    assert(kr_sequence_progress(krseq, &pattern, 900) == 3);
+    assert(krseq->runs[2].start == 700);
+
+    /* one event advances a run by one step only */
+    kr_sequence_reset(krseq);
+    kr_sequence_advance(krseq, &pattern, RESET|NEWDEV|TRANSF, 10);
+    assert(kr_sequence_progress(krseq, &pattern, 10) == 1);
+    kr_sequence_advance(krseq, &pattern, RESET|NEWDEV|TRANSF, 20);
+    kr_sequence_advance(krseq, &pattern, RESET|NEWDEV|TRANSF, 30);
+    assert(kr_sequence_progress(krseq, &pattern, 30) == 3);
+
+    /* active runs never exceed steps */
+    kr_sequence_reset(krseq);
+    for (int i = 0; i < 1000; i++) {
+        kr_sequence_advance(krseq, &pattern, (i%2) ? NEWDEV : RESET, i);
+    }
+    assert(krseq->live == NEWDEV);
+    assert(krseq->runs[1].start == 998 && krseq->runs[1].last == 999);
+
+    kr_sequence_free(krseq);
+
+    printf("Success!\n");
+    return 0;
+}
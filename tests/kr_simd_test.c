@@ -0,0 +1,151 @@
+#include "krutils/kr_utils.h"
+#include "krutils/kr_simd.h"
+#include <assert.h>
+#include <math.h>
+#include <time.h>
+
+#define VALUE_NUMBER   100003
+#define BENCH_ROUNDS   200
+
+static time_t gtTime[VALUE_NUMBER];
+static uint64_t guiMask[VALUE_NUMBER/64+1];
+static int giValue[VALUE_NUMBER];
+static long glValue[VALUE_NUMBER];
+static double gdValue[VALUE_NUMBER];
+
+
+/* what every level must return, the plain loop written out again */
+static void expect(size_t n, const T_KRSimdSel *ptSel, long *plCnt,
+        long *plSum, long *plMin, long *plMax, double *pdSum)
+{
+    *plCnt = 0; *plSum = 0; *plMin = 0; *plMax = 0; *pdSum = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (gtTime[i] < ptSel->tBegin || gtTime[i] > ptSel->tEnd) continue;
+        if (ptSel->puiMask && !((ptSel->puiMask[i/64] >> (i%64)) & 1)) continue;
+        (*plCnt)++;
+        *plSum += glValue[i];
+        *plMin = MIN(*plMin, glValue[i]);
+        *plMax = MAX(*plMax, glValue[i]);
+        *pdSum += gdValue[i];
+    }
+}
+
+
+static void check(size_t n, const T_KRSimdSel *ptSel)
+{
+    long lCnt, lSum, lMin, lMax, lAcc;
+    double dSum, dAcc;
+    expect(n, ptSel, &lCnt, &lSum, &lMin, &lMax, &dSum);
+
+    assert(kr_simd_count(n, ptSel) == lCnt);
+    lAcc = 0; assert(kr_simd_sum_int(giValue, n, ptSel, &lAcc) == lCnt);
+    assert(lAcc == lSum);
+    lAcc = 0; assert(kr_simd_min_int(giValue, n, ptSel, &lAcc) == lCnt);
+    assert(lAcc == lMin);
+    lAcc = 0; assert(kr_simd_max_int(giValue, n, ptSel, &lAcc) == lCnt);
+    assert(lAcc == lMax);
+    lAcc = 0; assert(kr_simd_sum_long(glValue, n, ptSel, &lAcc) == lCnt);
+    assert(lAcc == lSum);
+    lAcc = 0; assert(kr_simd_min_long(glValue, n, ptSel, &lAcc) == lCnt);
+    assert(lAcc == lMin);
+    lAcc = 0; assert(kr_simd_max_long(glValue, n, ptSel, &lAcc) == lCnt);
+    assert(lAcc == lMax);
+    /*doubles summed in lanes*/
+    dAcc = 0; assert(kr_simd_sum_double(gdValue, n, ptSel, &dAcc) == lCnt);
+    assert(fabs(dAcc - dSum) <= 1e-9 * (fabs(dSum) + 1));
+    dAcc = 0; assert(kr_simd_min_double(gdValue, n, ptSel, &dAcc) == lCnt);
+    assert(dAcc == (double )lMin / 4);
+    dAcc = 0; assert(kr_simd_max_double(gdValue, n, ptSel, &dAcc) == lCnt);
+    assert(dAcc == (double )lMax / 4);
+}
+
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#define BENCH(name, call) \
+    do { \
+        double dBegin = now_ns(); \
+        for (int r = 0; r < BENCH_ROUNDS; r++) { call; } \
+        double dNs = now_ns() - dBegin; \
+        printf("  %-12s %6.3f records/ns\n", name, \
+                (double )VALUE_NUMBER * BENCH_ROUNDS / dNs); \
+    } while(0)
+
+static void bench(const T_KRSimdSel *ptSel)
+{
+    long lAcc = 0;
+    double dAcc = 0;
+    volatile long lSink = 0;
+
+    BENCH("count", lSink += kr_simd_count(VALUE_NUMBER, ptSel));
+    BENCH("sum_int", lSink += kr_simd_sum_int(giValue, VALUE_NUMBER, ptSel, &lAcc));
+    BENCH("min_int", lSink += kr_simd_min_int(giValue, VALUE_NUMBER, ptSel, &lAcc));
+    BENCH("max_int", lSink += kr_simd_max_int(giValue, VALUE_NUMBER, ptSel, &lAcc));
+    BENCH("sum_long", lSink += kr_simd_sum_long(glValue, VALUE_NUMBER, ptSel, &lAcc));
+    BENCH("min_long", lSink += kr_simd_min_long(glValue, VALUE_NUMBER, ptSel, &lAcc));
+    BENCH("max_long", lSink += kr_simd_max_long(glValue, VALUE_NUMBER, ptSel, &lAcc));
+    BENCH("sum_double", lSink += kr_simd_sum_double(gdValue, VALUE_NUMBER, ptSel, &dAcc));
+    BENCH("min_double", lSink += kr_simd_min_double(gdValue, VALUE_NUMBER, ptSel, &dAcc));
+    BENCH("max_double", lSink += kr_simd_max_double(gdValue, VALUE_NUMBER, ptSel, &dAcc));
+}
+
+
+int main(int argc, char *argv[])
+{
+    srand(42);
+    for (int i = 0; i < VALUE_NUMBER; i++) {
+        gtTime[i] = 1000000 + i / 4;
+        giValue[i] = rand() % 2000001 - 1000000;
+        glValue[i] = giValue[i];
+        /*exact in binary, min and max compare equal*/
+        gdValue[i] = (double )giValue[i] / 4;
+    }
+    for (int i = 0; i < VALUE_NUMBER/64+1; i++) {
+        guiMask[i] = ((uint64_t )rand() << 32) ^ (uint64_t )rand();
+    }
+    /*out of order times, as late transactions come*/
+    gtTime[17] = 999000;
+    gtTime[4097] = 2000000;
+
+    T_KRSimdSel stAll = {gtTime, 0, (time_t )1<<40, NULL};
+    T_KRSimdSel stWindow = {gtTime, 1001000, 1020000, NULL};
+    T_KRSimdSel stMasked = {gtTime, 1001000, 1020000, guiMask};
+    T_KRSimdSel stNone = {gtTime, 0, 10, guiMask};
+
+    E_KRSimdLevel eBest = kr_simd_set_level(KR_SIMD_AVX2);
+    printf("best level => %s\n", kr_simd_level_name(eBest));
+    for (int l = KR_SIMD_SCALAR; l <= eBest; l++) {
+        assert(kr_simd_set_level((E_KRSimdLevel )l) == l);
+        assert(kr_simd_get_level() == l);
+        /*lengths around every vector width and tail*/
+        for (size_t n = 0; n < 70; n++) {
+            check(n, &stAll);
+            check(n, &stMasked);
+        }
+        check(VALUE_NUMBER, &stAll);
+        check(VALUE_NUMBER, &stWindow);
+        check(VALUE_NUMBER, &stMasked);
+        check(VALUE_NUMBER, &stNone);
+        /*the accumulator passed in is folded too*/
+        long lAcc = -2000000;
+        kr_simd_min_long(glValue, VALUE_NUMBER, &stMasked, &lAcc);
+        assert(lAcc == -2000000);
+        lAcc = 5;
+        kr_simd_sum_long(glValue, 0, &stMasked, &lAcc);
+        assert(lAcc == 5);
+    }
+
+    for (int l = KR_SIMD_SCALAR; l <= eBest; l++) {
+        kr_simd_set_level((E_KRSimdLevel )l);
+        printf("%s, masked window:\n", kr_simd_level_name((E_KRSimdLevel )l));
+        bench(&stMasked);
+    }
+
+    printf("Success!\n");
+    return 0;
+}
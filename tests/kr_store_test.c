@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+
+#include "krutils/kr_utils.h"
+#include "krdb/kr_db.h"
+
+#define KEEP_CNT   16
+#define SHARD_CNT  2
+#define KEY_CNT    5
+#define STORE_FILE "kr_store_test.krdb"
+
+/*proctime, transtime, key and amount, all long*/
+typedef struct _tradflow_t {
+    long lProcTime;
+    long lTransTime;
+    long lKey;
+    long lAmt;
+}T_TradFlow;
+
+/*amounts of each key's slot, oldest first, count in [0]*/
+static long glBefore[KEY_CNT][KEEP_CNT+1];
+static long glAfter[KEY_CNT][KEEP_CNT+1];
+
+
+/*a ring of KEEP_CNT records split into SHARD_CNT shards by key*/
+static T_KRDB *create_db(void)
+{
+    T_KRDB *ptDB = kr_db_create("test", NULL, NULL);
+    T_KRTable *ptTable = kr_table_create(ptDB, 1, "flow",
+            KR_SIZEKEEPMODE_RECORD, KEEP_CNT);
+    assert(ptTable != NULL);
+    ptTable->iFieldCnt = 4;
+    ptTable->ptFieldDef = kr_calloc(sizeof(T_KRFieldDef)*4);
+    for (int i=0; i<4; i++) {
+        ptTable->ptFieldDef[i].id = i;
+        ptTable->ptFieldDef[i].type = KR_TYPE_LONG;
+        ptTable->ptFieldDef[i].length = sizeof(long);
+        ptTable->ptFieldDef[i].offset = i*sizeof(long);
+    }
+    /*aligned as kr_db_define does*/
+    ptTable->iRecordSize = (sizeof(T_KRRecord)+sizeof(T_TradFlow)+0xf) & ~0xf;
+    ptTable->pRecordBuff = kr_calloc(ptTable->iRecordSize*KEEP_CNT);
+    assert(ptTable->pRecordBuff != NULL);
+
+    kr_index_create(ptDB, 1, "key", KR_TYPE_LONG);
+    assert(kr_index_table_create(ptDB, 1, 1, 2, 1) != NULL);
+    assert(kr_table_set_shards(ptTable, SHARD_CNT, 1) == 0);
+    return ptDB;
+}
+
+
+static void dump(T_KRDB *ptDB, long plAmt[KEY_CNT][KEEP_CNT+1])
+{
+    T_KRIndex *ptIndex = kr_index_get(ptDB, 1);
+    for (long lKey=0; lKey<KEY_CNT; lKey++) {
+        plAmt[lKey][0] = 0;
+        T_KRIndexSolt *ptIndexSlot = kr_index_slot_hold(ptIndex, &lKey);
+        if (ptIndexSlot == NULL) continue;
+        T_KRListNode *node = ptIndexSlot->pRecList->head;
+        for (; node; node=node->next) {
+            T_TradFlow *ptFlow = \
+                (T_TradFlow *)((T_KRRecord *)kr_list_value(node))->pRecBuf;
+            assert(ptFlow->lKey == lKey);
+            plAmt[lKey][++plAmt[lKey][0]] = ptFlow->lAmt;
+        }
+        kr_index_slot_release(ptIndexSlot);
+    }
+}
+
+
+/*drop amount lAmt of key lKey from what was dumped*/
+static void forget(long plAmt[KEY_CNT][KEEP_CNT+1], long lKey, long lAmt)
+{
+    long *pl = plAmt[lKey];
+    for (long i=1; i<=pl[0]; i++) {
+        if (pl[i] == lAmt) {
+            memmove(&pl[i], &pl[i+1], sizeof(long)*(pl[0]-i));
+            pl[0]--;
+            return;
+        }
+    }
+    assert(0);
+}
+
+
+int main(void)
+{
+    unlink(STORE_FILE);
+
+    /*a new file has no records*/
+    T_KRDB *ptDB = create_db();
+    T_KRTable *ptTable = kr_table_get(ptDB, 1);
+    assert(kr_table_store_open(ptTable, STORE_FILE) == 0);
+    for (long i=0; i<40; i++) {
+        T_TradFlow stFlow = {1000+i, 1000+i, i%KEY_CNT, i};
+        T_KRRecord *ptRecord = NULL;
+        assert(kr_table_ingest(ptTable, (char *)&stFlow, sizeof(stFlow),
+                    &ptRecord) == 0);
+    }
+    assert(ptTable->uiRecordNum == KEEP_CNT);
+    dump(ptDB, glBefore);
+
+    /*a crash in the middle of rewriting one leaves its sequence odd*/
+    T_KRRecord *ptTorn = kr_record_at(ptTable, 3);
+    T_TradFlow *ptFlow = (T_TradFlow *)ptTorn->pRecBuf;
+    long lTornKey = ptFlow->lKey, lTornAmt = ptFlow->lAmt;
+    ptTorn->uiSeq |= 1;
+    forget(glBefore, lTornKey, lTornAmt);
+    kr_db_drop(ptDB);
+
+    /*the same layout maps every record again*/
+    ptDB = create_db();
+    ptTable = kr_table_get(ptDB, 1);
+    assert(kr_table_store_open(ptTable, STORE_FILE) == KEEP_CNT);
+    assert(kr_db_rebuild(ptDB, SHARD_CNT) == 0);
+
+    /*the torn one is dropped, slots rebuilt in the order inserted*/
+    assert(ptTable->uiRecordNum == KEEP_CNT-1);
+    assert(ptTable->tMaxTransTime == 1039);
+    assert(kr_record_at(ptTable, 3)->ptTable == NULL);
+    dump(ptDB, glAfter);
+    for (int k=0; k<KEY_CNT; k++) {
+        assert(glAfter[k][0] == glBefore[k][0]);
+        for (long i=1; i<=glBefore[k][0]; i++) {
+            assert(glAfter[k][i] == glBefore[k][i]);
+        }
+    }
+
+    /*inserting goes on where it stopped*/
+    T_TradFlow stFlow = {1040, 1040, lTornKey, 40};
+    T_KRRecord *ptRecord = NULL;
+    assert(kr_table_ingest(ptTable, (char *)&stFlow, sizeof(stFlow),
+                &ptRecord) == 0);
+    assert(ptTable->tMaxTransTime == 1040);
+    kr_db_drop(ptDB);
+
+    unlink(STORE_FILE);
+    printf("Success!\n");
+    return 0;
+}
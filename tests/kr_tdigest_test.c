@@ -0,0 +1,58 @@
+#include "krutils/kr_utils.h"
+#include "krutils/kr_tdigest.h"
+#include <assert.h>
+#include <math.h>
+
+#define VALUE_NUMBER 100000
+
+
+int main(int argc, char *argv[])
+{
+    double qs[] = {0.01, 0.1, 0.5, 0.9, 0.95, 0.99, 0.999};
+    double value, error;
+
+    T_KRTDigest *krtd = kr_tdigest_new(100);
+    assert(krtd != NULL);
+    assert(isnan(kr_tdigest_quantile(krtd, 0.5)));
+
+    kr_tdigest_add(krtd, 42.0, 1);
+    assert(kr_tdigest_quantile(krtd, 0.5) == 42.0);
+
+    /* uniform 0..VALUE_NUMBER-1, shuffled */
+    kr_tdigest_reset(krtd);
+    for (int i = 0; i < VALUE_NUMBER; i++) {
+        kr_tdigest_add(krtd, (double )((i * 7919L) % VALUE_NUMBER), 1);
+    }
+    assert(kr_tdigest_total(krtd) == VALUE_NUMBER);
+    assert(krtd->merged <= krtd->capacity);
+    printf("centroids [%d] for [%d] values\n", krtd->merged, VALUE_NUMBER);
+
+    for (int i = 0; i < sizeof(qs)/sizeof(qs[0]); i++) {
+        value = kr_tdigest_quantile(krtd, qs[i]);
+        error = fabs(value - qs[i] * VALUE_NUMBER) / VALUE_NUMBER;
+        printf("q[%.3f] => [%.2f], error [%.5f]\n", qs[i], value, error);
+        assert(error < 0.01);
+    }
+    assert(kr_tdigest_quantile(krtd, 0) == 0);
+    assert(kr_tdigest_quantile(krtd, 1) == VALUE_NUMBER - 1);
+
+    /* merging two halves */
+    T_KRTDigest *low = kr_tdigest_new(100);
+    T_KRTDigest *high = kr_tdigest_new(100);
+    for (int i = 0; i < VALUE_NUMBER/2; i++) {
+        kr_tdigest_add(low, (double )i, 1);
+        kr_tdigest_add(high, (double )(i + VALUE_NUMBER/2), 1);
+    }
+    kr_tdigest_merge(low, high);
+    assert(kr_tdigest_total(low) == VALUE_NUMBER);
+    value = kr_tdigest_quantile(low, 0.95);
+    printf("merged q[0.95] => [%.2f]\n", value);
+    assert(fabs(value - 0.95 * VALUE_NUMBER) / VALUE_NUMBER < 0.01);
+
+    kr_tdigest_free(low);
+    kr_tdigest_free(high);
+    kr_tdigest_free(krtd);
+
+    printf("Success!\n");
+    return 0;
+}
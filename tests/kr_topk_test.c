@@ -0,0 +1,43 @@
+#include "krutils/kr_utils.h"
+#include "krutils/kr_topk.h"
+#include <assert.h>
+
+
+int main(int argc, char *argv[])
+{
+    char caKey[20];
+    T_KRTopKItem *top = NULL;
+
+    T_KRTopK *krtk = kr_topk_new(4);
+    assert(krtk != NULL);
+    assert(kr_topk_top(krtk) == NULL);
+
+    /* exact while keys fit */
+    for (int i = 0; i < 10; i++) {
+        snprintf(caKey, sizeof(caKey), "merchant_%d", i%3 ? 1 : 2);
+        kr_topk_add(krtk, caKey, strlen(caKey));
+    }
+    top = kr_topk_top(krtk);
+    printf("top [%.*s] => %lu\n", (int )top->len, top->key, top->count);
+    assert(top->count == 6 && memcmp(top->key, "merchant_1", top->len) == 0);
+    assert(kr_topk_count(krtk, "merchant_2", 10) == 4);
+    assert(kr_topk_count(krtk, "merchant_3", 10) == 0);
+
+    /* heavy hitter survives a long tail */
+    kr_topk_reset(krtk);
+    for (long l = 0; l < 10000; l++) {
+        long lKey = (l % 3 == 0) ? 42 : l;
+        kr_topk_add(krtk, &lKey, sizeof(lKey));
+    }
+    top = kr_topk_top(krtk);
+    printf("top [%ld] => %lu, error %lu, total %lu\n", 
+            *(long *)top->key, top->count, top->error, krtk->total);
+    assert(*(long *)top->key == 42);
+    assert(top->count >= 3334 && top->count - top->error <= 3334);
+    assert(krtk->total == 10000);
+
+    kr_topk_free(krtk);
+
+    printf("Success!\n");
+    return 0;
+}